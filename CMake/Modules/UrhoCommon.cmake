@@ -375,6 +375,11 @@ foreach (OPT
     endif ()
 endforeach ()
 
+# Make Bullet's pool allocators, solver and GImpact safe for the threaded simulation mode of PhysicsWorld. Every target that includes the Bullet headers must see the same definition, as it changes their inline functions
+if (URHO3D_PHYSICS AND URHO3D_THREADING)
+    add_definitions (-DBT_THREADSAFE=1)
+endif ()
+
 # TODO: The logic below is earmarked to be moved into SDL's CMakeLists.txt when refactoring the library dependency handling, until then ensure the DirectX package is not being searched again in external projects such as when building LuaJIT library
 if (WIN32 AND NOT CMAKE_PROJECT_NAME MATCHES ^Urho3D-ExternalProject-)
     set (DIRECTX_REQUIRED_COMPONENTS)
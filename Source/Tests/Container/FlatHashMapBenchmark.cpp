@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Container/FlatHashMap.h>
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Container/Str.h>
+#include <Urho3D/Math/StringHash.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Urho3D;
+
+/// Number of lookups per measurement.
+static const unsigned NUM_LOOKUPS = 10000000;
+/// Number of element visits per measurement.
+static const unsigned NUM_VISITS = 50000000;
+
+/// Return nanoseconds elapsed since a time point.
+static double NanosecondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Measure random lookups and full iteration of a map with string hash keys, and print the time per operation.
+template <class M> void Benchmark(const char* name, unsigned numElements)
+{
+    M map;
+    PODVector<StringHash> keys;
+    for (unsigned i = 0; i < numElements; ++i)
+    {
+        StringHash key(String("Key") + String(i));
+        keys.Push(key);
+        map[key] = i;
+    }
+
+    PODVector<StringHash> lookups;
+    srand(1);
+    for (unsigned i = 0; i < NUM_LOOKUPS; ++i)
+        lookups.Push(keys[rand() % numElements]);
+
+    // Accumulate the values so that the loops are not optimized away
+    unsigned long long sum = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (PODVector<StringHash>::ConstIterator i = lookups.Begin(); i != lookups.End(); ++i)
+        sum += map.Find(*i)->second_;
+    double lookupTime = NanosecondsSince(start) / NUM_LOOKUPS;
+
+    unsigned numPasses = NUM_VISITS / numElements;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < numPasses; ++i)
+    {
+        for (typename M::ConstIterator j = map.Begin(); j != map.End(); ++j)
+            sum += j->second_;
+    }
+    double iterationTime = NanosecondsSince(start) / ((double)numPasses * numElements);
+
+    printf("%-12s %6u elements: lookup %6.2f ns, iteration %5.2f ns per element (%llu)\n", name, numElements, lookupTime,
+        iterationTime, sum);
+}
+
+int main()
+{
+    const unsigned sizes[] = {16, 256, 4096, 65536};
+    for (unsigned i = 0; i < sizeof sizes / sizeof sizes[0]; ++i)
+    {
+        Benchmark<HashMap<StringHash, unsigned> >("HashMap", sizes[i]);
+        Benchmark<FlatHashMap<StringHash, unsigned> >("FlatHashMap", sizes[i]);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Container/FlatHashMap.h>
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Container/Str.h>
+#include <Urho3D/Graphics/Batch.h>
+
+#include "UnitTest.h"
+
+#include <cstdlib>
+
+using namespace Urho3D;
+
+/// Return whether a flat hash map has the same contents as a reference hash map.
+static bool Matches(const FlatHashMap<String, unsigned>& map, const HashMap<String, unsigned>& reference)
+{
+    if (map.Size() != reference.Size())
+        return false;
+    for (HashMap<String, unsigned>::ConstIterator i = reference.Begin(); i != reference.End(); ++i)
+    {
+        FlatHashMap<String, unsigned>::ConstIterator j = map.Find(i->first_);
+        if (j == map.End() || j->second_ != i->second_)
+            return false;
+    }
+    return true;
+}
+
+/// Insert and erase random keys, by key and by iterator, and compare against a hash map.
+static void TestRandomErase()
+{
+    FlatHashMap<String, unsigned> map;
+    HashMap<String, unsigned> reference;
+
+    srand(1);
+    for (unsigned i = 0; i < 100000; ++i)
+    {
+        String key(rand() % 2000);
+        switch (rand() % 4)
+        {
+        case 0:
+        case 1:
+            map[key] = i;
+            reference[key] = i;
+            break;
+
+        case 2:
+            TEST_CHECK(map.Erase(key) == reference.Erase(key));
+            break;
+
+        default:
+            {
+                FlatHashMap<String, unsigned>::Iterator it = map.Find(key);
+                TEST_CHECK((it != map.End()) == reference.Contains(key));
+                if (it != map.End())
+                {
+                    map.Erase(it);
+                    reference.Erase(key);
+                }
+            }
+            break;
+        }
+    }
+
+    TEST_CHECK(Matches(map, reference));
+
+    // Erase every other element while iterating
+    for (FlatHashMap<String, unsigned>::Iterator it = map.Begin(); it != map.End();)
+    {
+        if (it->second_ & 1)
+        {
+            reference.Erase(it->first_);
+            it = map.Erase(it);
+        }
+        else
+            ++it;
+    }
+
+    TEST_CHECK(Matches(map, reference));
+}
+
+/// Check that values with nested containers keep their storage when the map grows or erases elements.
+static void TestRelocate()
+{
+    FlatHashMap<unsigned, PODVector<unsigned> > map;
+    PODVector<const unsigned*> buffers;
+
+    for (unsigned i = 0; i < 1000; ++i)
+    {
+        PODVector<unsigned>& values = map[i];
+        for (unsigned j = 0; j < 4; ++j)
+            values.Push(i * 4 + j);
+        buffers.Push(values.Buffer());
+    }
+
+    for (unsigned i = 0; i < 1000; i += 3)
+        map.Erase(i);
+
+    TEST_CHECK(map.Size() == 666);
+    for (FlatHashMap<unsigned, PODVector<unsigned> >::ConstIterator it = map.Begin(); it != map.End(); ++it)
+    {
+        TEST_CHECK(it->first_ % 3 != 0);
+        TEST_CHECK(it->second_.Buffer() == buffers[it->first_]);
+        TEST_CHECK(it->second_.Size() == 4 && it->second_[3] == it->first_ * 4 + 3);
+    }
+
+    // Batch groups are relocated by swapping as well
+    FlatHashMap<unsigned, BatchGroup> groups;
+    PODVector<const InstanceData*> instanceBuffers;
+    for (unsigned i = 0; i < 100; ++i)
+    {
+        BatchGroup& group = groups[i];
+        group.distance_ = (float)i;
+        group.instances_.Resize(i + 1);
+        instanceBuffers.Push(group.instances_.Buffer());
+    }
+
+    groups.Erase(0);
+    for (FlatHashMap<unsigned, BatchGroup>::ConstIterator it = groups.Begin(); it != groups.End(); ++it)
+    {
+        TEST_CHECK(it->second_.distance_ == (float)it->first_);
+        TEST_CHECK(it->second_.instances_.Size() == it->first_ + 1);
+        TEST_CHECK(it->second_.instances_.Buffer() == instanceBuffers[it->first_]);
+    }
+}
+
+int main()
+{
+    TestRandomErase();
+    TestRelocate();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Container/FrameAllocator.h>
+
+#include "UnitTest.h"
+
+using namespace Urho3D;
+
+/// Number of values per vector, enough to need more than one arena chunk in total.
+static const unsigned NUM_VALUES = 10000;
+
+/// Fill a frame vector with values starting from a base.
+static void Fill(FramePODVector<unsigned>& vector, unsigned base)
+{
+    for (unsigned i = 0; i < NUM_VALUES; ++i)
+        vector.Push(base + i);
+}
+
+/// Return whether a frame vector still holds the values starting from a base.
+static bool IsIntact(const FramePODVector<unsigned>& vector, unsigned base)
+{
+    if (vector.Size() != NUM_VALUES)
+        return false;
+    for (unsigned i = 0; i < NUM_VALUES; ++i)
+    {
+        if (vector[i] != base + i)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    // A vector alive across the frame boundary must not be overwritten by allocations in the new frame
+    {
+        FramePODVector<unsigned> spanning;
+        Fill(spanning, 0);
+
+        FrameAllocator::BeginFrame();
+        FramePODVector<unsigned> next;
+        Fill(next, NUM_VALUES);
+
+        TEST_CHECK(IsIntact(spanning, 0));
+        TEST_CHECK(IsIntact(next, NUM_VALUES));
+    }
+
+    // Once no vectors are held, the arena is rewound and steady-state frames reuse the same memory
+    unsigned reservedBytes = 0;
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        FrameAllocator::BeginFrame();
+        FramePODVector<unsigned> first;
+        Fill(first, 0);
+        FramePODVector<unsigned> second;
+        Fill(second, NUM_VALUES);
+        TEST_CHECK(IsIntact(first, 0));
+        TEST_CHECK(IsIntact(second, NUM_VALUES));
+
+        if (!i)
+            reservedBytes = FrameAllocator::GetReservedBytes();
+        else
+            TEST_CHECK(FrameAllocator::GetReservedBytes() == reservedBytes);
+    }
+
+    return TEST_RESULT();
+}
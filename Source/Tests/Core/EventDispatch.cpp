@@ -0,0 +1,334 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+
+#include "UnitTest.h"
+
+#include <functional>
+
+using namespace Urho3D;
+
+/// Event sent in the tests.
+URHO3D_EVENT(E_TESTEVENT, TestEvent)
+{
+    URHO3D_PARAM(P_VALUE, Value); // int
+}
+
+/// Event sent from within the test event handlers.
+URHO3D_EVENT(E_NESTEDEVENT, NestedEvent)
+{
+}
+
+/// Strongly typed data of the test event.
+struct TestEventData
+{
+    /// Convert to event data map.
+    void ToVariantMap(VariantMap& eventData) const { eventData[TestEvent::P_VALUE] = value_; }
+    /// Convert from event data map.
+    void FromVariantMap(const VariantMap& eventData)
+    {
+        const Variant* value = eventData[TestEvent::P_VALUE];
+        value_ = value ? value->GetInt() : 0;
+    }
+
+    /// Value.
+    int value_;
+};
+
+/// Object that counts the events it receives and can run an action in its handlers.
+class Receiver : public Object
+{
+    URHO3D_OBJECT(Receiver, Object);
+
+public:
+    /// Construct.
+    explicit Receiver(Context* context) :
+        Object(context),
+        numEvents_(0),
+        numSpecificEvents_(0),
+        numNestedEvents_(0),
+        expectedValue_(0)
+    {
+    }
+
+    /// Subscribe to the test event from any sender.
+    void SubscribeNonSpecific() { SubscribeToEvent(E_TESTEVENT, URHO3D_HANDLER(Receiver, HandleEvent)); }
+    /// Subscribe to the test event from one sender.
+    void SubscribeSpecific(Object* sender) { SubscribeToEvent(sender, E_TESTEVENT, URHO3D_HANDLER(Receiver, HandleSpecificEvent)); }
+    /// Subscribe to the test event from any sender with a typed handler.
+    void SubscribeTyped() { SubscribeToEvent(E_TESTEVENT, URHO3D_TYPED_HANDLER(Receiver, HandleTypedEvent)); }
+    /// Subscribe to the nested event from one sender.
+    void SubscribeNested(Object* sender) { SubscribeToEvent(sender, E_NESTEDEVENT, URHO3D_HANDLER(Receiver, HandleNestedEvent)); }
+
+    /// Reset the counters.
+    void Reset()
+    {
+        numEvents_ = 0;
+        numSpecificEvents_ = 0;
+        numNestedEvents_ = 0;
+    }
+
+    /// Number of events received through the non-specific handler.
+    unsigned numEvents_;
+    /// Number of events received through the specific handler.
+    unsigned numSpecificEvents_;
+    /// Number of nested events received.
+    unsigned numNestedEvents_;
+    /// Value expected in the event data by the value handlers.
+    int expectedValue_;
+    /// Action run in the test event handlers.
+    std::function<void()> action_;
+
+private:
+    /// Handle the test event from any sender.
+    void HandleEvent(StringHash eventType, VariantMap& eventData)
+    {
+        ++numEvents_;
+        if (action_)
+            action_();
+    }
+
+    /// Handle the test event from the specific sender.
+    void HandleSpecificEvent(StringHash eventType, VariantMap& eventData)
+    {
+        ++numSpecificEvents_;
+        if (action_)
+            action_();
+    }
+
+    /// Handle the test event with a typed handler. Check and increment the value.
+    void HandleTypedEvent(StringHash eventType, TestEventData& event)
+    {
+        TEST_CHECK(event.value_ == expectedValue_);
+        ++event.value_;
+    }
+
+    /// Handle the nested event.
+    void HandleNestedEvent(StringHash eventType, VariantMap& eventData) { ++numNestedEvents_; }
+};
+
+/// Receiver that checks and increments the value of the test event in a VariantMap handler.
+class ValueReceiver : public Object
+{
+    URHO3D_OBJECT(ValueReceiver, Object);
+
+public:
+    /// Construct and subscribe.
+    ValueReceiver(Context* context, int expectedValue) :
+        Object(context),
+        expectedValue_(expectedValue)
+    {
+        SubscribeToEvent(E_TESTEVENT, URHO3D_HANDLER(ValueReceiver, HandleEvent));
+    }
+
+private:
+    /// Handle the test event.
+    void HandleEvent(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace TestEvent;
+
+        TEST_CHECK(eventData[P_VALUE].GetInt() == expectedValue_);
+        eventData[P_VALUE] = eventData[P_VALUE].GetInt() + 1;
+    }
+
+    /// Value expected in the event data.
+    int expectedValue_;
+};
+
+/// Create receivers.
+static Vector<SharedPtr<Receiver> > CreateReceivers(Context* context, unsigned count)
+{
+    Vector<SharedPtr<Receiver> > receivers;
+    for (unsigned i = 0; i < count; ++i)
+        receivers.Push(SharedPtr<Receiver>(new Receiver(context)));
+    return receivers;
+}
+
+/// Check that receivers subscribed during a send get the specific event only from the next send, but the non-specific event already from the current one, and that receivers unsubscribed before their turn no longer get it. Optionally create the non-specific receiver group before the send, instead of in a handler.
+static void TestSubscribeDuringSend(Context* context, bool existingGroup)
+{
+    SharedPtr<Receiver> sender(new Receiver(context));
+    Vector<SharedPtr<Receiver> > receivers = CreateReceivers(context, 5);
+    SharedPtr<Receiver> first = receivers[0];
+
+    first->SubscribeSpecific(sender);
+    receivers[3]->SubscribeSpecific(sender);
+    if (existingGroup)
+        receivers[4]->SubscribeNonSpecific();
+
+    first->action_ = [&]()
+    {
+        receivers[1]->SubscribeSpecific(sender);
+        receivers[2]->SubscribeNonSpecific();
+        receivers[3]->UnsubscribeFromEvent(sender, E_TESTEVENT);
+        receivers[4]->UnsubscribeFromEvent(E_TESTEVENT);
+        first->action_ = nullptr;
+    };
+    sender->SendEvent(E_TESTEVENT);
+
+    TEST_CHECK(first->numSpecificEvents_ == 1);
+    TEST_CHECK(receivers[1]->numSpecificEvents_ == 0);
+    TEST_CHECK(receivers[2]->numEvents_ == 1);
+    TEST_CHECK(receivers[3]->numSpecificEvents_ == 0);
+    TEST_CHECK(receivers[4]->numEvents_ == 0);
+
+    sender->SendEvent(E_TESTEVENT);
+    TEST_CHECK(first->numSpecificEvents_ == 2);
+    TEST_CHECK(receivers[1]->numSpecificEvents_ == 1);
+    TEST_CHECK(receivers[2]->numEvents_ == 2);
+    TEST_CHECK(receivers[3]->numSpecificEvents_ == 0);
+    TEST_CHECK(receivers[4]->numEvents_ == 0);
+
+    // A handler unsubscribing itself does not get the event again
+    first->action_ = [&]() { first->UnsubscribeFromAllEvents(); };
+    sender->SendEvent(E_TESTEVENT);
+    sender->SendEvent(E_TESTEVENT);
+    TEST_CHECK(first->numSpecificEvents_ == 3);
+    TEST_CHECK(receivers[1]->numSpecificEvents_ == 3);
+    TEST_CHECK(receivers[2]->numEvents_ == 4);
+}
+
+/// Check that destroying the sender in a handler stops the send, both among the specific and the non-specific receivers, and leaves the dispatch state intact for the next sends.
+static void TestSenderDestruction(Context* context)
+{
+    SharedPtr<Receiver> sender(new Receiver(context));
+    SharedPtr<Receiver> other(new Receiver(context));
+    other->SubscribeNonSpecific();
+    Vector<SharedPtr<Receiver> > receivers = CreateReceivers(context, 4);
+    for (unsigned i = 0; i < receivers.Size(); ++i)
+    {
+        receivers[i]->SubscribeSpecific(sender);
+        receivers[i]->SubscribeNonSpecific();
+    }
+
+    // Destroyed by a specific handler
+    receivers[1]->action_ = [&]() { sender.Reset(); };
+    sender->SendEvent(E_TESTEVENT);
+    TEST_CHECK(!sender);
+    TEST_CHECK(receivers[0]->numSpecificEvents_ == 1 && receivers[1]->numSpecificEvents_ == 1);
+    TEST_CHECK(receivers[2]->numSpecificEvents_ == 0 && receivers[3]->numSpecificEvents_ == 0);
+    TEST_CHECK(other->numEvents_ == 0);
+
+    // Destroyed by the first non-specific handler
+    receivers[1]->action_ = nullptr;
+    sender = new Receiver(context);
+    receivers[0]->SubscribeSpecific(sender);
+    other->action_ = [&]() { sender.Reset(); };
+    sender->SendEvent(E_TESTEVENT);
+    TEST_CHECK(!sender);
+    TEST_CHECK(receivers[0]->numSpecificEvents_ == 2);
+    TEST_CHECK(other->numEvents_ == 1);
+    for (unsigned i = 0; i < receivers.Size(); ++i)
+        TEST_CHECK(receivers[i]->numEvents_ == 0);
+
+    // The next send delivers to every receiver once
+    other->action_ = nullptr;
+    sender = new Receiver(context);
+    receivers[0]->SubscribeSpecific(sender);
+    for (unsigned i = 0; i < receivers.Size(); ++i)
+        receivers[i]->Reset();
+    other->Reset();
+    sender->SendEvent(E_TESTEVENT);
+    TEST_CHECK(receivers[0]->numSpecificEvents_ == 1 && receivers[0]->numEvents_ == 0);
+    for (unsigned i = 1; i < receivers.Size(); ++i)
+        TEST_CHECK(receivers[i]->numSpecificEvents_ == 0 && receivers[i]->numEvents_ == 1);
+    TEST_CHECK(other->numEvents_ == 1);
+}
+
+/// Check that receivers subscribed both specifically and non-specifically get the event once through the specific handler, also when nested sends grow the processed receiver stack in the middle of the send.
+static void TestNoDoubleDelivery(Context* context)
+{
+    SharedPtr<Receiver> sender(new Receiver(context));
+    SharedPtr<Receiver> nestedSender(new Receiver(context));
+    Vector<SharedPtr<Receiver> > receivers = CreateReceivers(context, 20);
+    Vector<SharedPtr<Receiver> > nestedReceivers = CreateReceivers(context, 500);
+
+    for (unsigned i = 0; i < receivers.Size(); ++i)
+    {
+        if (i % 3 != 2)
+            receivers[i]->SubscribeSpecific(sender);
+        if (i % 3 != 0)
+            receivers[i]->SubscribeNonSpecific();
+
+        // Each handler sends a nested event, which stacks its specific receivers on top of the outer send's receivers and
+        // their duplicate check table
+        receivers[i]->action_ = [&]() { nestedSender->SendEvent(E_NESTEDEVENT); };
+    }
+    for (unsigned i = 0; i < nestedReceivers.Size(); ++i)
+        nestedReceivers[i]->SubscribeNested(nestedSender);
+
+    sender->SendEvent(E_TESTEVENT);
+
+    for (unsigned i = 0; i < receivers.Size(); ++i)
+    {
+        TEST_CHECK(receivers[i]->numSpecificEvents_ == (i % 3 != 2 ? 1 : 0));
+        TEST_CHECK(receivers[i]->numEvents_ == (i % 3 == 2 ? 1 : 0));
+    }
+    for (unsigned i = 0; i < nestedReceivers.Size(); ++i)
+        TEST_CHECK(nestedReceivers[i]->numNestedEvents_ == receivers.Size());
+}
+
+/// Check that typed and VariantMap handlers see each other's changes, whether the event is sent typed or as a VariantMap.
+static void TestTypedHandlers(Context* context)
+{
+    SharedPtr<Receiver> sender(new Receiver(context));
+    Vector<SharedPtr<Object> > receivers;
+    for (int i = 0; i < 6; ++i)
+    {
+        // Alternate pairs of typed and VariantMap handlers
+        if (i & 2)
+            receivers.Push(SharedPtr<Object>(new ValueReceiver(context, i)));
+        else
+        {
+            SharedPtr<Receiver> receiver(new Receiver(context));
+            receiver->expectedValue_ = i;
+            receiver->SubscribeTyped();
+            receivers.Push(receiver);
+        }
+    }
+
+    TestEventData event;
+    event.value_ = 0;
+    sender->SendTypedEvent(E_TESTEVENT, event);
+    TEST_CHECK(event.value_ == 6);
+
+    using namespace TestEvent;
+    VariantMap& eventData = sender->GetEventDataMap();
+    eventData[P_VALUE] = 0;
+    sender->SendEvent(E_TESTEVENT, eventData);
+    TEST_CHECK(eventData[P_VALUE].GetInt() == 6);
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+
+    TestSubscribeDuringSend(context, false);
+    TestSubscribeDuringSend(context, true);
+    TestSenderDestruction(context);
+    TestNoDoubleDelivery(context);
+    TestTypedHandlers(context);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Thread.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include "UnitTest.h"
+
+#include <atomic>
+
+using namespace Urho3D;
+
+/// Number of worker threads.
+static const unsigned NUM_THREADS = 3;
+/// Number of outer ranges in the nested ParallelFor test.
+static const unsigned NUM_OUTER = 64;
+/// Number of inner ranges per outer range in the nested ParallelFor test.
+static const unsigned NUM_INNER = 256;
+
+/// Thread that is not owned by the work queue and records its thread index.
+class UserThread : public Thread
+{
+public:
+    /// Record the thread index.
+    void ThreadFunction() override { threadIndex_ = WorkQueue::GetCurrentThreadIndex(); }
+
+    /// Thread index seen by the thread.
+    unsigned threadIndex_{};
+};
+
+/// Data of a prioritized work item.
+struct PriorityItemData
+{
+    /// Execution counter shared by the items.
+    std::atomic<unsigned>* counter_;
+    /// Value of the counter when the item was executed.
+    unsigned order_;
+};
+
+/// Work function of the prioritized items.
+static void PriorityWork(const WorkItem* item, unsigned /*threadIndex*/)
+{
+    auto* data = static_cast<PriorityItemData*>(item->aux_);
+    data->order_ = (*data->counter_)++;
+}
+
+/// Check the thread indices of the main, worker and other threads.
+static void TestThreadIndices(WorkQueue* queue)
+{
+    TEST_CHECK(WorkQueue::GetCurrentThreadIndex() == 0);
+
+    UserThread thread;
+    thread.Run();
+    thread.Stop();
+    TEST_CHECK(thread.threadIndex_ == NON_WORKER_THREAD_INDEX);
+
+    std::atomic<bool> indexMatches(true);
+    queue->ParallelFor(1000, 1, [&](unsigned begin, unsigned end, unsigned threadIndex)
+    {
+        if (threadIndex > NUM_THREADS || threadIndex != WorkQueue::GetCurrentThreadIndex())
+            indexMatches = false;
+    });
+    TEST_CHECK(indexMatches);
+}
+
+/// Check that a nested ParallelFor processes every element once, also when called from the worker threads, and that the worker threads steal ranges.
+static void TestNestedParallelFor(WorkQueue* queue)
+{
+    static std::atomic<unsigned> counts[NUM_OUTER * NUM_INNER];
+    std::atomic<unsigned> outerThreads(0);
+    std::atomic<unsigned> innerThreads(0);
+    std::atomic<bool> workerNested(false);
+
+    queue->ParallelFor(NUM_OUTER, 1, [&](unsigned outerBegin, unsigned outerEnd, unsigned outerThreadIndex)
+    {
+        outerThreads |= 1u << outerThreadIndex;
+        for (unsigned i = outerBegin; i < outerEnd; ++i)
+        {
+            if (outerThreadIndex)
+                workerNested = true;
+
+            queue->ParallelFor(NUM_INNER, 4, [&](unsigned innerBegin, unsigned innerEnd, unsigned innerThreadIndex)
+            {
+                innerThreads |= 1u << innerThreadIndex;
+                for (unsigned j = innerBegin; j < innerEnd; ++j)
+                    ++counts[i * NUM_INNER + j];
+
+                // Give the other threads time to steal
+                Time::Sleep(0);
+            });
+        }
+
+        // Make sure that the outer ranges take long enough to be spread over the threads
+        HiresTimer timer;
+        while (timer.GetUSec(false) < 500)
+        {
+        }
+    });
+
+    bool allOnce = true;
+    for (unsigned i = 0; i < NUM_OUTER * NUM_INNER; ++i)
+        allOnce &= counts[i] == 1;
+    TEST_CHECK(allOnce);
+    TEST_CHECK(workerNested);
+
+    // The main thread takes the whole range at first, so the worker threads only get to execute ranges by stealing them
+    TEST_CHECK(outerThreads & ~1u);
+    TEST_CHECK(innerThreads & ~1u);
+}
+
+/// Check that Complete() finishes the items of at least the specified priority, in priority order when executed by one thread.
+static void TestPriorities(WorkQueue* queue, bool threaded)
+{
+    const unsigned priorities[] = { 1, 3, 0, 2, 3, 1, 0, 2 };
+    const unsigned numItems = sizeof priorities / sizeof priorities[0];
+    std::atomic<unsigned> counter(0);
+    PriorityItemData data[numItems];
+    Vector<SharedPtr<WorkItem> > items;
+
+    for (unsigned i = 0; i < numItems; ++i)
+    {
+        data[i].counter_ = &counter;
+        data[i].order_ = M_MAX_UNSIGNED;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = priorities[i];
+        item->workFunction_ = PriorityWork;
+        item->aux_ = &data[i];
+        items.Push(item);
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(2);
+    TEST_CHECK(queue->IsCompleted(2));
+    for (unsigned i = 0; i < numItems; ++i)
+    {
+        if (priorities[i] >= 2)
+            TEST_CHECK(data[i].order_ != M_MAX_UNSIGNED);
+        else if (!threaded)
+            TEST_CHECK(data[i].order_ == M_MAX_UNSIGNED);
+    }
+
+    queue->Complete(0);
+    TEST_CHECK(queue->IsCompleted(0));
+    TEST_CHECK(counter == numItems);
+    for (unsigned i = 0; i < numItems; ++i)
+    {
+        TEST_CHECK(data[i].order_ < numItems);
+
+        // Without worker threads, the main thread takes the items in descending priority order
+        for (unsigned j = 0; j < numItems && !threaded; ++j)
+        {
+            if (priorities[i] > priorities[j])
+                TEST_CHECK(data[i].order_ < data[j].order_);
+        }
+    }
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+
+    {
+        SharedPtr<WorkQueue> queue(new WorkQueue(context));
+        TestPriorities(queue, false);
+    }
+
+    SharedPtr<WorkQueue> queue(new WorkQueue(context));
+    queue->CreateThreads(NUM_THREADS);
+    TestThreadIndices(queue);
+    TestNestedParallelFor(queue);
+    TestPriorities(queue, true);
+
+    return TEST_RESULT();
+}
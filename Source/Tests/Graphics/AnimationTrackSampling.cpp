@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Graphics/Animation.h>
+
+#include "UnitTest.h"
+
+#include <cstdlib>
+
+using namespace Urho3D;
+
+/// Number of keyframes in the test track.
+static const unsigned NUM_KEYFRAMES = 50;
+/// Animation length.
+static const float LENGTH = 10.0f;
+
+/// Return a random float between 0 and 1.
+static float RandomFloat() { return (float)rand() / (float)RAND_MAX; }
+
+/// Create a track with irregular keyframe times, changing position and rotation, and constant scale.
+static AnimationTrack CreateTrack()
+{
+    AnimationTrack track;
+    track.channelMask_ = CHANNEL_POSITION | CHANNEL_ROTATION | CHANNEL_SCALE;
+
+    float time = 0.0f;
+    for (unsigned i = 0; i < NUM_KEYFRAMES; ++i)
+    {
+        AnimationKeyFrame keyFrame;
+        keyFrame.time_ = time;
+        keyFrame.position_ = Vector3(RandomFloat(), RandomFloat(), RandomFloat()) * 10.0f;
+        keyFrame.rotation_ = Quaternion(RandomFloat() * 360.0f, Vector3(RandomFloat(), RandomFloat(), RandomFloat() + 0.1f).Normalized());
+        keyFrame.scale_ = Vector3(1.0f, 2.0f, 3.0f);
+        track.AddKeyFrame(keyFrame);
+        time += (0.5f + RandomFloat()) * LENGTH / NUM_KEYFRAMES;
+    }
+
+    return track;
+}
+
+/// Check that the keyframe search finds the last keyframe at or before a time, whatever the previous index.
+static void TestKeyFrameSearch(const AnimationTrack& track)
+{
+    unsigned numKeyFrames = track.GetNumKeyFrames();
+    for (unsigned i = 0; i < 10000; ++i)
+    {
+        float time = RandomFloat() * track.GetKeyFrameTime(numKeyFrames - 1) * 1.1f;
+        unsigned index = (unsigned)rand() % (numKeyFrames + 2);
+        track.GetKeyFrameIndex(time, index);
+
+        TEST_CHECK(index < numKeyFrames);
+        TEST_CHECK(track.GetKeyFrameTime(index) <= time);
+        TEST_CHECK(index + 1 == numKeyFrames || time < track.GetKeyFrameTime(index + 1));
+    }
+
+    // Before the first keyframe, the first one is returned
+    unsigned index = numKeyFrames / 2;
+    track.GetKeyFrameIndex(-1.0f, index);
+    TEST_CHECK(index == 0);
+}
+
+/// Check that a compressed track samples the same as the uncompressed one, within the rotation quantization error.
+static void TestCompressedSampling(const AnimationTrack& track, const AnimationTrack& compressed, bool looped)
+{
+    unsigned index = 0;
+    unsigned compressedIndex = 0;
+    for (unsigned i = 0; i <= 1000; ++i)
+    {
+        // Advance through the animation like playback does, using the previous index
+        float time = LENGTH * i / 1000.0f;
+        Vector3 position, compressedPosition, scale, compressedScale;
+        Quaternion rotation, compressedRotation;
+        track.Sample(time, LENGTH, looped, index, position, rotation, scale);
+        compressed.Sample(time, LENGTH, looped, compressedIndex, compressedPosition, compressedRotation, compressedScale);
+
+        TEST_CHECK(index == compressedIndex);
+        TEST_CHECK((compressedPosition - position).Length() < 1.0e-4f);
+        TEST_CHECK(Abs(compressedRotation.DotProduct(rotation)) > 0.9999f);
+        TEST_CHECK((compressedScale - scale).Length() < 1.0e-4f);
+    }
+}
+
+int main()
+{
+    srand(1);
+    AnimationTrack track = CreateTrack();
+    AnimationTrack compressed = track;
+    compressed.Compress();
+
+    TEST_CHECK(!track.IsCompressed());
+    TEST_CHECK(compressed.IsCompressed());
+    TEST_CHECK(compressed.GetNumKeyFrames() == NUM_KEYFRAMES);
+    TEST_CHECK(compressed.constantMask_ == CHANNEL_SCALE);
+    TEST_CHECK(compressed.GetMemoryUse() < track.GetMemoryUse());
+
+    TestKeyFrameSearch(track);
+    TestKeyFrameSearch(compressed);
+    TestCompressedSampling(track, compressed, false);
+    TestCompressedSampling(track, compressed, true);
+
+    // Keyframes read from the compressed track match the originals
+    for (unsigned i = 0; i < NUM_KEYFRAMES; ++i)
+    {
+        AnimationKeyFrame keyFrame = compressed.GetKeyFrame(i);
+        TEST_CHECK(keyFrame.time_ == track.keyFrames_[i].time_);
+        TEST_CHECK(keyFrame.position_ == track.keyFrames_[i].position_);
+        TEST_CHECK(Abs(keyFrame.rotation_.DotProduct(track.keyFrames_[i].rotation_)) > 0.9999f);
+        TEST_CHECK(keyFrame.scale_ == track.keyFrames_[i].scale_);
+    }
+    TEST_CHECK(compressed.IsCompressed());
+
+    // Decompressing restores editable keyframes
+    compressed.Decompress();
+    TEST_CHECK(!compressed.IsCompressed());
+    TEST_CHECK(compressed.keyFrames_.Size() == NUM_KEYFRAMES);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Batch.h>
+
+#include "UnitTest.h"
+
+#include <cstdlib>
+
+using namespace Urho3D;
+
+/// Batch count of the small queues, which are sorted as a single chunk.
+static const unsigned SMALL_QUEUE_SIZE = 1000;
+/// Batch count of the large queues, which are sorted in parallel chunks when a work queue is given.
+static const unsigned LARGE_QUEUE_SIZE = 20000;
+
+/// Compare batches by render order, then distance from front to back, then state. This is the comparator of the previous comparison sort.
+static bool CompareBatchesFrontToBack(Batch* lhs, Batch* rhs)
+{
+    if (lhs->renderOrder_ != rhs->renderOrder_)
+        return lhs->renderOrder_ < rhs->renderOrder_;
+    else if (lhs->distance_ != rhs->distance_)
+        return lhs->distance_ < rhs->distance_;
+    else
+        return lhs->sortKey_ < rhs->sortKey_;
+}
+
+/// Compare batches by render order, then distance from back to front, then state. This is the comparator of the previous comparison sort.
+static bool CompareBatchesBackToFront(Batch* lhs, Batch* rhs)
+{
+    if (lhs->renderOrder_ != rhs->renderOrder_)
+        return lhs->renderOrder_ < rhs->renderOrder_;
+    else if (lhs->distance_ != rhs->distance_)
+        return lhs->distance_ > rhs->distance_;
+    else
+        return lhs->sortKey_ < rhs->sortKey_;
+}
+
+/// Fill a queue with random batches. Distances are unique unless ties are requested, so that the front to back order is fully defined.
+static void FillQueue(BatchQueue& queue, unsigned count, bool distanceTies)
+{
+    queue.Clear(0);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Batch batch;
+        batch.renderOrder_ = (unsigned char)(rand() % 3 * 64);
+        batch.distance_ = distanceTies ? (float)(rand() % 64) : (float)(i * 7919 % count) * 0.25f;
+
+        // Base pass flag, shader, light queue, material and geometry in the layout of Batch::CalculateSortKey()
+        unsigned long long shaderID = (unsigned long long)(rand() % 8) | (rand() % 4 ? 0 : 0x8000);
+        batch.sortKey_ = (shaderID << 48) | ((unsigned long long)(rand() % 3) << 32) | ((unsigned long long)(rand() % 16) << 16) |
+            (unsigned long long)(rand() % 32);
+        queue.batches_.Push(batch);
+    }
+}
+
+/// Return the batches of a queue in the order of the previous front to back sort. It sorted by distance, renamed the shaders, materials and geometries in the order they were first seen, and sorted by the renamed state.
+static PODVector<Batch*> SortFrontToBackReference(BatchQueue& queue)
+{
+    PODVector<Batch*> batches;
+    for (unsigned i = 0; i < queue.batches_.Size(); ++i)
+        batches.Push(&queue.batches_[i]);
+    Sort(batches.Begin(), batches.End(), CompareBatchesFrontToBack);
+
+    HashMap<unsigned, unsigned> shaderRanks;
+    HashMap<unsigned, unsigned> materialRanks;
+    HashMap<unsigned, unsigned> geometryRanks;
+    HashMap<Batch*, unsigned long long> rankedKeys;
+    for (PODVector<Batch*>::ConstIterator i = batches.Begin(); i != batches.End(); ++i)
+    {
+        Batch* batch = *i;
+        auto shaderID = (unsigned)(batch->sortKey_ >> 32);
+        auto materialID = (unsigned)((batch->sortKey_ >> 16) & 0xffff);
+        auto geometryID = (unsigned)(batch->sortKey_ & 0xffff);
+        if (!shaderRanks.Contains(shaderID))
+            shaderRanks[shaderID] = shaderRanks.Size();
+        if (!materialRanks.Contains(materialID))
+            materialRanks[materialID] = materialRanks.Size();
+        if (!geometryRanks.Contains(geometryID))
+            geometryRanks[geometryID] = geometryRanks.Size();
+
+        rankedKeys[batch] = ((unsigned long long)(shaderRanks[shaderID] | (shaderID & 0x80000000)) << 32) |
+            ((unsigned long long)materialRanks[materialID] << 16) | geometryRanks[geometryID];
+    }
+
+    // Sort by the renamed state like CompareBatchesState, without changing the batches
+    Sort(batches.Begin(), batches.End(), [&rankedKeys](Batch* lhs, Batch* rhs)
+    {
+        if (lhs->renderOrder_ != rhs->renderOrder_)
+            return lhs->renderOrder_ < rhs->renderOrder_;
+        unsigned long long lhsKey = rankedKeys[lhs];
+        unsigned long long rhsKey = rankedKeys[rhs];
+        if (lhsKey != rhsKey)
+            return lhsKey < rhsKey;
+        return lhs->distance_ < rhs->distance_;
+    });
+    return batches;
+}
+
+/// Check that the front to back sort gives the order of the previous sort.
+static void TestFrontToBack(unsigned count, WorkQueue* workQueue)
+{
+    BatchQueue queue;
+    FillQueue(queue, count, false);
+    PODVector<Batch*> expected = SortFrontToBackReference(queue);
+
+    queue.SortFrontToBack(workQueue);
+    TEST_CHECK(queue.sortedBatches_.Size() == count);
+    TEST_CHECK(queue.sortedBatches_ == expected);
+}
+
+/// Check that the back to front sort gives the order of the previous sort. Batches that compare equal may be in any order, so compare their keys.
+static void TestBackToFront(unsigned count, WorkQueue* workQueue, bool distanceTies)
+{
+    BatchQueue queue;
+    FillQueue(queue, count, distanceTies);
+    PODVector<Batch*> expected;
+    for (unsigned i = 0; i < count; ++i)
+        expected.Push(&queue.batches_[i]);
+    Sort(expected.Begin(), expected.End(), CompareBatchesBackToFront);
+
+    queue.SortBackToFront(workQueue);
+    TEST_CHECK(queue.sortedBatches_.Size() == count);
+    for (unsigned i = 0; i < count && i < queue.sortedBatches_.Size(); ++i)
+    {
+        Batch* batch = queue.sortedBatches_[i];
+        TEST_CHECK(batch->renderOrder_ == expected[i]->renderOrder_);
+        TEST_CHECK(batch->distance_ == expected[i]->distance_);
+        TEST_CHECK(batch->sortKey_ == expected[i]->sortKey_);
+    }
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    auto* workQueue = new WorkQueue(context);
+    context->RegisterSubsystem(workQueue);
+    workQueue->CreateThreads(3);
+
+    // Single chunk without and with a work queue, then parallel chunks
+    TestFrontToBack(SMALL_QUEUE_SIZE, nullptr);
+    TestFrontToBack(SMALL_QUEUE_SIZE, workQueue);
+    TestFrontToBack(LARGE_QUEUE_SIZE, nullptr);
+    TestFrontToBack(LARGE_QUEUE_SIZE, workQueue);
+
+    // Batches at the same distance are ordered by state, although only the most significant state bits fit in the key
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        bool distanceTies = i != 0;
+        TestBackToFront(SMALL_QUEUE_SIZE, nullptr, distanceTies);
+        TestBackToFront(SMALL_QUEUE_SIZE, workQueue, distanceTies);
+        TestBackToFront(LARGE_QUEUE_SIZE, nullptr, distanceTies);
+        TestBackToFront(LARGE_QUEUE_SIZE, workQueue, distanceTies);
+    }
+
+    return TEST_RESULT();
+}
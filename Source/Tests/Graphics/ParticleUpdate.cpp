@@ -0,0 +1,226 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/ParticleEffect.h>
+#include <Urho3D/Graphics/ParticleEmitter.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "UnitTest.h"
+
+using namespace Urho3D;
+
+/// Scene timestep.
+static const float TIME_STEP = 1.0f / 60.0f;
+/// Number of updates per particle count.
+static const unsigned NUM_STEPS = 90;
+/// Allowed relative difference to the reference, as the vectorized update may round differently.
+static const float TOLERANCE = 1e-4f;
+
+/// Return whether a value is close to the reference.
+static bool Near(float value, float reference)
+{
+    return Abs(value - reference) <= TOLERANCE * Max(1.0f, Abs(reference));
+}
+
+/// Return whether a vector is close to the reference.
+static bool Near(const Vector3& value, const Vector3& reference)
+{
+    return Near(value.x_, reference.x_) && Near(value.y_, reference.y_) && Near(value.z_, reference.z_);
+}
+
+/// Return whether a color is close to the reference.
+static bool Near(const Color& value, const Color& reference)
+{
+    return Near(value.r_, reference.r_) && Near(value.g_, reference.g_) && Near(value.b_, reference.b_) &&
+        Near(value.a_, reference.a_);
+}
+
+/// Create an effect that uses all per-particle update features.
+static SharedPtr<ParticleEffect> CreateEffect(Context* context)
+{
+    SharedPtr<ParticleEffect> effect(new ParticleEffect(context));
+    effect->SetUpdateInvisible(true);
+    effect->SetRelative(false);
+    effect->SetEmitterType(EMITTER_SPHERE);
+    effect->SetEmitterSize(Vector3(2.0f, 2.0f, 2.0f));
+    effect->SetMinDirection(Vector3(-1.0f, 0.0f, -1.0f));
+    effect->SetMaxDirection(Vector3(1.0f, 1.0f, 1.0f));
+    effect->SetMinEmissionRate(200.0f);
+    effect->SetMaxEmissionRate(400.0f);
+    effect->SetMinTimeToLive(0.1f);
+    effect->SetMaxTimeToLive(0.6f);
+    effect->SetMinVelocity(1.0f);
+    effect->SetMaxVelocity(5.0f);
+    effect->SetMinRotationSpeed(-90.0f);
+    effect->SetMaxRotationSpeed(90.0f);
+    effect->SetConstantForce(Vector3(0.0f, -9.81f, 1.0f));
+    effect->SetDampingForce(0.5f);
+    effect->SetSizeAdd(-0.5f);
+    effect->SetSizeMul(1.5f);
+
+    effect->AddColorFrame(ColorFrame(Color::RED, 0.0f));
+    effect->AddColorFrame(ColorFrame(Color::GREEN, 0.2f));
+    effect->AddColorFrame(ColorFrame(Color::BLUE, 0.4f));
+
+    TextureFrame textureFrame;
+    effect->AddTextureFrame(textureFrame);
+    textureFrame.uv_ = Rect(0.5f, 0.5f, 1.0f, 1.0f);
+    textureFrame.time_ = 0.3f;
+    effect->AddTextureFrame(textureFrame);
+    return effect;
+}
+
+/// Check the updated particles and billboards against a scalar update of the previous state. Return the number of expired particles.
+static unsigned CheckUpdate(ParticleEmitter* emitter, const ParticleStreams& previous)
+{
+    ParticleEffect* effect = emitter->GetEffect();
+    const ParticleStreams& p = emitter->GetParticles();
+    const PODVector<Billboard>& billboards = emitter->GetBillboards();
+    const Vector<ColorFrame>& colorFrames = effect->GetColorFrames();
+    const Vector<TextureFrame>& textureFrames = effect->GetTextureFrames();
+    float sizeMulStep = TIME_STEP * (effect->GetSizeMul() - 1.0f) + 1.0f;
+    unsigned numExpired = 0;
+
+    TEST_CHECK(billboards.Size() == p.Size());
+    for (unsigned i = 0; i < p.Size() && i < billboards.Size(); ++i)
+    {
+        // Particles that were not alive may have been emitted on this update
+        if (!previous.alive_[i])
+            continue;
+
+        const Billboard& billboard = billboards[i];
+        if (previous.timer_[i] >= previous.timeToLive_[i])
+        {
+            TEST_CHECK(!p.alive_[i]);
+            TEST_CHECK(!billboard.enabled_);
+            ++numExpired;
+            continue;
+        }
+
+        float timer = previous.timer_[i] + TIME_STEP;
+        Vector3 velocity(previous.velocityX_[i], previous.velocityY_[i], previous.velocityZ_[i]);
+        velocity += TIME_STEP * effect->GetConstantForce();
+        velocity += TIME_STEP * (-effect->GetDampingForce() * velocity);
+        Vector3 position = Vector3(previous.positionX_[i], previous.positionY_[i], previous.positionZ_[i]) + TIME_STEP * velocity;
+        float rotation = previous.rotation_[i] + TIME_STEP * previous.rotationSpeed_[i];
+        float scale = Max(previous.scale_[i] + TIME_STEP * effect->GetSizeAdd(), 0.0f) * sizeMulStep;
+
+        TEST_CHECK(p.alive_[i] == M_MAX_UNSIGNED);
+        TEST_CHECK(billboard.enabled_);
+        TEST_CHECK(Near(p.timer_[i], timer));
+        TEST_CHECK(Near(Vector3(p.velocityX_[i], p.velocityY_[i], p.velocityZ_[i]), velocity));
+        TEST_CHECK(Near(Vector3(p.positionX_[i], p.positionY_[i], p.positionZ_[i]), position));
+        TEST_CHECK(Near(p.rotation_[i], rotation));
+        TEST_CHECK(Near(p.scale_[i], scale));
+
+        TEST_CHECK(Near(billboard.position_, position));
+        TEST_CHECK(Near(billboard.direction_, velocity.Normalized()));
+        TEST_CHECK(Near(billboard.rotation_, rotation));
+        TEST_CHECK(Near(billboard.size_.x_, previous.sizeX_[i] * scale));
+        TEST_CHECK(Near(billboard.size_.y_, previous.sizeY_[i] * scale));
+
+        unsigned colorIndex = previous.colorIndex_[i];
+        if (colorIndex < colorFrames.Size() - 1 && timer >= colorFrames[colorIndex + 1].time_)
+            ++colorIndex;
+        TEST_CHECK(p.colorIndex_[i] == colorIndex);
+        TEST_CHECK(Near(billboard.color_, colorIndex < colorFrames.Size() - 1 ?
+            colorFrames[colorIndex].Interpolate(colorFrames[colorIndex + 1], timer) : colorFrames[colorIndex].color_));
+
+        unsigned texIndex = previous.texIndex_[i];
+        if (texIndex < textureFrames.Size() - 1 && timer >= textureFrames[texIndex + 1].time_)
+            ++texIndex;
+        TEST_CHECK(p.texIndex_[i] == texIndex);
+        TEST_CHECK(billboard.uv_ == textureFrames[texIndex].uv_);
+    }
+
+    // The padding lanes of the last four-particle group are never alive
+    for (unsigned i = p.Size(); i < p.alive_.Size(); ++i)
+        TEST_CHECK(!p.alive_[i]);
+
+    return numExpired;
+}
+
+/// Run an emitter with a particle count and check each update.
+static void TestParticles(Scene* scene, ParticleEffect* effect, unsigned numParticles)
+{
+    Node* node = scene->CreateChild("Emitter");
+    auto* emitter = node->CreateComponent<ParticleEmitter>();
+    emitter->SetEffect(effect);
+    emitter->SetNumParticles(numParticles);
+    TEST_CHECK(emitter->GetNumParticles() == numParticles);
+
+    FrameInfo frame;
+    frame.timeStep_ = TIME_STEP;
+    unsigned numExpired = 0;
+    unsigned numAlive = 0;
+
+    for (unsigned i = 0; i < NUM_STEPS; ++i)
+    {
+        ParticleStreams previous = emitter->GetParticles();
+        scene->Update(TIME_STEP);
+        frame.frameNumber_ = i + 1;
+        emitter->Update(frame);
+        numExpired += CheckUpdate(emitter, previous);
+
+        for (unsigned j = 0; j < numParticles; ++j)
+            numAlive += emitter->GetParticles().alive_[j] != 0;
+    }
+
+    // Make sure that the particles were emitted and expired while checked
+    TEST_CHECK(numAlive > 0);
+    TEST_CHECK(numExpired > 0);
+
+    // Shrinking to a size within the same group clears the lanes past it
+    if (numParticles > 2)
+    {
+        emitter->SetNumParticles(numParticles - 2);
+        ParticleStreams previous = emitter->GetParticles();
+        scene->Update(TIME_STEP);
+        emitter->Update(frame);
+        CheckUpdate(emitter, previous);
+    }
+
+    node->Remove();
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new WorkQueue(context));
+    context->GetSubsystem<WorkQueue>()->CreateThreads(3);
+    RegisterSceneLibrary(context);
+    context->RegisterFactory<ParticleEmitter>();
+
+    SharedPtr<Scene> scene(new Scene(context));
+    SharedPtr<ParticleEffect> effect = CreateEffect(context);
+    SetRandomSeed(1);
+
+    // Counts that leave the last four-particle group partially used, and one large enough to split the update between threads
+    const unsigned particleCounts[] = { 1, 2, 3, 5, 6, 7, 13, 50, 2051 };
+    for (unsigned numParticles : particleCounts)
+        TestParticles(scene, effect, numParticles);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,269 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Drawable.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "UnitTest.h"
+
+#include <cstdlib>
+
+using namespace Urho3D;
+
+/// Number of rays per comparison.
+static const unsigned NUM_RAYS = 500;
+/// Size of the area the boxes are placed in.
+static const float AREA_SIZE = 100.0f;
+
+/// Return a random float between 0 and 1.
+static float RandomFloat() { return (float)rand() / (float)RAND_MAX; }
+
+/// Return a random position within the area.
+static Vector3 RandomPosition()
+{
+    return Vector3(RandomFloat() - 0.5f, RandomFloat() - 0.5f, RandomFloat() - 0.5f) * AREA_SIZE;
+}
+
+/// Drawable that is hit by rays on its bounding box.
+class TestBox : public Drawable
+{
+    URHO3D_OBJECT(TestBox, Drawable);
+
+public:
+    /// Construct.
+    explicit TestBox(Context* context) :
+        Drawable(context, DRAWABLE_GEOMETRY)
+    {
+        boundingBox_ = BoundingBox(-Vector3::ONE, Vector3::ONE);
+    }
+
+protected:
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override { worldBoundingBox_ = boundingBox_.Transformed(node_->GetWorldTransform()); }
+};
+
+/// Two scenes with identical boxes, one raycast through the octree and the other through the BVH.
+struct TestScenes
+{
+    /// Scene raycast through the octree.
+    SharedPtr<Scene> octreeScene_;
+    /// Scene raycast through the BVH.
+    SharedPtr<Scene> bvhScene_;
+    /// Box nodes of the octree scene.
+    PODVector<Node*> octreeNodes_;
+    /// Box nodes of the BVH scene, in the same order.
+    PODVector<Node*> bvhNodes_;
+    /// Frame number.
+    unsigned frameNumber_;
+};
+
+/// Create a scene with an octree.
+static SharedPtr<Scene> CreateScene(Context* context, bool raycastBVH)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    auto* octree = scene->CreateComponent<Octree>();
+    octree->SetSize(BoundingBox(-AREA_SIZE, AREA_SIZE), 6);
+    octree->SetRaycastBVH(raycastBVH);
+    return scene;
+}
+
+/// Add boxes with the same random transforms to both scenes.
+static void AddBoxes(TestScenes& scenes, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Vector3 position = RandomPosition();
+        Quaternion rotation(RandomFloat() * 360.0f, Vector3(RandomFloat(), RandomFloat(), RandomFloat() + 0.1f).Normalized());
+        Vector3 scale(0.5f + RandomFloat() * 2.0f, 0.5f + RandomFloat() * 2.0f, 0.5f + RandomFloat() * 2.0f);
+
+        for (unsigned j = 0; j < 2; ++j)
+        {
+            Node* node = (j ? scenes.bvhScene_ : scenes.octreeScene_)->CreateChild("Box");
+            node->SetTransform(position, rotation, scale);
+            node->CreateComponent<TestBox>();
+            (j ? scenes.bvhNodes_ : scenes.octreeNodes_).Push(node);
+        }
+    }
+}
+
+/// Move random boxes in both scenes.
+static void MoveBoxes(TestScenes& scenes, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        unsigned index = (unsigned)rand() % scenes.octreeNodes_.Size();
+        Vector3 position = RandomPosition();
+        scenes.octreeNodes_[index]->SetPosition(position);
+        scenes.bvhNodes_[index]->SetPosition(position);
+    }
+}
+
+/// Remove random boxes from both scenes.
+static void RemoveBoxes(TestScenes& scenes, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        unsigned index = (unsigned)rand() % scenes.octreeNodes_.Size();
+        scenes.octreeNodes_[index]->Remove();
+        scenes.bvhNodes_[index]->Remove();
+        scenes.octreeNodes_.Erase(index);
+        scenes.bvhNodes_.Erase(index);
+    }
+}
+
+/// Update the octrees of both scenes, which also refits or rebuilds the BVH.
+static void UpdateOctrees(TestScenes& scenes)
+{
+    FrameInfo frame;
+    frame.frameNumber_ = ++scenes.frameNumber_;
+    frame.timeStep_ = 0.01f;
+    scenes.octreeScene_->GetComponent<Octree>()->Update(frame);
+    scenes.bvhScene_->GetComponent<Octree>()->Update(frame);
+}
+
+/// Return a random ray through the area.
+static Ray RandomRay()
+{
+    Vector3 origin = RandomPosition() * 1.5f;
+    Vector3 target = RandomPosition() * 0.5f;
+    return Ray(origin, target - origin);
+}
+
+/// Compare the results of two queries. The node IDs match between the scenes, as the nodes were created in the same order.
+static bool CompareResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
+{
+    if (lhs.distance_ != rhs.distance_)
+        return lhs.distance_ < rhs.distance_;
+    return lhs.node_->GetID() < rhs.node_->GetID();
+}
+
+/// Check that the BVH gives the same hits as the octree for random rays.
+static void CompareRaycasts(TestScenes& scenes)
+{
+    auto* octree = scenes.octreeScene_->GetComponent<Octree>();
+    auto* bvhOctree = scenes.bvhScene_->GetComponent<Octree>();
+    TEST_CHECK(!octree->GetRaycastBVH());
+    TEST_CHECK(bvhOctree->GetRaycastBVH());
+
+    PODVector<Ray> rays;
+    PODVector<RayQueryResult> octreeResults;
+    PODVector<RayQueryResult> bvhResults;
+    PODVector<RayQueryResult> singleResults;
+    unsigned numHits = 0;
+
+    for (unsigned i = 0; i < NUM_RAYS; ++i)
+    {
+        Ray ray = RandomRay();
+        float maxDistance = i & 1 ? M_INFINITY : AREA_SIZE;
+        rays.Push(ray);
+
+        // All hits
+        RayOctreeQuery octreeQuery(octreeResults, ray, RAY_AABB, maxDistance);
+        octree->Raycast(octreeQuery);
+        RayOctreeQuery bvhQuery(bvhResults, ray, RAY_AABB, maxDistance);
+        bvhOctree->Raycast(bvhQuery);
+        Sort(octreeResults.Begin(), octreeResults.End(), CompareResults);
+        Sort(bvhResults.Begin(), bvhResults.End(), CompareResults);
+
+        TEST_CHECK(octreeResults.Size() == bvhResults.Size());
+        for (unsigned j = 0; j < octreeResults.Size() && j < bvhResults.Size(); ++j)
+        {
+            TEST_CHECK(octreeResults[j].node_->GetID() == bvhResults[j].node_->GetID());
+            TEST_CHECK(octreeResults[j].distance_ == bvhResults[j].distance_);
+        }
+        numHits += octreeResults.Size();
+
+        // Closest hit. Equally close hits may come from different drawables
+        RayOctreeQuery octreeSingleQuery(octreeResults, ray, RAY_AABB, maxDistance);
+        octree->RaycastSingle(octreeSingleQuery);
+        RayOctreeQuery bvhSingleQuery(bvhResults, ray, RAY_AABB, maxDistance);
+        bvhOctree->RaycastSingle(bvhSingleQuery);
+
+        TEST_CHECK(octreeResults.Size() == bvhResults.Size());
+        if (octreeResults.Size() && bvhResults.Size())
+            TEST_CHECK(octreeResults[0].distance_ == bvhResults[0].distance_);
+        singleResults.Push(octreeResults.Size() ? octreeResults[0] : RayQueryResult());
+        if (!octreeResults.Size())
+            singleResults.Back().distance_ = M_INFINITY;
+    }
+
+    // The rays are random, so the packets are incoherent, which covers the rays of a packet taking different paths
+    octree->RaycastBatch(rays, octreeResults, RAY_AABB);
+    bvhOctree->RaycastBatch(rays, bvhResults, RAY_AABB);
+    TEST_CHECK(octreeResults.Size() == rays.Size());
+    TEST_CHECK(bvhResults.Size() == rays.Size());
+    for (unsigned i = 0; i < rays.Size() && i < octreeResults.Size() && i < bvhResults.Size(); ++i)
+    {
+        TEST_CHECK(octreeResults[i].distance_ == bvhResults[i].distance_);
+        TEST_CHECK((octreeResults[i].drawable_ != nullptr) == (bvhResults[i].drawable_ != nullptr));
+        if (i & 1)
+            TEST_CHECK(octreeResults[i].distance_ == singleResults[i].distance_);
+    }
+
+    // Make sure that the rays actually hit something
+    TEST_CHECK(numHits > NUM_RAYS / 2);
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new WorkQueue(context));
+    context->RegisterFactory<Octree>();
+    context->RegisterFactory<TestBox>();
+
+    TestScenes scenes;
+    scenes.octreeScene_ = CreateScene(context, false);
+    scenes.bvhScene_ = CreateScene(context, true);
+    scenes.frameNumber_ = 0;
+
+    // Initial build
+    AddBoxes(scenes, 300);
+    UpdateOctrees(scenes);
+    CompareRaycasts(scenes);
+
+    // Refit after moving some of the boxes
+    MoveBoxes(scenes, 60);
+    UpdateOctrees(scenes);
+    CompareRaycasts(scenes);
+
+    // A few added boxes are tested linearly until the next rebuild, and removed boxes leave empty slots
+    AddBoxes(scenes, 5);
+    RemoveBoxes(scenes, 5);
+    UpdateOctrees(scenes);
+    CompareRaycasts(scenes);
+
+    // Moving boxes that share the BVH with linearly tested ones refits it again
+    MoveBoxes(scenes, 20);
+    UpdateOctrees(scenes);
+    CompareRaycasts(scenes);
+
+    // Many added and removed boxes cause a rebuild
+    AddBoxes(scenes, 200);
+    RemoveBoxes(scenes, 150);
+    UpdateOctrees(scenes);
+    CompareRaycasts(scenes);
+
+    return TEST_RESULT();
+}
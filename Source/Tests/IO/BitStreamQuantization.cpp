@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/IO/BitStream.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Math/Quaternion.h>
+
+#include "UnitTest.h"
+
+#include <cfloat>
+#include <cstdlib>
+
+using namespace Urho3D;
+
+/// Number of values of each kind.
+static const unsigned NUM_VALUES = 1000;
+/// Quantization range minimum.
+static const float MIN_VALUE = -100.0f;
+/// Quantization range maximum.
+static const float MAX_VALUE = 100.0f;
+
+/// Return a random float between 0 and 1.
+static float RandomFloat() { return (float)rand() / (float)RAND_MAX; }
+
+/// Return the largest error of a float quantized to a number of bits within the test range.
+static float GetMaxError(unsigned numBits)
+{
+    // Half a quantization step, plus rounding to the nearest float
+    return (MAX_VALUE - MIN_VALUE) / (float)((1u << numBits) - 1) * 0.5f + MAX_VALUE * FLT_EPSILON;
+}
+
+/// Write values of each kind with a number of bits, interleaved with byte data, and check that they read back within the quantization error.
+static void TestRoundTrip(unsigned numBits)
+{
+    PODVector<unsigned> rawValues;
+    PODVector<float> floats;
+    Vector<Quaternion> rotations;
+
+    srand(numBits);
+    for (unsigned i = 0; i < NUM_VALUES; ++i)
+    {
+        rawValues.Push((unsigned)rand() & ((1u << numBits) - 1));
+        floats.Push(MIN_VALUE + (MAX_VALUE - MIN_VALUE) * RandomFloat());
+        rotations.Push(Quaternion(RandomFloat() * 360.0f, Vector3(RandomFloat() - 0.5f, RandomFloat() - 0.5f,
+            RandomFloat() - 0.5f).Normalized()));
+    }
+
+    VectorBuffer buffer;
+    {
+        BitWriter writer(buffer);
+        for (unsigned i = 0; i < NUM_VALUES; ++i)
+        {
+            writer.WriteBits(rawValues[i], numBits);
+            writer.WriteQuantizedFloat(floats[i], MIN_VALUE, MAX_VALUE, numBits);
+            writer.WriteQuantizedQuaternion(rotations[i], numBits);
+            // Byte data starts at the next byte boundary
+            if (i % 100 == 0)
+                writer.WriteUInt(i);
+        }
+
+        // The range ends are exact, and values outside the range are clamped
+        writer.WriteQuantizedFloat(MIN_VALUE, MIN_VALUE, MAX_VALUE, numBits);
+        writer.WriteQuantizedFloat(MAX_VALUE, MIN_VALUE, MAX_VALUE, numBits);
+        writer.WriteQuantizedFloat(MAX_VALUE * 2.0f, MIN_VALUE, MAX_VALUE, numBits);
+        writer.WriteString("End");
+    }
+
+    buffer.Seek(0);
+    BitReader reader(buffer);
+    float maxError = GetMaxError(numBits);
+    // Three components quantized within [-1/sqrt(2), 1/sqrt(2)], with the fourth reconstructed
+    float maxRotationError = 1.5f * 1.42f / (float)((1u << numBits) - 1) + 4.0f * FLT_EPSILON;
+
+    for (unsigned i = 0; i < NUM_VALUES; ++i)
+    {
+        TEST_CHECK(reader.ReadBits(numBits) == rawValues[i]);
+        TEST_CHECK(Abs(reader.ReadQuantizedFloat(MIN_VALUE, MAX_VALUE, numBits) - floats[i]) <= maxError);
+        Quaternion rotation = reader.ReadQuantizedQuaternion(numBits);
+        TEST_CHECK(Abs(rotation.LengthSquared() - 1.0f) < 1.0e-5f);
+        TEST_CHECK(1.0f - Abs(rotation.DotProduct(rotations[i])) <= maxRotationError);
+        if (i % 100 == 0)
+            TEST_CHECK(reader.ReadUInt() == i);
+    }
+
+    TEST_CHECK(reader.ReadQuantizedFloat(MIN_VALUE, MAX_VALUE, numBits) == MIN_VALUE);
+    TEST_CHECK(reader.ReadQuantizedFloat(MIN_VALUE, MAX_VALUE, numBits) == MAX_VALUE);
+    TEST_CHECK(reader.ReadQuantizedFloat(MIN_VALUE, MAX_VALUE, numBits) == MAX_VALUE);
+    TEST_CHECK(reader.ReadString() == "End");
+    TEST_CHECK(reader.IsEof());
+}
+
+int main()
+{
+    const unsigned bitCounts[] = {1, 7, 12, 16, 24};
+    for (unsigned i = 0; i < sizeof bitCounts / sizeof bitCounts[0]; ++i)
+        TestRoundTrip(bitCounts[i]);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/PackageFile.h>
+
+#include <LZ4/lz4.h>
+
+#include "UnitTest.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Urho3D;
+
+/// Uncompressed size of the compressed blocks.
+static const unsigned BLOCK_SIZE = 1024;
+
+/// Package file entry to write.
+struct TestEntry
+{
+    /// Name.
+    String name_;
+    /// Contents.
+    PODVector<unsigned char> data_;
+};
+
+/// Compress an entry's data into blocks preceded by their offsets, like PackageTool does. Return false if it does not shrink.
+static bool CompressEntry(const PODVector<unsigned char>& data, PODVector<unsigned char>& dest)
+{
+    unsigned numBlocks = (data.Size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    unsigned indexSize = (numBlocks + 1) * sizeof(unsigned);
+    PODVector<unsigned> blockOffsets(numBlocks + 1);
+    dest.Resize(indexSize + numBlocks * LZ4_compressBound(BLOCK_SIZE));
+
+    unsigned packedTotal = 0;
+    for (unsigned i = 0; i < numBlocks; ++i)
+    {
+        unsigned pos = i * BLOCK_SIZE;
+        unsigned unpackedSize = Min(BLOCK_SIZE, data.Size() - pos);
+        blockOffsets[i] = indexSize + packedTotal;
+        packedTotal += (unsigned)LZ4_compress_default((const char*)&data[pos], (char*)&dest[indexSize + packedTotal],
+            unpackedSize, LZ4_compressBound(unpackedSize));
+    }
+    blockOffsets[numBlocks] = indexSize + packedTotal;
+
+    memcpy(&dest[0], &blockOffsets[0], indexSize);
+    dest.Resize(indexSize + packedTotal);
+    return dest.Size() < data.Size();
+}
+
+/// Write a block compressed package file.
+static void WritePackage(Context* context, const String& fileName, const Vector<TestEntry>& entries)
+{
+    File dest(context, fileName, FILE_WRITE);
+    dest.WriteFileID("ULZB");
+    dest.WriteUInt(entries.Size());
+    dest.WriteUInt(0);
+    dest.WriteUInt(BLOCK_SIZE);
+
+    unsigned offset = dest.GetSize();
+    for (unsigned i = 0; i < entries.Size(); ++i)
+        offset += entries[i].name_.Length() + 1 + 3 * sizeof(unsigned) + 1;
+
+    Vector<PODVector<unsigned char> > storedData(entries.Size());
+    for (unsigned i = 0; i < entries.Size(); ++i)
+    {
+        bool compressed = CompressEntry(entries[i].data_, storedData[i]);
+        if (!compressed)
+            storedData[i] = entries[i].data_;
+
+        dest.WriteString(entries[i].name_);
+        dest.WriteUInt(offset);
+        dest.WriteUInt(entries[i].data_.Size());
+        dest.WriteUInt(0);
+        dest.WriteUByte((unsigned char)compressed);
+        offset += storedData[i].Size();
+    }
+
+    for (unsigned i = 0; i < entries.Size(); ++i)
+        dest.Write(&storedData[i][0], storedData[i].Size());
+}
+
+/// Check that random seeks and reads of a packaged file, forward and backward, return the original data.
+static void TestRandomReads(Context* context, PackageFile* package, const TestEntry& entry)
+{
+    File file(context, package, entry.name_);
+    TEST_CHECK(file.IsOpen());
+    TEST_CHECK(file.GetSize() == entry.data_.Size());
+
+    unsigned size = entry.data_.Size();
+    PODVector<unsigned char> buffer(size);
+
+    // The whole file at once
+    TEST_CHECK(file.Read(&buffer[0], size) == size);
+    TEST_CHECK(!memcmp(&buffer[0], &entry.data_[0], size));
+    TEST_CHECK(file.IsEof());
+
+    for (unsigned i = 0; i < 1000; ++i)
+    {
+        unsigned position = (unsigned)rand() % size;
+        // Mix small reads within a block with reads spanning several whole blocks
+        unsigned length = Min((unsigned)rand() % (i & 1 ? 64 : 4 * BLOCK_SIZE) + 1, size - position);
+
+        TEST_CHECK(file.Seek(position) == position);
+        TEST_CHECK(file.Read(&buffer[0], length) == length);
+        TEST_CHECK(!memcmp(&buffer[0], &entry.data_[position], length));
+        TEST_CHECK(file.GetPosition() == position + length);
+    }
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new FileSystem(context));
+
+    Vector<TestEntry> entries(2);
+    entries[0].name_ = "Compressible.bin";
+    for (unsigned i = 0; i < 10 * BLOCK_SIZE + 123; ++i)
+        entries[0].data_.Push((unsigned char)(i / 7 % 13));
+    entries[1].name_ = "Incompressible.bin";
+    srand(1);
+    for (unsigned i = 0; i < 3 * BLOCK_SIZE + 45; ++i)
+        entries[1].data_.Push((unsigned char)rand());
+
+    String fileName = context->GetSubsystem<FileSystem>()->GetTemporaryDir() + "PackageBlockRead.pak";
+    WritePackage(context, fileName, entries);
+
+    {
+        SharedPtr<PackageFile> package(new PackageFile(context, fileName));
+        TEST_CHECK(package->GetNumFiles() == 2);
+        TEST_CHECK(package->GetBlockSize() == BLOCK_SIZE);
+        TEST_CHECK(package->GetEntry(entries[0].name_)->compressed_);
+        TEST_CHECK(!package->GetEntry(entries[1].name_)->compressed_);
+
+        TestRandomReads(context, package, entries[0]);
+        TestRandomReads(context, package, entries[1]);
+
+        // Uncompressed entries of a mapped package can be read without copying
+        if (package->IsMapped())
+        {
+            File file(context, package, entries[1].name_);
+            TEST_CHECK(file.GetMappedData() && !memcmp(file.GetMappedData(), &entries[1].data_[0], entries[1].data_.Size()));
+        }
+    }
+
+    context->GetSubsystem<FileSystem>()->Delete(fileName);
+
+    return TEST_RESULT();
+}
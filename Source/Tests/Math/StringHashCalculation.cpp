@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+#include "UnitTest.h"
+
+using namespace Urho3D;
+
+/// Event whose name is not registered.
+URHO3D_EVENT(E_UNREGISTEREDTEST, UnregisteredTest)
+{
+}
+
+/// Event whose name is registered at static initialization.
+URHO3D_EVENT_REGISTERED(E_REGISTEREDTEST, RegisteredTest)
+{
+    URHO3D_PARAM(P_VALUE, Value); // int
+}
+
+// Hashes of string literals are constant expressions, which lowercase only ASCII letters
+static_assert(StringHash("A").Value() == 'a', "Uppercase ASCII letters must be lowercased");
+static_assert(StringHash("AB").Value() == 'b' + ('a' << 6) + ('a' << 16) - 'a', "Hash must be the SDBM hash");
+static_assert(StringHash("SceneUpdate") == StringHash("sceneupdate"), "Hash must be case-insensitive");
+static_assert(StringHash("\xC3\x84").Value() == 0x84 + (0xC3 << 6) + (0xC3 << 16) - 0xC3, "Non-ASCII bytes must be hashed unsigned");
+static_assert(StringHash("\xC3\x84") != StringHash("\xC3\xA4"), "Non-ASCII letters must not be lowercased");
+static_assert(E_SCENEUPDATE == StringHash("SceneUpdate"), "Event IDs must be hashes of the event names");
+static_assert(RegisteredTest::P_VALUE == StringHash("Value"), "Parameter IDs must be hashes of the parameter names");
+
+/// Strings to compare the constant expression and runtime hashes with.
+static const char* testStrings[] = {
+    "",
+    "a",
+    "MixedCase",
+    "ALL UPPER CASE WITH SPACES",
+    "Digits0123456789_and-punctuation.!?[]{}@`",
+    "\xC3\x84pfel \xC3\xBC" "ber Stra\xC3\x9F" "e",                     // UTF-8 with uppercase and lowercase non-ASCII letters
+    "\xD0\x9C\xD0\xBE\xD1\x81\xD0\xBA\xD0\xB2\xD0\xB0",                 // Cyrillic
+    "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E",                             // CJK
+    "\x7F\x80\xFF\x01\x1F"                                              // Control and high bytes
+};
+
+/// Return the constant expression hash of a string, evaluated at runtime.
+static StringHash ConstexprHash(const char* str) { return StringHash(str); }
+
+int main()
+{
+    for (const char* str : testStrings)
+    {
+        const unsigned runtimeHash = StringHash::Calculate(str);
+        TEST_CHECK(ConstexprHash(str).Value() == runtimeHash);
+        TEST_CHECK(StringHash(String(str)).Value() == runtimeHash);
+        TEST_CHECK(StringHash(String(str).ToLower()) == StringHash(String(str).ToUpper()));
+    }
+
+    // The engine's own event names are registered on the first lookup, and others only if described as registered
+    TEST_CHECK(EventNameRegistrar::GetEventName(E_SCENEUPDATE) == "SceneUpdate");
+    TEST_CHECK(EventNameRegistrar::GetEventName(E_REGISTEREDTEST) == "RegisteredTest");
+    TEST_CHECK(EventNameRegistrar::GetEventName(E_UNREGISTEREDTEST).Empty());
+    EventNameRegistrar::RegisterEventName("UnregisteredTest");
+    TEST_CHECK(EventNameRegistrar::GetEventName(E_UNREGISTEREDTEST) == "UnregisteredTest");
+
+    return TEST_RESULT();
+}
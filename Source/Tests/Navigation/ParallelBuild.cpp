@@ -0,0 +1,184 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Navigation/DynamicNavigationMesh.h>
+#include <Urho3D/Navigation/Navigable.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "UnitTest.h"
+
+#include <cstdlib>
+
+using namespace Urho3D;
+
+/// Number of random boxes on the floor.
+static const unsigned NUM_BOXES = 40;
+/// Bounding box of the floor. With the default cell size and the smallest tile size it spans more tiles than one build batch.
+static const BoundingBox FLOOR_BOX(Vector3(-45.0f, -1.0f, -45.0f), Vector3(45.0f, 0.0f, 45.0f));
+
+/// Transform of a box on the floor.
+struct BoxTransform
+{
+    /// Position.
+    Vector3 position_;
+    /// Rotation.
+    Quaternion rotation_;
+    /// Size.
+    Vector3 size_;
+};
+
+/// Return a random float between 0 and 1.
+static float RandomFloat() { return (float)rand() / (float)RAND_MAX; }
+
+/// Return random box transforms, so that both scenes get the same geometry.
+static PODVector<BoxTransform> CreateBoxTransforms()
+{
+    PODVector<BoxTransform> result;
+    for (unsigned i = 0; i < NUM_BOXES; ++i)
+    {
+        BoxTransform box;
+        box.position_ = Vector3((RandomFloat() - 0.5f) * 85.0f, RandomFloat() * 1.5f, (RandomFloat() - 0.5f) * 85.0f);
+        box.rotation_ = Quaternion(RandomFloat() * 360.0f, Vector3::UP);
+        box.size_ = Vector3(0.5f + RandomFloat() * 6.0f, 0.5f + RandomFloat() * 2.0f, 0.5f + RandomFloat() * 6.0f);
+        result.Push(box);
+    }
+    return result;
+}
+
+/// Create a scene with walls and the boxes on the floor, and build its navigation mesh.
+static SharedPtr<Scene> CreateScene(Context* context, const PODVector<BoxTransform>& boxes, bool dynamic)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    scene->CreateComponent<PhysicsWorld>();
+
+    Node* floorNode = scene->CreateChild("Floor");
+    floorNode->CreateComponent<Navigable>();
+    auto* floorShape = floorNode->CreateComponent<CollisionShape>();
+    floorShape->SetBox(FLOOR_BOX.Size(), FLOOR_BOX.Center());
+
+    for (int i = 0; i < 5; ++i)
+    {
+        Node* wallNode = floorNode->CreateChild("Wall");
+        wallNode->SetPosition(Vector3(i & 1 ? 5.0f : -5.0f, 1.5f, -20.0f + i * 10.0f));
+        wallNode->CreateComponent<CollisionShape>()->SetBox(Vector3(50.0f, 3.0f, 1.0f));
+    }
+
+    for (unsigned i = 0; i < boxes.Size(); ++i)
+    {
+        Node* boxNode = floorNode->CreateChild("Box");
+        boxNode->SetPosition(boxes[i].position_);
+        boxNode->SetRotation(boxes[i].rotation_);
+        boxNode->CreateComponent<CollisionShape>()->SetBox(boxes[i].size_);
+    }
+
+    NavigationMesh* navMesh = dynamic ? scene->CreateComponent<DynamicNavigationMesh>() : scene->CreateComponent<NavigationMesh>();
+    navMesh->SetTileSize(16);
+    TEST_CHECK(navMesh->Build());
+    return scene;
+}
+
+/// Check that two navigation meshes have the same tiles with identical data.
+static void CompareTiles(NavigationMesh* serialNavMesh, NavigationMesh* parallelNavMesh)
+{
+    const IntVector2 numTiles = serialNavMesh->GetNumTiles();
+    TEST_CHECK(numTiles == parallelNavMesh->GetNumTiles());
+    TEST_CHECK((unsigned)(numTiles.x_ * numTiles.y_) > NAVMESH_TILE_BATCH_SIZE);
+
+    unsigned numBuiltTiles = 0;
+    for (int z = 0; z < numTiles.y_; ++z)
+    {
+        for (int x = 0; x < numTiles.x_; ++x)
+        {
+            const IntVector2 tile(x, z);
+            TEST_CHECK(serialNavMesh->HasTile(tile) == parallelNavMesh->HasTile(tile));
+            const PODVector<unsigned char> serialData = serialNavMesh->GetTileData(tile);
+            TEST_CHECK(serialData == parallelNavMesh->GetTileData(tile));
+            numBuiltTiles += serialNavMesh->HasTile(tile);
+        }
+    }
+
+    // Make sure that the meshes actually contain something
+    TEST_CHECK(numBuiltTiles > NAVMESH_TILE_BATCH_SIZE);
+}
+
+/// Move the same box in both scenes and rebuild the affected tiles.
+static void MoveBox(Scene* serialScene, Scene* parallelScene, unsigned index, const Vector3& position)
+{
+    Scene* scenes[] = {serialScene, parallelScene};
+    for (Scene* scene : scenes)
+    {
+        auto* navMesh = scene->GetDerivedComponent<NavigationMesh>();
+        Node* boxNode = scene->GetChild("Floor")->GetChildren()[5 + index];
+        navMesh->MarkTilesDirty(boxNode->GetComponent<CollisionShape>()->GetWorldBoundingBox());
+        boxNode->SetPosition(position);
+        navMesh->MarkTilesDirty(boxNode->GetComponent<CollisionShape>()->GetWorldBoundingBox());
+        TEST_CHECK(navMesh->GetNumDirtyTiles() > 0);
+        TEST_CHECK(navMesh->BuildDirtyTiles());
+        TEST_CHECK(navMesh->GetNumDirtyTiles() == 0);
+    }
+}
+
+/// Check that building in parallel gives the same tiles as building serially, for a full build and for a partial rebuild.
+static void TestParallelBuild(Context* serialContext, Context* parallelContext, bool dynamic)
+{
+    const PODVector<BoxTransform> boxes = CreateBoxTransforms();
+    SharedPtr<Scene> serialScene = CreateScene(serialContext, boxes, dynamic);
+    SharedPtr<Scene> parallelScene = CreateScene(parallelContext, boxes, dynamic);
+    auto* serialNavMesh = serialScene->GetDerivedComponent<NavigationMesh>();
+    auto* parallelNavMesh = parallelScene->GetDerivedComponent<NavigationMesh>();
+    CompareTiles(serialNavMesh, parallelNavMesh);
+
+    MoveBox(serialScene, parallelScene, 0, Vector3(-12.0f, 0.5f, 13.0f));
+    MoveBox(serialScene, parallelScene, 1, Vector3(22.0f, 0.5f, -3.0f));
+    CompareTiles(serialNavMesh, parallelNavMesh);
+
+    // A full rebuild replaces the tiles, which changes their references, so rebuild both
+    TEST_CHECK(serialNavMesh->Build());
+    TEST_CHECK(parallelNavMesh->Build());
+    CompareTiles(serialNavMesh, parallelNavMesh);
+}
+
+int main()
+{
+    // Without the work queue the tiles are built in the calling thread
+    SharedPtr<Context> serialContext(new Context());
+    RegisterSceneLibrary(serialContext);
+    RegisterPhysicsLibrary(serialContext);
+    RegisterNavigationLibrary(serialContext);
+
+    SharedPtr<Context> parallelContext(new Context());
+    parallelContext->RegisterSubsystem(new WorkQueue(parallelContext));
+    parallelContext->GetSubsystem<WorkQueue>()->CreateThreads(3);
+    RegisterSceneLibrary(parallelContext);
+    RegisterPhysicsLibrary(parallelContext);
+    RegisterNavigationLibrary(parallelContext);
+
+    TestParallelBuild(serialContext, parallelContext, false);
+    TestParallelBuild(serialContext, parallelContext, true);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,247 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Navigation/DynamicNavigationMesh.h>
+#include <Urho3D/Navigation/Navigable.h>
+#include <Urho3D/Navigation/NavigationEvents.h>
+#include <Urho3D/Navigation/Obstacle.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "UnitTest.h"
+
+using namespace Urho3D;
+
+/// Maximum number of frames to wait for the path requests to complete.
+static const unsigned MAX_FRAMES = 1000;
+/// Bounding box of the floor.
+static const BoundingBox FLOOR_BOX(Vector3(-30.0f, -1.0f, -30.0f), Vector3(30.0f, 0.0f, 30.0f));
+/// Start point of the long paths, below the first wall.
+static const Vector3 LONG_PATH_START(-25.0f, 0.0f, -25.0f);
+/// End point of the long paths, above the last wall.
+static const Vector3 LONG_PATH_END(25.0f, 0.0f, 25.0f);
+
+/// Records the delivered path results.
+class PathRecorder : public Object
+{
+    URHO3D_OBJECT(PathRecorder, Object);
+
+public:
+    /// Construct.
+    explicit PathRecorder(Context* context) :
+        Object(context)
+    {
+        SubscribeToEvent(E_NAVIGATION_PATH_RESULT, URHO3D_HANDLER(PathRecorder, HandlePathResult));
+    }
+
+    /// Return the number of times a request was delivered.
+    unsigned GetNumResults(NavigationPathRequest* request) const
+    {
+        unsigned count = 0;
+        for (unsigned i = 0; i < results_.Size(); ++i)
+            count += results_[i] == request;
+        return count;
+    }
+
+    /// Results in delivery order.
+    Vector<SharedPtr<NavigationPathRequest> > results_;
+
+private:
+    /// Handle a path result.
+    void HandlePathResult(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace NavigationPathResult;
+
+        auto* request = static_cast<NavigationPathRequest*>(eventData[P_REQUEST].GetPtr());
+        TEST_CHECK(request->IsCompleted());
+        TEST_CHECK(eventData[P_SUCCESS].GetBool() == (request->GetState() == PATHREQUEST_SUCCEEDED));
+        TEST_CHECK(eventData[P_SUCCESS].GetBool() == !request->GetPath().Empty());
+        results_.Push(SharedPtr<NavigationPathRequest>(request));
+    }
+};
+
+/// Create a scene with a floor divided by walls into a winding corridor, and build a static or dynamic navigation mesh on it.
+static SharedPtr<Scene> CreateScene(Context* context, bool dynamic)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    scene->CreateComponent<PhysicsWorld>();
+
+    Node* floorNode = scene->CreateChild("Floor");
+    floorNode->CreateComponent<Navigable>();
+    auto* floorShape = floorNode->CreateComponent<CollisionShape>();
+    floorShape->SetBox(FLOOR_BOX.Size(), FLOOR_BOX.Center());
+
+    // Leave a gap at alternating ends of the walls
+    for (int i = 0; i < 5; ++i)
+    {
+        Node* wallNode = floorNode->CreateChild("Wall");
+        wallNode->SetPosition(Vector3(i & 1 ? 5.0f : -5.0f, 1.5f, -20.0f + i * 10.0f));
+        wallNode->CreateComponent<CollisionShape>()->SetBox(Vector3(50.0f, 3.0f, 1.0f));
+    }
+
+    NavigationMesh* navMesh = dynamic ? scene->CreateComponent<DynamicNavigationMesh>() : scene->CreateComponent<NavigationMesh>();
+    navMesh->SetTileSize(8);
+    TEST_CHECK(navMesh->Build());
+    return scene;
+}
+
+/// Update the scene until the path requests have completed.
+static void UpdateUntilCompleted(Scene* scene, NavigationMesh* navMesh)
+{
+    for (unsigned i = 0; i < MAX_FRAMES && navMesh->GetNumPathRequests(); ++i)
+        scene->Update(1.0f / 60.0f);
+    TEST_CHECK(!navMesh->GetNumPathRequests());
+}
+
+/// Check that a request succeeded with a path to near its end point.
+static void CheckSucceeded(NavigationPathRequest* request)
+{
+    TEST_CHECK(request->GetState() == PATHREQUEST_SUCCEEDED);
+    if (!request->GetPath().Empty())
+        TEST_CHECK((request->GetPath().Back().position_ - request->GetEnd()).Length() < 2.0f);
+}
+
+/// Check result ordering, coalescing and canceling.
+static void TestQueue(Context* context)
+{
+    SharedPtr<Scene> scene = CreateScene(context, false);
+    auto* navMesh = scene->GetComponent<NavigationMesh>();
+    SharedPtr<PathRecorder> recorder(new PathRecorder(context));
+
+    // With enough time, the requests complete within one frame and are delivered in request order, including the failed ones
+    navMesh->SetPathTimeBudget(1000.0f);
+    Vector<SharedPtr<NavigationPathRequest> > requests;
+    for (int i = 0; i < 20; ++i)
+    {
+        Vector3 start(-25.0f + i * 2.5f, 0.0f, -25.0f + (i % 5) * 10.0f);
+        Vector3 end(25.0f - i * 2.5f, 0.0f, 25.0f - (i % 4) * 10.0f);
+        if (i % 7 == 3)
+            end.y_ = 100.0f;
+        requests.Push(navMesh->RequestPath(start, end));
+    }
+    TEST_CHECK(navMesh->GetNumPathRequests() == requests.Size());
+    scene->Update(1.0f / 60.0f);
+    TEST_CHECK(recorder->results_ == requests);
+    for (unsigned i = 0; i < requests.Size(); ++i)
+    {
+        if (i % 7 == 3)
+            TEST_CHECK(requests[i]->GetState() == PATHREQUEST_FAILED);
+        else
+            CheckSucceeded(requests[i]);
+    }
+
+    // Requests between the same polygons share one search, but each gets its own straight path
+    recorder->results_.Clear();
+    SharedPtr<NavigationPathRequest> first = navMesh->RequestPath(LONG_PATH_START, LONG_PATH_END);
+    SharedPtr<NavigationPathRequest> second = navMesh->RequestPath(LONG_PATH_START, LONG_PATH_END);
+    SharedPtr<NavigationPathRequest> nearby = navMesh->RequestPath(LONG_PATH_START + Vector3(0.1f, 0.0f, 0.1f), LONG_PATH_END);
+    UpdateUntilCompleted(scene, navMesh);
+    TEST_CHECK(recorder->results_.Size() == 3);
+    TEST_CHECK(recorder->results_[0] == first && recorder->results_[1] == second && recorder->results_[2] == nearby);
+    CheckSucceeded(first);
+    CheckSucceeded(second);
+    CheckSucceeded(nearby);
+    TEST_CHECK(first->GetPath().Size() == second->GetPath().Size());
+    for (unsigned i = 0; i < first->GetPath().Size() && i < second->GetPath().Size(); ++i)
+        TEST_CHECK(first->GetPath()[i].position_ == second->GetPath()[i].position_);
+    TEST_CHECK(first->GetPath().Back().position_ == nearby->GetPath().Back().position_);
+
+    // Canceled requests are never delivered, whether they are still new or already share a search in progress
+    navMesh->SetPathTimeBudget(0.0f);
+    recorder->results_.Clear();
+    first = navMesh->RequestPath(LONG_PATH_START, LONG_PATH_END);
+    second = navMesh->RequestPath(LONG_PATH_START, LONG_PATH_END);
+    SharedPtr<NavigationPathRequest> newRequest = navMesh->RequestPath(LONG_PATH_END, LONG_PATH_START);
+    navMesh->CancelPathRequest(newRequest);
+    TEST_CHECK(newRequest->GetState() == PATHREQUEST_CANCELED);
+    TEST_CHECK(navMesh->GetNumPathRequests() == 2);
+    scene->Update(1.0f / 60.0f);
+    TEST_CHECK(navMesh->GetNumPathRequests() == 2);
+    navMesh->CancelPathRequest(first);
+    TEST_CHECK(first->GetState() == PATHREQUEST_CANCELED);
+    TEST_CHECK(navMesh->GetNumPathRequests() == 1);
+    UpdateUntilCompleted(scene, navMesh);
+    TEST_CHECK(recorder->results_.Size() == 1);
+    TEST_CHECK(recorder->GetNumResults(second) == 1);
+    CheckSucceeded(second);
+    TEST_CHECK(first->GetState() == PATHREQUEST_CANCELED);
+    TEST_CHECK(newRequest->GetState() == PATHREQUEST_CANCELED);
+}
+
+/// Check that the searches in progress are requeued when tiles are replaced, by a partial rebuild or by a tile cache update around an obstacle.
+static void TestRequeue(Context* context, bool dynamic)
+{
+    SharedPtr<Scene> scene = CreateScene(context, dynamic);
+    auto* navMesh = scene->GetDerivedComponent<NavigationMesh>();
+    SharedPtr<PathRecorder> recorder(new PathRecorder(context));
+    navMesh->SetPathTimeBudget(0.0f);
+
+    Vector<SharedPtr<NavigationPathRequest> > requests;
+    requests.Push(navMesh->RequestPath(LONG_PATH_START, LONG_PATH_END));
+    requests.Push(navMesh->RequestPath(LONG_PATH_END, LONG_PATH_START));
+    requests.Push(navMesh->RequestPath(LONG_PATH_START, Vector3(-25.0f, 0.0f, 15.0f)));
+    scene->Update(1.0f / 60.0f);
+    scene->Update(1.0f / 60.0f);
+    TEST_CHECK(navMesh->GetNumPathRequests() == requests.Size());
+
+    // Replace the tiles containing the start and end polygons of the searches in progress
+    if (dynamic)
+    {
+        Node* obstacleNode = scene->CreateChild("Obstacle");
+        obstacleNode->SetPosition(LONG_PATH_START);
+        obstacleNode->CreateComponent<Obstacle>()->SetRadius(0.5f);
+        obstacleNode = scene->CreateChild("Obstacle");
+        obstacleNode->SetPosition(LONG_PATH_END);
+        obstacleNode->CreateComponent<Obstacle>()->SetRadius(0.5f);
+    }
+    else
+        TEST_CHECK(navMesh->Build(FLOOR_BOX));
+
+    // The results of searches that complete on different frames are delivered in completion order
+    UpdateUntilCompleted(scene, navMesh);
+    TEST_CHECK(recorder->results_.Size() == requests.Size());
+    for (unsigned i = 0; i < requests.Size(); ++i)
+    {
+        TEST_CHECK(recorder->GetNumResults(requests[i]) == 1);
+        CheckSucceeded(requests[i]);
+    }
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new WorkQueue(context));
+    context->GetSubsystem<WorkQueue>()->CreateThreads(3);
+    RegisterSceneLibrary(context);
+    RegisterPhysicsLibrary(context);
+    RegisterNavigationLibrary(context);
+
+    TestQueue(context);
+    TestRequeue(context, false);
+    TestRequeue(context, true);
+
+    return TEST_RESULT();
+}
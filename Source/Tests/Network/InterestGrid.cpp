@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Network/NetworkInterestGrid.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "UnitTest.h"
+
+using namespace Urho3D;
+
+/// Grid cell size.
+static const float CELL_SIZE = 10.0f;
+/// Area of interest radius around the origin.
+static const float RADIUS = 10.0f;
+
+/// Update the grid and prepare the scene's network update, in the same order as Network.
+static void Step(Scene* scene, NetworkInterestGrid* grid)
+{
+    grid->Update();
+    scene->PrepareNetworkUpdate();
+}
+
+/// Return whether a node is in the area of interest around the origin.
+static bool IsVisible(NetworkInterestGrid* grid, Node* node, Connection* connection = nullptr)
+{
+    return grid->IsRelevant(node->GetID(), grid->GetCellRect(Vector3::ZERO, RADIUS), connection);
+}
+
+/// Return the nodes in the area of interest around the origin.
+static PODVector<unsigned> GetVisibleNodes(NetworkInterestGrid* grid)
+{
+    PODVector<unsigned> nodes;
+    grid->GetNodes(nodes, grid->GetCellRect(Vector3::ZERO, RADIUS));
+    return nodes;
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    RegisterSceneLibrary(context);
+    NetworkInterestGrid::RegisterObject(context);
+
+    SharedPtr<Scene> scene(new Scene(context));
+    auto* grid = scene->CreateComponent<NetworkInterestGrid>();
+    grid->SetCellSize(CELL_SIZE);
+
+    // Hierarchies are placed by their root, and unknown nodes are never visible
+    Node* near = scene->CreateChild("Near");
+    near->SetPosition(Vector3(5.0f, 0.0f, 5.0f));
+    Node* nearChild = near->CreateChild("NearChild");
+    nearChild->SetPosition(Vector3(100.0f, 0.0f, 100.0f));
+    Node* far = scene->CreateChild("Far");
+    far->SetPosition(Vector3(100.0f, 0.0f, 100.0f));
+    Step(scene, grid);
+    TEST_CHECK(IsVisible(grid, near));
+    TEST_CHECK(IsVisible(grid, nearChild));
+    TEST_CHECK(!IsVisible(grid, far));
+    TEST_CHECK(!grid->IsRelevant(M_MAX_UNSIGNED, grid->GetCellRect(Vector3::ZERO, RADIUS), nullptr));
+    TEST_CHECK(GetVisibleNodes(grid).Size() == 2);
+    TEST_CHECK(GetVisibleNodes(grid).Contains(nearChild->GetID()));
+    TEST_CHECK(grid->GetNumOccupiedCells() == 2);
+
+    // Nodes enter and leave when their root moves, and the cell left behind is removed
+    far->SetPosition(Vector3(-8.0f, 0.0f, 8.0f));
+    near->SetPosition(Vector3(200.0f, 0.0f, 0.0f));
+    Step(scene, grid);
+    TEST_CHECK(IsVisible(grid, far));
+    TEST_CHECK(!IsVisible(grid, near));
+    TEST_CHECK(!IsVisible(grid, nearChild));
+    TEST_CHECK(GetVisibleNodes(grid).Size() == 1);
+    TEST_CHECK(grid->GetNumOccupiedCells() == 2);
+
+    // Moving a node within its hierarchy does not move it on the grid, but reparenting does
+    nearChild->SetPosition(Vector3::ZERO);
+    Step(scene, grid);
+    TEST_CHECK(!IsVisible(grid, nearChild));
+    nearChild->SetParent(far);
+    Step(scene, grid);
+    TEST_CHECK(IsVisible(grid, nearChild));
+    TEST_CHECK(GetVisibleNodes(grid).Size() == 2);
+
+    // Added nodes enter with their hierarchy, and removed nodes leave
+    Node* added = far->CreateChild("Added");
+    Step(scene, grid);
+    TEST_CHECK(IsVisible(grid, added));
+    TEST_CHECK(GetVisibleNodes(grid).Size() == 3);
+    unsigned farID = far->GetID();
+    unsigned addedID = added->GetID();
+    far->Remove();
+    Step(scene, grid);
+    TEST_CHECK(!grid->IsRelevant(farID, grid->GetCellRect(Vector3::ZERO, RADIUS), nullptr));
+    TEST_CHECK(!grid->IsRelevant(addedID, grid->GetCellRect(Vector3::ZERO, RADIUS), nullptr));
+    TEST_CHECK(GetVisibleNodes(grid).Empty());
+    TEST_CHECK(grid->GetNumOccupiedCells() == 1);
+
+    // The connection owning any node of a hierarchy, not only its root, keeps the whole hierarchy visible to it.
+    // The connection is only compared, so any address will do
+    int connectionTag = 0;
+    auto* connection = reinterpret_cast<Connection*>(&connectionTag);
+    Node* owned = near->CreateChild("Owned");
+    owned->SetOwner(connection);
+    Step(scene, grid);
+    TEST_CHECK(!IsVisible(grid, near));
+    TEST_CHECK(IsVisible(grid, near, connection));
+    TEST_CHECK(IsVisible(grid, owned, connection));
+    owned->SetOwner(nullptr);
+    TEST_CHECK(!IsVisible(grid, near, connection));
+
+    // Replicated nodes under a local root follow the root, although it is not marked for network update
+    Node* localRoot = scene->CreateChild("Local", LOCAL);
+    localRoot->SetPosition(Vector3(200.0f, 0.0f, 200.0f));
+    Node* localChild = localRoot->CreateChild("LocalChild", REPLICATED);
+    Step(scene, grid);
+    TEST_CHECK(!IsVisible(grid, localChild));
+    localRoot->SetPosition(Vector3::ZERO);
+    Step(scene, grid);
+    TEST_CHECK(IsVisible(grid, localChild));
+    localRoot->Remove();
+    Step(scene, grid);
+    TEST_CHECK(GetVisibleNodes(grid).Empty());
+
+    // Changes while disabled are found when enabled again
+    grid->SetEnabled(false);
+    near->SetPosition(Vector3::ZERO);
+    scene->PrepareNetworkUpdate();
+    grid->SetEnabled(true);
+    Step(scene, grid);
+    TEST_CHECK(IsVisible(grid, near));
+
+    // Changing the cell size places all nodes again
+    grid->SetCellSize(100.0f);
+    near->SetPosition(Vector3(50.0f, 0.0f, 50.0f));
+    scene->PrepareNetworkUpdate();
+    Step(scene, grid);
+    TEST_CHECK(IsVisible(grid, near));
+    TEST_CHECK(grid->GetNumOccupiedCells() == 1);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,198 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Math/Ray.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <Bullet/BulletCollision/CollisionShapes/btCapsuleShape.h>
+
+#include "UnitTest.h"
+
+#include <cstdlib>
+
+using namespace Urho3D;
+
+/// Number of bodies in the world.
+static const unsigned NUM_BODIES = 200;
+/// Number of queries per batch, enough to be split into many work items.
+static const unsigned NUM_QUERIES = 500;
+/// Size of the area the bodies are placed in.
+static const float AREA_SIZE = 50.0f;
+/// Maximum query distance.
+static const float MAX_DISTANCE = 100.0f;
+/// Collision mask that leaves out the bodies on the second layer.
+static const unsigned FIRST_LAYER_MASK = 1;
+
+/// Return a random float between 0 and 1.
+static float RandomFloat() { return (float)rand() / (float)RAND_MAX; }
+
+/// Return a random position within the area.
+static Vector3 RandomPosition()
+{
+    return Vector3(RandomFloat() - 0.5f, RandomFloat() - 0.5f, RandomFloat() - 0.5f) * AREA_SIZE;
+}
+
+/// Return a random rotation.
+static Quaternion RandomRotation()
+{
+    return Quaternion(RandomFloat() * 360.0f, Vector3(RandomFloat(), RandomFloat(), RandomFloat() + 0.1f).Normalized());
+}
+
+/// Return whether two query results are identical.
+static bool Equals(const PhysicsRaycastResult& lhs, const PhysicsRaycastResult& rhs)
+{
+    return !(lhs != rhs) && (!lhs.body_ || lhs.hitFraction_ == rhs.hitFraction_);
+}
+
+/// Queries run in a batch and one by one.
+struct TestQueries
+{
+    /// Physics world.
+    PhysicsWorld* physicsWorld_;
+    /// Convex shape of a body in the world.
+    CollisionShape* shape_;
+    /// Rays for the raycasts and sphere casts.
+    PODVector<Ray> rays_;
+    /// Sweeps for the convex casts.
+    PODVector<PhysicsConvexSweep> sweeps_;
+};
+
+/// Check that the batched queries give the same results as the single queries. Return the number of hits.
+static unsigned CompareQueries(const TestQueries& queries, unsigned collisionMask)
+{
+    PhysicsWorld* physicsWorld = queries.physicsWorld_;
+    const PODVector<Ray>& rays = queries.rays_;
+    const PODVector<PhysicsConvexSweep>& sweeps = queries.sweeps_;
+    btCapsuleShape capsule(0.5f, 2.0f);
+    PODVector<PhysicsRaycastResult> results;
+    PhysicsRaycastResult result;
+    unsigned numHits = 0;
+
+    physicsWorld->RaycastSingleBatch(results, rays, MAX_DISTANCE, collisionMask);
+    TEST_CHECK(results.Size() == rays.Size());
+    for (unsigned i = 0; i < rays.Size() && i < results.Size(); ++i)
+    {
+        physicsWorld->RaycastSingle(result, rays[i], MAX_DISTANCE, collisionMask);
+        TEST_CHECK(Equals(results[i], result));
+        numHits += result.body_ != nullptr;
+    }
+
+    physicsWorld->SphereCastBatch(results, rays, 1.0f, MAX_DISTANCE, collisionMask);
+    TEST_CHECK(results.Size() == rays.Size());
+    for (unsigned i = 0; i < rays.Size() && i < results.Size(); ++i)
+    {
+        physicsWorld->SphereCast(result, rays[i], 1.0f, MAX_DISTANCE, collisionMask);
+        TEST_CHECK(Equals(results[i], result));
+        numHits += result.body_ != nullptr;
+    }
+
+    // The shape's own body must be left out of both, and its offset and the node scale applied the same way
+    physicsWorld->ConvexCastBatch(results, queries.shape_, sweeps, collisionMask);
+    TEST_CHECK(results.Size() == sweeps.Size());
+    for (unsigned i = 0; i < sweeps.Size() && i < results.Size(); ++i)
+    {
+        const PhysicsConvexSweep& sweep = sweeps[i];
+        physicsWorld->ConvexCast(result, queries.shape_, sweep.startPos_, sweep.startRot_, sweep.endPos_, sweep.endRot_, collisionMask);
+        TEST_CHECK(Equals(results[i], result));
+        TEST_CHECK(result.body_ != queries.shape_->GetComponent<RigidBody>());
+        numHits += result.body_ != nullptr;
+    }
+
+    physicsWorld->ConvexCastBatch(results, &capsule, sweeps, collisionMask);
+    TEST_CHECK(results.Size() == sweeps.Size());
+    for (unsigned i = 0; i < sweeps.Size() && i < results.Size(); ++i)
+    {
+        const PhysicsConvexSweep& sweep = sweeps[i];
+        physicsWorld->ConvexCast(result, &capsule, sweep.startPos_, sweep.startRot_, sweep.endPos_, sweep.endRot_, collisionMask);
+        TEST_CHECK(Equals(results[i], result));
+        numHits += result.body_ != nullptr;
+    }
+
+    return numHits;
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    auto* workQueue = new WorkQueue(context);
+    context->RegisterSubsystem(workQueue);
+    workQueue->CreateThreads(3);
+    RegisterSceneLibrary(context);
+    RegisterPhysicsLibrary(context);
+
+    SharedPtr<Scene> scene(new Scene(context));
+    TestQueries queries;
+    queries.physicsWorld_ = scene->CreateComponent<PhysicsWorld>();
+
+    // Static boxes and spheres, half of them on a second collision layer
+    for (unsigned i = 0; i < NUM_BODIES; ++i)
+    {
+        Node* node = scene->CreateChild("Body");
+        node->SetTransform(RandomPosition(), RandomRotation());
+        auto* body = node->CreateComponent<RigidBody>();
+        body->SetCollisionLayer(i & 1 ? 2 : 1);
+        auto* shape = node->CreateComponent<CollisionShape>();
+        if (i & 2)
+            shape->SetBox(Vector3(1.0f + RandomFloat() * 3.0f, 1.0f + RandomFloat() * 3.0f, 1.0f + RandomFloat() * 3.0f));
+        else
+            shape->SetSphere(1.0f + RandomFloat() * 3.0f);
+    }
+
+    // A scaled body whose offset shape is swept through the world
+    Node* shapeNode = scene->CreateChild("Shape");
+    shapeNode->SetScale(Vector3(1.0f, 2.0f, 1.5f));
+    shapeNode->CreateComponent<RigidBody>();
+    queries.shape_ = shapeNode->CreateComponent<CollisionShape>();
+    queries.shape_->SetBox(Vector3::ONE, Vector3(0.5f, 0.0f, 0.0f), Quaternion(30.0f, Vector3::UP));
+    queries.physicsWorld_->Update(1.0f / DEFAULT_FPS);
+
+    for (unsigned i = 0; i < NUM_QUERIES; ++i)
+    {
+        Vector3 origin = RandomPosition() * 1.5f;
+        Vector3 target = RandomPosition() * 0.5f;
+        queries.rays_.Push(Ray(origin, target - origin));
+        // The sweep of the shape starts from its body, which must not be hit
+        Vector3 start = i & 1 ? origin : Vector3::ZERO;
+        queries.sweeps_.Push(PhysicsConvexSweep(start, RandomRotation(), target, RandomRotation()));
+    }
+
+    // From the main thread the queries are split over the work queue
+    unsigned numHits = CompareQueries(queries, M_MAX_UNSIGNED);
+    TEST_CHECK(numHits > NUM_QUERIES);
+    unsigned numMaskedHits = CompareQueries(queries, FIRST_LAYER_MASK);
+    TEST_CHECK(numMaskedHits > 0 && numMaskedHits < numHits);
+
+    // From within a work item they are split further with the current thread's index. The convex cast of a shape changes
+    // the collision group of its body during the query, so only one work item runs them
+    workQueue->ParallelFor(1, 1, [&queries](unsigned, unsigned, unsigned)
+    {
+        CompareQueries(queries, M_MAX_UNSIGNED);
+    });
+
+    return TEST_RESULT();
+}
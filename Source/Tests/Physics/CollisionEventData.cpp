@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsEvents.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "UnitTest.h"
+
+using namespace Urho3D;
+
+/// Parameter added by the event handlers.
+static const StringHash P_HANDLERPARAM("HandlerParam");
+
+/// Checks the collision event data and adds a parameter of its own to it.
+class CollisionListener : public Object
+{
+    URHO3D_OBJECT(CollisionListener, Object);
+
+public:
+    /// Construct.
+    explicit CollisionListener(Context* context, Node* node) :
+        Object(context),
+        numCollisions_(0),
+        numEnds_(0),
+        numNodeEnds_(0)
+    {
+        SubscribeToEvent(E_PHYSICSCOLLISION, URHO3D_HANDLER(CollisionListener, HandlePhysicsCollision));
+        SubscribeToEvent(E_PHYSICSCOLLISIONEND, URHO3D_HANDLER(CollisionListener, HandlePhysicsCollisionEnd));
+        SubscribeToEvent(node, E_NODECOLLISION, URHO3D_HANDLER(CollisionListener, HandleNodeCollision));
+        SubscribeToEvent(node, E_NODECOLLISIONEND, URHO3D_HANDLER(CollisionListener, HandleNodeCollisionEnd));
+    }
+
+    /// Number of ongoing collision events.
+    unsigned numCollisions_;
+    /// Number of collision end events.
+    unsigned numEnds_;
+    /// Number of node collision end events.
+    unsigned numNodeEnds_;
+
+private:
+    /// Handle an ongoing collision.
+    void HandlePhysicsCollision(StringHash eventType, VariantMap& eventData)
+    {
+        TEST_CHECK(!eventData.Contains(P_HANDLERPARAM));
+        TEST_CHECK(!eventData[PhysicsCollision::P_CONTACTS].GetBuffer().Empty());
+        eventData[P_HANDLERPARAM] = true;
+        ++numCollisions_;
+    }
+
+    /// Handle an ongoing node collision.
+    void HandleNodeCollision(StringHash eventType, VariantMap& eventData)
+    {
+        TEST_CHECK(!eventData.Contains(P_HANDLERPARAM));
+        eventData[P_HANDLERPARAM] = true;
+    }
+
+    /// Handle a collision end. The contacts and the parameters added by the handlers must not be left over.
+    void HandlePhysicsCollisionEnd(StringHash eventType, VariantMap& eventData)
+    {
+        TEST_CHECK(!eventData.Contains(PhysicsCollision::P_CONTACTS));
+        TEST_CHECK(!eventData.Contains(P_HANDLERPARAM));
+        ++numEnds_;
+    }
+
+    /// Handle a node collision end.
+    void HandleNodeCollisionEnd(StringHash eventType, VariantMap& eventData)
+    {
+        TEST_CHECK(!eventData.Contains(NodeCollision::P_CONTACTS));
+        TEST_CHECK(!eventData.Contains(P_HANDLERPARAM));
+        ++numNodeEnds_;
+    }
+};
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    RegisterSceneLibrary(context);
+    RegisterPhysicsLibrary(context);
+
+    SharedPtr<Scene> scene(new Scene(context));
+    auto* physicsWorld = scene->CreateComponent<PhysicsWorld>();
+
+    Node* floorNode = scene->CreateChild("Floor");
+    floorNode->CreateComponent<RigidBody>();
+    floorNode->CreateComponent<CollisionShape>()->SetStaticPlane();
+
+    Node* boxNode = scene->CreateChild("Box");
+    boxNode->SetPosition(Vector3(0.0f, 0.49f, 0.0f));
+    auto* box = boxNode->CreateComponent<RigidBody>();
+    box->SetMass(1.0f);
+    boxNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    SharedPtr<CollisionListener> listener(new CollisionListener(context, boxNode));
+
+    // Several steps of contact, during which the handler parameters must not persist from step to step
+    for (unsigned i = 0; i < 5; ++i)
+        physicsWorld->Update(1.0f / DEFAULT_FPS);
+    TEST_CHECK(listener->numCollisions_ == 5);
+
+    // Moving the box away from the floor ends the collision
+    box->SetPosition(Vector3(0.0f, 10.0f, 0.0f));
+    physicsWorld->Update(1.0f / DEFAULT_FPS);
+    TEST_CHECK(listener->numEnds_ == 1);
+    TEST_CHECK(listener->numNodeEnds_ == 1);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsEvents.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "UnitTest.h"
+
+using namespace Urho3D;
+
+/// Maximum number of steps to wait for a body to fall asleep.
+static const unsigned MAX_SLEEP_STEPS = 1000;
+
+/// Contact stream pair recorded from the event, with the pair key.
+struct RecordedPair
+{
+    /// Rigid body A.
+    RigidBody* bodyA_;
+    /// Rigid body B.
+    RigidBody* bodyB_;
+    /// Begin, stay or end state.
+    ContactPairState state_;
+    /// Pair key made of the component IDs.
+    unsigned long long key_;
+};
+
+/// Records the contact stream pairs of the last simulation step.
+class ContactRecorder : public Object
+{
+    URHO3D_OBJECT(ContactRecorder, Object);
+
+public:
+    /// Construct.
+    explicit ContactRecorder(Context* context) :
+        Object(context)
+    {
+        SubscribeToEvent(E_PHYSICSCONTACTS, URHO3D_HANDLER(ContactRecorder, HandlePhysicsContacts));
+    }
+
+    /// Step the physics world and return the recorded pairs.
+    const PODVector<RecordedPair>& Step(PhysicsWorld* physicsWorld)
+    {
+        pairs_.Clear();
+        physicsWorld->Update(1.0f / DEFAULT_FPS);
+        return pairs_;
+    }
+
+    /// Return the state of the pair of two bodies on the last step, or -1 if it was not reported. Check that it is reported at most once.
+    int GetState(RigidBody* bodyA, RigidBody* bodyB) const
+    {
+        int state = -1;
+        for (unsigned i = 0; i < pairs_.Size(); ++i)
+        {
+            if (pairs_[i].bodyA_ == bodyA && pairs_[i].bodyB_ == bodyB)
+            {
+                TEST_CHECK(state == -1);
+                state = pairs_[i].state_;
+            }
+        }
+        return state;
+    }
+
+private:
+    /// Handle the contact stream event.
+    void HandlePhysicsContacts(StringHash eventType, VariantMap& eventData)
+    {
+        auto* physicsWorld = static_cast<PhysicsWorld*>(eventData[PhysicsContacts::P_WORLD].GetPtr());
+        const PODVector<PhysicsContactPair>& pairs = physicsWorld->GetContactPairs();
+        for (unsigned i = 0; i < pairs.Size(); ++i)
+        {
+            const PhysicsContactPair& pair = pairs[i];
+            TEST_CHECK(pair.bodyA_->GetID() < pair.bodyB_->GetID());
+            TEST_CHECK((pair.state_ == CONTACT_END) == (pair.numContacts_ == 0));
+
+            RecordedPair recorded;
+            recorded.bodyA_ = pair.bodyA_;
+            recorded.bodyB_ = pair.bodyB_;
+            recorded.state_ = pair.state_;
+            recorded.key_ = (unsigned long long)pair.bodyA_->GetID() << 32u | pair.bodyB_->GetID();
+
+            // The pairs are merged in key order, and a key appears twice only when a reused ID ends and begins a pair
+            if (!pairs_.Empty())
+                TEST_CHECK(pairs_.Back().key_ < recorded.key_ || (pairs_.Back().key_ == recorded.key_ &&
+                    pairs_.Back().state_ == CONTACT_END && recorded.state_ == CONTACT_BEGIN));
+            pairs_.Push(recorded);
+        }
+    }
+
+    /// Pairs recorded on the last step.
+    PODVector<RecordedPair> pairs_;
+};
+
+/// Create a dynamic box resting on the floor.
+static RigidBody* CreateBox(Scene* scene, const Vector3& position, unsigned id = 0)
+{
+    Node* node = scene->CreateChild("Box");
+    node->SetPosition(position);
+    auto* body = static_cast<RigidBody*>(node->CreateComponent(RigidBody::GetTypeStatic(), REPLICATED, id));
+    body->SetMass(1.0f);
+    node->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+    return body;
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    RegisterSceneLibrary(context);
+    RegisterPhysicsLibrary(context);
+
+    SharedPtr<Scene> scene(new Scene(context));
+    auto* physicsWorld = scene->CreateComponent<PhysicsWorld>();
+    physicsWorld->SetContactStream(true);
+    physicsWorld->SetCollisionEvents(false);
+    SharedPtr<ContactRecorder> recorder(new ContactRecorder(context));
+
+    Node* floorNode = scene->CreateChild("Floor");
+    auto* floor = floorNode->CreateComponent<RigidBody>();
+    floorNode->CreateComponent<CollisionShape>()->SetStaticPlane();
+
+    // A box touching the floor begins the pair, then continues it
+    RigidBody* box = CreateBox(scene, Vector3(0.0f, 0.49f, 0.0f));
+    recorder->Step(physicsWorld);
+    TEST_CHECK(recorder->GetState(floor, box) == CONTACT_BEGIN);
+    recorder->Step(physicsWorld);
+    TEST_CHECK(recorder->GetState(floor, box) == CONTACT_STAY);
+
+    // A second box begins its own pair, while the first one continues
+    RigidBody* otherBox = CreateBox(scene, Vector3(5.0f, 0.49f, 0.0f));
+    recorder->Step(physicsWorld);
+    TEST_CHECK(recorder->GetState(floor, box) == CONTACT_STAY);
+    TEST_CHECK(recorder->GetState(floor, otherBox) == CONTACT_BEGIN);
+
+    // Moving a box away from the floor ends its pair
+    otherBox->SetPosition(Vector3(5.0f, 10.0f, 0.0f));
+    recorder->Step(physicsWorld);
+    TEST_CHECK(recorder->GetState(floor, box) == CONTACT_STAY);
+    TEST_CHECK(recorder->GetState(floor, otherBox) == CONTACT_END);
+    recorder->Step(physicsWorld);
+    TEST_CHECK(recorder->GetState(floor, otherBox) == -1);
+    otherBox->GetNode()->Remove();
+
+    // A box falling asleep on the static floor is no longer reported, which must end the pair, and waking it up begins it again
+    unsigned numBegins = 0;
+    unsigned numEnds = 0;
+    for (unsigned i = 0; i < MAX_SLEEP_STEPS && box->IsActive(); ++i)
+    {
+        recorder->Step(physicsWorld);
+        int state = recorder->GetState(floor, box);
+        numBegins += state == CONTACT_BEGIN;
+        numEnds += state == CONTACT_END;
+    }
+    TEST_CHECK(!box->IsActive());
+    TEST_CHECK(numBegins == 0);
+    TEST_CHECK(numEnds == 1);
+    recorder->Step(physicsWorld);
+    TEST_CHECK(recorder->GetState(floor, box) == -1);
+    box->Activate();
+    recorder->Step(physicsWorld);
+    TEST_CHECK(recorder->GetState(floor, box) == CONTACT_BEGIN);
+
+    // A destroyed body does not end its pair, and a new body reusing its component ID begins a new pair instead of continuing it
+    unsigned boxID = box->GetID();
+    box->GetNode()->Remove();
+    RigidBody* newBox = CreateBox(scene, Vector3(0.0f, 0.49f, 0.0f), boxID);
+    TEST_CHECK(newBox->GetID() == boxID);
+    const PODVector<RecordedPair>& pairs = recorder->Step(physicsWorld);
+    TEST_CHECK(pairs.Size() == 1);
+    TEST_CHECK(recorder->GetState(floor, newBox) == CONTACT_BEGIN);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsUtils.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+
+#include "UnitTest.h"
+
+using namespace Urho3D;
+
+/// Number of box stacks.
+static const unsigned NUM_STACKS = 8;
+/// Number of boxes per stack.
+static const unsigned NUM_BOXES = 6;
+/// Number of simulation steps.
+static const unsigned NUM_STEPS = 180;
+/// Largest allowed distance between a box simulated in the threaded and in the sequential world.
+static const float MAX_POSITION_DIFFERENCE = 0.1f;
+
+/// Contact manifold reduced to box indices and contact points.
+struct ManifoldState
+{
+    /// Index of the first box, or -1 for the floor.
+    int indexA_;
+    /// Index of the second box, or -1 for the floor.
+    int indexB_;
+    /// Contact positions on body B.
+    PODVector<Vector3> positions_;
+};
+
+/// Physics scene with the box stacks.
+struct TestScene
+{
+    /// Scene.
+    SharedPtr<Scene> scene_;
+    /// Physics world.
+    PhysicsWorld* physicsWorld_;
+    /// Box nodes.
+    PODVector<Node*> boxNodes_;
+};
+
+/// Create the box stacks with or without the threaded mode. The boxes overlap slightly, so that contacts exist from the start.
+static TestScene CreateScene(Context* context, bool threaded)
+{
+    TestScene result;
+    PhysicsWorld::config.threaded_ = threaded;
+    result.scene_ = new Scene(context);
+    result.physicsWorld_ = result.scene_->CreateComponent<PhysicsWorld>();
+    PhysicsWorld::config.threaded_ = false;
+    TEST_CHECK(result.physicsWorld_->IsThreaded() == threaded);
+    result.physicsWorld_->SetInterpolation(false);
+
+    Node* floorNode = result.scene_->CreateChild("Floor");
+    floorNode->CreateComponent<RigidBody>();
+    floorNode->CreateComponent<CollisionShape>()->SetStaticPlane();
+
+    for (unsigned i = 0; i < NUM_STACKS; ++i)
+    {
+        for (unsigned j = 0; j < NUM_BOXES; ++j)
+        {
+            // Offset and rotate the boxes slightly, so that the stacks are not perfectly balanced
+            Node* boxNode = result.scene_->CreateChild("Box");
+            boxNode->SetPosition(Vector3(i * 1.5f + j * 0.1f, 0.49f + j * 0.99f, (i & 1) * 0.3f));
+            boxNode->SetRotation(Quaternion(i * 7.0f + j * 11.0f, Vector3::UP));
+            auto* body = boxNode->CreateComponent<RigidBody>();
+            body->SetMass(1.0f);
+            body->SetFriction(0.7f);
+            boxNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+            result.boxNodes_.Push(boxNode);
+        }
+    }
+
+    return result;
+}
+
+/// Return the box index of a collision object, or -1 if it is not a box.
+static int GetBoxIndex(const TestScene& testScene, const btCollisionObject* object)
+{
+    auto* body = static_cast<RigidBody*>(object->getUserPointer());
+    unsigned index = testScene.boxNodes_.IndexOf(body->GetNode());
+    return index < testScene.boxNodes_.Size() ? (int)index : -1;
+}
+
+/// Run the collision detection once and return the manifold array.
+static Vector<ManifoldState> DetectCollisions(const TestScene& testScene)
+{
+    btDiscreteDynamicsWorld* world = testScene.physicsWorld_->GetWorld();
+    world->performDiscreteCollisionDetection();
+
+    Vector<ManifoldState> result;
+    btDispatcher* dispatcher = world->getDispatcher();
+    for (int i = 0; i < dispatcher->getNumManifolds(); ++i)
+    {
+        btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+        ManifoldState state;
+        state.indexA_ = GetBoxIndex(testScene, manifold->getBody0());
+        state.indexB_ = GetBoxIndex(testScene, manifold->getBody1());
+        for (int j = 0; j < manifold->getNumContacts(); ++j)
+            state.positions_.Push(ToVector3(manifold->getContactPoint(j).m_positionWorldOnB));
+        result.Push(state);
+    }
+    return result;
+}
+
+/// Simulate the scene and return the final box positions.
+static PODVector<Vector3> Simulate(const TestScene& testScene)
+{
+    for (unsigned i = 0; i < NUM_STEPS; ++i)
+        testScene.physicsWorld_->Update(1.0f / DEFAULT_FPS);
+
+    PODVector<Vector3> result;
+    for (unsigned i = 0; i < testScene.boxNodes_.Size(); ++i)
+        result.Push(testScene.boxNodes_[i]->GetWorldPosition());
+    return result;
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new WorkQueue(context));
+    context->GetSubsystem<WorkQueue>()->CreateThreads(3);
+    RegisterSceneLibrary(context);
+    RegisterPhysicsLibrary(context);
+
+    // The threaded collision dispatch must produce the same manifold array as the sequential dispatch
+    {
+        TestScene sequentialScene = CreateScene(context, false);
+        TestScene threadedScene = CreateScene(context, true);
+        Vector<ManifoldState> sequential = DetectCollisions(sequentialScene);
+        Vector<ManifoldState> threaded = DetectCollisions(threadedScene);
+
+        TEST_CHECK(!sequential.Empty());
+        TEST_CHECK(sequential.Size() == threaded.Size());
+        for (unsigned i = 0; i < sequential.Size() && i < threaded.Size(); ++i)
+        {
+            TEST_CHECK(sequential[i].indexA_ == threaded[i].indexA_);
+            TEST_CHECK(sequential[i].indexB_ == threaded[i].indexB_);
+            TEST_CHECK(sequential[i].positions_ == threaded[i].positions_);
+        }
+    }
+
+    // Repeated threaded simulations must give identical results regardless of the scheduling of the worker threads.
+    // The multithreaded Bullet world orders the constraints of an island differently from the sequential world, so
+    // the sequential results can only be expected to be close
+    {
+        PODVector<Vector3> sequential = Simulate(CreateScene(context, false));
+        PODVector<Vector3> threaded = Simulate(CreateScene(context, true));
+        PODVector<Vector3> threadedAgain = Simulate(CreateScene(context, true));
+
+        TEST_CHECK(threaded == threadedAgain);
+        TEST_CHECK(sequential.Size() == threaded.Size());
+        for (unsigned i = 0; i < sequential.Size() && i < threaded.Size(); ++i)
+            TEST_CHECK((sequential[i] - threaded[i]).Length() < MAX_POSITION_DIFFERENCE);
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Scene/LogicComponent.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "UnitTest.h"
+
+#include <atomic>
+
+using namespace Urho3D;
+
+/// Logic component that counts its updates and can switch to thread-safe update when starting.
+class CountingComponent : public LogicComponent
+{
+    URHO3D_OBJECT(CountingComponent, LogicComponent);
+
+public:
+    /// Construct.
+    explicit CountingComponent(Context* context) :
+        LogicComponent(context),
+        threadSafeOnStart_(threadSafeOnStartDefault_),
+        threadSafeOnDelayedStart_(threadSafeOnDelayedStartDefault_),
+        numUpdates_(0),
+        numPostUpdates_(0)
+    {
+        SetUpdateEventMask(USE_UPDATE | USE_POSTUPDATE);
+    }
+
+    /// Called when the component is added to a scene node.
+    void Start() override
+    {
+        if (threadSafeOnStart_)
+            SetThreadSafeUpdate(true);
+    }
+
+    /// Called before the first update.
+    void DelayedStart() override
+    {
+        if (threadSafeOnDelayedStart_)
+            SetThreadSafeUpdate(true);
+    }
+
+    /// Called on scene update.
+    void Update(float timeStep) override { ++numUpdates_; }
+
+    /// Called on scene post-update.
+    void PostUpdate(float timeStep) override { ++numPostUpdates_; }
+
+    /// Whether new components switch to thread-safe update in Start().
+    static bool threadSafeOnStartDefault_;
+    /// Whether new components switch to thread-safe update in DelayedStart().
+    static bool threadSafeOnDelayedStartDefault_;
+
+    /// Switch to thread-safe update in Start().
+    bool threadSafeOnStart_;
+    /// Switch to thread-safe update in DelayedStart().
+    bool threadSafeOnDelayedStart_;
+    /// Number of updates.
+    std::atomic<unsigned> numUpdates_;
+    /// Number of post-updates.
+    std::atomic<unsigned> numPostUpdates_;
+};
+
+bool CountingComponent::threadSafeOnStartDefault_ = false;
+bool CountingComponent::threadSafeOnDelayedStartDefault_ = false;
+
+/// Number of components per test, enough for the thread-safe ones to be updated in parallel.
+static const unsigned NUM_COMPONENTS = 100;
+
+/// Create components with the given start behavior and check that each of them receives every update.
+static void TestUpdates(Scene* scene, bool threadSafeOnStart, bool threadSafeOnDelayedStart)
+{
+    CountingComponent::threadSafeOnStartDefault_ = threadSafeOnStart;
+    CountingComponent::threadSafeOnDelayedStartDefault_ = threadSafeOnDelayedStart;
+
+    PODVector<CountingComponent*> components;
+    for (unsigned i = 0; i < NUM_COMPONENTS; ++i)
+    {
+        // Create some components in nodes already in the scene, and others before adding their nodes to it
+        SharedPtr<Node> node(i < NUM_COMPONENTS / 2 ? scene->CreateChild() : new Node(scene->GetContext()));
+        components.Push(node->CreateComponent<CountingComponent>());
+        scene->AddChild(node);
+    }
+
+    scene->Update(0.01f);
+    scene->Update(0.01f);
+
+    // Toggle thread-safe update of half of the components while they are in the scene
+    for (unsigned i = 0; i < NUM_COMPONENTS; i += 2)
+        components[i]->SetThreadSafeUpdate(!components[i]->IsThreadSafeUpdate());
+
+    scene->Update(0.01f);
+
+    for (unsigned i = 0; i < NUM_COMPONENTS; ++i)
+    {
+        TEST_CHECK(components[i]->numUpdates_ == 3);
+        TEST_CHECK(components[i]->numPostUpdates_ == 3);
+        TEST_CHECK(components[i]->IsThreadSafeUpdate() == ((threadSafeOnStart || threadSafeOnDelayedStart) != !(i & 1)));
+    }
+
+    scene->RemoveAllChildren();
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new WorkQueue(context));
+    context->GetSubsystem<WorkQueue>()->CreateThreads(2);
+    context->RegisterFactory<CountingComponent>();
+
+    SharedPtr<Scene> scene(new Scene(context));
+    TestUpdates(scene, false, false);
+    TestUpdates(scene, true, false);
+    TestUpdates(scene, false, true);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/UI/LineEdit.h>
+#include <Urho3D/UI/Text.h>
+#include <Urho3D/UI/UI.h>
+#include <Urho3D/UI/UIBatch.h>
+
+#include "UnitTest.h"
+
+using namespace Urho3D;
+
+/// Scissor used for all batches.
+static const IntRect SCISSOR(0, 0, 1000, 1000);
+
+/// Text that is cacheable and renders one quad per character, as fonts have no faces without a graphics subsystem.
+class TestText : public Text
+{
+    URHO3D_OBJECT(TestText, Text);
+
+public:
+    /// Construct.
+    explicit TestText(Context* context) :
+        Text(context)
+    {
+    }
+
+    /// Return whether the batches can currently be cached.
+    bool IsBatchCacheable() override { return true; }
+
+    /// Return UI rendering batches. Each character is a quad with the character code as its height.
+    void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor) override
+    {
+        Text::GetBatches(batches, vertexData, currentScissor);
+
+        UIBatch batch(this, BLEND_ALPHA, currentScissor, nullptr, &vertexData);
+        const String& text = GetText();
+        for (unsigned i = 0; i < text.Length(); ++i)
+            batch.AddQuad((float)(i * 8), 0.0f, 8.0f, (float)text[i], 0, 0);
+        UIBatch::AddOrMerge(batch, batches);
+    }
+};
+
+/// Factory that creates the test text in place of the text type, so that the line edit uses it.
+class TestTextFactory : public ObjectFactory
+{
+public:
+    /// Construct.
+    explicit TestTextFactory(Context* context) :
+        ObjectFactory(context)
+    {
+        typeInfo_ = Text::GetTypeInfoStatic();
+    }
+
+    /// Create the test text.
+    SharedPtr<Object> CreateObject() override { return SharedPtr<Object>(new TestText(context_)); }
+};
+
+/// Return the batches of an element through its cache and whether they were rebuilt.
+static bool GetCachedBatches(UIElement* element, PODVector<float>& vertexData)
+{
+    PODVector<UIBatch> batches;
+    vertexData.Clear();
+    return element->GetCachedBatches(batches, vertexData, SCISSOR);
+}
+
+int main()
+{
+    SharedPtr<Context> context(new Context());
+    RegisterUILibrary(context);
+    context->RegisterFactory(new TestTextFactory(context));
+
+    SharedPtr<LineEdit> lineEdit(new LineEdit(context));
+    Text* text = lineEdit->GetTextElement();
+    TEST_CHECK(text->GetType() == TestText::GetTypeStatic());
+
+    PODVector<float> vertexData;
+    PODVector<float> newVertexData;
+
+    // Unchanged text is drawn from the cache
+    lineEdit->SetText("abc");
+    TEST_CHECK(GetCachedBatches(text, vertexData));
+    TEST_CHECK(!vertexData.Empty());
+    TEST_CHECK(!GetCachedBatches(text, newVertexData));
+    TEST_CHECK(newVertexData == vertexData);
+
+    // Text of the same length keeps the size, and the line edit updates the char locations when moving the cursor,
+    // yet the batches must be rebuilt
+    lineEdit->SetText("xyz");
+    TEST_CHECK(GetCachedBatches(text, newVertexData));
+    TEST_CHECK(newVertexData.Size() == vertexData.Size());
+    TEST_CHECK(newVertexData != vertexData);
+    TEST_CHECK(!GetCachedBatches(text, vertexData));
+
+    // Alignment and indent change the layout without changing the size
+    text->SetTextAlignment(HA_RIGHT);
+    text->GetCharPosition(0);
+    TEST_CHECK(GetCachedBatches(text, vertexData));
+    TEST_CHECK(!GetCachedBatches(text, vertexData));
+    text->SetIndent(1);
+    text->GetCharPosition(0);
+    TEST_CHECK(GetCachedBatches(text, vertexData));
+    TEST_CHECK(!GetCachedBatches(text, vertexData));
+
+    return TEST_RESULT();
+}
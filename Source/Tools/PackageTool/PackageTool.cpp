@@ -46,6 +46,7 @@ struct FileEntry
     unsigned offset_{};
     unsigned size_{};
     unsigned checksum_{};
+    bool compressed_{};
 };
 
 SharedPtr<Context> context_(new Context());
@@ -90,7 +91,7 @@ void Run(const Vector<String>& arguments)
             "Usage: PackageTool <directory to process> <package name> [basepath] [options]\n"
             "\n"
             "Options:\n"
-            "-c      Enable package file LZ4 compression\n"
+            "-c      Enable package file LZ4 compression. Entries are compressed in independent blocks to allow random access\n"
             "-q      Enable quiet mode\n"
             "\n"
             "Basepath is an optional prefix that will be added to the file entries.\n\n"
@@ -172,6 +173,8 @@ void Run(const Vector<String>& arguments)
             PrintLine("Package size: " + String(packageFile->GetTotalSize()));
             PrintLine("Checksum: " + String(packageFile->GetChecksum()));
             PrintLine("Compressed: " + String(packageFile->IsCompressed() ? "yes" : "no"));
+            if (packageFile->GetBlockSize())
+                PrintLine("Block size: " + String(packageFile->GetBlockSize()));
             break;
         case 'L':
             if (!packageFile->IsCompressed())
@@ -239,6 +242,8 @@ void WritePackageFile(const String& fileName, const String& rootDir)
         dest.WriteUInt(entries_[i].offset_);
         dest.WriteUInt(entries_[i].size_);
         dest.WriteUInt(entries_[i].checksum_);
+        if (compress_)
+            dest.WriteUByte((unsigned char)entries_[i].compressed_);
     }
 
     unsigned totalDataSize = 0;
@@ -276,26 +281,38 @@ void WritePackageFile(const String& fileName, const String& rootDir)
         }
         else
         {
-            SharedArrayPtr<unsigned char> compressBuffer(new unsigned char[LZ4_compressBound(blockSize_)]);
-
-            unsigned pos = 0;
-
-            while (pos < dataSize)
+            // Compress each block independently and store the block offsets before the blocks, so that reading can
+            // start from any block
+            unsigned numBlocks = (dataSize + blockSize_ - 1) / blockSize_;
+            unsigned indexSize = (numBlocks + 1) * sizeof(unsigned);
+            PODVector<unsigned> blockOffsets(numBlocks + 1);
+            SharedArrayPtr<unsigned char> compressBuffer(new unsigned char[numBlocks * LZ4_compressBound(blockSize_)]);
+
+            unsigned packedTotal = 0;
+            for (unsigned j = 0; j < numBlocks; ++j)
             {
-                unsigned unpackedSize = blockSize_;
-                if (pos + unpackedSize > dataSize)
-                    unpackedSize = dataSize - pos;
+                unsigned pos = j * blockSize_;
+                unsigned unpackedSize = Min(blockSize_, dataSize - pos);
 
-                auto packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)compressBuffer.Get(), unpackedSize, LZ4_compressBound(unpackedSize), 0);
+                auto packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)compressBuffer.Get() + packedTotal,
+                    unpackedSize, LZ4_compressBound(unpackedSize), 0);
                 if (!packedSize)
                     ErrorExit("LZ4 compression failed for file " + entries_[i].name_ + " at offset " + String(pos));
 
-                dest.WriteUShort((unsigned short)unpackedSize);
-                dest.WriteUShort((unsigned short)packedSize);
-                dest.Write(compressBuffer.Get(), packedSize);
+                blockOffsets[j] = indexSize + packedTotal;
+                packedTotal += packedSize;
+            }
+            blockOffsets[numBlocks] = indexSize + packedTotal;
 
-                pos += unpackedSize;
+            // Store incompressible files as is. They can then also be read directly from a memory mapped package
+            entries_[i].compressed_ = indexSize + packedTotal < dataSize;
+            if (entries_[i].compressed_)
+            {
+                dest.Write(&blockOffsets[0], indexSize);
+                dest.Write(compressBuffer.Get(), packedTotal);
             }
+            else
+                dest.Write(&buffer[0], dataSize);
 
             if (!quiet_)
             {
@@ -322,6 +339,8 @@ void WritePackageFile(const String& fileName, const String& rootDir)
         dest.WriteUInt(entries_[i].offset_);
         dest.WriteUInt(entries_[i].size_);
         dest.WriteUInt(entries_[i].checksum_);
+        if (compress_)
+            dest.WriteUByte((unsigned char)entries_[i].compressed_);
     }
 
     if (!quiet_)
@@ -339,7 +358,9 @@ void WriteHeader(File& dest)
     if (!compress_)
         dest.WriteFileID("UPAK");
     else
-        dest.WriteFileID("ULZ4");
+        dest.WriteFileID("ULZB");
     dest.WriteUInt(entries_.Size());
     dest.WriteUInt(checksum_);
+    if (compress_)
+        dest.WriteUInt(blockSize_);
 }
@@ -152,9 +152,14 @@ static void RegisterLog(asIScriptEngine* engine)
     engine->RegisterGlobalProperty("const int LOG_ERROR", (void*)&LOG_ERROR);
     engine->RegisterGlobalProperty("const int LOG_NONE", (void*)&LOG_NONE);
 
+    engine->RegisterEnum("LogOverflowMode");
+    engine->RegisterEnumValue("LogOverflowMode", "LOG_OVERFLOW_DROP", LOG_OVERFLOW_DROP);
+    engine->RegisterEnumValue("LogOverflowMode", "LOG_OVERFLOW_BLOCK", LOG_OVERFLOW_BLOCK);
+
     RegisterObject<Log>(engine, "Log");
     engine->RegisterObjectMethod("Log", "void Open(const String&in)", asMETHOD(Log, Open), asCALL_THISCALL);
     engine->RegisterObjectMethod("Log", "void Close()", asMETHOD(Log, Close), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Log", "void Flush()", asMETHOD(Log, Flush), asCALL_THISCALL);
     engine->RegisterObjectMethod("Log", "void Write(const String&in, bool error = false)", asFUNCTION(LogWrite), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Log", "void Trace(const String&in)", asFUNCTION(LogTrace), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Log", "void Debug(const String&in)", asFUNCTION(LogDebug), asCALL_CDECL_OBJLAST);
@@ -168,6 +173,10 @@ static void RegisterLog(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Log", "String get_lastMessage()", asMETHOD(Log, GetLastMessage), asCALL_THISCALL);
     engine->RegisterObjectMethod("Log", "void set_quiet(bool)", asMETHOD(Log, SetQuiet), asCALL_THISCALL);
     engine->RegisterObjectMethod("Log", "bool get_quiet() const", asMETHOD(Log, IsQuiet), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Log", "void set_overflowMode(LogOverflowMode)", asMETHOD(Log, SetOverflowMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Log", "LogOverflowMode get_overflowMode() const", asMETHOD(Log, GetOverflowMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Log", "uint get_numDroppedMessages() const", asMETHOD(Log, GetNumDroppedMessages), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Log", "uint get_numBlockedWrites() const", asMETHOD(Log, GetNumBlockedWrites), asCALL_THISCALL);
     engine->RegisterGlobalFunction("Log@+ get_log()", asFUNCTION(GetLog), asCALL_CDECL);
 
     // Register also Print() functions for convenience
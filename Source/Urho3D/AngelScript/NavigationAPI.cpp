@@ -114,12 +114,36 @@ static Vector3 CrowdManagerRandomPointInCircle(const Vector3& center, float radi
     return manager->GetRandomPointInCircle(center, radius, queryFilterType);
 }
 
+static NavigationPathRequest* NavigationMeshRequestPath(const Vector3& start, const Vector3& end, const Vector3& extents, NavigationMesh* ptr)
+{
+    // The navigation mesh keeps a reference until the request completes
+    return ptr->RequestPath(start, end, extents).Get();
+}
+
+static CScriptArray* NavigationPathRequestGetPath(NavigationPathRequest* ptr)
+{
+    const PODVector<NavigationPathPoint>& path = ptr->GetPath();
+    PODVector<Vector3> dest(path.Size());
+    for (unsigned i = 0; i < path.Size(); ++i)
+        dest[i] = path[i].position_;
+    return VectorToArray<Vector3>(dest, "Array<Vector3>");
+}
+
 template<class T> static void RegisterNavMeshBase(asIScriptEngine* engine, const char* name)
 {
     engine->RegisterObjectMethod(name, "bool Allocate(const BoundingBox&in, uint)", asMETHOD(T, Allocate), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "bool Build()", asMETHODPR(T, Build, (), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "bool Build(const BoundingBox&in)", asMETHODPR(T, Build, (const BoundingBox&), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "bool Build(const IntVector2&, const IntVector2&)", asMETHODPR(T, Build, (const IntVector2&, const IntVector2&), bool), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void MarkTileDirty(const IntVector2&in)", asMETHOD(T, MarkTileDirty), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void MarkTilesDirty(const BoundingBox&in)", asMETHOD(T, MarkTilesDirty), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool BuildDirtyTiles()", asMETHOD(T, BuildDirtyTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "NavigationPathRequest@+ RequestPath(const Vector3&in, const Vector3&in, const Vector3&in extents = Vector3(1.0, 1.0, 1.0))", asFUNCTION(NavigationMeshRequestPath), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod(name, "void CancelPathRequest(NavigationPathRequest@+)", asMETHOD(T, CancelPathRequest), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void UpdatePathRequests()", asMETHOD(T, UpdatePathRequests), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_pathTimeBudget(float)", asMETHOD(T, SetPathTimeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "float get_pathTimeBudget() const", asMETHOD(T, GetPathTimeBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numPathRequests() const", asMETHOD(T, GetNumPathRequests), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "VectorBuffer GetTileData(const IntVector2&) const", asFUNCTION(NavigationMeshGetTileData), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "bool AddTile(const VectorBuffer&in) const", asFUNCTION(NavigationMeshAddTile), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "void RemoveTile(const IntVector2&)", asMETHOD(T, RemoveTile), asCALL_THISCALL);
@@ -168,6 +192,7 @@ template<class T> static void RegisterNavMeshBase(asIScriptEngine* engine, const
     engine->RegisterObjectMethod(name, "const BoundingBox& get_boundingBox() const", asMETHOD(T, GetBoundingBox), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "BoundingBox get_worldBoundingBox() const", asMETHOD(T, GetWorldBoundingBox), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "IntVector2 get_numTiles() const", asMETHOD(T, GetNumTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numDirtyTiles() const", asMETHOD(T, GetNumDirtyTiles), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "void set_partitionType()", asMETHOD(T, SetPartitionType), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "NavmeshPartitionType get_partitionType()", asMETHOD(T, GetPartitionType), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "void set_drawOffMeshConnections(bool)", asMETHOD(T, SetDrawOffMeshConnections), asCALL_THISCALL);
@@ -182,6 +207,20 @@ void RegisterNavigationMesh(asIScriptEngine* engine)
     engine->RegisterEnumValue("NavmeshPartitionType", "NAVMESH_PARTITION_WATERSHED", NAVMESH_PARTITION_WATERSHED);
     engine->RegisterEnumValue("NavmeshPartitionType", "NAVMESH_PARTITION_MONOTONE", NAVMESH_PARTITION_MONOTONE);
 
+    engine->RegisterEnum("NavigationPathRequestState");
+    engine->RegisterEnumValue("NavigationPathRequestState", "PATHREQUEST_PENDING", PATHREQUEST_PENDING);
+    engine->RegisterEnumValue("NavigationPathRequestState", "PATHREQUEST_SUCCEEDED", PATHREQUEST_SUCCEEDED);
+    engine->RegisterEnumValue("NavigationPathRequestState", "PATHREQUEST_FAILED", PATHREQUEST_FAILED);
+    engine->RegisterEnumValue("NavigationPathRequestState", "PATHREQUEST_CANCELED", PATHREQUEST_CANCELED);
+
+    RegisterRefCounted<NavigationPathRequest>(engine, "NavigationPathRequest");
+    engine->RegisterObjectMethod("NavigationPathRequest", "const Vector3& get_start() const", asMETHOD(NavigationPathRequest, GetStart), asCALL_THISCALL);
+    engine->RegisterObjectMethod("NavigationPathRequest", "const Vector3& get_end() const", asMETHOD(NavigationPathRequest, GetEnd), asCALL_THISCALL);
+    engine->RegisterObjectMethod("NavigationPathRequest", "const Vector3& get_extents() const", asMETHOD(NavigationPathRequest, GetExtents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("NavigationPathRequest", "NavigationPathRequestState get_state() const", asMETHOD(NavigationPathRequest, GetState), asCALL_THISCALL);
+    engine->RegisterObjectMethod("NavigationPathRequest", "bool get_completed() const", asMETHOD(NavigationPathRequest, IsCompleted), asCALL_THISCALL);
+    engine->RegisterObjectMethod("NavigationPathRequest", "Array<Vector3>@ get_path() const", asFUNCTION(NavigationPathRequestGetPath), asCALL_CDECL_OBJLAST);
+
     RegisterComponent<NavigationMesh>(engine, "NavigationMesh");
     RegisterNavMeshBase<NavigationMesh>(engine, "NavigationMesh");
     engine->RegisterObjectMethod("NavigationMesh", "Array<Vector3>@ FindPath(const Vector3&in, const Vector3&in, const Vector3&in extents = Vector3(1.0, 1.0, 1.0))", asFUNCTION(NavigationMeshFindPath), asCALL_CDECL_OBJLAST);
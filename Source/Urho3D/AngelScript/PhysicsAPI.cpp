@@ -25,6 +25,7 @@
 #include "../Precompiled.h"
 
 #include "../AngelScript/APITemplates.h"
+#include "../Math/Ray.h"
 #include "../Physics/CollisionShape.h"
 #include "../Physics/Constraint.h"
 #include "../Physics/PhysicsWorld.h"
@@ -267,6 +268,20 @@ static PhysicsRaycastResult PhysicsWorldConvexCast(CollisionShape* shape, const
     return result;
 }
 
+static CScriptArray* PhysicsWorldRaycastSingleBatch(CScriptArray* rays, float maxDistance, unsigned collisionMask, PhysicsWorld* ptr)
+{
+    PODVector<PhysicsRaycastResult> result;
+    ptr->RaycastSingleBatch(result, ArrayToPODVector<Ray>(rays), maxDistance, collisionMask);
+    return VectorToArray<PhysicsRaycastResult>(result, "Array<PhysicsRaycastResult>");
+}
+
+static CScriptArray* PhysicsWorldSphereCastBatch(CScriptArray* rays, float radius, float maxDistance, unsigned collisionMask, PhysicsWorld* ptr)
+{
+    PODVector<PhysicsRaycastResult> result;
+    ptr->SphereCastBatch(result, ArrayToPODVector<Ray>(rays), radius, maxDistance, collisionMask);
+    return VectorToArray<PhysicsRaycastResult>(result, "Array<PhysicsRaycastResult>");
+}
+
 static CScriptArray* PhysicsWorldGetRigidBodiesSphere(const Sphere& sphere, unsigned collisionMask, PhysicsWorld* ptr)
 {
     PODVector<RigidBody*> result;
@@ -317,6 +332,8 @@ static void RegisterPhysicsWorld(asIScriptEngine* engine)
     // There seems to be a bug in AngelScript resulting in a crash if we use an auto handle with this function.
     // Work around by manually releasing the CollisionShape handle
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult ConvexCast(CollisionShape@, const Vector3&in, const Quaternion&in, const Vector3&in, const Quaternion&in, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldConvexCast), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsWorld", "Array<PhysicsRaycastResult>@ RaycastSingleBatch(Array<Ray>@+, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldRaycastSingleBatch), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsWorld", "Array<PhysicsRaycastResult>@ SphereCastBatch(Array<Ray>@+, float, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldSphereCastBatch), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "Array<RigidBody@>@ GetRigidBodies(const Sphere&in, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldGetRigidBodiesSphere), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "Array<RigidBody@>@ GetRigidBodies(const BoundingBox&in, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldGetRigidBodiesBox), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "Array<RigidBody@>@ GetRigidBodies(RigidBody@+)", asFUNCTION(PhysicsWorldGetRigidBodiesBody), asCALL_CDECL_OBJLAST);
@@ -339,6 +356,11 @@ static void RegisterPhysicsWorld(asIScriptEngine* engine)
     engine->RegisterObjectMethod("PhysicsWorld", "bool get_internalEdge() const", asMETHOD(PhysicsWorld, GetInternalEdge), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "void set_splitImpulse(bool)", asMETHOD(PhysicsWorld, SetSplitImpulse), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "bool get_splitImpulse() const", asMETHOD(PhysicsWorld, GetSplitImpulse), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_threaded() const", asMETHOD(PhysicsWorld, IsThreaded), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_collisionEvents(bool)", asMETHOD(PhysicsWorld, SetCollisionEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_collisionEvents() const", asMETHOD(PhysicsWorld, GetCollisionEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_contactStream(bool)", asMETHOD(PhysicsWorld, SetContactStream), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_contactStream() const", asMETHOD(PhysicsWorld, GetContactStream), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "PhysicsWorld@+ get_physicsWorld() const", asFUNCTION(SceneGetPhysicsWorld), asCALL_CDECL_OBJLAST);
     engine->RegisterGlobalFunction("PhysicsWorld@+ get_physicsWorld()", asFUNCTION(GetPhysicsWorld), asCALL_CDECL);
 }
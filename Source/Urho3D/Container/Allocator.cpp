@@ -22,16 +22,21 @@
 
 #include "../Precompiled.h"
 
+#include <atomic>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+static std::atomic<unsigned> numHeapAllocations{0};
+
 AllocatorBlock* AllocatorReserveBlock(AllocatorBlock* allocator, unsigned nodeSize, unsigned capacity)
 {
     if (!capacity)
         capacity = 1;
 
+    AllocatorCountHeapAllocation();
     auto* blockPtr = new unsigned char[sizeof(AllocatorBlock) + capacity * (sizeof(AllocatorNode) + nodeSize)];
     auto* newBlock = reinterpret_cast<AllocatorBlock*>(blockPtr);
     newBlock->nodeSize_ = nodeSize;
@@ -119,4 +124,14 @@ void AllocatorFree(AllocatorBlock* allocator, void* ptr)
     allocator->free_ = node;
 }
 
+void AllocatorCountHeapAllocation()
+{
+    numHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+unsigned AllocatorGetNumHeapAllocations()
+{
+    return numHeapAllocations.load(std::memory_order_relaxed);
+}
+
 }
@@ -66,6 +66,10 @@ URHO3D_API void AllocatorUninitialize(AllocatorBlock* allocator);
 URHO3D_API void* AllocatorReserve(AllocatorBlock* allocator);
 /// Free a node. Does not free any blocks.
 URHO3D_API void AllocatorFree(AllocatorBlock* allocator, void* ptr);
+/// Record a heap allocation made by a container.
+URHO3D_API void AllocatorCountHeapAllocation();
+/// Return number of heap allocations made by containers (vector buffers, hash buckets, allocator blocks, flat hash storage and frame arena chunks) since startup. Used to verify that steady-state frames do not allocate container storage. Does not count String buffers, objects allocated with new or any frees.
+URHO3D_API unsigned AllocatorGetNumHeapAllocations();
 
 /// %Allocator template class. Allocates objects of a specific class.
 template <class T> class Allocator
@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/Allocator.h"
+#include "../Container/FlatHashBase.h"
+
+#include <cassert>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+void FlatHashBase::InsertSlot(unsigned hash, unsigned index)
+{
+    unsigned mask = numSlots_ - 1;
+    unsigned pos = HomeSlot(hash);
+    Slot slot{hash, index};
+
+    for (unsigned dist = 0;; ++dist)
+    {
+        Slot& current = slots_[pos];
+        if (current.index_ == NO_INDEX)
+        {
+            current = slot;
+            return;
+        }
+
+        // Take the place of a slot that is closer to its home, then continue inserting the displaced slot
+        unsigned currentDist = (pos - HomeSlot(current.hash_)) & mask;
+        if (currentDist < dist)
+        {
+            Urho3D::Swap(current, slot);
+            dist = currentDist;
+        }
+        pos = (pos + 1) & mask;
+    }
+}
+
+void FlatHashBase::EraseSlot(unsigned hash, unsigned index)
+{
+    unsigned mask = numSlots_ - 1;
+    unsigned pos = FindSlot(hash, index);
+
+    // Shift the following slots back until one is empty or already at its home
+    for (;;)
+    {
+        unsigned next = (pos + 1) & mask;
+        const Slot& nextSlot = slots_[next];
+        if (nextSlot.index_ == NO_INDEX || HomeSlot(nextSlot.hash_) == next)
+            break;
+        slots_[pos] = nextSlot;
+        pos = next;
+    }
+
+    slots_[pos].index_ = NO_INDEX;
+}
+
+void FlatHashBase::MoveSlot(unsigned hash, unsigned oldIndex, unsigned newIndex)
+{
+    slots_[FindSlot(hash, oldIndex)].index_ = newIndex;
+}
+
+void FlatHashBase::ReserveSlots(unsigned numElements)
+{
+    // Keep the load factor at most 0.8
+    unsigned numSlots = numSlots_ ? numSlots_ : MIN_SLOTS;
+    while (numSlots * 4 < numElements * 5)
+        numSlots <<= 1;
+    if (numSlots == numSlots_)
+        return;
+
+    Slot* oldSlots = slots_;
+    unsigned oldNumSlots = numSlots_;
+
+    AllocatorCountHeapAllocation();
+    slots_ = new Slot[numSlots];
+    numSlots_ = numSlots;
+    shift_ = 32;
+    while (numSlots > 1)
+    {
+        numSlots >>= 1;
+        --shift_;
+    }
+    ClearSlots();
+
+    for (unsigned i = 0; i < oldNumSlots; ++i)
+    {
+        if (oldSlots[i].index_ != NO_INDEX)
+            InsertSlot(oldSlots[i].hash_, oldSlots[i].index_);
+    }
+
+    delete[] oldSlots;
+}
+
+void FlatHashBase::ClearSlots()
+{
+    for (unsigned i = 0; i < numSlots_; ++i)
+        slots_[i].index_ = NO_INDEX;
+}
+
+unsigned FlatHashBase::NextCapacity(unsigned minCapacity) const
+{
+    unsigned capacity = capacity_ ? capacity_ : MIN_SLOTS / 2;
+    while (capacity < minCapacity)
+        capacity += (capacity + 1) >> 1;
+    return capacity;
+}
+
+unsigned FlatHashBase::FindSlot(unsigned hash, unsigned index) const
+{
+    unsigned mask = numSlots_ - 1;
+    unsigned pos = HomeSlot(hash);
+    while (slots_[pos].index_ != index)
+    {
+        assert(slots_[pos].index_ != NO_INDEX);
+        pos = (pos + 1) & mask;
+    }
+    return pos;
+}
+
+}
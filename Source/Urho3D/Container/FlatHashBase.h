@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include "../Container/Swap.h"
+
+namespace Urho3D
+{
+
+/// Relocate a value into a default-constructed one by swapping, for types with a Swap() member such as strings, shared pointers and containers. Avoids deep-copying nested containers when flat hash storage is moved.
+template <class T> inline auto FlatHashRelocate(T& dest, T& src, int) -> decltype(dest.Swap(src), void())
+{
+    dest.Swap(src);
+}
+
+/// Relocate a value by copying, for types without a Swap() member.
+template <class T> inline void FlatHashRelocate(T& dest, T& src, long)
+{
+    dest = src;
+}
+
+/// Open-addressing hash index shared by the flat hash set and map. Elements are stored densely in insertion order, and the index maps hashes to element positions using Robin Hood linear probing, so that a lookup touches a few adjacent slots instead of chasing a chain of nodes.
+class URHO3D_API FlatHashBase
+{
+public:
+    /// Element index of an empty slot or a missing element.
+    static const unsigned NO_INDEX = 0xffffffff;
+    /// Minimum number of slots when allocated.
+    static const unsigned MIN_SLOTS = 8;
+
+    /// Construct.
+    FlatHashBase() noexcept = default;
+    /// Destruct.
+    ~FlatHashBase()
+    {
+        delete[] slots_;
+    }
+
+    /// Prevent copy construction.
+    FlatHashBase(const FlatHashBase& rhs) = delete;
+    /// Prevent assignment.
+    FlatHashBase& operator =(const FlatHashBase& rhs) = delete;
+
+    /// Return number of elements.
+    unsigned Size() const { return size_; }
+
+    /// Return element capacity.
+    unsigned Capacity() const { return capacity_; }
+
+    /// Return number of index slots.
+    unsigned NumSlots() const { return numSlots_; }
+
+    /// Return whether has no elements.
+    bool Empty() const { return size_ == 0; }
+
+protected:
+    /// Index slot.
+    struct Slot
+    {
+        /// Mixed hash of the element's key.
+        unsigned hash_;
+        /// Element index, or NO_INDEX if empty.
+        unsigned index_;
+    };
+
+    /// Mix a key hash so that the high bits, which select the home slot, depend on all of its bits.
+    static unsigned MixHash(unsigned hash) { return hash * 2654435769u; }
+
+    /// Return home slot of a mixed hash.
+    unsigned HomeSlot(unsigned hash) const { return hash >> shift_; }
+
+    /// Return index of the element matching a mixed hash and key comparison, or NO_INDEX if not found.
+    template <class Equal> unsigned FindIndex(unsigned hash, const Equal& equal) const
+    {
+        if (!size_)
+            return NO_INDEX;
+
+        unsigned mask = numSlots_ - 1;
+        unsigned pos = HomeSlot(hash);
+        for (unsigned dist = 0;; ++dist)
+        {
+            const Slot& slot = slots_[pos];
+            // An empty slot, or one closer to its home than the probe, ends the search
+            if (slot.index_ == NO_INDEX || ((pos - HomeSlot(slot.hash_)) & mask) < dist)
+                return NO_INDEX;
+            if (slot.hash_ == hash && equal(slot.index_))
+                return slot.index_;
+            pos = (pos + 1) & mask;
+        }
+    }
+
+    /// Add an element index to the slots. There must be room for it.
+    void InsertSlot(unsigned hash, unsigned index);
+    /// Remove an element index from the slots.
+    void EraseSlot(unsigned hash, unsigned index);
+    /// Change the element index stored in a slot after the element has moved.
+    void MoveSlot(unsigned hash, unsigned oldIndex, unsigned newIndex);
+    /// Make sure there are enough slots for the given number of elements, rebuilding the index if necessary.
+    void ReserveSlots(unsigned numElements);
+    /// Mark all slots empty.
+    void ClearSlots();
+    /// Return the next element capacity when growing.
+    unsigned NextCapacity(unsigned minCapacity) const;
+
+    /// Swap with another flat hash set or map.
+    void Swap(FlatHashBase& rhs)
+    {
+        Urho3D::Swap(slots_, rhs.slots_);
+        Urho3D::Swap(buffer_, rhs.buffer_);
+        Urho3D::Swap(numSlots_, rhs.numSlots_);
+        Urho3D::Swap(shift_, rhs.shift_);
+        Urho3D::Swap(size_, rhs.size_);
+        Urho3D::Swap(capacity_, rhs.capacity_);
+    }
+
+    /// Index slots.
+    Slot* slots_{};
+    /// Element buffer.
+    unsigned char* buffer_{};
+    /// Number of slots, zero or a power of two.
+    unsigned numSlots_{};
+    /// Shift to get the home slot from a mixed hash.
+    unsigned shift_{32};
+    /// Number of elements.
+    unsigned size_{};
+    /// Element capacity.
+    unsigned capacity_{};
+
+private:
+    /// Return slot position holding an element index.
+    unsigned FindSlot(unsigned hash, unsigned index) const;
+};
+
+}
@@ -0,0 +1,369 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Allocator.h"
+#include "../Container/FlatHashBase.h"
+#include "../Container/HashMap.h"
+
+namespace Urho3D
+{
+
+/// Hash map template class using open addressing. Key-value pairs are stored contiguously in insertion order until erased (erasing moves the last pair into the freed position), which makes lookups and iteration cache-friendly. Unlike HashMap, inserting may move the pairs, so pointers, references and iterators to them are invalidated by insertion and erasure.
+template <class T, class U> class FlatHashMap : public FlatHashBase
+{
+public:
+    using KeyType = T;
+    using ValueType = U;
+    using KeyValue = typename HashMap<T, U>::KeyValue;
+    using Iterator = RandomAccessIterator<KeyValue>;
+    using ConstIterator = RandomAccessConstIterator<KeyValue>;
+
+    /// Construct empty.
+    FlatHashMap() noexcept = default;
+
+    /// Construct from another hash map.
+    FlatHashMap(const FlatHashMap<T, U>& map)
+    {
+        Insert(map);
+    }
+
+    /// Aggregate initialization constructor.
+    FlatHashMap(const std::initializer_list<Pair<T, U>>& list)
+    {
+        Reserve((unsigned)list.size());
+        for (auto it = list.begin(); it != list.end(); it++)
+            Insert(*it);
+    }
+
+    /// Destruct.
+    ~FlatHashMap()
+    {
+        DestructElements();
+        delete[] buffer_;
+    }
+
+    /// Assign a hash map.
+    FlatHashMap& operator =(const FlatHashMap<T, U>& rhs)
+    {
+        // In case of self-assignment do nothing
+        if (&rhs != this)
+        {
+            Clear();
+            Insert(rhs);
+        }
+        return *this;
+    }
+
+    /// Add-assign a pair.
+    FlatHashMap& operator +=(const Pair<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash map.
+    FlatHashMap& operator +=(const FlatHashMap<T, U>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash map.
+    bool operator ==(const FlatHashMap<T, U>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            ConstIterator j = rhs.Find(i->first_);
+            if (j == rhs.End() || j->second_ != i->second_)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash map.
+    bool operator !=(const FlatHashMap<T, U>& rhs) const { return !(*this == rhs); }
+
+    /// Index the map. Create a new pair if key not found.
+    U& operator [](const T& key)
+    {
+        unsigned hash = MixHash(MakeHash(key));
+        unsigned index = FindIndex(hash, key);
+        if (index == NO_INDEX)
+            index = InsertElement(hash, key, U());
+        return Buffer()[index].second_;
+    }
+
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    U* operator [](const T& key) const
+    {
+        unsigned index = FindIndex(MixHash(MakeHash(key)), key);
+        return index != NO_INDEX ? &Buffer()[index].second_ : nullptr;
+    }
+
+    /// Populate the map using variadic template. This handles the base case.
+    FlatHashMap& Populate(const T& key, const U& value)
+    {
+        this->operator [](key) = value;
+        return *this;
+    }
+
+    /// Populate the map using variadic template.
+    template <typename... Args> FlatHashMap& Populate(const T& key, const U& value, Args... args)
+    {
+        this->operator [](key) = value;
+        return Populate(args...);
+    }
+
+    /// Insert a pair. Return an iterator to it.
+    Iterator Insert(const Pair<T, U>& pair)
+    {
+        bool exists;
+        return Insert(pair, exists);
+    }
+
+    /// Insert a pair. Return iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const Pair<T, U>& pair, bool& exists)
+    {
+        unsigned hash = MixHash(MakeHash(pair.first_));
+        unsigned index = FindIndex(hash, pair.first_);
+        exists = index != NO_INDEX;
+        if (exists)
+            Buffer()[index].second_ = pair.second_;
+        else
+            index = InsertElement(hash, pair.first_, pair.second_);
+        return Iterator(Buffer() + index);
+    }
+
+    /// Insert a map.
+    void Insert(const FlatHashMap<T, U>& map)
+    {
+        Reserve(size_ + map.size_);
+        for (ConstIterator it = map.Begin(); it != map.End(); ++it)
+            Insert(MakePair(it->first_, it->second_));
+    }
+
+    /// Insert a pair by iterator. Return iterator to the value.
+    Iterator Insert(const ConstIterator& it) { return Insert(MakePair(it->first_, it->second_)); }
+
+    /// Insert a range by iterators.
+    void Insert(const ConstIterator& start, const ConstIterator& end)
+    {
+        for (ConstIterator it = start; it != end; ++it)
+            Insert(it);
+    }
+
+    /// Erase a pair by key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned hash = MixHash(MakeHash(key));
+        unsigned index = FindIndex(hash, key);
+        if (index == NO_INDEX)
+            return false;
+
+        EraseElement(hash, index);
+        return true;
+    }
+
+    /// Erase a pair by iterator. Return iterator to the next pair, which is the former last pair moved into the erased position.
+    Iterator Erase(const Iterator& it)
+    {
+        auto index = (unsigned)(it.ptr_ - Buffer());
+        if (index >= size_)
+            return End();
+
+        EraseElement(MixHash(MakeHash(it->first_)), index);
+        return Iterator(Buffer() + index);
+    }
+
+    /// Clear the map. Keeps the allocated storage.
+    void Clear()
+    {
+        DestructElements();
+        size_ = 0;
+        ClearSlots();
+    }
+
+    /// Make sure there is room for at least the given number of pairs.
+    void Reserve(unsigned numElements)
+    {
+        if (numElements > capacity_)
+            Reallocate(numElements);
+    }
+
+    /// Swap with another hash map.
+    void Swap(FlatHashMap<T, U>& map) { FlatHashBase::Swap(map); }
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        unsigned index = FindIndex(MixHash(MakeHash(key)), key);
+        return Iterator(Buffer() + (index != NO_INDEX ? index : size_));
+    }
+
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned index = FindIndex(MixHash(MakeHash(key)), key);
+        return ConstIterator(Buffer() + (index != NO_INDEX ? index : size_));
+    }
+
+    /// Return whether contains a pair with key.
+    bool Contains(const T& key) const { return FindIndex(MixHash(MakeHash(key)), key) != NO_INDEX; }
+
+    /// Try to copy value to output. Return true if was found.
+    bool TryGetValue(const T& key, U& out) const
+    {
+        unsigned index = FindIndex(MixHash(MakeHash(key)), key);
+        if (index == NO_INDEX)
+            return false;
+
+        out = Buffer()[index].second_;
+        return true;
+    }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.Reserve(size_);
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->first_);
+        return result;
+    }
+
+    /// Return all the values.
+    Vector<U> Values() const
+    {
+        Vector<U> result;
+        result.Reserve(size_);
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->second_);
+        return result;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return Iterator(Buffer()); }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return ConstIterator(Buffer()); }
+
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(Buffer() + size_); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return ConstIterator(Buffer() + size_); }
+
+    /// Return first pair.
+    const KeyValue& Front() const { return *Begin(); }
+
+    /// Return last pair.
+    const KeyValue& Back() const { return *(--End()); }
+
+private:
+    /// Return the pair buffer with right type.
+    KeyValue* Buffer() const { return reinterpret_cast<KeyValue*>(buffer_); }
+
+    /// Return index of a pair by key and mixed hash.
+    unsigned FindIndex(unsigned hash, const T& key) const
+    {
+        KeyValue* buffer = Buffer();
+        return FlatHashBase::FindIndex(hash, [buffer, &key](unsigned index) { return buffer[index].first_ == key; });
+    }
+
+    /// Append a new pair and index it. Return its index.
+    unsigned InsertElement(unsigned hash, const T& key, const U& value)
+    {
+        // The key or value may refer to a pair in this map, so construct the new pair before the old buffer is released
+        if (size_ == capacity_)
+            Reallocate(NextCapacity(size_ + 1), &key, &value);
+        else
+            new(Buffer() + size_) KeyValue(key, value);
+
+        InsertSlot(hash, size_);
+        return size_++;
+    }
+
+    /// Remove a pair and move the last pair into its position. Values are swapped rather than copied where possible.
+    void EraseElement(unsigned hash, unsigned index)
+    {
+        EraseSlot(hash, index);
+
+        unsigned last = size_ - 1;
+        KeyValue* buffer = Buffer();
+        if (index != last)
+        {
+            MoveSlot(MixHash(MakeHash(buffer[last].first_)), last, index);
+            (buffer + index)->~KeyValue();
+            new(buffer + index) KeyValue(buffer[last].first_, U());
+            FlatHashRelocate(buffer[index].second_, buffer[last].second_, 0);
+        }
+        (buffer + last)->~KeyValue();
+        --size_;
+    }
+
+    /// Move the pairs to a new buffer, optionally constructing a new pair after them. Values are swapped rather than copied where possible.
+    void Reallocate(unsigned newCapacity, const T* newKey = nullptr, const U* newValue = nullptr)
+    {
+        AllocatorCountHeapAllocation();
+        auto* newBuffer = reinterpret_cast<KeyValue*>(new unsigned char[newCapacity * sizeof(KeyValue)]);
+        if (newKey)
+            new(newBuffer + size_) KeyValue(*newKey, *newValue);
+
+        KeyValue* buffer = Buffer();
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            new(newBuffer + i) KeyValue(buffer[i].first_, U());
+            FlatHashRelocate(newBuffer[i].second_, buffer[i].second_, 0);
+            (buffer + i)->~KeyValue();
+        }
+
+        delete[] buffer_;
+        buffer_ = reinterpret_cast<unsigned char*>(newBuffer);
+        capacity_ = newCapacity;
+        ReserveSlots(capacity_);
+    }
+
+    /// Call the destructors of all pairs.
+    void DestructElements()
+    {
+        KeyValue* buffer = Buffer();
+        for (unsigned i = 0; i < size_; ++i)
+            (buffer + i)->~KeyValue();
+    }
+};
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator begin(const Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator end(const Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator begin(Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator end(Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+}
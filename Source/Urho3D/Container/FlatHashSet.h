@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Allocator.h"
+#include "../Container/FlatHashBase.h"
+#include "../Container/Hash.h"
+#include "../Container/Vector.h"
+
+#include <initializer_list>
+
+namespace Urho3D
+{
+
+/// Hash set template class using open addressing. Keys are stored contiguously in insertion order until erased (erasing moves the last key into the freed position), which makes lookups and iteration cache-friendly. Unlike HashSet, inserting may move the keys, so pointers and iterators to them are invalidated by insertion and erasure.
+template <class T> class FlatHashSet : public FlatHashBase
+{
+public:
+    using KeyType = T;
+    using Iterator = RandomAccessConstIterator<T>;
+    using ConstIterator = RandomAccessConstIterator<T>;
+
+    /// Construct empty.
+    FlatHashSet() noexcept = default;
+
+    /// Construct from another hash set.
+    FlatHashSet(const FlatHashSet<T>& set)
+    {
+        Insert(set);
+    }
+
+    /// Aggregate initialization constructor.
+    FlatHashSet(const std::initializer_list<T>& list)
+    {
+        Reserve((unsigned)list.size());
+        for (auto it = list.begin(); it != list.end(); it++)
+            Insert(*it);
+    }
+
+    /// Destruct.
+    ~FlatHashSet()
+    {
+        DestructElements();
+        delete[] buffer_;
+    }
+
+    /// Assign a hash set.
+    FlatHashSet& operator =(const FlatHashSet<T>& rhs)
+    {
+        // In case of self-assignment do nothing
+        if (&rhs != this)
+        {
+            Clear();
+            Insert(rhs);
+        }
+        return *this;
+    }
+
+    /// Add-assign a value.
+    FlatHashSet& operator +=(const T& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Add-assign a hash set.
+    FlatHashSet& operator +=(const FlatHashSet<T>& rhs)
+    {
+        Insert(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash set.
+    bool operator ==(const FlatHashSet<T>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator it = Begin(); it != End(); ++it)
+        {
+            if (!rhs.Contains(*it))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash set.
+    bool operator !=(const FlatHashSet<T>& rhs) const { return !(*this == rhs); }
+
+    /// Insert a key. Return an iterator to it.
+    Iterator Insert(const T& key)
+    {
+        bool exists;
+        return Insert(key, exists);
+    }
+
+    /// Insert a key. Return an iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const T& key, bool& exists)
+    {
+        unsigned hash = MixHash(MakeHash(key));
+        unsigned index = FindIndex(hash, key);
+        exists = index != NO_INDEX;
+        if (!exists)
+        {
+            // The key may refer to an element of this set, so construct the new element before the old buffer is released
+            if (size_ == capacity_)
+                Reallocate(NextCapacity(size_ + 1), &key);
+            else
+                new(Buffer() + size_) T(key);
+
+            InsertSlot(hash, size_);
+            index = size_++;
+        }
+        return Iterator(Buffer() + index);
+    }
+
+    /// Insert a set.
+    void Insert(const FlatHashSet<T>& set)
+    {
+        Reserve(size_ + set.size_);
+        for (ConstIterator it = set.Begin(); it != set.End(); ++it)
+            Insert(*it);
+    }
+
+    /// Insert a key by iterator. Return iterator to the value.
+    Iterator Insert(const ConstIterator& it) { return Insert(*it); }
+
+    /// Erase a key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned hash = MixHash(MakeHash(key));
+        unsigned index = FindIndex(hash, key);
+        if (index == NO_INDEX)
+            return false;
+
+        EraseElement(hash, index);
+        return true;
+    }
+
+    /// Erase a key by iterator. Return iterator to the next key, which is the former last key moved into the erased position.
+    Iterator Erase(const Iterator& it)
+    {
+        auto index = (unsigned)(it.ptr_ - Buffer());
+        if (index >= size_)
+            return End();
+
+        EraseElement(MixHash(MakeHash(*it)), index);
+        return Iterator(Buffer() + index);
+    }
+
+    /// Clear the set. Keeps the allocated storage.
+    void Clear()
+    {
+        DestructElements();
+        size_ = 0;
+        ClearSlots();
+    }
+
+    /// Make sure there is room for at least the given number of keys.
+    void Reserve(unsigned numElements)
+    {
+        if (numElements > capacity_)
+            Reallocate(numElements);
+    }
+
+    /// Swap with another hash set.
+    void Swap(FlatHashSet<T>& set) { FlatHashBase::Swap(set); }
+
+    /// Return iterator to the key, or end iterator if not found.
+    Iterator Find(const T& key) const
+    {
+        unsigned index = FindIndex(MixHash(MakeHash(key)), key);
+        return Iterator(Buffer() + (index != NO_INDEX ? index : size_));
+    }
+
+    /// Return whether contains a key.
+    bool Contains(const T& key) const { return FindIndex(MixHash(MakeHash(key)), key) != NO_INDEX; }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() const { return Iterator(Buffer()); }
+
+    /// Return iterator to the end.
+    Iterator End() const { return Iterator(Buffer() + size_); }
+
+    /// Return first key.
+    const T& Front() const { return *Begin(); }
+
+    /// Return last key.
+    const T& Back() const { return *(--End()); }
+
+private:
+    /// Return the key buffer with right type.
+    T* Buffer() const { return reinterpret_cast<T*>(buffer_); }
+
+    /// Return index of a key by key and mixed hash.
+    unsigned FindIndex(unsigned hash, const T& key) const
+    {
+        T* buffer = Buffer();
+        return FlatHashBase::FindIndex(hash, [buffer, &key](unsigned index) { return buffer[index] == key; });
+    }
+
+    /// Remove a key and move the last key into its position. Keys are swapped rather than copied where possible.
+    void EraseElement(unsigned hash, unsigned index)
+    {
+        EraseSlot(hash, index);
+
+        unsigned last = size_ - 1;
+        T* buffer = Buffer();
+        if (index != last)
+        {
+            MoveSlot(MixHash(MakeHash(buffer[last])), last, index);
+            FlatHashRelocate(buffer[index], buffer[last], 0);
+        }
+        (buffer + last)->~T();
+        --size_;
+    }
+
+    /// Move the keys to a new buffer, optionally constructing a new key after them. Keys are swapped rather than copied where possible.
+    void Reallocate(unsigned newCapacity, const T* newKey = nullptr)
+    {
+        AllocatorCountHeapAllocation();
+        auto* newBuffer = reinterpret_cast<T*>(new unsigned char[newCapacity * sizeof(T)]);
+        if (newKey)
+            new(newBuffer + size_) T(*newKey);
+
+        T* buffer = Buffer();
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            new(newBuffer + i) T();
+            FlatHashRelocate(newBuffer[i], buffer[i], 0);
+            (buffer + i)->~T();
+        }
+
+        delete[] buffer_;
+        buffer_ = reinterpret_cast<unsigned char*>(newBuffer);
+        capacity_ = newCapacity;
+        ReserveSlots(capacity_);
+    }
+
+    /// Call the destructors of all keys.
+    void DestructElements()
+    {
+        T* buffer = Buffer();
+        for (unsigned i = 0; i < size_; ++i)
+            (buffer + i)->~T();
+    }
+};
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator begin(const Urho3D::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator end(const Urho3D::FlatHashSet<T>& v) { return v.End(); }
+
+}
@@ -0,0 +1,246 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/Allocator.h"
+#include "../Container/FrameAllocator.h"
+
+#include <atomic>
+#include <cassert>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Default size of an arena chunk.
+static const unsigned DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+/// Frame arena memory chunk.
+struct FrameArenaChunk
+{
+    /// Next chunk.
+    FrameArenaChunk* next_;
+    /// Usable size in bytes.
+    unsigned size_;
+    /// Data follows.
+};
+
+/// Frame arena of one thread.
+struct FrameArena
+{
+    /// Destruct. Free all chunks.
+    ~FrameArena()
+    {
+        FreeChunks();
+    }
+
+    /// Return data pointer of a chunk.
+    static unsigned char* ChunkData(FrameArenaChunk* chunk) { return reinterpret_cast<unsigned char*>(chunk) + sizeof(FrameArenaChunk); }
+
+    /// Allocate a new chunk and append it after the current one.
+    void AddChunk(unsigned size)
+    {
+        AllocatorCountHeapAllocation();
+        auto* chunk = reinterpret_cast<FrameArenaChunk*>(new unsigned char[sizeof(FrameArenaChunk) + size]);
+        chunk->size_ = size;
+        if (current_)
+        {
+            chunk->next_ = current_->next_;
+            current_->next_ = chunk;
+        }
+        else
+        {
+            chunk->next_ = nullptr;
+            first_ = chunk;
+        }
+        current_ = chunk;
+        offset_ = 0;
+        reserved_ += size;
+    }
+
+    /// Free all chunks.
+    void FreeChunks()
+    {
+        while (first_)
+        {
+            FrameArenaChunk* next = first_->next_;
+            delete[] reinterpret_cast<unsigned char*>(first_);
+            first_ = next;
+        }
+        current_ = nullptr;
+        offset_ = 0;
+        reserved_ = 0;
+    }
+
+    /// Rewind for a new frame. If last frame needed several chunks, replace them with one chunk large enough for all of it.
+    void Reset(unsigned frameNumber)
+    {
+        if (first_ && first_->next_)
+        {
+            unsigned size = reserved_;
+            FreeChunks();
+            AddChunk(size);
+        }
+        current_ = first_;
+        offset_ = 0;
+        used_ = 0;
+        lastAllocation_ = nullptr;
+        frameNumber_ = frameNumber;
+    }
+
+    /// First chunk.
+    FrameArenaChunk* first_{};
+    /// Chunk being allocated from.
+    FrameArenaChunk* current_{};
+    /// Allocation offset within the current chunk.
+    unsigned offset_{};
+    /// Frame number the arena was last rewound for.
+    unsigned frameNumber_{};
+    /// Bytes allocated this frame.
+    unsigned used_{};
+    /// Bytes reserved in all chunks.
+    unsigned reserved_{};
+    /// Most recent allocation, which can be extended in place.
+    unsigned char* lastAllocation_{};
+    /// Number of live holders of allocations, which prevent rewinding for a new frame.
+    unsigned numHolders_{};
+};
+
+static std::atomic<unsigned> frameNumber{0};
+static thread_local FrameArena frameArena;
+
+void* FrameAllocator::Allocate(unsigned size, unsigned alignment)
+{
+    FrameArena& arena = frameArena;
+    unsigned currentFrame = frameNumber.load(std::memory_order_relaxed);
+    if (arena.frameNumber_ != currentFrame && !arena.numHolders_)
+        arena.Reset(currentFrame);
+
+    for (;;)
+    {
+        if (arena.current_)
+        {
+            unsigned char* data = FrameArena::ChunkData(arena.current_);
+            auto address = reinterpret_cast<size_t>(data + arena.offset_);
+            unsigned padding = (unsigned)((alignment - (address & (alignment - 1))) & (alignment - 1));
+            if (arena.offset_ + padding + size <= arena.current_->size_)
+            {
+                unsigned char* ptr = data + arena.offset_ + padding;
+                arena.offset_ += padding + size;
+                arena.used_ += padding + size;
+                arena.lastAllocation_ = ptr;
+                return ptr;
+            }
+
+            // Move on to a chunk retained from earlier frames if there is one
+            if (arena.current_->next_)
+            {
+                arena.current_ = arena.current_->next_;
+                arena.offset_ = 0;
+                continue;
+            }
+        }
+
+        unsigned chunkSize = arena.current_ ? arena.current_->size_ * 2 : DEFAULT_CHUNK_SIZE;
+        while (chunkSize < size + alignment)
+            chunkSize *= 2;
+        arena.AddChunk(chunkSize);
+    }
+}
+
+void FrameAllocator::AddHolder()
+{
+    ++frameArena.numHolders_;
+}
+
+void FrameAllocator::RemoveHolder()
+{
+    FrameArena& arena = frameArena;
+    assert(arena.numHolders_);
+    --arena.numHolders_;
+}
+
+bool FrameAllocator::Extend(void* ptr, unsigned oldSize, unsigned newSize)
+{
+    FrameArena& arena = frameArena;
+    if (!ptr || ptr != arena.lastAllocation_ || arena.frameNumber_ != frameNumber.load(std::memory_order_relaxed))
+        return false;
+
+    unsigned char* data = FrameArena::ChunkData(arena.current_);
+    auto offset = (unsigned)(static_cast<unsigned char*>(ptr) - data);
+    if (offset + newSize > arena.current_->size_)
+        return false;
+
+    arena.offset_ = offset + newSize;
+    arena.used_ += newSize - oldSize;
+    return true;
+}
+
+void FrameAllocator::BeginFrame()
+{
+    frameNumber.fetch_add(1, std::memory_order_relaxed);
+}
+
+unsigned FrameAllocator::GetFrameNumber()
+{
+    return frameNumber.load(std::memory_order_relaxed);
+}
+
+unsigned FrameAllocator::GetUsedBytes()
+{
+    const FrameArena& arena = frameArena;
+    return arena.frameNumber_ == frameNumber.load(std::memory_order_relaxed) ? arena.used_ : 0;
+}
+
+unsigned FrameAllocator::GetReservedBytes()
+{
+    return frameArena.reserved_;
+}
+
+FrameAllocatorMark FrameAllocator::GetMark()
+{
+    FrameArena& arena = frameArena;
+    unsigned currentFrame = frameNumber.load(std::memory_order_relaxed);
+    if (arena.frameNumber_ != currentFrame && !arena.numHolders_)
+        arena.Reset(currentFrame);
+
+    return FrameAllocatorMark{arena.current_, arena.offset_, arena.used_, arena.frameNumber_, arena.lastAllocation_};
+}
+
+void FrameAllocator::Rewind(const FrameAllocatorMark& mark)
+{
+    FrameArena& arena = frameArena;
+    if (arena.frameNumber_ != mark.frameNumber_)
+        return;
+
+    // Chunks added after the mark stay linked after it and are reused by later allocations. If the arena had no chunks
+    // at the mark, restart from the first one
+    arena.current_ = mark.chunk_ ? static_cast<FrameArenaChunk*>(mark.chunk_) : arena.first_;
+    arena.offset_ = mark.offset_;
+    arena.used_ = mark.used_;
+    arena.lastAllocation_ = static_cast<unsigned char*>(mark.lastAllocation_);
+}
+
+}
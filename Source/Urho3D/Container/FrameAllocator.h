@@ -0,0 +1,298 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Vector.h"
+
+namespace Urho3D
+{
+
+/// Position in a thread's frame arena, used to rewind it.
+struct FrameAllocatorMark
+{
+    /// Chunk being allocated from.
+    void* chunk_;
+    /// Allocation offset within the chunk.
+    unsigned offset_;
+    /// Bytes allocated this frame.
+    unsigned used_;
+    /// Frame number.
+    unsigned frameNumber_;
+    /// Most recent allocation.
+    void* lastAllocation_;
+};
+
+/// Per-thread linear allocator for transient data that only needs to live until the end of the current frame. Allocations are never freed individually: each thread's arena is rewound on its first allocation after the engine has begun a new frame, so steady-state frames reuse the same memory without touching the heap. A thread that still holds frame vectors when a new frame begins, such as a work item or a background loader spanning the frame boundary, keeps allocating after them and is rewound only once it holds none.
+class URHO3D_API FrameAllocator
+{
+public:
+    /// Allocate memory from the calling thread's arena. Unless held with AddHolder(), it stays valid until the calling thread allocates again after the next BeginFrame().
+    static void* Allocate(unsigned size, unsigned alignment = 16);
+    /// Register a holder of live allocations on the calling thread. The arena is not rewound for a new frame while it has holders.
+    static void AddHolder();
+    /// Unregister a holder of live allocations on the calling thread.
+    static void RemoveHolder();
+    /// Try to grow the calling thread's most recent allocation in place. Return true on success.
+    static bool Extend(void* ptr, unsigned oldSize, unsigned newSize);
+    /// Begin a new frame, making all earlier allocations reusable. Called by the engine at the start of each frame.
+    static void BeginFrame();
+
+    /// Return current frame number.
+    static unsigned GetFrameNumber();
+    /// Return number of bytes the calling thread has allocated during the current frame.
+    static unsigned GetUsedBytes();
+    /// Return number of bytes reserved by the calling thread's arena.
+    static unsigned GetReservedBytes();
+
+    /// Return the calling thread's current allocation position.
+    static FrameAllocatorMark GetMark();
+    /// Make the calling thread's allocations after a mark reusable. Does nothing if a new frame has begun since the mark.
+    static void Rewind(const FrameAllocatorMark& mark);
+};
+
+/// Scope that rewinds the calling thread's frame arena when it ends, for code that may run many times per frame. Frame vectors created before the scope must not grow within it.
+class FrameAllocatorScope
+{
+public:
+    /// Construct and mark the current allocation position.
+    FrameAllocatorScope() :
+        mark_(FrameAllocator::GetMark())
+    {
+    }
+
+    /// Destruct and rewind to the marked position.
+    ~FrameAllocatorScope()
+    {
+        FrameAllocator::Rewind(mark_);
+    }
+
+    /// Prevent copy construction.
+    FrameAllocatorScope(const FrameAllocatorScope& rhs) = delete;
+    /// Prevent assignment.
+    FrameAllocatorScope& operator =(const FrameAllocatorScope& rhs) = delete;
+
+private:
+    /// Marked allocation position.
+    FrameAllocatorMark mark_;
+};
+
+/// %Vector of POD values whose storage comes from the frame allocator. Meant for function-local temporaries: the vector must be destroyed on the thread that created it, and its storage is only returned when that thread's arena is rewound.
+template <class T> class FramePODVector
+{
+public:
+    using ValueType = T;
+    using Iterator = RandomAccessIterator<T>;
+    using ConstIterator = RandomAccessConstIterator<T>;
+
+    /// Construct empty.
+    FramePODVector() noexcept = default;
+
+    /// Construct with initial capacity.
+    explicit FramePODVector(unsigned capacity)
+    {
+        Reserve(capacity);
+    }
+
+    /// Destruct. Allow the storage to be reused in a new frame.
+    ~FramePODVector()
+    {
+        if (buffer_)
+            FrameAllocator::RemoveHolder();
+    }
+
+    /// Prevent copy construction.
+    FramePODVector(const FramePODVector<T>& rhs) = delete;
+    /// Prevent assignment.
+    FramePODVector<T>& operator =(const FramePODVector<T>& rhs) = delete;
+
+    /// Return element at index.
+    T& operator [](unsigned index)
+    {
+        assert(index < size_);
+        return buffer_[index];
+    }
+
+    /// Return const element at index.
+    const T& operator [](unsigned index) const
+    {
+        assert(index < size_);
+        return buffer_[index];
+    }
+
+    /// Add an element at the end.
+    void Push(const T& value)
+    {
+        if (size_ == capacity_)
+            Grow(size_ + 1);
+        buffer_[size_++] = value;
+    }
+
+    /// Add elements from a buffer at the end.
+    void Push(const T* data, unsigned count)
+    {
+        if (size_ + count > capacity_)
+            Grow(size_ + count);
+        if (count)
+            memcpy(buffer_ + size_, data, count * sizeof(T));
+        size_ += count;
+    }
+
+    /// Add another vector at the end.
+    void Push(const PODVector<T>& vector) { Push(vector.Buffer(), vector.Size()); }
+
+    /// Remove the last element.
+    void Pop()
+    {
+        if (size_)
+            --size_;
+    }
+
+    /// Erase an element by swapping with the last element.
+    void EraseSwap(unsigned pos)
+    {
+        if (pos >= size_)
+            return;
+        buffer_[pos] = buffer_[--size_];
+    }
+
+    /// Resize the vector. New elements are left uninitialized.
+    void Resize(unsigned newSize)
+    {
+        if (newSize > capacity_)
+            Grow(newSize);
+        size_ = newSize;
+    }
+
+    /// Make sure there is room for at least the given number of elements.
+    void Reserve(unsigned newCapacity)
+    {
+        if (newCapacity > capacity_)
+            Reallocate(newCapacity);
+    }
+
+    /// Clear the vector. The storage is kept for reuse.
+    void Clear() { size_ = 0; }
+
+    /// Return iterator to value, or to the end if not found.
+    Iterator Find(const T& value)
+    {
+        Iterator it = Begin();
+        while (it != End() && *it != value)
+            ++it;
+        return it;
+    }
+
+    /// Return const iterator to value, or to the end if not found.
+    ConstIterator Find(const T& value) const
+    {
+        ConstIterator it = Begin();
+        while (it != End() && *it != value)
+            ++it;
+        return it;
+    }
+
+    /// Return whether contains a specific value.
+    bool Contains(const T& value) const { return Find(value) != End(); }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return Iterator(buffer_); }
+
+    /// Return const iterator to the beginning.
+    ConstIterator Begin() const { return ConstIterator(buffer_); }
+
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(buffer_ + size_); }
+
+    /// Return const iterator to the end.
+    ConstIterator End() const { return ConstIterator(buffer_ + size_); }
+
+    /// Return first element.
+    T& Front()
+    {
+        assert(size_);
+        return buffer_[0];
+    }
+
+    /// Return last element.
+    T& Back()
+    {
+        assert(size_);
+        return buffer_[size_ - 1];
+    }
+
+    /// Return number of elements.
+    unsigned Size() const { return size_; }
+
+    /// Return capacity of vector.
+    unsigned Capacity() const { return capacity_; }
+
+    /// Return whether vector is empty.
+    bool Empty() const { return size_ == 0; }
+
+    /// Return the buffer.
+    T* Buffer() const { return buffer_; }
+
+private:
+    /// Grow the capacity using the same policy as PODVector.
+    void Grow(unsigned minCapacity)
+    {
+        unsigned newCapacity = capacity_ ? capacity_ : minCapacity;
+        while (newCapacity < minCapacity)
+            newCapacity += (newCapacity + 1) >> 1;
+        Reallocate(newCapacity);
+    }
+
+    /// Move to a larger buffer, extending the current one in place when it is the arena's latest allocation.
+    void Reallocate(unsigned newCapacity)
+    {
+        if (!buffer_ || !FrameAllocator::Extend(buffer_, capacity_ * (unsigned)sizeof(T), newCapacity * (unsigned)sizeof(T)))
+        {
+            T* newBuffer = static_cast<T*>(FrameAllocator::Allocate(newCapacity * (unsigned)sizeof(T),
+                alignof(T) > 16 ? (unsigned)alignof(T) : 16));
+            if (size_)
+                memcpy(newBuffer, buffer_, size_ * sizeof(T));
+            if (!buffer_)
+                FrameAllocator::AddHolder();
+            buffer_ = newBuffer;
+        }
+        capacity_ = newCapacity;
+    }
+
+    /// Buffer.
+    T* buffer_{};
+    /// Number of elements.
+    unsigned size_{};
+    /// Capacity.
+    unsigned capacity_{};
+};
+
+template <class T> typename Urho3D::FramePODVector<T>::ConstIterator begin(const Urho3D::FramePODVector<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FramePODVector<T>::ConstIterator end(const Urho3D::FramePODVector<T>& v) { return v.End(); }
+
+template <class T> typename Urho3D::FramePODVector<T>::Iterator begin(Urho3D::FramePODVector<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FramePODVector<T>::Iterator end(Urho3D::FramePODVector<T>& v) { return v.End(); }
+
+}
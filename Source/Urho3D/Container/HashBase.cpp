@@ -31,6 +31,7 @@ void HashBase::AllocateBuckets(unsigned size, unsigned numBuckets)
 {
     delete[] ptrs_;
 
+    AllocatorCountHeapAllocation();
     auto ptrs = new HashNodeBase* [numBuckets + 2];
     auto* data = reinterpret_cast<unsigned*>(ptrs);
     data[0] = size;
@@ -141,4 +141,79 @@ template <class T, class U> void Sort(RandomAccessIterator<T> begin, RandomAcces
     InsertionSort(begin, end, compare);
 }
 
+/// Key and value pair for radix sorting.
+template <class T> struct RadixSortItem
+{
+    /// Sort key.
+    unsigned long long key_;
+    /// Sorted value.
+    T value_;
+};
+
+/// Number of key bits sorted per radix sort pass.
+static const unsigned RADIX_SORT_BITS = 8;
+/// Number of buckets per radix sort pass.
+static const unsigned RADIX_SORT_BUCKETS = 1u << RADIX_SORT_BITS;
+/// Number of radix sort passes for a 64-bit key.
+static const unsigned RADIX_SORT_PASSES = 64 / RADIX_SORT_BITS;
+
+/// Return a radix sort key for a float that orders the same as the float itself.
+inline unsigned RadixSortKey(float value)
+{
+    union
+    {
+        float f_;
+        unsigned u_;
+    } bits;
+    bits.f_ = value;
+    // Flip all bits of negative values and only the sign bit of positive values
+    return (bits.u_ & 0x80000000) ? ~bits.u_ : bits.u_ | 0x80000000;
+}
+
+/// Sort items by their keys in ascending order using a stable least significant digit radix sort. Passes in which all keys share the same digit are skipped. The scratch buffer must have room for count items. The sorted items are left in the items buffer.
+template <class T> void RadixSort(RadixSortItem<T>* items, RadixSortItem<T>* scratch, unsigned count)
+{
+    if (count < 2)
+        return;
+
+    // Gather the histograms of all passes at once
+    unsigned histograms[RADIX_SORT_PASSES][RADIX_SORT_BUCKETS] = {};
+    for (unsigned i = 0; i < count; ++i)
+    {
+        unsigned long long key = items[i].key_;
+        for (unsigned pass = 0; pass < RADIX_SORT_PASSES; ++pass)
+            ++histograms[pass][(key >> (pass * RADIX_SORT_BITS)) & (RADIX_SORT_BUCKETS - 1)];
+    }
+
+    RadixSortItem<T>* src = items;
+    RadixSortItem<T>* dest = scratch;
+
+    for (unsigned pass = 0; pass < RADIX_SORT_PASSES; ++pass)
+    {
+        unsigned shift = pass * RADIX_SORT_BITS;
+        unsigned* histogram = histograms[pass];
+        if (histogram[(src[0].key_ >> shift) & (RADIX_SORT_BUCKETS - 1)] == count)
+            continue;
+
+        unsigned offsets[RADIX_SORT_BUCKETS];
+        unsigned offset = 0;
+        for (unsigned i = 0; i < RADIX_SORT_BUCKETS; ++i)
+        {
+            offsets[i] = offset;
+            offset += histogram[i];
+        }
+
+        for (unsigned i = 0; i < count; ++i)
+            dest[offsets[(src[i].key_ >> shift) & (RADIX_SORT_BUCKETS - 1)]++] = src[i];
+
+        Swap(src, dest);
+    }
+
+    if (src != items)
+    {
+        for (unsigned i = 0; i < count; ++i)
+            items[i] = src[i];
+    }
+}
+
 }
@@ -78,6 +78,21 @@ struct AttributeInfo
     {
     }
 
+    /// Set network replication quantization of float, vector and quaternion attributes. Components are sent with the number of bits (1-24, or 0 to disable) within the range. Quaternions are sent as their three smallest components and do not use the range.
+    void SetQuantization(float minValue, float maxValue, unsigned bits)
+    {
+        quantizeMin_ = minValue;
+        quantizeMax_ = maxValue;
+        quantizeBits_ = bits < 24 ? bits : 24;
+    }
+
+    /// Return whether the attribute is quantized for network replication.
+    bool IsQuantized() const
+    {
+        return quantizeBits_ && (type_ == VAR_FLOAT || type_ == VAR_VECTOR2 || type_ == VAR_VECTOR3 || type_ == VAR_VECTOR4 ||
+            type_ == VAR_QUATERNION);
+    }
+
     /// Get attribute metadata.
     const Variant& GetMetadata(const StringHash& key) const
     {
@@ -107,6 +122,12 @@ struct AttributeInfo
     VariantMap metadata_;
     /// Attribute data pointer if elsewhere than in the Serializable.
     void* ptr_ = nullptr;
+    /// Network replication quantization range minimum per component.
+    float quantizeMin_ = 0.0f;
+    /// Network replication quantization range maximum per component.
+    float quantizeMax_ = 0.0f;
+    /// Network replication quantization bits per component. Zero (default) replicates the full value.
+    unsigned quantizeBits_ = 0;
 };
 
 /// Attribute handle returned by Context::RegisterAttribute and used to chain attribute setup calls.
@@ -132,6 +153,15 @@ public:
             networkAttributeInfo_->metadata_[key] = value;
         return *this;
     }
+    /// Set network replication quantization.
+    AttributeHandle& SetQuantization(float minValue, float maxValue, unsigned bits)
+    {
+        if (attributeInfo_)
+            attributeInfo_->SetQuantization(minValue, maxValue, bits);
+        if (networkAttributeInfo_)
+            networkAttributeInfo_->SetQuantization(minValue, maxValue, bits);
+        return *this;
+    }
 };
 
 }
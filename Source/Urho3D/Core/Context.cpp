@@ -121,6 +121,8 @@ void RemoveNamedAttribute(HashMap<StringHash, Vector<AttributeInfo> >& attribute
 }
 
 Context::Context() :
+    typedEvent_(nullptr),
+    eventReceiverGroupsVersion_(1),
     eventHandler_(nullptr)
 {
 #ifdef __ANDROID__
@@ -149,6 +151,12 @@ Context::~Context()
     for (PODVector<VariantMap*>::Iterator i = eventDataMaps_.Begin(); i != eventDataMaps_.End(); ++i)
         delete *i;
     eventDataMaps_.Clear();
+    for (PODVector<VariantMap*>::Iterator i = typedEventDataMaps_.Begin(); i != typedEventDataMaps_.End(); ++i)
+        delete *i;
+    typedEventDataMaps_.Clear();
+    for (PODVector<VariantMap*>::Iterator i = emptyEventDataMaps_.Begin(); i != emptyEventDataMaps_.End(); ++i)
+        delete *i;
+    emptyEventDataMaps_.Clear();
 }
 
 SharedPtr<Object> Context::CreateObject(StringHash objectType)
@@ -238,6 +246,26 @@ void Context::UpdateAttributeDefaultValue(StringHash objectType, const char* nam
         info->defaultValue_ = defaultValue;
 }
 
+void Context::SetAttributeQuantization(StringHash objectType, const char* name, float minValue, float maxValue, unsigned bits)
+{
+    AttributeInfo* info = GetAttribute(objectType, name);
+    if (info)
+        info->SetQuantization(minValue, maxValue, bits);
+
+    HashMap<StringHash, Vector<AttributeInfo> >::Iterator i = networkAttributes_.Find(objectType);
+    if (i == networkAttributes_.End())
+        return;
+
+    for (Vector<AttributeInfo>::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
+    {
+        if (!j->name_.Compare(name, true))
+        {
+            j->SetQuantization(minValue, maxValue, bits);
+            break;
+        }
+    }
+}
+
 VariantMap& Context::GetEventDataMap()
 {
     unsigned nestingLevel = eventSenders_.Size();
@@ -249,6 +277,29 @@ VariantMap& Context::GetEventDataMap()
     return ret;
 }
 
+VariantMap& Context::GetTypedEventDataMap()
+{
+    unsigned nestingLevel = eventSenders_.Size();
+    while (typedEventDataMaps_.Size() < nestingLevel + 1)
+        typedEventDataMaps_.Push(new VariantMap());
+
+    VariantMap& ret = *typedEventDataMaps_[nestingLevel];
+    ret.Clear();
+    return ret;
+}
+
+VariantMap& Context::GetEmptyEventDataMap()
+{
+    unsigned nestingLevel = eventSenders_.Size();
+    while (emptyEventDataMaps_.Size() < nestingLevel + 1)
+        emptyEventDataMaps_.Push(new VariantMap());
+
+    // Receivers may have written into the map during an earlier send
+    VariantMap& ret = *emptyEventDataMaps_[nestingLevel];
+    ret.Clear();
+    return ret;
+}
+
 #ifndef MINI_URHO
 bool Context::RequireSDL(unsigned int sdlFlags)
 {
@@ -407,7 +458,10 @@ void Context::AddEventReceiver(Object* receiver, StringHash eventType)
 {
     SharedPtr<EventReceiverGroup>& group = eventReceivers_[eventType];
     if (!group)
+    {
         group = new EventReceiverGroup();
+        ++eventReceiverGroupsVersion_;
+    }
     group->Add(receiver);
 }
 
@@ -415,16 +469,19 @@ void Context::AddEventReceiver(Object* receiver, Object* sender, StringHash even
 {
     SharedPtr<EventReceiverGroup>& group = specificEventReceivers_[sender][eventType];
     if (!group)
+    {
         group = new EventReceiverGroup();
+        ++eventReceiverGroupsVersion_;
+    }
     group->Add(receiver);
 }
 
 void Context::RemoveEventSender(Object* sender)
 {
-    HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
+    FlatHashMap<Object*, FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
     if (i != specificEventReceivers_.End())
     {
-        for (HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
+        for (FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
         {
             for (PODVector<Object*>::Iterator k = j->second_->receivers_.Begin(); k != j->second_->receivers_.End(); ++k)
             {
@@ -434,6 +491,7 @@ void Context::RemoveEventSender(Object* sender)
             }
         }
         specificEventReceivers_.Erase(i);
+        ++eventReceiverGroupsVersion_;
     }
 }
 
@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Object.h"
+
+namespace Urho3D
+{
+
+/// Name of an engine event. Linked into a list at static initialization without allocating or hashing.
+struct EngineEventName
+{
+    /// Construct and link to the list.
+    EngineEventName(StringHash eventID, const char* eventName) :
+        eventID_(eventID),
+        eventName_(eventName),
+        next_(first_)
+    {
+        first_ = this;
+    }
+
+    /// Event hash ID.
+    StringHash eventID_;
+    /// Event name.
+    const char* eventName_;
+    /// Next event name in the list.
+    const EngineEventName* next_;
+
+    /// First event name in the list.
+    static const EngineEventName* first_;
+};
+
+const EngineEventName* EngineEventName::first_ = nullptr;
+
+bool AddEngineEventNames(HashMap<StringHash, String>& eventNames)
+{
+    for (const EngineEventName* name = EngineEventName::first_; name; name = name->next_)
+    {
+        if (!eventNames.Contains(name->eventID_))
+            eventNames[name->eventID_] = name->eventName_;
+    }
+    return true;
+}
+
+}
+
+// Expand the engine's event definitions so that in this translation unit only they also link their names into the list
+#undef URHO3D_EVENT
+#define URHO3D_EVENT(eventID, eventName) static constexpr Urho3D::StringHash eventID(#eventName); \
+    static const Urho3D::EngineEventName eventName##Name_(eventID, #eventName); namespace eventName
+
+#include "../Audio/AudioEvents.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/WorkQueue.h"
+#ifdef URHO3D_DATABASE
+#include "../Database/DatabaseEvents.h"
+#endif
+#include "../Engine/EngineEvents.h"
+#include "../Graphics/DrawableEvents.h"
+#include "../Graphics/GraphicsEvents.h"
+#ifdef URHO3D_IK
+#include "../IK/IKEvents.h"
+#endif
+#include "../Input/InputEvents.h"
+#include "../IO/IOEvents.h"
+#ifdef URHO3D_NAVIGATION
+#include "../Navigation/NavigationEvents.h"
+#endif
+#ifdef URHO3D_NETWORK
+#include "../Network/NetworkEvents.h"
+#endif
+#ifdef URHO3D_PHYSICS
+#include "../Physics/PhysicsEvents.h"
+#endif
+#include "../Resource/ResourceEvents.h"
+#include "../Scene/SceneEvents.h"
+#include "../UI/UIEvents.h"
@@ -29,10 +29,54 @@
 
 #include "../DebugNew.h"
 
-
 namespace Urho3D
 {
 
+/// Add the names of the engine's own events to an event name map. Return true. Defined in EventNames.cpp.
+bool AddEngineEventNames(HashMap<StringHash, String>& eventNames);
+
+/// Number of event types for which an object caches the resolved receiver groups.
+static const unsigned NUM_EVENT_SEND_CACHE_ENTRIES = 8;
+
+/// Receiver groups resolved for an event type sent by an object.
+struct EventSendCacheEntry
+{
+    /// Event type.
+    StringHash eventType_;
+    /// Context receiver group version the entry was resolved at. Zero if unused.
+    unsigned version_;
+    /// Receivers subscribed to the event from this sender specifically.
+    EventReceiverGroup* specific_;
+    /// Receivers subscribed to the event from any sender.
+    EventReceiverGroup* nonSpecific_;
+};
+
+/// Return hash of an event receiver pointer for the processed receivers table.
+static inline unsigned HashReceiver(Object* receiver)
+{
+    auto hash = (unsigned)((size_t)receiver >> 4);
+    hash ^= hash >> 11;
+    hash *= 2654435761u;
+    return hash ^ (hash >> 15);
+}
+
+/// Per-sender cache of resolved receiver groups, to avoid hash map lookups on each send.
+struct EventSendCache
+{
+    /// Construct.
+    EventSendCache() :
+        next_(0)
+    {
+        for (unsigned i = 0; i < NUM_EVENT_SEND_CACHE_ENTRIES; ++i)
+            entries_[i].version_ = 0;
+    }
+
+    /// Cache entries.
+    EventSendCacheEntry entries_[NUM_EVENT_SEND_CACHE_ENTRIES];
+    /// Next entry to replace.
+    unsigned next_;
+};
+
 TypeInfo::TypeInfo(const char* typeName, const TypeInfo* baseTypeInfo) :
     type_(typeName),
     typeName_(typeName),
@@ -109,21 +153,35 @@ void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData
         handler = eventHandlers_.Next(handler);
     }
 
-    // Specific event handlers have priority, so if found, invoke first
-    if (specific)
-    {
-        context->SetEventHandler(specific);
-        specific->Invoke(eventData);
-        context->SetEventHandler(nullptr);
+    // Specific event handlers have priority, so if found, invoke it instead of the non-specific one
+    EventHandler* invoked = specific ? specific : nonSpecific;
+    if (!invoked)
         return;
-    }
 
-    if (nonSpecific)
+    context->SetEventHandler(invoked);
+
+    TypedEventPayload* typedEvent = context->typedEvent_;
+    if (typedEvent && typedEvent->eventType_ == eventType)
     {
-        context->SetEventHandler(nonSpecific);
-        nonSpecific->Invoke(eventData);
-        context->SetEventHandler(nullptr);
+        if (invoked->IsTyped())
+        {
+            invoked->InvokeTyped(typedEvent->event_);
+            typedEvent->converted_ = false;
+        }
+        else
+        {
+            // Convert the typed event only when a handler needs the VariantMap, and read back any changes it makes
+            if (!typedEvent->converted_)
+                typedEvent->toVariantMap_(typedEvent->event_, eventData);
+            invoked->Invoke(eventData);
+            typedEvent->fromVariantMap_(typedEvent->event_, eventData);
+            typedEvent->converted_ = true;
+        }
     }
+    else
+        invoked->Invoke(eventData);
+
+    context->SetEventHandler(nullptr);
 }
 
 bool Object::IsInstanceOf(StringHash type) const
@@ -289,9 +347,9 @@ void Object::UnsubscribeFromAllEventsExcept(const PODVector<StringHash>& excepti
 
 void Object::SendEvent(StringHash eventType)
 {
-    VariantMap noEventData;
-
-    SendEvent(eventType, noEventData);
+    // Use a pooled map instead of a local one, as constructing a map allocates its sentinel node. It is separate from
+    // GetEventDataMap(), which the caller may be filling for its own send
+    SendEvent(eventType, context_->GetEmptyEventDataMap());
 }
 
 void Object::SendEvent(StringHash eventType, VariantMap& eventData)
@@ -305,16 +363,64 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     if (blockEvents_)
         return;
 
+    // Hide an outer typed event from the handlers of this one
+    Context* context = context_;
+    TypedEventPayload* outerTypedEvent = context->typedEvent_;
+    context->typedEvent_ = nullptr;
+
+    DispatchEvent(eventType, eventData);
+
+    context->typedEvent_ = outerTypedEvent;
+}
+
+void Object::SendTypedEvent(StringHash eventType, void* event, void (*toVariantMap)(const void*, VariantMap&),
+    void (*fromVariantMap)(void*, const VariantMap&))
+{
+    if (!Thread::IsMainThread())
+    {
+        URHO3D_LOGERROR("Sending events is only supported from the main thread");
+        return;
+    }
+
+    if (blockEvents_)
+        return;
+
+    Context* context = context_;
+    TypedEventPayload typedEvent;
+    typedEvent.eventType_ = eventType;
+    typedEvent.event_ = event;
+    typedEvent.toVariantMap_ = toVariantMap;
+    typedEvent.fromVariantMap_ = fromVariantMap;
+    typedEvent.converted_ = false;
+
+    TypedEventPayload* outerTypedEvent = context->typedEvent_;
+    context->typedEvent_ = &typedEvent;
+
+    DispatchEvent(eventType, context->GetTypedEventDataMap());
+
+    context->typedEvent_ = outerTypedEvent;
+}
+
+void Object::DispatchEvent(StringHash eventType, VariantMap& eventData)
+{
     // Make a weak pointer to self to check for destruction during event handling
     WeakPtr<Object> self(this);
     Context* context = context_;
-    HashSet<Object*> processed;
+
+    EventReceiverGroup* specificGroup;
+    EventReceiverGroup* nonSpecificGroup;
+    GetEventReceiverGroups(eventType, specificGroup, nonSpecificGroup);
+    const unsigned version = context->eventReceiverGroupsVersion_;
+
+    // Receivers invoked through the specific group are stacked in the context above any outer sends' receivers
+    PODVector<Object*>& processed = context->processedEventReceivers_;
+    const unsigned processedBegin = processed.Size();
 
     context->BeginSendEvent(this, eventType);
 
     // Check first the specific event receivers
     // Note: group is held alive with a shared ptr, as it may get destroyed along with the sender
-    SharedPtr<EventReceiverGroup> group(context->GetEventReceivers(this, eventType));
+    SharedPtr<EventReceiverGroup> group(specificGroup);
     if (group)
     {
         group->BeginSendEvent();
@@ -334,27 +440,33 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
             {
                 group->EndSendEvent();
                 context->EndSendEvent();
+                processed.Resize(processedBegin);
                 return;
             }
 
-            processed.Insert(receiver);
+            processed.Push(receiver);
         }
 
         group->EndSendEvent();
+        group.Reset();
+
+        // The non-specific group may have been created by the handlers
+        if (context->eventReceiverGroupsVersion_ != version)
+            nonSpecificGroup = context->GetEventReceivers(eventType);
     }
 
     // Then the non-specific receivers
-    group = context->GetEventReceivers(eventType);
-    if (group)
+    if (nonSpecificGroup)
     {
-        group->BeginSendEvent();
+        nonSpecificGroup->BeginSendEvent();
 
-        if (processed.Empty())
+        const unsigned numProcessed = processed.Size() - processedBegin;
+        if (!numProcessed)
         {
-            const unsigned numReceivers = group->receivers_.Size();
+            const unsigned numReceivers = nonSpecificGroup->receivers_.Size();
             for (unsigned i = 0; i < numReceivers; ++i)
             {
-                Object* receiver = group->receivers_[i];
+                Object* receiver = nonSpecificGroup->receivers_[i];
                 if (!receiver)
                     continue;
 
@@ -362,7 +474,7 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
 
                 if (self.Expired())
                 {
-                    group->EndSendEvent();
+                    nonSpecificGroup->EndSendEvent();
                     context->EndSendEvent();
                     return;
                 }
@@ -370,29 +482,86 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
         }
         else
         {
-            // If there were specific receivers, check that the event is not sent doubly to them
-            const unsigned numReceivers = group->receivers_.Size();
+            // If there were specific receivers, check that the event is not sent doubly to them. Build a hash table of
+            // them on the stack after the receivers; it is not touched by nested sends, which only use the stack above it
+            const unsigned tableBegin = processed.Size();
+            const unsigned tableMask = NextPowerOfTwo(numProcessed * 2) - 1;
+            processed.Resize(tableBegin + tableMask + 1);
+            Object** table = processed.Buffer() + tableBegin;
+            for (unsigned i = 0; i <= tableMask; ++i)
+                table[i] = nullptr;
+            for (unsigned i = processedBegin; i < tableBegin; ++i)
+            {
+                Object* receiver = processed[i];
+                unsigned j = HashReceiver(receiver) & tableMask;
+                while (table[j] && table[j] != receiver)
+                    j = (j + 1) & tableMask;
+                table[j] = receiver;
+            }
+
+            const unsigned numReceivers = nonSpecificGroup->receivers_.Size();
             for (unsigned i = 0; i < numReceivers; ++i)
             {
-                Object* receiver = group->receivers_[i];
-                if (!receiver || processed.Contains(receiver))
+                Object* receiver = nonSpecificGroup->receivers_[i];
+                if (!receiver)
+                    continue;
+
+                // Note: the stack may be reallocated by nested sends, so take the buffer pointer each time
+                table = processed.Buffer() + tableBegin;
+                unsigned j = HashReceiver(receiver) & tableMask;
+                while (table[j] && table[j] != receiver)
+                    j = (j + 1) & tableMask;
+                if (table[j])
                     continue;
 
                 receiver->OnEvent(this, eventType, eventData);
 
                 if (self.Expired())
                 {
-                    group->EndSendEvent();
+                    nonSpecificGroup->EndSendEvent();
                     context->EndSendEvent();
+                    processed.Resize(processedBegin);
                     return;
                 }
             }
         }
 
-        group->EndSendEvent();
+        nonSpecificGroup->EndSendEvent();
     }
 
     context->EndSendEvent();
+    processed.Resize(processedBegin);
+}
+
+void Object::GetEventReceiverGroups(StringHash eventType, EventReceiverGroup*& specific, EventReceiverGroup*& nonSpecific)
+{
+    // Specific groups of self are destroyed only along with self, and non-specific groups never, so the cached pointers
+    // stay valid until a group is created, which bumps the context's version
+    const unsigned version = context_->eventReceiverGroupsVersion_;
+
+    if (!eventSendCache_)
+        eventSendCache_ = new EventSendCache();
+
+    for (unsigned i = 0; i < NUM_EVENT_SEND_CACHE_ENTRIES; ++i)
+    {
+        EventSendCacheEntry& entry = eventSendCache_->entries_[i];
+        if (entry.eventType_ == eventType && entry.version_ == version)
+        {
+            specific = entry.specific_;
+            nonSpecific = entry.nonSpecific_;
+            return;
+        }
+    }
+
+    specific = context_->GetEventReceivers(this, eventType);
+    nonSpecific = context_->GetEventReceivers(eventType);
+
+    EventSendCacheEntry& entry = eventSendCache_->entries_[eventSendCache_->next_];
+    eventSendCache_->next_ = (eventSendCache_->next_ + 1) % NUM_EVENT_SEND_CACHE_ENTRIES;
+    entry.eventType_ = eventType;
+    entry.version_ = version;
+    entry.specific_ = specific;
+    entry.nonSpecific_ = nonSpecific;
 }
 
 VariantMap& Object::GetEventDataMap() const
@@ -530,10 +699,17 @@ void Object::RemoveEventSender(Object* sender)
     }
 }
 
+/// Return the registered event names without adding the engine's event names.
+static HashMap<StringHash, String>& GetRegisteredEventNames()
+{
+    static HashMap<StringHash, String> eventNames_;
+    return eventNames_;
+}
+
 Urho3D::StringHash EventNameRegistrar::RegisterEventName(const char* eventName)
 {
     StringHash id(eventName);
-    GetEventNameMap()[id] = eventName;
+    GetRegisteredEventNames()[id] = eventName;
     return id;
 }
 
@@ -545,8 +721,11 @@ const String& EventNameRegistrar::GetEventName(StringHash eventID)
 
 HashMap<StringHash, String>& EventNameRegistrar::GetEventNameMap()
 {
-    static HashMap<StringHash, String> eventNames_;
-    return eventNames_;
+    // Add the engine's event names on first lookup, so that they cost nothing at static initialization
+    HashMap<StringHash, String>& eventNames = GetRegisteredEventNames();
+    static const bool engineEventNamesAdded = AddEngineEventNames(eventNames);
+    (void)engineEventNamesAdded;
+    return eventNames;
 }
 
 }
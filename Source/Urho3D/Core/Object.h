@@ -32,6 +32,23 @@ namespace Urho3D
 
 class Context;
 class EventHandler;
+class EventReceiverGroup;
+struct EventSendCache;
+
+/// Strongly typed event payload being sent. Converted to a VariantMap only when a non-typed handler needs one.
+struct TypedEventPayload
+{
+    /// Event type.
+    StringHash eventType_;
+    /// Event struct.
+    void* event_;
+    /// Event struct to VariantMap conversion function.
+    void (*toVariantMap_)(const void*, VariantMap&);
+    /// VariantMap to event struct conversion function.
+    void (*fromVariantMap_)(void*, const VariantMap&);
+    /// Whether the event data map is in sync with the event struct.
+    bool converted_;
+};
 
 /// Type info.
 class URHO3D_API TypeInfo
@@ -138,6 +155,13 @@ public:
     {
         SendEvent(eventType, GetEventDataMap().Populate(args...));
     }
+    /// Send a strongly typed event struct to all subscribers. The struct must define ToVariantMap() and FromVariantMap() functions, which are used only for handlers that take a VariantMap.
+    template <class T> void SendTypedEvent(StringHash eventType, T& event)
+    {
+        SendTypedEvent(eventType, &event,
+            [](const void* src, VariantMap& dest) { static_cast<const T*>(src)->ToVariantMap(dest); },
+            [](void* dest, const VariantMap& src) { static_cast<T*>(dest)->FromVariantMap(src); });
+    }
 
     /// Return execution context.
     Context* GetContext() const { return context_; }
@@ -184,9 +208,17 @@ private:
     EventHandler* FindSpecificEventHandler(Object* sender, StringHash eventType, EventHandler** previous = nullptr) const;
     /// Remove event handlers related to a specific sender.
     void RemoveEventSender(Object* sender);
+    /// Send a strongly typed event through type-erased conversion functions.
+    void SendTypedEvent(StringHash eventType, void* event, void (*toVariantMap)(const void*, VariantMap&), void (*fromVariantMap)(void*, const VariantMap&));
+    /// Dispatch event to the specific and non-specific receivers.
+    void DispatchEvent(StringHash eventType, VariantMap& eventData);
+    /// Return the specific and non-specific receiver groups for an event sent by self, using the per-sender cache.
+    void GetEventReceiverGroups(StringHash eventType, EventReceiverGroup*& specific, EventReceiverGroup*& nonSpecific);
 
     /// Event handlers. Sender is null for non-specific handlers.
     LinkedList<EventHandler> eventHandlers_;
+    /// Receiver groups resolved for recently sent events. Allocated on first send.
+    UniquePtr<EventSendCache> eventSendCache_;
 
     /// Block object from sending and receiving any events.
     bool blockEvents_;
@@ -266,8 +298,12 @@ public:
 
     /// Invoke event handler function.
     virtual void Invoke(VariantMap& eventData) = 0;
+    /// Invoke event handler function with a strongly typed event struct. Called only if IsTyped() returns true.
+    virtual void InvokeTyped(void* event) { }
     /// Return a unique copy of the event handler.
     virtual EventHandler* Clone() const = 0;
+    /// Return whether the handler function takes a strongly typed event struct.
+    virtual bool IsTyped() const { return false; }
 
     /// Return event receiver.
     Object* GetReceiver() const { return receiver_; }
@@ -354,6 +390,58 @@ private:
     std::function<void(StringHash, VariantMap&)> function_;
 };
 
+/// Template implementation of the event handler invoke helper for a strongly typed event struct.
+template <class T, class E> class TypedEventHandlerImpl : public EventHandler
+{
+public:
+    using HandlerFunctionPtr = void (T::*)(StringHash, E&);
+
+    /// Construct with receiver and function pointers and userdata.
+    TypedEventHandlerImpl(T* receiver, HandlerFunctionPtr function, void* userData = nullptr) :
+        EventHandler(receiver, userData),
+        function_(function)
+    {
+        assert(receiver_);
+        assert(function_);
+    }
+
+    /// Invoke event handler function. Converts from and back to the VariantMap, as the event was not sent as a typed struct.
+    void Invoke(VariantMap& eventData) override
+    {
+        auto* receiver = static_cast<T*>(receiver_);
+        E event;
+        event.FromVariantMap(eventData);
+        (receiver->*function_)(eventType_, event);
+        event.ToVariantMap(eventData);
+    }
+
+    /// Invoke event handler function with a strongly typed event struct.
+    void InvokeTyped(void* event) override
+    {
+        auto* receiver = static_cast<T*>(receiver_);
+        (receiver->*function_)(eventType_, *static_cast<E*>(event));
+    }
+
+    /// Return a unique copy of the event handler.
+    EventHandler* Clone() const override
+    {
+        return new TypedEventHandlerImpl(static_cast<T*>(receiver_), function_, userData_);
+    }
+
+    /// Return whether the handler function takes a strongly typed event struct.
+    bool IsTyped() const override { return true; }
+
+private:
+    /// Class-specific pointer to handler function.
+    HandlerFunctionPtr function_;
+};
+
+/// Construct a strongly typed event handler, deducing the event struct type from the handler function.
+template <class T, class E> EventHandler* MakeTypedEventHandler(T* receiver, void (T::*function)(StringHash, E&), void* userData = nullptr)
+{
+    return new TypedEventHandlerImpl<T, E>(receiver, function, userData);
+}
+
 /// Register event names.
 struct URHO3D_API EventNameRegistrar
 {
@@ -365,13 +453,18 @@ struct URHO3D_API EventNameRegistrar
     static HashMap<StringHash, String>& GetEventNameMap();
 };
 
-/// Describe an event's hash ID and begin a namespace in which to define its parameters.
-#define URHO3D_EVENT(eventID, eventName) static const Urho3D::StringHash eventID(Urho3D::EventNameRegistrar::RegisterEventName(#eventName)); namespace eventName
-/// Describe an event's parameter hash ID. Should be used inside an event namespace.
-#define URHO3D_PARAM(paramID, paramName) static const Urho3D::StringHash paramID(#paramName)
+/// Describe an event's hash ID and begin a namespace in which to define its parameters. The hash ID is a compile-time constant. The names of the engine's own events are registered on the first name lookup; other event names are not registered, unless described with URHO3D_EVENT_REGISTERED or registered with EventNameRegistrar::RegisterEventName().
+#define URHO3D_EVENT(eventID, eventName) static constexpr Urho3D::StringHash eventID(#eventName); namespace eventName
+/// Describe an event like URHO3D_EVENT, and also register its name for EventNameRegistrar::GetEventName() at static initialization in each translation unit that includes it.
+#define URHO3D_EVENT_REGISTERED(eventID, eventName) static constexpr Urho3D::StringHash eventID(#eventName); \
+    static const Urho3D::StringHash eventName##Registered_ = Urho3D::EventNameRegistrar::RegisterEventName(#eventName); namespace eventName
+/// Describe an event's parameter hash ID. Should be used inside an event namespace. The hash ID is a compile-time constant.
+#define URHO3D_PARAM(paramID, paramName) static constexpr Urho3D::StringHash paramID(#paramName)
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function.
 #define URHO3D_HANDLER(className, function) (new Urho3D::EventHandlerImpl<className>(this, &className::function))
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function, and also defines a userdata pointer.
 #define URHO3D_HANDLER_USERDATA(className, function, userData) (new Urho3D::EventHandlerImpl<className>(this, &className::function, userData))
+/// Convenience macro to construct an EventHandler that points to a receiver object and its member function taking a strongly typed event struct.
+#define URHO3D_TYPED_HANDLER(className, function) (Urho3D::MakeTypedEventHandler<className>(this, &className::function))
 
 }
@@ -1253,7 +1253,7 @@ bool HasEnvVar(const String &var)
 
 void SetEnvVar(const String &name, const String &val)
 {
-	SetEnvironmentVariable(name.CString(), val.CString());
+	setenv(name.CString(), val.CString(), 1);
 }
 
 }
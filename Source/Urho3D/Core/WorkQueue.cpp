@@ -31,6 +31,9 @@
 namespace Urho3D
 {
 
+/// Work queue thread index of the calling thread. Set by the worker threads, while the main thread is recognized by its thread ID.
+static thread_local unsigned currentThreadIndex = NON_WORKER_THREAD_INDEX;
+
 /// Worker thread managed by the work queue.
 class WorkerThread : public Thread, public RefCounted
 {
@@ -47,6 +50,7 @@ public:
     {
         // Init FPU state first
         InitFPU();
+        currentThreadIndex = index_;
         owner_->ProcessItems(index_);
     }
 
@@ -60,16 +64,62 @@ private:
     unsigned index_;
 };
 
+/// Prioritized work item deque owned by one thread. Other threads steal from it when their own deque runs empty.
+struct WorkQueueDeque
+{
+    /// Construct.
+    WorkQueueDeque() :
+        numItems_(0)
+    {
+    }
+
+    /// Work items in descending priority order. Items of equal priority are taken newest first.
+    List<WorkItem*> items_;
+    /// Number of items, readable without locking.
+    std::atomic<unsigned> numItems_;
+    /// Deque mutex.
+    Mutex mutex_;
+};
+
+/// Work item for a range split off by ParallelFor. Lives on the stack of the splitting thread until the split is waited for.
+struct RangeWorkItem : public WorkItem
+{
+    /// Construct.
+    RangeWorkItem(WorkQueue* queue, const ParallelForFunction& function, unsigned begin, unsigned end, unsigned grainSize) :
+        queue_(queue),
+        function_(function),
+        begin_(begin),
+        end_(end),
+        grainSize_(grainSize)
+    {
+    }
+
+    /// Work queue.
+    WorkQueue* queue_;
+    /// Range function.
+    const ParallelForFunction& function_;
+    /// Range start.
+    unsigned begin_;
+    /// Range end.
+    unsigned end_;
+    /// Size under which the range is not split further.
+    unsigned grainSize_;
+};
+
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
+    numQueued_(0),
+    nextDeque_(0),
     shutDown_(false),
-    pausing_(false),
     paused_(false),
     completing_(false),
     tolerance_(10),
     lastSize_(0),
     maxNonThreadedWorkMs_(5)
 {
+    // The main thread's deque
+    deques_.Push(new WorkQueueDeque());
+
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
 }
 
@@ -81,6 +131,9 @@ WorkQueue::~WorkQueue()
 
     for (unsigned i = 0; i < threads_.Size(); ++i)
         threads_[i]->Stop();
+
+    for (unsigned i = 0; i < deques_.Size(); ++i)
+        delete deques_[i];
 }
 
 void WorkQueue::CreateThreads(unsigned numThreads)
@@ -94,6 +147,10 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     // Start threads in paused mode
     Pause();
 
+    // Create all deques before any thread runs, as the threads scan the deque array without locking
+    for (unsigned i = 0; i < numThreads; ++i)
+        deques_.Push(new WorkQueueDeque());
+
     for (unsigned i = 0; i < numThreads; ++i)
     {
         SharedPtr<WorkerThread> thread(new WorkerThread(this, i + 1));
@@ -137,37 +194,14 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
     // Clear completed flag in case item is reused
     workItems_.Push(item);
     item->completed_ = false;
+    item->parent_ = nullptr;
 
-    // Make sure worker threads' list is safe to modify
-    if (threads_.Size() && !paused_)
-        queueMutex_.Acquire();
-
-    // Find position for new item
-    if (queue_.Empty())
-        queue_.Push(item);
-    else
-    {
-        bool inserted = false;
-
-        for (List<WorkItem*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
-        {
-            if ((*i)->priority_ <= item->priority_)
-            {
-                queue_.Insert(i, item);
-                inserted = true;
-                break;
-            }
-        }
-
-        if (!inserted)
-            queue_.Push(item);
-    }
+    // Spread the items over the deques so that the threads start out without stealing
+    PushItem(item, nextDeque_);
+    nextDeque_ = (nextDeque_ + 1) % deques_.Size();
 
     if (threads_.Size())
-    {
-        queueMutex_.Release();
-        paused_ = false;
-    }
+        Resume();
 }
 
 bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
@@ -175,18 +209,24 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
     if (!item)
         return false;
 
-    MutexLock lock(queueMutex_);
-
     // Can only remove successfully if the item was not yet taken by threads for execution
-    List<WorkItem*>::Iterator i = queue_.Find(item.Get());
-    if (i != queue_.End())
+    for (unsigned i = 0; i < deques_.Size(); ++i)
     {
-        List<SharedPtr<WorkItem> >::Iterator j = workItems_.Find(item);
-        if (j != workItems_.End())
+        WorkQueueDeque* deque = deques_[i];
+        MutexLock lock(deque->mutex_);
+
+        List<WorkItem*>::Iterator j = deque->items_.Find(item.Get());
+        if (j != deque->items_.End())
         {
-            queue_.Erase(i);
+            List<SharedPtr<WorkItem> >::Iterator k = workItems_.Find(item);
+            if (k == workItems_.End())
+                return false;
+
+            deque->items_.Erase(j);
+            --deque->numItems_;
+            --numQueued_;
             ReturnToPool(item);
-            workItems_.Erase(j);
+            workItems_.Erase(k);
             return true;
         }
     }
@@ -196,23 +236,12 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
 
 unsigned WorkQueue::RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items)
 {
-    MutexLock lock(queueMutex_);
     unsigned removed = 0;
 
     for (Vector<SharedPtr<WorkItem> >::ConstIterator i = items.Begin(); i != items.End(); ++i)
     {
-        List<WorkItem*>::Iterator j = queue_.Find(i->Get());
-        if (j != queue_.End())
-        {
-            List<SharedPtr<WorkItem> >::Iterator k = workItems_.Find(*i);
-            if (k != workItems_.End())
-            {
-                queue_.Erase(j);
-                ReturnToPool(*k);
-                workItems_.Erase(k);
-                ++removed;
-            }
-        }
+        if (RemoveWorkItem(*i))
+            ++removed;
     }
 
     return removed;
@@ -220,23 +249,20 @@ unsigned WorkQueue::RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items)
 
 void WorkQueue::Pause()
 {
-    if (!paused_)
+    // The pause mutex is owned by the main thread
+    if (!paused_ && Thread::IsMainThread())
     {
-        pausing_ = true;
-
         queueMutex_.Acquire();
         paused_ = true;
-
-        pausing_ = false;
     }
 }
 
 void WorkQueue::Resume()
 {
-    if (paused_)
+    if (paused_ && Thread::IsMainThread())
     {
-        queueMutex_.Release();
         paused_ = false;
+        queueMutex_.Release();
     }
 }
 
@@ -249,24 +275,9 @@ void WorkQueue::Complete(unsigned priority)
     {
         Resume();
 
-        // Take work items also in the main thread until queue empty or no high-priority items anymore
-        while (!queue_.Empty())
-        {
-            queueMutex_.Acquire();
-            if (!queue_.Empty() && queue_.Front()->priority_ >= priority)
-            {
-                WorkItem* item = queue_.Front();
-                queue_.PopFront();
-                queueMutex_.Release();
-                item->workFunction_(item, 0);
-                item->completed_ = true;
-            }
-            else
-            {
-                queueMutex_.Release();
-                break;
-            }
-        }
+        // Take work items also in the main thread until no high-priority items are queued anymore
+        while (WorkItem* item = PopItem(0, priority))
+            ExecuteItem(item, 0);
 
         // Wait for threaded work to complete
         while (!IsCompleted(priority))
@@ -274,25 +285,79 @@ void WorkQueue::Complete(unsigned priority)
         }
 
         // If no work at all remaining, pause worker threads by leaving the mutex locked
-        if (queue_.Empty())
+        if (!numQueued_)
             Pause();
     }
     else
     {
         // No worker threads: ensure all high-priority items are completed in the main thread
-        while (!queue_.Empty() && queue_.Front()->priority_ >= priority)
-        {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
-        }
+        while (WorkItem* item = PopItem(0, priority))
+            ExecuteItem(item, 0);
     }
 
     PurgeCompleted(priority);
     completing_ = false;
 }
 
+void WorkQueue::AddChildWorkItem(WorkItem* parent, WorkItem* child, unsigned threadIndex)
+{
+    assert(parent && child && threadIndex < deques_.Size());
+
+    child->parent_ = parent;
+    child->priority_ = parent->priority_;
+    child->completed_ = false;
+    ++parent->pendingChildren_;
+
+    PushItem(child, threadIndex);
+
+    // Only the main thread may release the pause mutex
+    if (threads_.Size() && Thread::IsMainThread())
+        Resume();
+}
+
+void WorkQueue::WaitForChildren(WorkItem* parent, unsigned threadIndex)
+{
+    // Help with work of the same or higher priority instead of blocking. This includes the children themselves
+    // unless another thread has stolen them
+    while (parent->pendingChildren_ > 0)
+    {
+        if (WorkItem* item = PopItem(threadIndex, parent->priority_))
+            ExecuteItem(item, threadIndex);
+        else
+            Time::Sleep(0);
+    }
+}
+
+void WorkQueue::ParallelFor(unsigned count, unsigned grainSize, const ParallelForFunction& function, unsigned threadIndex)
+{
+    grainSize = Max(grainSize, 1U);
+
+    if (!count)
+        return;
+
+    // Other threads have no deque to split the range into, and no slot in the per-thread state of the range function
+    if (threadIndex >= deques_.Size())
+    {
+        URHO3D_LOGERROR("ParallelFor can only be called from the main thread or a worker thread");
+        return;
+    }
+
+    if (threads_.Empty() || count <= grainSize)
+    {
+        function(0, count, threadIndex);
+        return;
+    }
+
+    // Someone is always blocked on the result, so the pieces are of the highest priority
+    WorkItem root;
+    root.priority_ = M_MAX_UNSIGNED;
+    ExecuteRange(&root, function, 0, count, grainSize, threadIndex);
+
+    // When called from the main thread outside Complete(), pause the worker threads again if nothing else is queued
+    if (!completing_ && !numQueued_ && Thread::IsMainThread())
+        Pause();
+}
+
 bool WorkQueue::IsCompleted(unsigned priority) const
 {
     for (List<SharedPtr<WorkItem> >::ConstIterator i = workItems_.Begin(); i != workItems_.End(); ++i)
@@ -304,39 +369,111 @@ bool WorkQueue::IsCompleted(unsigned priority) const
     return true;
 }
 
-void WorkQueue::ProcessItems(unsigned threadIndex)
+unsigned WorkQueue::GetCurrentThreadIndex()
 {
-    bool wasActive = false;
+    return Thread::IsMainThread() ? 0 : currentThreadIndex;
+}
 
+void WorkQueue::ProcessItems(unsigned threadIndex)
+{
     for (;;)
     {
         if (shutDown_)
             return;
 
-        if (pausing_ && !wasActive)
-            Time::Sleep(0);
+        if (WorkItem* item = PopItem(threadIndex, 0))
+            ExecuteItem(item, threadIndex);
         else
         {
-            queueMutex_.Acquire();
-            if (!queue_.Empty())
+            // Out of work. If paused, block on the mutex held by the main thread until resumed
+            if (paused_)
             {
-                wasActive = true;
-
-                WorkItem* item = queue_.Front();
-                queue_.PopFront();
+                queueMutex_.Acquire();
                 queueMutex_.Release();
-                item->workFunction_(item, threadIndex);
-                item->completed_ = true;
             }
-            else
-            {
-                wasActive = false;
+            Time::Sleep(0);
+        }
+    }
+}
 
-                queueMutex_.Release();
-                Time::Sleep(0);
-            }
+void WorkQueue::PushItem(WorkItem* item, unsigned dequeIndex)
+{
+    WorkQueueDeque* deque = deques_[dequeIndex];
+    MutexLock lock(deque->mutex_);
+
+    // Find position for new item
+    List<WorkItem*>& items = deque->items_;
+    List<WorkItem*>::Iterator i = items.Begin();
+    while (i != items.End() && (*i)->priority_ > item->priority_)
+        ++i;
+    items.Insert(i, item);
+
+    ++deque->numItems_;
+    ++numQueued_;
+}
+
+WorkItem* WorkQueue::PopItem(unsigned threadIndex, unsigned priority)
+{
+    if (!numQueued_)
+        return nullptr;
+
+    // Start from the thread's own deque, then steal from the following ones
+    unsigned numDeques = deques_.Size();
+    for (unsigned i = 0; i < numDeques; ++i)
+    {
+        WorkQueueDeque* deque = deques_[(threadIndex + i) % numDeques];
+        if (!deque->numItems_)
+            continue;
+
+        MutexLock lock(deque->mutex_);
+        if (!deque->items_.Empty() && deque->items_.Front()->priority_ >= priority)
+        {
+            WorkItem* item = deque->items_.Front();
+            deque->items_.PopFront();
+            --deque->numItems_;
+            --numQueued_;
+            return item;
         }
     }
+
+    return nullptr;
+}
+
+void WorkQueue::ExecuteItem(WorkItem* item, unsigned threadIndex)
+{
+    // Read the parent first, as a completed item may be recycled or go out of scope at any time
+    WorkItem* parent = item->parent_;
+
+    item->workFunction_(item, threadIndex);
+    item->completed_ = true;
+
+    if (parent)
+        --parent->pendingChildren_;
+}
+
+void WorkQueue::ExecuteRange(WorkItem* parent, const ParallelForFunction& function, unsigned begin, unsigned end,
+    unsigned grainSize, unsigned threadIndex)
+{
+    if (end - begin > grainSize)
+    {
+        // Offer the upper half for stealing and continue splitting the lower half. Ranges that are not stolen
+        // are taken back by this thread when waiting
+        unsigned middle = begin + (end - begin) / 2;
+        RangeWorkItem upper(this, function, middle, end, grainSize);
+        upper.workFunction_ = RangeWork;
+
+        AddChildWorkItem(parent, &upper, threadIndex);
+        ExecuteRange(parent, function, begin, middle, grainSize, threadIndex);
+        WaitForChildren(parent, threadIndex);
+    }
+    else
+        function(begin, end, threadIndex);
+}
+
+void WorkQueue::RangeWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* range = static_cast<RangeWorkItem*>(const_cast<WorkItem*>(item));
+    range->queue_->ExecuteRange(range, range->function_, range->begin_, range->end_, range->grainSize_, threadIndex);
 }
 
 void WorkQueue::PurgeCompleted(unsigned priority)
@@ -393,6 +530,7 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
         item->priority_ = M_MAX_UNSIGNED;
         item->sendEvent_ = false;
         item->completed_ = false;
+        item->parent_ = nullptr;
 
         poolItems_.Push(item);
     }
@@ -401,18 +539,18 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     // If no worker threads, complete low-priority work here
-    if (threads_.Empty() && !queue_.Empty())
+    if (threads_.Empty() && numQueued_)
     {
         URHO3D_PROFILE(CompleteWorkNonthreaded);
 
         HiresTimer timer;
 
-        while (!queue_.Empty() && timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL)
+        while (timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL)
         {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            WorkItem* item = PopItem(0, 0);
+            if (!item)
+                break;
+            ExecuteItem(item, 0);
         }
     }
 
@@ -26,6 +26,9 @@
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
+#include <atomic>
+#include <functional>
+
 namespace Urho3D
 {
 
@@ -36,6 +39,13 @@ URHO3D_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
 }
 
 class WorkerThread;
+struct WorkQueueDeque;
+
+/// Parallel range function. Called with the [begin, end) range to process and the executing thread index (0 = main thread.)
+using ParallelForFunction = std::function<void(unsigned, unsigned, unsigned)>;
+
+/// Thread index of threads that are neither the main thread nor work queue worker threads, such as the background loading threads. These must not call ParallelFor or index per-thread state by their thread index.
+static const unsigned NON_WORKER_THREAD_INDEX = M_MAX_UNSIGNED;
 
 /// Work queue item.
 struct WorkItem : public RefCounted
@@ -48,6 +58,8 @@ public:
         priority_(0),
         sendEvent_(false),
         completed_(false),
+        parent_(nullptr),
+        pendingChildren_(0),
         pooled_(false)
     {
     }
@@ -66,6 +78,10 @@ public:
     bool sendEvent_;
     /// Completed flag.
     volatile bool completed_;
+    /// Parent item to notify on completion. Null for top-level items.
+    WorkItem* parent_;
+    /// Number of child items not yet completed.
+    std::atomic<int> pendingChildren_;
 
 private:
     bool pooled_;
@@ -94,12 +110,18 @@ public:
     bool RemoveWorkItem(SharedPtr<WorkItem> item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
     unsigned RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items);
-    /// Pause worker threads.
+    /// Pause worker threads. Does nothing if not called from the main thread.
     void Pause();
-    /// Resume worker threads.
+    /// Resume worker threads. Does nothing if not called from the main thread.
     void Resume();
     /// Finish all queued work which has at least the specified priority. Main thread will also execute priority work. Pause worker threads if no more work remains.
     void Complete(unsigned priority);
+    /// Add a child of a currently executing work item to the executing thread's deque. The child inherits the parent's priority and must stay alive until the parent has waited for it.
+    void AddChildWorkItem(WorkItem* parent, WorkItem* child, unsigned threadIndex);
+    /// Execute queued work in the calling thread until all children of the parent item have completed.
+    void WaitForChildren(WorkItem* parent, unsigned threadIndex);
+    /// Process the range [0, count) in parallel, splitting it in halves that other threads can steal until the pieces are at most grainSize long. Return when the whole range has been processed. The thread index defaults to that of the calling thread, which must be the main thread or a worker thread.
+    void ParallelFor(unsigned count, unsigned grainSize, const ParallelForFunction& function, unsigned threadIndex = GetCurrentThreadIndex());
 
     /// Set the pool telerance before it starts deleting pool items.
     void SetTolerance(int tolerance) { tolerance_ = tolerance; }
@@ -109,6 +131,8 @@ public:
 
     /// Return number of worker threads.
     unsigned GetNumThreads() const { return threads_.Size(); }
+    /// Return the calling thread's index for ParallelFor: 0 for the main thread, from 1 for the worker threads and NON_WORKER_THREAD_INDEX for any other thread.
+    static unsigned GetCurrentThreadIndex();
 
     /// Return whether all work with at least the specified priority is finished.
     bool IsCompleted(unsigned priority) const;
@@ -124,6 +148,16 @@ public:
 private:
     /// Process work items until shut down. Called by the worker threads.
     void ProcessItems(unsigned threadIndex);
+    /// Insert an item into a deque in priority order.
+    void PushItem(WorkItem* item, unsigned dequeIndex);
+    /// Take the highest priority item from the thread's own deque, or steal from another deque. Return null if no item with at least the specified priority is queued.
+    WorkItem* PopItem(unsigned threadIndex, unsigned priority);
+    /// Execute an item and notify its parent.
+    void ExecuteItem(WorkItem* item, unsigned threadIndex);
+    /// Process a range split off by ParallelFor.
+    void ExecuteRange(WorkItem* parent, const ParallelForFunction& function, unsigned begin, unsigned end, unsigned grainSize, unsigned threadIndex);
+    /// Work function for ranges split off by ParallelFor.
+    static void RangeWork(const WorkItem* item, unsigned threadIndex);
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(unsigned priority);
     /// Purge the pool to reduce allocation where its unneeded.
@@ -139,16 +173,18 @@ private:
     List<SharedPtr<WorkItem> > poolItems_;
     /// Work item collection. Accessed only by the main thread.
     List<SharedPtr<WorkItem> > workItems_;
-    /// Work item prioritized queue for worker threads. Pointers are guaranteed to be valid (point to workItems.)
-    List<WorkItem*> queue_;
-    /// Worker queue mutex.
+    /// Prioritized work item deques, one per thread with the main thread at index 0. Threads take from their own deque first and steal from the others when it runs empty.
+    PODVector<WorkQueueDeque*> deques_;
+    /// Number of items queued across all deques.
+    std::atomic<unsigned> numQueued_;
+    /// Deque that receives the next item added from the main thread.
+    unsigned nextDeque_;
+    /// Pause mutex. Held by the main thread while paused so that idle worker threads block on it instead of using up CPU time.
     Mutex queueMutex_;
     /// Shutting down flag.
     volatile bool shutDown_;
-    /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
-    volatile bool pausing_;
-    /// Paused flag. Indicates the queue mutex being locked to prevent worker threads using up CPU time.
-    bool paused_;
+    /// Paused flag. Indicates the pause mutex being locked to prevent worker threads using up CPU time.
+    volatile bool paused_;
     /// Completing work in the main thread flag.
     bool completing_;
     /// Tolerance for the shared pool before it begins to deallocate.
@@ -143,13 +143,16 @@ void DebugHud::Update()
         }
 
         String stats;
-        stats.AppendWithFormat("Triangles %u\nBatches %u\nViews %u\nLights %u\nShadowmaps %u\nOccluders %u",
+        stats.AppendWithFormat("Triangles %u\nBatches %u\nViews %u\nLights %u\nShadowmaps %u\nOccluders %u\nUI rebuilds %u\n"
+            "Container buffer allocs %u",
             primitives,
             batches,
             renderer->GetNumViews(),
             renderer->GetNumLights(true),
             renderer->GetNumShadowMaps(true),
-            renderer->GetNumOccluders(true));
+            renderer->GetNumOccluders(true),
+            GetSubsystem<UI>()->GetNumRebuiltElements(),
+            GetSubsystem<Engine>()->GetNumFrameHeapAllocations());
 
         if (!appStats_.Empty())
         {
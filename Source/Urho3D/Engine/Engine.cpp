@@ -23,6 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../Audio/Audio.h"
+#include "../Container/Allocator.h"
+#include "../Container/FrameAllocator.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/EventProfiler.h"
@@ -101,10 +103,14 @@ Engine::Engine(Context* context) :
 #if defined(IOS) || defined(__ANDROID__) || defined(__arm__) || defined(__aarch64__)
     maxFps_(60),
     maxInactiveFps_(10),
+    frameStartHeapAllocations_(0),
+    numFrameHeapAllocations_(0),
     pauseMinimized_(true),
 #else
     maxFps_(200),
     maxInactiveFps_(60),
+    frameStartHeapAllocations_(0),
+    numFrameHeapAllocations_(0),
     pauseMinimized_(false),
 #endif
 #ifdef URHO3D_TESTING
@@ -221,6 +227,8 @@ bool Engine::Initialize(const VariantMap& parameters)
     auto* cache = GetSubsystem<ResourceCache>();
     auto* fileSystem = GetSubsystem<FileSystem>();
 
+    cache->SetNumBackgroundLoadThreads((unsigned)GetParameter(parameters, EP_BACKGROUND_LOAD_THREADS, 1).GetInt());
+
     // Initialize graphics & audio output
     if (!headless_)
     {
@@ -257,6 +265,7 @@ bool Engine::Initialize(const VariantMap& parameters)
             return false;
 
         graphics->SetShaderCacheDir(GetParameter(parameters, EP_SHADER_CACHE_DIR, fileSystem->GetAppPreferencesDir("urho3d", "shadercache")).GetString());
+        graphics->SetShaderProgramCache(GetParameter(parameters, EP_SHADER_PROGRAM_CACHE, true).GetBool());
 
         if (HasParameter(parameters, EP_DUMP_SHADERS))
             graphics->BeginDumpShaders(GetParameter(parameters, EP_DUMP_SHADERS, String::EMPTY).GetString());
@@ -481,6 +490,14 @@ void Engine::RunFrame()
     auto* input = GetSubsystem<Input>();
     auto* audio = GetSubsystem<Audio>();
 
+    // Previous frame's transient allocations are no longer in use
+    FrameAllocator::BeginFrame();
+
+    // Steady-state frames should not allocate container storage. Count the previous frame's allocations for the debug HUD
+    unsigned heapAllocations = AllocatorGetNumHeapAllocations();
+    numFrameHeapAllocations_ = heapAllocations - frameStartHeapAllocations_;
+    frameStartHeapAllocations_ = heapAllocations;
+
 #ifdef URHO3D_PROFILING
     if (EventProfiler::IsActive())
     {
@@ -618,16 +635,16 @@ void Engine::DumpResources(bool dumpFileName)
         return;
 
     auto* cache = GetSubsystem<ResourceCache>();
-    const HashMap<StringHash, ResourceGroup>& resourceGroups = cache->GetAllResources();
+    const FlatHashMap<StringHash, ResourceGroup>& resourceGroups = cache->GetAllResources();
     if (dumpFileName)
     {
         URHO3D_LOGRAW("Used resources:\n");
-        for (HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups.Begin(); i != resourceGroups.End(); ++i)
+        for (FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups.Begin(); i != resourceGroups.End(); ++i)
         {
-            const HashMap<StringHash, SharedPtr<Resource> >& resources = i->second_.resources_;
+            const FlatHashMap<StringHash, SharedPtr<Resource> >& resources = i->second_.resources_;
             if (dumpFileName)
             {
-                for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = resources.Begin(); j != resources.End(); ++j)
+                for (FlatHashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = resources.Begin(); j != resources.End(); ++j)
                     URHO3D_LOGRAW(j->second_->GetName() + "\n");
             }
         }
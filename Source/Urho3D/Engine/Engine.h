@@ -90,6 +90,9 @@ public:
     /// Return how many frames to average for timestep smoothing.
     int GetTimeStepSmoothing() const { return timeStepSmoothing_; }
 
+    /// Return number of container heap allocations made during the previous frame.
+    unsigned GetNumFrameHeapAllocations() const { return numFrameHeapAllocations_; }
+
     /// Return whether to pause update events and audio when minimized.
     bool GetPauseMinimized() const { return pauseMinimized_; }
 
@@ -140,6 +143,10 @@ private:
     unsigned maxFps_;
     /// Maximum frames per second when the application does not have input focus.
     unsigned maxInactiveFps_;
+    /// Container heap allocation count at the start of the frame.
+    unsigned frameStartHeapAllocations_;
+    /// Container heap allocations made during the previous frame.
+    unsigned numFrameHeapAllocations_;
     /// Pause when minimized flag.
     bool pauseMinimized_;
 #ifdef URHO3D_TESTING
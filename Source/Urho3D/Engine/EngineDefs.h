@@ -27,6 +27,7 @@ namespace Urho3D
 
 // Engine parameters
 static const String EP_AUTOLOAD_PATHS = "AutoloadPaths";
+static const String EP_BACKGROUND_LOAD_THREADS = "BackgroundLoadThreads";
 static const String EP_BORDERLESS = "Borderless";
 static const String EP_DUMP_SHADERS = "DumpShaders";
 static const String EP_EVENT_PROFILER = "EventProfiler";
@@ -52,6 +53,7 @@ static const String EP_RESOURCE_PACKAGES = "ResourcePackages";
 static const String EP_RESOURCE_PATHS = "ResourcePaths";
 static const String EP_RESOURCE_PREFIX_PATHS = "ResourcePrefixPaths";
 static const String EP_SHADER_CACHE_DIR = "ShaderCacheDir";
+static const String EP_SHADER_PROGRAM_CACHE = "ShaderProgramCache";
 static const String EP_SHADOWS = "Shadows";
 static const String EP_SOUND = "Sound";
 static const String EP_SOUND_BUFFER = "SoundBuffer";
@@ -254,6 +254,12 @@ void AnimatedModel::Update(const FrameInfo& frame)
         UpdateAnimation(frame);
     else if (boneBoundingBoxDirty_)
         UpdateBoneBoundingBox();
+
+    // If the model was in view last frame it is likely to be rendered again, so compute the skin matrices already
+    // in this threaded pass instead of in the per-view geometry update. Bones moved later in the frame, for example by
+    // IK, mark skinning dirty again and it is redone on demand
+    if (skinningDirty_ && frame.camera_ && abs((int)frame.frameNumber_ - (int)viewFrameNumber_) <= 1)
+        UpdateSkinning();
 }
 
 void AnimatedModel::UpdateBatches(const FrameInfo& frame)
@@ -34,11 +34,17 @@
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+static const float ROTATION_QUANTIZE_SCALE = 32767.0f;
+
 inline bool CompareTriggers(AnimationTriggerPoint& lhs, AnimationTriggerPoint& rhs)
 {
     return lhs.time_ < rhs.time_;
@@ -49,8 +55,71 @@ inline bool CompareKeyFrames(AnimationKeyFrame& lhs, AnimationKeyFrame& rhs)
     return lhs.time_ < rhs.time_;
 }
 
+static QuantizedQuaternion QuantizeRotation(const Quaternion& rotation)
+{
+    Quaternion normalized = rotation.Normalized();
+    QuantizedQuaternion ret;
+    ret.w_ = (short)RoundToInt(Clamp(normalized.w_, -1.0f, 1.0f) * ROTATION_QUANTIZE_SCALE);
+    ret.x_ = (short)RoundToInt(Clamp(normalized.x_, -1.0f, 1.0f) * ROTATION_QUANTIZE_SCALE);
+    ret.y_ = (short)RoundToInt(Clamp(normalized.y_, -1.0f, 1.0f) * ROTATION_QUANTIZE_SCALE);
+    ret.z_ = (short)RoundToInt(Clamp(normalized.z_, -1.0f, 1.0f) * ROTATION_QUANTIZE_SCALE);
+    return ret;
+}
+
+static inline Quaternion DequantizeRotation(const QuantizedQuaternion& rotation)
+{
+#ifdef URHO3D_SSE
+    // Sign-extend the four components to 32 bits and convert
+    __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&rotation));
+    __m128 components = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16));
+    return Quaternion(_mm_mul_ps(components, _mm_set1_ps(1.0f / ROTATION_QUANTIZE_SCALE))).Normalized();
+#else
+    return Quaternion(rotation.w_ / ROTATION_QUANTIZE_SCALE, rotation.x_ / ROTATION_QUANTIZE_SCALE,
+        rotation.y_ / ROTATION_QUANTIZE_SCALE, rotation.z_ / ROTATION_QUANTIZE_SCALE).Normalized();
+#endif
+}
+
+/// Find the last keyframe at or before time, or the first keyframe if time is before it. Checks the previous index and the next ones first, as playback usually advances by at most one keyframe.
+template <class T> static void FindKeyFrameIndex(float time, unsigned numKeyFrames, unsigned& index, T getTime)
+{
+    if (time < 0.0f)
+        time = 0.0f;
+
+    if (index >= numKeyFrames)
+        index = numKeyFrames - 1;
+
+    if (time >= getTime(index))
+    {
+        if (index + 1 >= numKeyFrames || time < getTime(index + 1))
+            return;
+        if (index + 2 >= numKeyFrames || time < getTime(index + 2))
+        {
+            ++index;
+            return;
+        }
+    }
+    else if (!index)
+        return;
+
+    // Binary search for the first keyframe after time
+    unsigned first = 0;
+    unsigned last = numKeyFrames;
+    while (first < last)
+    {
+        unsigned middle = (first + last) / 2;
+        if (time < getTime(middle))
+            last = middle;
+        else
+            first = middle + 1;
+    }
+
+    index = first ? first - 1 : 0;
+}
+
 void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
+    Decompress();
+
     if (index < keyFrames_.Size())
     {
         keyFrames_[index] = keyFrame;
@@ -62,6 +131,8 @@ void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFra
 
 void AnimationTrack::AddKeyFrame(const AnimationKeyFrame& keyFrame)
 {
+    Decompress();
+
     bool needSort = keyFrames_.Size() ? keyFrames_.Back().time_ > keyFrame.time_ : false;
     keyFrames_.Push(keyFrame);
     if (needSort)
@@ -70,40 +141,262 @@ void AnimationTrack::AddKeyFrame(const AnimationKeyFrame& keyFrame)
 
 void AnimationTrack::InsertKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
+    Decompress();
+
     keyFrames_.Insert(index, keyFrame);
     Urho3D::Sort(keyFrames_.Begin(), keyFrames_.End(), CompareKeyFrames);
 }
 
 void AnimationTrack::RemoveKeyFrame(unsigned index)
 {
+    Decompress();
+
     keyFrames_.Erase(index);
 }
 
 void AnimationTrack::RemoveAllKeyFrames()
 {
     keyFrames_.Clear();
+    keyTimes_.Clear();
+    positionKeys_.Clear();
+    rotationKeys_.Clear();
+    scaleKeys_.Clear();
+    constantMask_ = 0;
+}
+
+void AnimationTrack::Compress()
+{
+    if (keyFrames_.Empty())
+        return;
+
+    unsigned numKeyFrames = keyFrames_.Size();
+    const AnimationKeyFrame& firstKeyFrame = keyFrames_[0];
+    constantMask_ = 0;
+
+    keyTimes_.Resize(numKeyFrames);
+    for (unsigned i = 0; i < numKeyFrames; ++i)
+        keyTimes_[i] = keyFrames_[i].time_;
+
+    positionKeys_.Clear();
+    if (channelMask_ & CHANNEL_POSITION)
+    {
+        constantMask_ |= CHANNEL_POSITION;
+        for (unsigned i = 1; i < numKeyFrames; ++i)
+        {
+            if (!keyFrames_[i].position_.Equals(firstKeyFrame.position_))
+            {
+                constantMask_ &= ~CHANNEL_POSITION;
+                break;
+            }
+        }
+
+        unsigned numKeys = (constantMask_ & CHANNEL_POSITION) ? 1 : numKeyFrames;
+        positionKeys_.Resize(numKeys);
+        for (unsigned i = 0; i < numKeys; ++i)
+            positionKeys_[i] = keyFrames_[i].position_;
+    }
+
+    rotationKeys_.Clear();
+    if (channelMask_ & CHANNEL_ROTATION)
+    {
+        rotationKeys_.Resize(numKeyFrames);
+        constantMask_ |= CHANNEL_ROTATION;
+        for (unsigned i = 0; i < numKeyFrames; ++i)
+        {
+            rotationKeys_[i] = QuantizeRotation(keyFrames_[i].rotation_);
+            if (memcmp(&rotationKeys_[i], &rotationKeys_[0], sizeof(QuantizedQuaternion)) != 0)
+                constantMask_ &= ~CHANNEL_ROTATION;
+        }
+
+        if (constantMask_ & CHANNEL_ROTATION)
+            rotationKeys_.Resize(1);
+    }
+
+    scaleKeys_.Clear();
+    if (channelMask_ & CHANNEL_SCALE)
+    {
+        constantMask_ |= CHANNEL_SCALE;
+        for (unsigned i = 1; i < numKeyFrames; ++i)
+        {
+            if (!keyFrames_[i].scale_.Equals(firstKeyFrame.scale_))
+            {
+                constantMask_ &= ~CHANNEL_SCALE;
+                break;
+            }
+        }
+
+        unsigned numKeys = (constantMask_ & CHANNEL_SCALE) ? 1 : numKeyFrames;
+        scaleKeys_.Resize(numKeys);
+        for (unsigned i = 0; i < numKeys; ++i)
+            scaleKeys_[i] = keyFrames_[i].scale_;
+    }
+
+    positionKeys_.Compact();
+    rotationKeys_.Compact();
+    scaleKeys_.Compact();
+    keyFrames_.Clear();
+    keyFrames_.Compact();
+}
+
+void AnimationTrack::Decompress()
+{
+    if (!IsCompressed())
+        return;
+
+    keyFrames_.Resize(keyTimes_.Size());
+    for (unsigned i = 0; i < keyFrames_.Size(); ++i)
+        DecodeKeyFrame(i, keyFrames_[i]);
+
+    keyTimes_.Clear();
+    keyTimes_.Compact();
+    positionKeys_.Clear();
+    positionKeys_.Compact();
+    rotationKeys_.Clear();
+    rotationKeys_.Compact();
+    scaleKeys_.Clear();
+    scaleKeys_.Compact();
+    constantMask_ = 0;
 }
 
-AnimationKeyFrame* AnimationTrack::GetKeyFrame(unsigned index)
+AnimationKeyFrame AnimationTrack::GetKeyFrame(unsigned index) const
 {
-    return index < keyFrames_.Size() ? &keyFrames_[index] : nullptr;
+    AnimationKeyFrame keyFrame;
+    DecodeKeyFrame(index, keyFrame);
+    return keyFrame;
+}
+
+bool AnimationTrack::DecodeKeyFrame(unsigned index, AnimationKeyFrame& dest) const
+{
+    if (!IsCompressed())
+    {
+        if (index >= keyFrames_.Size())
+            return false;
+        dest = keyFrames_[index];
+        return true;
+    }
+
+    if (index >= keyTimes_.Size())
+        return false;
+
+    dest = AnimationKeyFrame();
+    dest.time_ = keyTimes_[index];
+    if (channelMask_ & CHANNEL_POSITION)
+        dest.position_ = positionKeys_[(constantMask_ & CHANNEL_POSITION) ? 0 : index];
+    if (channelMask_ & CHANNEL_ROTATION)
+        dest.rotation_ = DequantizeRotation(rotationKeys_[(constantMask_ & CHANNEL_ROTATION) ? 0 : index]);
+    if (channelMask_ & CHANNEL_SCALE)
+        dest.scale_ = scaleKeys_[(constantMask_ & CHANNEL_SCALE) ? 0 : index];
+    return true;
 }
 
 void AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
 {
-    if (time < 0.0f)
-        time = 0.0f;
+    if (IsCompressed())
+    {
+        const float* keyTimes = &keyTimes_[0];
+        FindKeyFrameIndex(time, keyTimes_.Size(), index, [keyTimes](unsigned i) { return keyTimes[i]; });
+    }
+    else if (!keyFrames_.Empty())
+    {
+        const AnimationKeyFrame* keyFrames = &keyFrames_[0];
+        FindKeyFrameIndex(time, keyFrames_.Size(), index, [keyFrames](unsigned i) { return keyFrames[i].time_; });
+    }
+}
+
+void AnimationTrack::Sample(float time, float length, bool looped, unsigned& index, Vector3& position, Quaternion& rotation,
+    Vector3& scale) const
+{
+    unsigned numKeyFrames = GetNumKeyFrames();
+    if (!numKeyFrames)
+        return;
 
-    if (index >= keyFrames_.Size())
-        index = keyFrames_.Size() - 1;
+    GetKeyFrameIndex(time, index);
 
-    // Check for being too far ahead
-    while (index && time < keyFrames_[index].time_)
-        --index;
+    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
+    unsigned nextIndex = index + 1;
+    bool interpolate = true;
+    if (nextIndex >= numKeyFrames)
+    {
+        if (!looped)
+        {
+            nextIndex = index;
+            interpolate = false;
+        }
+        else
+            nextIndex = 0;
+    }
+
+    float t = 0.0f;
+    if (interpolate)
+    {
+        float keyTime = GetKeyFrameTime(index);
+        float timeInterval = GetKeyFrameTime(nextIndex) - keyTime;
+        if (timeInterval < 0.0f)
+            timeInterval += length;
+        t = timeInterval > 0.0f ? (time - keyTime) / timeInterval : 1.0f;
+    }
+
+    if (!IsCompressed())
+    {
+        const AnimationKeyFrame& keyFrame = keyFrames_[index];
+        const AnimationKeyFrame& nextKeyFrame = keyFrames_[nextIndex];
 
-    // Check for being too far behind
-    while (index < keyFrames_.Size() - 1 && time >= keyFrames_[index + 1].time_)
-        ++index;
+        if (interpolate)
+        {
+            if (channelMask_ & CHANNEL_POSITION)
+                position = keyFrame.position_.Lerp(nextKeyFrame.position_, t);
+            if (channelMask_ & CHANNEL_ROTATION)
+                rotation = keyFrame.rotation_.Slerp(nextKeyFrame.rotation_, t);
+            if (channelMask_ & CHANNEL_SCALE)
+                scale = keyFrame.scale_.Lerp(nextKeyFrame.scale_, t);
+        }
+        else
+        {
+            if (channelMask_ & CHANNEL_POSITION)
+                position = keyFrame.position_;
+            if (channelMask_ & CHANNEL_ROTATION)
+                rotation = keyFrame.rotation_;
+            if (channelMask_ & CHANNEL_SCALE)
+                scale = keyFrame.scale_;
+        }
+        return;
+    }
+
+    // Each channel reads only its own key array. Constant channels have a single key and need no interpolation
+    unsigned char varying = channelMask_ & ~constantMask_;
+
+    if (channelMask_ & CHANNEL_POSITION)
+    {
+        if (varying & CHANNEL_POSITION)
+            position = interpolate ? positionKeys_[index].Lerp(positionKeys_[nextIndex], t) : positionKeys_[index];
+        else
+            position = positionKeys_[0];
+    }
+    if (channelMask_ & CHANNEL_ROTATION)
+    {
+        if (varying & CHANNEL_ROTATION)
+        {
+            rotation = DequantizeRotation(rotationKeys_[index]);
+            if (interpolate)
+                rotation = rotation.Slerp(DequantizeRotation(rotationKeys_[nextIndex]), t);
+        }
+        else
+            rotation = DequantizeRotation(rotationKeys_[0]);
+    }
+    if (channelMask_ & CHANNEL_SCALE)
+    {
+        if (varying & CHANNEL_SCALE)
+            scale = interpolate ? scaleKeys_[index].Lerp(scaleKeys_[nextIndex], t) : scaleKeys_[index];
+        else
+            scale = scaleKeys_[0];
+    }
+}
+
+unsigned AnimationTrack::GetMemoryUse() const
+{
+    return sizeof(AnimationTrack) + keyFrames_.Size() * sizeof(AnimationKeyFrame) + keyTimes_.Size() * sizeof(float) +
+        positionKeys_.Size() * sizeof(Vector3) + rotationKeys_.Size() * sizeof(QuantizedQuaternion) +
+        scaleKeys_.Size() * sizeof(Vector3);
 }
 
 Animation::Animation(Context* context) :
@@ -124,7 +417,8 @@ bool Animation::BeginLoad(Deserializer& source)
     unsigned memoryUse = sizeof(Animation);
 
     // Check ID
-    if (source.ReadFileID() != "UANI")
+    String fileID = source.ReadFileID();
+    if (fileID != "UANI" && fileID != "UANC")
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid animation file");
         return false;
@@ -136,30 +430,35 @@ bool Animation::BeginLoad(Deserializer& source)
     length_ = source.ReadFloat();
     tracks_.Clear();
 
-    unsigned tracks = source.ReadUInt();
-    memoryUse += tracks * sizeof(AnimationTrack);
-
     // Read tracks
-    for (unsigned i = 0; i < tracks; ++i)
+    if (fileID == "UANC")
+        memoryUse += ReadCompressedTracks(source);
+    else
     {
-        AnimationTrack* newTrack = CreateTrack(source.ReadString());
-        newTrack->channelMask_ = source.ReadUByte();
+        unsigned tracks = source.ReadUInt();
+        memoryUse += tracks * sizeof(AnimationTrack);
 
-        unsigned keyFrames = source.ReadUInt();
-        newTrack->keyFrames_.Resize(keyFrames);
-        memoryUse += keyFrames * sizeof(AnimationKeyFrame);
-
-        // Read keyframes of the track
-        for (unsigned j = 0; j < keyFrames; ++j)
+        for (unsigned i = 0; i < tracks; ++i)
         {
-            AnimationKeyFrame& newKeyFrame = newTrack->keyFrames_[j];
-            newKeyFrame.time_ = source.ReadFloat();
-            if (newTrack->channelMask_ & CHANNEL_POSITION)
-                newKeyFrame.position_ = source.ReadVector3();
-            if (newTrack->channelMask_ & CHANNEL_ROTATION)
-                newKeyFrame.rotation_ = source.ReadQuaternion();
-            if (newTrack->channelMask_ & CHANNEL_SCALE)
-                newKeyFrame.scale_ = source.ReadVector3();
+            AnimationTrack* newTrack = CreateTrack(source.ReadString());
+            newTrack->channelMask_ = source.ReadUByte();
+
+            unsigned keyFrames = source.ReadUInt();
+            newTrack->keyFrames_.Resize(keyFrames);
+            memoryUse += keyFrames * sizeof(AnimationKeyFrame);
+
+            // Read keyframes of the track
+            for (unsigned j = 0; j < keyFrames; ++j)
+            {
+                AnimationKeyFrame& newKeyFrame = newTrack->keyFrames_[j];
+                newKeyFrame.time_ = source.ReadFloat();
+                if (newTrack->channelMask_ & CHANNEL_POSITION)
+                    newKeyFrame.position_ = source.ReadVector3();
+                if (newTrack->channelMask_ & CHANNEL_ROTATION)
+                    newKeyFrame.rotation_ = source.ReadQuaternion();
+                if (newTrack->channelMask_ & CHANNEL_SCALE)
+                    newKeyFrame.scale_ = source.ReadVector3();
+            }
         }
     }
 
@@ -223,31 +522,38 @@ bool Animation::BeginLoad(Deserializer& source)
 
 bool Animation::Save(Serializer& dest) const
 {
-    // Write ID, name and length
-    dest.WriteFileID("UANI");
+    // Write ID, name and length. Compressed animations are written in the compressed format
+    bool compressed = IsCompressed();
+    dest.WriteFileID(compressed ? "UANC" : "UANI");
     dest.WriteString(animationName_);
     dest.WriteFloat(length_);
 
     // Write tracks
-    dest.WriteUInt(tracks_.Size());
-    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    if (compressed)
+        WriteCompressedTracks(dest);
+    else
     {
-        const AnimationTrack& track = i->second_;
-        dest.WriteString(track.name_);
-        dest.WriteUByte(track.channelMask_);
-        dest.WriteUInt(track.keyFrames_.Size());
-
-        // Write keyframes of the track
-        for (unsigned j = 0; j < track.keyFrames_.Size(); ++j)
+        dest.WriteUInt(tracks_.Size());
+        for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
         {
-            const AnimationKeyFrame& keyFrame = track.keyFrames_[j];
-            dest.WriteFloat(keyFrame.time_);
-            if (track.channelMask_ & CHANNEL_POSITION)
-                dest.WriteVector3(keyFrame.position_);
-            if (track.channelMask_ & CHANNEL_ROTATION)
-                dest.WriteQuaternion(keyFrame.rotation_);
-            if (track.channelMask_ & CHANNEL_SCALE)
-                dest.WriteVector3(keyFrame.scale_);
+            const AnimationTrack& track = i->second_;
+            dest.WriteString(track.name_);
+            dest.WriteUByte(track.channelMask_);
+            dest.WriteUInt(track.GetNumKeyFrames());
+
+            // Write keyframes of the track. Decode keyframes of individually compressed tracks
+            AnimationKeyFrame keyFrame;
+            for (unsigned j = 0; j < track.GetNumKeyFrames(); ++j)
+            {
+                track.DecodeKeyFrame(j, keyFrame);
+                dest.WriteFloat(keyFrame.time_);
+                if (track.channelMask_ & CHANNEL_POSITION)
+                    dest.WriteVector3(keyFrame.position_);
+                if (track.channelMask_ & CHANNEL_ROTATION)
+                    dest.WriteQuaternion(keyFrame.rotation_);
+                if (track.channelMask_ & CHANNEL_SCALE)
+                    dest.WriteVector3(keyFrame.scale_);
+            }
         }
     }
 
@@ -381,6 +687,32 @@ SharedPtr<Animation> Animation::Clone(const String& cloneName) const
     return ret;
 }
 
+void Animation::Compress()
+{
+    unsigned memoryUse = sizeof(Animation) + triggers_.Size() * sizeof(AnimationTriggerPoint);
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        i->second_.Compress();
+        memoryUse += i->second_.GetMemoryUse();
+    }
+
+    SetMemoryUse(memoryUse);
+}
+
+bool Animation::IsCompressed() const
+{
+    bool compressed = false;
+    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        if (!i->second_.keyFrames_.Empty())
+            return false;
+        if (i->second_.IsCompressed())
+            compressed = true;
+    }
+
+    return compressed;
+}
+
 AnimationTrack* Animation::GetTrack(unsigned index)
 {
     if (index >= GetNumTracks())
@@ -415,4 +747,64 @@ AnimationTriggerPoint* Animation::GetTrigger(unsigned index)
     return index < triggers_.Size() ? &triggers_[index] : nullptr;
 }
 
+unsigned Animation::ReadCompressedTracks(Deserializer& source)
+{
+    unsigned memoryUse = 0;
+    unsigned tracks = source.ReadUInt();
+
+    for (unsigned i = 0; i < tracks; ++i)
+    {
+        AnimationTrack* newTrack = CreateTrack(source.ReadString());
+        newTrack->channelMask_ = source.ReadUByte();
+        newTrack->constantMask_ = source.ReadUByte() & newTrack->channelMask_;
+
+        // Keyframe times, followed by the key arrays of each included channel. A constant channel has a single key
+        unsigned keyFrames = source.ReadUInt();
+        newTrack->keyTimes_.Resize(keyFrames);
+        source.Read(newTrack->keyTimes_.Buffer(), keyFrames * sizeof(float));
+
+        if (newTrack->channelMask_ & CHANNEL_POSITION)
+        {
+            newTrack->positionKeys_.Resize((newTrack->constantMask_ & CHANNEL_POSITION) ? Min(keyFrames, 1U) : keyFrames);
+            source.Read(newTrack->positionKeys_.Buffer(), newTrack->positionKeys_.Size() * sizeof(Vector3));
+        }
+        if (newTrack->channelMask_ & CHANNEL_ROTATION)
+        {
+            newTrack->rotationKeys_.Resize((newTrack->constantMask_ & CHANNEL_ROTATION) ? Min(keyFrames, 1U) : keyFrames);
+            source.Read(newTrack->rotationKeys_.Buffer(), newTrack->rotationKeys_.Size() * sizeof(QuantizedQuaternion));
+        }
+        if (newTrack->channelMask_ & CHANNEL_SCALE)
+        {
+            newTrack->scaleKeys_.Resize((newTrack->constantMask_ & CHANNEL_SCALE) ? Min(keyFrames, 1U) : keyFrames);
+            source.Read(newTrack->scaleKeys_.Buffer(), newTrack->scaleKeys_.Size() * sizeof(Vector3));
+        }
+
+        memoryUse += newTrack->GetMemoryUse();
+    }
+
+    return memoryUse;
+}
+
+void Animation::WriteCompressedTracks(Serializer& dest) const
+{
+    dest.WriteUInt(tracks_.Size());
+
+    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        const AnimationTrack& track = i->second_;
+        dest.WriteString(track.name_);
+        dest.WriteUByte(track.channelMask_);
+        dest.WriteUByte(track.constantMask_);
+        dest.WriteUInt(track.keyTimes_.Size());
+        dest.Write(track.keyTimes_.Buffer(), track.keyTimes_.Size() * sizeof(float));
+
+        if (track.channelMask_ & CHANNEL_POSITION)
+            dest.Write(track.positionKeys_.Buffer(), track.positionKeys_.Size() * sizeof(Vector3));
+        if (track.channelMask_ & CHANNEL_ROTATION)
+            dest.Write(track.rotationKeys_.Buffer(), track.rotationKeys_.Size() * sizeof(QuantizedQuaternion));
+        if (track.channelMask_ & CHANNEL_SCALE)
+            dest.Write(track.scaleKeys_.Buffer(), track.scaleKeys_.Size() * sizeof(Vector3));
+    }
+}
+
 }
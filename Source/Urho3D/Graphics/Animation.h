@@ -50,12 +50,26 @@ struct AnimationKeyFrame
     Vector3 scale_;
 };
 
-/// Skeletal animation track, stores keyframes of a single bone.
+/// Skeletal animation rotation key quantized to 16 bits per component.
+struct QuantizedQuaternion
+{
+    /// W coordinate.
+    short w_;
+    /// X coordinate.
+    short x_;
+    /// Y coordinate.
+    short y_;
+    /// Z coordinate.
+    short z_;
+};
+
+/// Skeletal animation track, stores keyframes of a single bone. Keyframes are either editable structures, or compressed into per-channel key arrays for playback.
 struct URHO3D_API AnimationTrack
 {
     /// Construct.
     AnimationTrack() :
-        channelMask_(0)
+        channelMask_(0),
+        constantMask_(0)
     {
     }
 
@@ -70,12 +84,27 @@ struct URHO3D_API AnimationTrack
     /// Remove all keyframes.
     void RemoveAllKeyFrames();
 
-    /// Return keyframe at index, or null if not found.
-    AnimationKeyFrame* GetKeyFrame(unsigned index);
+    /// Compress keyframes into per-channel key arrays with quantized rotations, storing channels that do not change as a single key. The editable keyframes are released.
+    void Compress();
+    /// Restore editable keyframes from the compressed keys. Called automatically by the keyframe editing functions; call explicitly before editing keyFrames_ directly.
+    void Decompress();
+
+    /// Return keyframe at index, or a default keyframe if not found. Does not decompress the track.
+    AnimationKeyFrame GetKeyFrame(unsigned index) const;
+    /// Decode keyframe at index without decompressing the track. Return true if found.
+    bool DecodeKeyFrame(unsigned index, AnimationKeyFrame& dest) const;
     /// Return number of keyframes.
-    unsigned GetNumKeyFrames() const { return keyFrames_.Size(); }
+    unsigned GetNumKeyFrames() const { return IsCompressed() ? keyTimes_.Size() : keyFrames_.Size(); }
+    /// Return keyframe time at index.
+    float GetKeyFrameTime(unsigned index) const { return IsCompressed() ? keyTimes_[index] : keyFrames_[index].time_; }
+    /// Return whether keyframes are compressed.
+    bool IsCompressed() const { return !keyTimes_.Empty(); }
     /// Return keyframe index based on time and previous index.
     void GetKeyFrameIndex(float time, unsigned& index) const;
+    /// Sample the channels included in the channel mask at time, using and updating the previous keyframe index. Wraps to the first keyframe at the end if looped.
+    void Sample(float time, float length, bool looped, unsigned& index, Vector3& position, Quaternion& rotation, Vector3& scale) const;
+    /// Return approximate memory use in bytes.
+    unsigned GetMemoryUse() const;
 
     /// Bone or scene node name.
     String name_;
@@ -83,8 +112,18 @@ struct URHO3D_API AnimationTrack
     StringHash nameHash_;
     /// Bitmask of included data (position, rotation, scale.)
     unsigned char channelMask_;
-    /// Keyframes.
+    /// Bitmask of compressed channels that store a single key for all keyframes.
+    unsigned char constantMask_;
+    /// Keyframes. Empty when compressed.
     Vector<AnimationKeyFrame> keyFrames_;
+    /// Compressed keyframe times.
+    PODVector<float> keyTimes_;
+    /// Compressed position keys.
+    PODVector<Vector3> positionKeys_;
+    /// Compressed rotation keys.
+    PODVector<QuantizedQuaternion> rotationKeys_;
+    /// Compressed scale keys.
+    PODVector<Vector3> scaleKeys_;
 };
 
 /// %Animation trigger point.
@@ -148,6 +187,8 @@ public:
     void SetNumTriggers(unsigned num);
     /// Clone the animation.
     SharedPtr<Animation> Clone(const String& cloneName = String::EMPTY) const;
+    /// Compress all tracks. A compressed animation is saved in the compressed format.
+    void Compress();
 
     /// Return animation name.
     const String& GetAnimationName() const { return animationName_; }
@@ -158,6 +199,9 @@ public:
     /// Return animation length.
     float GetLength() const { return length_; }
 
+    /// Return whether all tracks are compressed.
+    bool IsCompressed() const;
+
     /// Return all animation tracks.
     const HashMap<StringHash, AnimationTrack>& GetTracks() const { return tracks_; }
 
@@ -182,6 +226,11 @@ public:
     AnimationTriggerPoint* GetTrigger(unsigned index);
 
 private:
+    /// Read compressed tracks. Return memory use.
+    unsigned ReadCompressedTracks(Deserializer& source);
+    /// Write compressed tracks.
+    void WriteCompressedTracks(Serializer& dest) const;
+
     /// Animation name.
     String animationName_;
     /// Animation name hash.
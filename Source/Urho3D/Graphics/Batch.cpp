@@ -22,6 +22,8 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/FrameAllocator.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
@@ -40,44 +42,189 @@
 namespace Urho3D
 {
 
-inline bool CompareBatchesState(Batch* lhs, Batch* rhs)
+inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->sortKey_ != rhs->sortKey_)
-        return lhs->sortKey_ < rhs->sortKey_;
-    else
-        return lhs->distance_ < rhs->distance_;
+    return lhs.distance_ < rhs.distance_;
 }
 
-inline bool CompareBatchesFrontToBack(Batch* lhs, Batch* rhs)
+/// Batch count above which a queue is radix sorted in parallel chunks.
+static const unsigned PARALLEL_BATCH_SORT_THRESHOLD = 8192;
+/// Number of batches per parallel sort chunk. Fixed so that the result does not depend on the number of threads.
+static const unsigned BATCH_SORT_CHUNK_SIZE = 4096;
+/// Number of batch groups per instance sorting job.
+static const unsigned INSTANCE_SORT_GRAIN = 64;
+
+/// Maximum number of bits for the state ranks in the combined front to back sort key. The rest below the render order and base pass flag go to the distance.
+static const unsigned MAX_STATE_RANK_BITS = 48;
+
+/// Return the radix sort key of a batch.
+inline unsigned long long GetBatchSortKey(const Batch* batch, BatchSortKey key)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ < rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
+    switch (key)
+    {
+    case SORTKEY_FRONTTOBACK:
+        return ((unsigned long long)batch->renderOrder_ << 32) | RadixSortKey(batch->distance_);
+
+    case SORTKEY_BACKTOFRONT:
+        // The most significant state bits only break ties between batches at the same distance
+        return ((unsigned long long)batch->renderOrder_ << 56) | ((unsigned long long)(unsigned)~RadixSortKey(batch->distance_) << 24) |
+               (batch->sortKey_ >> 40);
+
+    default:
+        return batch->renderOrder_;
+    }
 }
 
-inline bool CompareBatchesBackToFront(Batch* lhs, Batch* rhs)
+/// Record the nearest front to back key of a state in a remapping table.
+template <class T> static void UpdateNearestStateKey(FlatHashMap<T, unsigned long long>& remapping, T id, unsigned long long key)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ > rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
+    typename FlatHashMap<T, unsigned long long>::Iterator i = remapping.Find(id);
+    if (i == remapping.End())
+        remapping.Insert(MakePair(id, key));
+    else if (key < i->second_)
+        i->second_ = key;
 }
 
-inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
+/// Replace the nearest keys in a remapping table with dense state ranks. Return the number of bits needed for the ranks.
+template <class T> static unsigned RankStates(FlatHashMap<T, unsigned long long>& remapping, PODVector<RadixSortItem<unsigned> >& items,
+    PODVector<RadixSortItem<unsigned> >& scratch)
 {
-    return lhs.distance_ < rhs.distance_;
+    unsigned count = remapping.Size();
+    items.Resize(count);
+    scratch.Resize(count);
+
+    typename FlatHashMap<T, unsigned long long>::Iterator begin = remapping.Begin();
+    for (unsigned i = 0; i < count; ++i)
+    {
+        items[i].key_ = (begin + i)->second_;
+        items[i].value_ = i;
+    }
+
+    // Mobile devices likely use a tiled deferred approach, with which front-to-back sorting is irrelevant, so rank states
+    // in the order they were first seen. For desktop, the state with the nearest batch gets the lowest rank
+#ifndef GL_ES_VERSION_2_0
+    RadixSort(items.Buffer(), scratch.Buffer(), count);
+#endif
+
+    for (unsigned rank = 0; rank < count; ++rank)
+        (begin + items[rank].value_)->second_ = rank;
+
+    return count > 1 ? LogBaseTwo(count - 1) + 1 : 0;
 }
 
-inline bool CompareBatchGroupOrder(BatchGroup* lhs, BatchGroup* rhs)
+/// Radix sort items in parallel chunks. Each pass builds per-chunk digit histograms, turns them into per-chunk output offsets and scatters the chunks independently, which keeps the sort stable.
+static void ParallelRadixSort(RadixSortItem<Batch*>* items, RadixSortItem<Batch*>* scratch, unsigned count, WorkQueue* workQueue,
+    unsigned threadIndex)
 {
-    return lhs->renderOrder_ < rhs->renderOrder_;
+    unsigned numChunks = (count + BATCH_SORT_CHUNK_SIZE - 1) / BATCH_SORT_CHUNK_SIZE;
+    FramePODVector<unsigned> offsets;
+    offsets.Resize(numChunks * RADIX_SORT_BUCKETS);
+
+    RadixSortItem<Batch*>* src = items;
+    RadixSortItem<Batch*>* dest = scratch;
+
+    for (unsigned pass = 0; pass < RADIX_SORT_PASSES; ++pass)
+    {
+        unsigned shift = pass * RADIX_SORT_BITS;
+
+        workQueue->ParallelFor(numChunks, 1, [&](unsigned begin, unsigned end, unsigned)
+        {
+            for (unsigned chunk = begin; chunk < end; ++chunk)
+            {
+                unsigned* histogram = &offsets[chunk * RADIX_SORT_BUCKETS];
+                memset(histogram, 0, RADIX_SORT_BUCKETS * sizeof(unsigned));
+
+                unsigned last = Min((chunk + 1) * BATCH_SORT_CHUNK_SIZE, count);
+                for (unsigned i = chunk * BATCH_SORT_CHUNK_SIZE; i < last; ++i)
+                    ++histogram[(src[i].key_ >> shift) & (RADIX_SORT_BUCKETS - 1)];
+            }
+        }, threadIndex);
+
+        // Skip the pass if all keys share the same digit
+        unsigned firstDigit = (unsigned)((src[0].key_ >> shift) & (RADIX_SORT_BUCKETS - 1));
+        unsigned firstDigitCount = 0;
+        for (unsigned chunk = 0; chunk < numChunks; ++chunk)
+            firstDigitCount += offsets[chunk * RADIX_SORT_BUCKETS + firstDigit];
+        if (firstDigitCount == count)
+            continue;
+
+        unsigned offset = 0;
+        for (unsigned digit = 0; digit < RADIX_SORT_BUCKETS; ++digit)
+        {
+            for (unsigned chunk = 0; chunk < numChunks; ++chunk)
+            {
+                unsigned& chunkOffset = offsets[chunk * RADIX_SORT_BUCKETS + digit];
+                unsigned chunkCount = chunkOffset;
+                chunkOffset = offset;
+                offset += chunkCount;
+            }
+        }
+
+        workQueue->ParallelFor(numChunks, 1, [&](unsigned begin, unsigned end, unsigned)
+        {
+            for (unsigned chunk = begin; chunk < end; ++chunk)
+            {
+                unsigned* chunkOffsets = &offsets[chunk * RADIX_SORT_BUCKETS];
+
+                unsigned last = Min((chunk + 1) * BATCH_SORT_CHUNK_SIZE, count);
+                for (unsigned i = chunk * BATCH_SORT_CHUNK_SIZE; i < last; ++i)
+                    dest[chunkOffsets[(src[i].key_ >> shift) & (RADIX_SORT_BUCKETS - 1)]++] = src[i];
+            }
+        }, threadIndex);
+
+        Swap(src, dest);
+    }
+
+    if (src != items)
+        memcpy(items, src, count * sizeof(RadixSortItem<Batch*>));
+}
+
+/// Sort runs of batches with the same render order and distance by their full state key. The back to front key only has room for the most significant state bits, and such runs are short, typically the geometries of one drawable.
+static void SortEqualDistanceRuns(PODVector<Batch*>& batches)
+{
+    unsigned count = batches.Size();
+    for (unsigned begin = 0; begin < count;)
+    {
+        unsigned end = begin + 1;
+        while (end < count && batches[end]->renderOrder_ == batches[begin]->renderOrder_ &&
+               batches[end]->distance_ == batches[begin]->distance_)
+            ++end;
+
+        // Insertion sort keeps batches with equal keys in submission order
+        for (unsigned i = begin + 1; i < end; ++i)
+        {
+            Batch* batch = batches[i];
+            unsigned j = i;
+            for (; j > begin && batches[j - 1]->sortKey_ > batch->sortKey_; --j)
+                batches[j] = batches[j - 1];
+            batches[j] = batch;
+        }
+
+        begin = end;
+    }
+}
+
+/// Sort the instances of batch groups front to back and update the group distances.
+static void SortInstances(BatchGroup** groups, unsigned count, unsigned maxSortedInstances)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        BatchGroup* group = groups[i];
+
+        if (group->instances_.Size() <= maxSortedInstances)
+        {
+            Sort(group->instances_.Begin(), group->instances_.End(), CompareInstancesFrontToBack);
+            if (group->instances_.Size())
+                group->distance_ = group->instances_[0].distance_;
+        }
+        else
+        {
+            float minDistance = M_INFINITY;
+            for (PODVector<InstanceData>::ConstIterator j = group->instances_.Begin(); j != group->instances_.End(); ++j)
+                minDistance = Min(minDistance, j->distance_);
+            group->distance_ = minDistance;
+        }
+    }
 }
 
 void CalculateShadowMatrix(Matrix4& dest, LightBatchQueue* queue, unsigned split, Renderer* renderer)
@@ -701,123 +848,149 @@ void BatchQueue::Clear(int maxSortedInstances)
     maxSortedInstances_ = (unsigned)maxSortedInstances;
 }
 
-void BatchQueue::SortBackToFront()
+void BatchQueue::SortBackToFront(WorkQueue* workQueue, unsigned threadIndex)
 {
     sortedBatches_.Resize(batches_.Size());
 
     for (unsigned i = 0; i < batches_.Size(); ++i)
         sortedBatches_[i] = &batches_[i];
 
-    Sort(sortedBatches_.Begin(), sortedBatches_.End(), CompareBatchesBackToFront);
+    // Render order first, then distance from back to front, then state
+    SortBatches(sortedBatches_, SORTKEY_BACKTOFRONT, workQueue, threadIndex);
+    SortEqualDistanceRuns(sortedBatches_);
 
     sortedBatchGroups_.Resize(batchGroups_.Size());
 
     unsigned index = 0;
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
         sortedBatchGroups_[index++] = &i->second_;
 
-    Sort(sortedBatchGroups_.Begin(), sortedBatchGroups_.End(), CompareBatchGroupOrder);
+    SortBatches(reinterpret_cast<PODVector<Batch*>& >(sortedBatchGroups_), SORTKEY_RENDERORDER, workQueue, threadIndex);
 }
 
-void BatchQueue::SortFrontToBack()
+void BatchQueue::SortFrontToBack(WorkQueue* workQueue, unsigned threadIndex)
 {
-    sortedBatches_.Clear();
+    sortedBatches_.Resize(batches_.Size());
 
     for (unsigned i = 0; i < batches_.Size(); ++i)
-        sortedBatches_.Push(&batches_[i]);
+        sortedBatches_[i] = &batches_[i];
 
-    SortFrontToBack2Pass(sortedBatches_);
-
-    // Sort each group front to back
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
-    {
-        if (i->second_.instances_.Size() <= maxSortedInstances_)
-        {
-            Sort(i->second_.instances_.Begin(), i->second_.instances_.End(), CompareInstancesFrontToBack);
-            if (i->second_.instances_.Size())
-                i->second_.distance_ = i->second_.instances_[0].distance_;
-        }
-        else
-        {
-            float minDistance = M_INFINITY;
-            for (PODVector<InstanceData>::ConstIterator j = i->second_.instances_.Begin(); j != i->second_.instances_.End(); ++j)
-                minDistance = Min(minDistance, j->distance_);
-            i->second_.distance_ = minDistance;
-        }
-    }
+    SortFrontToBack2Pass(sortedBatches_, workQueue, threadIndex);
 
     sortedBatchGroups_.Resize(batchGroups_.Size());
 
     unsigned index = 0;
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
         sortedBatchGroups_[index++] = &i->second_;
 
-    SortFrontToBack2Pass(reinterpret_cast<PODVector<Batch*>& >(sortedBatchGroups_));
+    // Sort each group front to back
+    if (workQueue)
+    {
+        BatchGroup** groups = sortedBatchGroups_.Buffer();
+        unsigned maxSortedInstances = maxSortedInstances_;
+        workQueue->ParallelFor(sortedBatchGroups_.Size(), INSTANCE_SORT_GRAIN, [=](unsigned begin, unsigned end, unsigned)
+        {
+            SortInstances(groups + begin, end - begin, maxSortedInstances);
+        }, threadIndex);
+    }
+    else
+        SortInstances(sortedBatchGroups_.Buffer(), sortedBatchGroups_.Size(), maxSortedInstances_);
+
+    SortFrontToBack2Pass(reinterpret_cast<PODVector<Batch*>& >(sortedBatchGroups_), workQueue, threadIndex);
 }
 
-void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
+void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches, WorkQueue* workQueue, unsigned threadIndex)
 {
-    // Mobile devices likely use a tiled deferred approach, with which front-to-back sorting is irrelevant. The 2-pass
-    // method is also time consuming, so just sort with state having priority
-#ifdef GL_ES_VERSION_2_0
-    Sort(batches.Begin(), batches.End(), CompareBatchesState);
-#else
-    // For desktop, first sort by distance and remap shader/material/geometry IDs in the sort key
-    Sort(batches.Begin(), batches.End(), CompareBatchesFrontToBack);
-
-    unsigned freeShaderID = 0;
-    unsigned short freeMaterialID = 0;
-    unsigned short freeGeometryID = 0;
+    unsigned count = batches.Size();
+    if (count < 2)
+        return;
 
-    for (PODVector<Batch*>::Iterator i = batches.Begin(); i != batches.End(); ++i)
+    // First pass: record the nearest batch of each shader, material and geometry, and rank them by it
+    for (PODVector<Batch*>::ConstIterator i = batches.Begin(); i != batches.End(); ++i)
     {
         Batch* batch = *i;
+        unsigned long long nearestKey = GetBatchSortKey(batch, SORTKEY_FRONTTOBACK);
+        UpdateNearestStateKey(shaderRemapping_, (unsigned)(batch->sortKey_ >> 32), nearestKey);
+        UpdateNearestStateKey(materialRemapping_, (unsigned short)((batch->sortKey_ >> 16) & 0xffff), nearestKey);
+        UpdateNearestStateKey(geometryRemapping_, (unsigned short)(batch->sortKey_ & 0xffff), nearestKey);
+    }
 
+    unsigned shaderBits = RankStates(shaderRemapping_, rankItems_, rankScratch_);
+    unsigned materialBits = RankStates(materialRemapping_, rankItems_, rankScratch_);
+    unsigned geometryBits = RankStates(geometryRemapping_, rankItems_, rankScratch_);
+
+    // With very many distinct states, drop the least significant rank bits, geometry first
+    unsigned excessBits = Max(shaderBits + materialBits + geometryBits, MAX_STATE_RANK_BITS) - MAX_STATE_RANK_BITS;
+    unsigned geometryShift = Min(excessBits, geometryBits);
+    excessBits -= geometryShift;
+    unsigned materialShift = Min(excessBits, materialBits);
+    excessBits -= materialShift;
+    unsigned shaderShift = excessBits;
+    geometryBits -= geometryShift;
+    materialBits -= materialShift;
+    shaderBits -= shaderShift;
+    unsigned distanceBits = Min(55 - shaderBits - materialBits - geometryBits, 32U);
+
+    // Second pass: build one key of render order, base pass flag, state ranks and the high distance bits, then sort once
+    sortItems_.Resize(count);
+    sortScratch_.Resize(count);
+
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Batch* batch = batches[i];
         auto shaderID = (unsigned)(batch->sortKey_ >> 32);
-        HashMap<unsigned, unsigned>::ConstIterator j = shaderRemapping_.Find(shaderID);
-        if (j != shaderRemapping_.End())
-            shaderID = j->second_;
-        else
-        {
-            shaderID = shaderRemapping_[shaderID] = freeShaderID | (shaderID & 0x80000000);
-            ++freeShaderID;
-        }
-
-        auto materialID = (unsigned short)(batch->sortKey_ & 0xffff0000);
-        HashMap<unsigned short, unsigned short>::ConstIterator k = materialRemapping_.Find(materialID);
-        if (k != materialRemapping_.End())
-            materialID = k->second_;
-        else
-        {
-            materialID = materialRemapping_[materialID] = freeMaterialID;
-            ++freeMaterialID;
-        }
 
-        auto geometryID = (unsigned short)(batch->sortKey_ & 0xffff);
-        HashMap<unsigned short, unsigned short>::ConstIterator l = geometryRemapping_.Find(geometryID);
-        if (l != geometryRemapping_.End())
-            geometryID = l->second_;
-        else
-        {
-            geometryID = geometryRemapping_[geometryID] = freeGeometryID;
-            ++freeGeometryID;
-        }
+        unsigned long long state = shaderRemapping_.Find(shaderID)->second_ >> shaderShift;
+        state = (state << materialBits) |
+            (materialRemapping_.Find((unsigned short)((batch->sortKey_ >> 16) & 0xffff))->second_ >> materialShift);
+        state = (state << geometryBits) | (geometryRemapping_.Find((unsigned short)(batch->sortKey_ & 0xffff))->second_ >> geometryShift);
 
-        batch->sortKey_ = (((unsigned long long)shaderID) << 32) | (((unsigned long long)materialID) << 16) | geometryID;
+        sortItems_[i].key_ = ((unsigned long long)batch->renderOrder_ << 56) | ((unsigned long long)(shaderID >> 31) << 55) |
+                             (state << distanceBits) | (RadixSortKey(batch->distance_) >> (32 - distanceBits));
+        sortItems_[i].value_ = batch;
     }
 
     shaderRemapping_.Clear();
     materialRemapping_.Clear();
     geometryRemapping_.Clear();
 
-    // Finally sort again with the rewritten ID's
-    Sort(batches.Begin(), batches.End(), CompareBatchesState);
-#endif
+    SortItems(batches, workQueue, threadIndex);
+}
+
+void BatchQueue::SortBatches(PODVector<Batch*>& batches, BatchSortKey key, WorkQueue* workQueue, unsigned threadIndex)
+{
+    unsigned count = batches.Size();
+    if (count < 2)
+        return;
+
+    sortItems_.Resize(count);
+    sortScratch_.Resize(count);
+
+    for (unsigned i = 0; i < count; ++i)
+    {
+        sortItems_[i].key_ = GetBatchSortKey(batches[i], key);
+        sortItems_[i].value_ = batches[i];
+    }
+
+    SortItems(batches, workQueue, threadIndex);
+}
+
+void BatchQueue::SortItems(PODVector<Batch*>& batches, WorkQueue* workQueue, unsigned threadIndex)
+{
+    // The sort is stable, so batches with equal keys stay in submission order
+    unsigned count = batches.Size();
+    if (workQueue && workQueue->GetNumThreads() && count > PARALLEL_BATCH_SORT_THRESHOLD)
+        ParallelRadixSort(sortItems_.Buffer(), sortScratch_.Buffer(), count, workQueue, threadIndex);
+    else
+        RadixSort(sortItems_.Buffer(), sortScratch_.Buffer(), count);
+
+    for (unsigned i = 0; i < count; ++i)
+        batches[i] = sortItems_[i].value_;
 }
 
 void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
 {
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
         i->second_.SetInstancingData(lockedData, stride, freeIndex);
 }
 
@@ -868,7 +1041,7 @@ unsigned BatchQueue::GetNumInstances() const
 {
     unsigned total = 0;
 
-    for (HashMap<BatchGroupKey, BatchGroup>::ConstIterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::ConstIterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
     {
         if (i->second_.geometryType_ == GEOM_INSTANCED)
             total += i->second_.instances_.Size();
@@ -22,7 +22,9 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
 #include "../Container/Ptr.h"
+#include "../Container/Sort.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Material.h"
 #include "../Math/MathDefs.h"
@@ -43,6 +45,7 @@ class ShaderVariation;
 class Texture2D;
 class VertexBuffer;
 class View;
+class WorkQueue;
 class Zone;
 struct LightBatchQueue;
 
@@ -167,6 +170,14 @@ struct BatchGroup : public Batch
         }
     }
 
+    /// Swap with another batch group. Lets the batch queue's group map move groups without copying their instances.
+    void Swap(BatchGroup& rhs)
+    {
+        Urho3D::Swap(static_cast<Batch&>(*this), static_cast<Batch&>(rhs));
+        instances_.Swap(rhs.instances_);
+        Urho3D::Swap(startIndex_, rhs.startIndex_);
+    }
+
     /// Pre-set the instance data. Buffer must be big enough to hold all data.
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
     /// Prepare and draw.
@@ -226,18 +237,33 @@ struct BatchGroupKey
     unsigned ToHash() const;
 };
 
+/// Keys for stable batch sorting.
+enum BatchSortKey
+{
+    /// Render order, then distance from front to back.
+    SORTKEY_FRONTTOBACK = 0,
+    /// Render order, then distance from back to front, then state.
+    SORTKEY_BACKTOFRONT,
+    /// Render order.
+    SORTKEY_RENDERORDER
+};
+
 /// Queue that contains both instanced and non-instanced draw calls.
 struct BatchQueue
 {
 public:
     /// Clear for new frame by clearing all groups and batches.
     void Clear(int maxSortedInstances);
-    /// Sort non-instanced draw calls back to front.
-    void SortBackToFront();
-    /// Sort instanced and non-instanced draw calls front to back.
-    void SortFrontToBack();
-    /// Sort batches front to back while also maintaining state sorting.
-    void SortFrontToBack2Pass(PODVector<Batch*>& batches);
+    /// Sort non-instanced draw calls back to front. Large queues are sorted in parallel if a work queue is given; the thread index is that of the calling thread.
+    void SortBackToFront(WorkQueue* workQueue = nullptr, unsigned threadIndex = 0);
+    /// Sort instanced and non-instanced draw calls front to back. Large queues are sorted in parallel if a work queue is given; the thread index is that of the calling thread.
+    void SortFrontToBack(WorkQueue* workQueue = nullptr, unsigned threadIndex = 0);
+    /// Sort batches by render order, then state, then distance front to back. States are ranked by their nearest batch in a first pass so that a single sort is needed.
+    void SortFrontToBack2Pass(PODVector<Batch*>& batches, WorkQueue* workQueue = nullptr, unsigned threadIndex = 0);
+    /// Stable radix sort of batches by a sort key.
+    void SortBatches(PODVector<Batch*>& batches, BatchSortKey key, WorkQueue* workQueue = nullptr, unsigned threadIndex = 0);
+    /// Stable radix sort of batches by the keys already written to the sort items.
+    void SortItems(PODVector<Batch*>& batches, WorkQueue* workQueue = nullptr, unsigned threadIndex = 0);
     /// Pre-set instance data of all groups. The vertex buffer must be big enough to hold all data.
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
     /// Draw.
@@ -249,13 +275,13 @@ public:
     bool IsEmpty() const { return batches_.Empty() && batchGroups_.Empty(); }
 
     /// Instanced draw calls.
-    HashMap<BatchGroupKey, BatchGroup> batchGroups_;
-    /// Shader remapping table for 2-pass state and distance sort.
-    HashMap<unsigned, unsigned> shaderRemapping_;
-    /// Material remapping table for 2-pass state and distance sort.
-    HashMap<unsigned short, unsigned short> materialRemapping_;
-    /// Geometry remapping table for 2-pass state and distance sort.
-    HashMap<unsigned short, unsigned short> geometryRemapping_;
+    FlatHashMap<BatchGroupKey, BatchGroup> batchGroups_;
+    /// Shader remapping table for 2-pass state and distance sort. Holds the nearest batch key, then the rank of each shader.
+    FlatHashMap<unsigned, unsigned long long> shaderRemapping_;
+    /// Material remapping table for 2-pass state and distance sort. Holds the nearest batch key, then the rank of each material.
+    FlatHashMap<unsigned short, unsigned long long> materialRemapping_;
+    /// Geometry remapping table for 2-pass state and distance sort. Holds the nearest batch key, then the rank of each geometry.
+    FlatHashMap<unsigned short, unsigned long long> geometryRemapping_;
 
     /// Unsorted non-instanced draw calls.
     PODVector<Batch> batches_;
@@ -263,6 +289,14 @@ public:
     PODVector<Batch*> sortedBatches_;
     /// Sorted instanced draw calls.
     PODVector<BatchGroup*> sortedBatchGroups_;
+    /// Radix sort keys of the batches being sorted.
+    PODVector<RadixSortItem<Batch*> > sortItems_;
+    /// Radix sort scratch buffer.
+    PODVector<RadixSortItem<Batch*> > sortScratch_;
+    /// State ranking sort keys.
+    PODVector<RadixSortItem<unsigned> > rankItems_;
+    /// State ranking sort scratch buffer.
+    PODVector<RadixSortItem<unsigned> > rankScratch_;
     /// Maximum sorted instances.
     unsigned maxSortedInstances_;
     /// Whether the pass command contains extra shader defines.
@@ -603,21 +603,6 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
             ++enabledBillboards;
     }
 
-    sortedBillboards_.Resize(enabledBillboards);
-    unsigned index = 0;
-
-    // Then set initial sort order and distances
-    for (unsigned i = 0; i < numBillboards; ++i)
-    {
-        Billboard& billboard = billboards_[i];
-        if (billboard.enabled_)
-        {
-            sortedBillboards_[index++] = &billboard;
-            if (sorted_)
-                billboard.sortDistance_ = frame.camera_->GetDistanceSquared(billboardTransform * billboards_[i].position_);
-        }
-    }
-
     batches_[0].geometry_->SetDrawRange(TRIANGLE_LIST, 0, enabledBillboards * 6, false);
 
     bufferDirty_ = false;
@@ -625,14 +610,39 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
     if (!enabledBillboards)
         return;
 
+    // Only sorted billboards need the pointer list. Unsorted ones are written in their original order
     if (sorted_)
     {
+        sortedBillboards_.Resize(enabledBillboards);
+        unsigned index = 0;
+        for (unsigned i = 0; i < numBillboards; ++i)
+        {
+            Billboard& billboard = billboards_[i];
+            if (billboard.enabled_)
+            {
+                sortedBillboards_[index++] = &billboard;
+                billboard.sortDistance_ = frame.camera_->GetDistanceSquared(billboardTransform * billboard.position_);
+            }
+        }
+
         Sort(sortedBillboards_.Begin(), sortedBillboards_.End(), CompareBillboards);
         Vector3 worldPos = node_->GetWorldPosition();
         // Store the "last sorted position" now
         previousOffset_ = (worldPos - frame.camera_->GetNode()->GetWorldPosition());
     }
 
+    Billboard* const* sortedBillboards = sorted_ ? sortedBillboards_.Buffer() : nullptr;
+    const Billboard* billboards = billboards_.Buffer();
+    unsigned next = 0;
+    auto nextBillboard = [&]() -> const Billboard&
+    {
+        if (sortedBillboards)
+            return **sortedBillboards++;
+        while (!billboards[next].enabled_)
+            ++next;
+        return billboards[next++];
+    };
+
     auto* dest = (float*)vertexBuffer_->Lock(0, enabledBillboards * 4, true);
     if (!dest)
         return;
@@ -641,7 +651,7 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
     {
         for (unsigned i = 0; i < enabledBillboards; ++i)
         {
-            Billboard& billboard = *sortedBillboards_[i];
+            const Billboard& billboard = nextBillboard();
 
             Vector2 size(billboard.size_.x_ * billboardScale.x_, billboard.size_.y_ * billboardScale.y_);
             unsigned color = billboard.color_.ToUInt();
@@ -696,7 +706,7 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
     {
         for (unsigned i = 0; i < enabledBillboards; ++i)
         {
-            Billboard& billboard = *sortedBillboards_[i];
+            const Billboard& billboard = nextBillboard();
 
             Vector2 size(billboard.size_.x_ * billboardScale.x_, billboard.size_.y_ * billboardScale.y_);
             unsigned color = billboard.color_.ToUInt();
@@ -810,7 +820,7 @@ void BillboardSet::CalculateFixedScreenSize(const FrameInfo& frame)
     {
         bufferDirty_ = true;
         forceUpdate_ = true;
-        worldBoundingBoxDirty_ = true;
+        MarkWorldBoundingBoxDirty();
     }
 }
 
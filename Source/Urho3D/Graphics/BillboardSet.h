@@ -204,7 +204,7 @@ private:
     /// Previous offset to camera for determining whether sorting is necessary.
     Vector3 previousOffset_;
     /// Billboard pointers for sorting.
-    Vector<Billboard*> sortedBillboards_;
+    PODVector<Billboard*> sortedBillboards_;
     /// Attribute buffer for network replication.
     mutable VectorBuffer attrBuffer_;
 };
@@ -65,8 +65,10 @@ Drawable::Drawable(Context* context, unsigned char drawableFlags) :
     occluder_(false),
     occludee_(true),
     updateQueued_(false),
+    boundsUpdateQueued_(false),
     zoneDirty_(false),
     octant_(nullptr),
+    octantIndex_(0),
     zone_(nullptr),
     viewMask_(DEFAULT_VIEWMASK),
     lightMask_(DEFAULT_LIGHTMASK),
@@ -374,14 +376,26 @@ void Drawable::OnSceneSet(Scene* scene)
 void Drawable::OnMarkedDirty(Node* node)
 {
     worldBoundingBoxDirty_ = true;
-    if (!updateQueued_ && octant_)
-        octant_->GetRoot()->QueueUpdate(this);
+    if (octant_)
+    {
+        if (!updateQueued_)
+            octant_->GetRoot()->QueueUpdate(this);
+        else
+            octant_->GetRoot()->MarkRaycastBVHDirty();
+    }
 
     // Mark zone assignment dirty when transform changes
     if (node == node_)
         zoneDirty_ = true;
 }
 
+void Drawable::MarkWorldBoundingBoxDirty()
+{
+    worldBoundingBoxDirty_ = true;
+    if (!boundsUpdateQueued_ && octant_)
+        octant_->GetRoot()->QueueBoundsUpdate(this);
+}
+
 void Drawable::AddToOctree()
 {
     // Do not add to octree when disabled
@@ -409,7 +423,7 @@ void Drawable::RemoveFromOctree()
     if (octant_)
     {
         Octree* octree = octant_->GetRoot();
-        if (updateQueued_)
+        if (updateQueued_ || boundsUpdateQueued_)
             octree->CancelUpdate(this);
 
         // Perform subclass specific deinitialization if necessary
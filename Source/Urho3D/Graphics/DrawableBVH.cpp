@@ -0,0 +1,553 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Graphics/DrawableBVH.h"
+
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned MAX_LEAF_DRAWABLES = 4;
+static const unsigned MIN_REBUILD_DRAWABLES = 32;
+static const unsigned MAX_SPATIAL_SPLIT_DEPTH = 64;
+static const unsigned MAX_STACK_DEPTH = 128;
+static const unsigned PACKET_SIZE = 4;
+static const float MIN_DIRECTION = 1e-20f;
+/// Widening of slab test results to keep them conservative against rounding, so that no drawable hit by the exact test is culled.
+static const float SLAB_TOLERANCE = 1.0f + 4.0f * M_EPSILON;
+
+/// Test a ray against a bounding box and return a lower bound of the hit distance, zero if inside. Undefined boxes are never hit.
+static inline bool SlabHit(const BoundingBox& box, const Vector3& origin, const Vector3& invDirection, float& distance)
+{
+    // Select the near and far planes by direction sign, which also keeps undefined boxes (min > max) from being hit
+    float nearX = ((invDirection.x_ < 0.0f ? box.max_.x_ : box.min_.x_) - origin.x_) * invDirection.x_;
+    float farX = ((invDirection.x_ < 0.0f ? box.min_.x_ : box.max_.x_) - origin.x_) * invDirection.x_;
+    float nearY = ((invDirection.y_ < 0.0f ? box.max_.y_ : box.min_.y_) - origin.y_) * invDirection.y_;
+    float farY = ((invDirection.y_ < 0.0f ? box.min_.y_ : box.max_.y_) - origin.y_) * invDirection.y_;
+    float nearZ = ((invDirection.z_ < 0.0f ? box.max_.z_ : box.min_.z_) - origin.z_) * invDirection.z_;
+    float farZ = ((invDirection.z_ < 0.0f ? box.min_.z_ : box.max_.z_) - origin.z_) * invDirection.z_;
+
+    float near = Max(Max(nearX, nearY), Max(nearZ, 0.0f));
+    float far = Min(Min(farX, farY), farZ) * SLAB_TOLERANCE;
+    distance = near / SLAB_TOLERANCE;
+    return near <= far;
+}
+
+/// Ray prepared for slab tests against bounding boxes.
+struct BVHRay
+{
+    /// Construct from a ray.
+    explicit BVHRay(const Ray& ray) :
+        origin_(ray.origin_)
+    {
+        // Avoid infinities, which would produce NaNs for boxes touching the origin
+        invDirection_.x_ = 1.0f / (ray.direction_.x_ != 0.0f ? ray.direction_.x_ : MIN_DIRECTION);
+        invDirection_.y_ = 1.0f / (ray.direction_.y_ != 0.0f ? ray.direction_.y_ : MIN_DIRECTION);
+        invDirection_.z_ = 1.0f / (ray.direction_.z_ != 0.0f ? ray.direction_.z_ : MIN_DIRECTION);
+    }
+
+    /// Test against a bounding box and return a lower bound of the hit distance.
+    bool Hit(const BoundingBox& box, float& distance) const { return SlabHit(box, origin_, invDirection_, distance); }
+
+    /// Test against a bounding box within a maximum distance.
+    bool HitWithin(const BoundingBox& box, float maxDistance) const
+    {
+        float distance;
+        return SlabHit(box, origin_, invDirection_, distance) && distance <= maxDistance;
+    }
+
+    /// Ray origin.
+    Vector3 origin_;
+    /// Reciprocal of the ray direction.
+    Vector3 invDirection_;
+};
+
+/// Packet of rays in structure-of-arrays form for testing against a bounding box at once.
+struct BVHRayPacket
+{
+    /// Ray origins.
+    float originX_[PACKET_SIZE];
+    float originY_[PACKET_SIZE];
+    float originZ_[PACKET_SIZE];
+    /// Reciprocals of the ray directions.
+    float invDirectionX_[PACKET_SIZE];
+    float invDirectionY_[PACKET_SIZE];
+    float invDirectionZ_[PACKET_SIZE];
+    /// Distance beyond which boxes are not of interest. Negative for unused lanes.
+    float maxDistance_[PACKET_SIZE];
+
+    /// Return a bit mask of the rays that hit a bounding box before their maximum distance.
+    unsigned HitMask(const BoundingBox& box) const
+    {
+#ifdef URHO3D_SSE
+        __m128 zero = _mm_setzero_ps();
+        __m128 hits = _mm_cmple_ps(zero, _mm_loadu_ps(maxDistance_));
+        __m128 near = zero;
+        __m128 far = _mm_set1_ps(M_INFINITY);
+
+        const float* origins[3] = {originX_, originY_, originZ_};
+        const float* invDirections[3] = {invDirectionX_, invDirectionY_, invDirectionZ_};
+        const float* boxMin = &box.min_.x_;
+        const float* boxMax = &box.max_.x_;
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            __m128 origin = _mm_loadu_ps(origins[i]);
+            __m128 invDirection = _mm_loadu_ps(invDirections[i]);
+            __m128 negative = _mm_cmplt_ps(invDirection, zero);
+            __m128 min = _mm_set1_ps(boxMin[i]);
+            __m128 max = _mm_set1_ps(boxMax[i]);
+            __m128 nearPlane = _mm_or_ps(_mm_and_ps(negative, max), _mm_andnot_ps(negative, min));
+            __m128 farPlane = _mm_or_ps(_mm_and_ps(negative, min), _mm_andnot_ps(negative, max));
+            near = _mm_max_ps(near, _mm_mul_ps(_mm_sub_ps(nearPlane, origin), invDirection));
+            far = _mm_min_ps(far, _mm_mul_ps(_mm_sub_ps(farPlane, origin), invDirection));
+        }
+
+        __m128 tolerance = _mm_set1_ps(SLAB_TOLERANCE);
+        hits = _mm_and_ps(hits, _mm_cmple_ps(near, _mm_mul_ps(far, tolerance)));
+        hits = _mm_and_ps(hits, _mm_cmple_ps(near, _mm_mul_ps(_mm_loadu_ps(maxDistance_), tolerance)));
+        return (unsigned)_mm_movemask_ps(hits);
+#else
+        unsigned mask = 0;
+        for (unsigned i = 0; i < PACKET_SIZE; ++i)
+        {
+            if (maxDistance_[i] < 0.0f)
+                continue;
+
+            Vector3 origin(originX_[i], originY_[i], originZ_[i]);
+            Vector3 invDirection(invDirectionX_[i], invDirectionY_[i], invDirectionZ_[i]);
+            float distance;
+            if (SlabHit(box, origin, invDirection, distance) && distance <= maxDistance_[i])
+                mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+};
+
+DrawableBVH::DrawableBVH() :
+    numIndexed_(0),
+    numRemoved_(0),
+    refitNeeded_(false)
+{
+}
+
+void DrawableBVH::AddDrawable(Drawable* drawable)
+{
+    if (!drawable || indices_.Contains(drawable))
+        return;
+
+    indices_[drawable] = drawables_.Size();
+    drawables_.Push(drawable);
+    boxes_.Push(drawable->GetWorldBoundingBox());
+}
+
+void DrawableBVH::RemoveDrawable(Drawable* drawable)
+{
+    HashMap<Drawable*, unsigned>::Iterator i = indices_.Find(drawable);
+    if (i == indices_.End())
+        return;
+
+    unsigned index = i->second_;
+    indices_.Erase(i);
+
+    if (index < numIndexed_)
+    {
+        // Leave a hole in the hierarchy until the next rebuild
+        drawables_[index] = nullptr;
+        ++numRemoved_;
+        refitNeeded_ = true;
+    }
+    else
+    {
+        // Not in the hierarchy yet, fill the hole from the end
+        unsigned last = drawables_.Size() - 1;
+        if (index != last)
+        {
+            drawables_[index] = drawables_[last];
+            boxes_[index] = boxes_[last];
+            indices_[drawables_[index]] = index;
+        }
+        drawables_.Pop();
+        boxes_.Pop();
+    }
+}
+
+void DrawableBVH::UpdateDrawable(Drawable* drawable)
+{
+    HashMap<Drawable*, unsigned>::Iterator i = indices_.Find(drawable);
+    if (i == indices_.End())
+        return;
+
+    // The same drawable may be refreshed several times before the next octree update, so refit only on actual change
+    unsigned index = i->second_;
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    if (box != boxes_[index])
+    {
+        boxes_[index] = box;
+        if (index < numIndexed_)
+            refitNeeded_ = true;
+    }
+}
+
+void DrawableBVH::Update()
+{
+    unsigned numAdded = drawables_.Size() - numIndexed_;
+    if (numRemoved_ > numIndexed_ / 4 || numAdded > Max(numIndexed_ / 8, MIN_REBUILD_DRAWABLES))
+        Build();
+    else if (refitNeeded_)
+        Refit();
+}
+
+void DrawableBVH::Clear()
+{
+    nodes_.Clear();
+    drawables_.Clear();
+    boxes_.Clear();
+    indices_.Clear();
+    numIndexed_ = 0;
+    numRemoved_ = 0;
+    refitNeeded_ = false;
+}
+
+void DrawableBVH::Raycast(RayOctreeQuery& query) const
+{
+    BVHRay ray(query.ray_);
+
+    // Drawables added after the last rebuild
+    for (unsigned i = numIndexed_; i < drawables_.Size(); ++i)
+    {
+        Drawable* drawable = drawables_[i];
+        if ((drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_))
+            drawable->ProcessRayQuery(query, query.result_);
+    }
+
+    if (nodes_.Empty() || !ray.HitWithin(nodes_[0].box_, query.maxDistance_))
+        return;
+
+    unsigned stack[MAX_STACK_DEPTH];
+    unsigned stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize)
+    {
+        const BVHNode& node = nodes_[stack[--stackSize]];
+        if (node.count_)
+        {
+            for (unsigned i = node.offset_; i < node.offset_ + node.count_; ++i)
+            {
+                Drawable* drawable = drawables_[i];
+                if (drawable && (drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_) &&
+                    ray.HitWithin(boxes_[i], query.maxDistance_))
+                    drawable->ProcessRayQuery(query, query.result_);
+            }
+        }
+        else
+        {
+            for (unsigned i = 0; i < 2; ++i)
+            {
+                if (ray.HitWithin(nodes_[node.offset_ + i].box_, query.maxDistance_))
+                    stack[stackSize++] = node.offset_ + i;
+            }
+        }
+    }
+}
+
+void DrawableBVH::RaycastSingle(RayOctreeQuery& query) const
+{
+    BVHRay ray(query.ray_);
+    float closestHit = M_INFINITY;
+
+    // Test the drawables added after the last rebuild first, so that a hit among them can cull the hierarchy
+    RaycastSingleRange(query, numIndexed_, drawables_.Size(), closestHit);
+
+    float rootDistance;
+    if (nodes_.Empty() || !ray.Hit(nodes_[0].box_, rootDistance))
+        return;
+
+    unsigned stack[MAX_STACK_DEPTH];
+    float stackDistances[MAX_STACK_DEPTH];
+    unsigned stackSize = 0;
+    stack[stackSize] = 0;
+    stackDistances[stackSize++] = rootDistance;
+
+    while (stackSize)
+    {
+        --stackSize;
+        if (stackDistances[stackSize] > Min(closestHit, query.maxDistance_))
+            continue;
+
+        const BVHNode& node = nodes_[stack[stackSize]];
+        if (node.count_)
+            RaycastSingleRange(query, node.offset_, node.offset_ + node.count_, closestHit);
+        else
+        {
+            // Push the farther child first so that the closer one is visited first
+            float distances[2];
+            bool hits[2];
+            hits[0] = ray.Hit(nodes_[node.offset_].box_, distances[0]);
+            hits[1] = ray.Hit(nodes_[node.offset_ + 1].box_, distances[1]);
+            unsigned closer = !hits[1] || (hits[0] && distances[0] <= distances[1]) ? 0 : 1;
+
+            for (unsigned i = 0; i < 2; ++i)
+            {
+                unsigned child = i ? closer : 1 - closer;
+                if (hits[child])
+                {
+                    stack[stackSize] = node.offset_ + child;
+                    stackDistances[stackSize++] = distances[child];
+                }
+            }
+        }
+    }
+}
+
+void DrawableBVH::RaycastBatch(const PODVector<Ray>& rays, PODVector<RayQueryResult>& results, RayQueryLevel level,
+    float maxDistance, unsigned char drawableFlags, unsigned viewMask) const
+{
+    RayQueryResult noHit;
+    noHit.distance_ = M_INFINITY;
+    results.Resize(rays.Size());
+    for (unsigned i = 0; i < results.Size(); ++i)
+        results[i] = noHit;
+
+    // Results of the single drawable object queries. Kept local, so that the query can run in several threads at once
+    PODVector<RayQueryResult> drawableResults;
+
+    for (unsigned base = 0; base < rays.Size(); base += PACKET_SIZE)
+    {
+        unsigned numRays = Min(rays.Size() - base, PACKET_SIZE);
+        float closestHits[PACKET_SIZE];
+        BVHRayPacket packet;
+
+        for (unsigned i = 0; i < PACKET_SIZE; ++i)
+        {
+            BVHRay ray(rays[base + (i < numRays ? i : 0)]);
+            packet.originX_[i] = ray.origin_.x_;
+            packet.originY_[i] = ray.origin_.y_;
+            packet.originZ_[i] = ray.origin_.z_;
+            packet.invDirectionX_[i] = ray.invDirection_.x_;
+            packet.invDirectionY_[i] = ray.invDirection_.y_;
+            packet.invDirectionZ_[i] = ray.invDirection_.z_;
+            packet.maxDistance_[i] = i < numRays ? maxDistance : -1.0f;
+            closestHits[i] = M_INFINITY;
+        }
+
+        // Test the drawables added after the last rebuild separately for each ray
+        for (unsigned i = 0; i < numRays; ++i)
+        {
+            RayOctreeQuery query(drawableResults, rays[base + i], level, maxDistance, drawableFlags, viewMask);
+            drawableResults.Clear();
+            RaycastSingleRange(query, numIndexed_, drawables_.Size(), closestHits[i]);
+            for (unsigned j = 0; j < drawableResults.Size(); ++j)
+            {
+                if (drawableResults[j].distance_ <= closestHits[i])
+                    results[base + i] = drawableResults[j];
+            }
+            packet.maxDistance_[i] = Min(closestHits[i], maxDistance);
+        }
+
+        if (nodes_.Empty())
+            continue;
+
+        // Traverse the hierarchy once for the whole packet. A node is entered when any of the rays hits it before its
+        // closest hit so far
+        unsigned stack[MAX_STACK_DEPTH];
+        unsigned stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize)
+        {
+            const BVHNode& node = nodes_[stack[--stackSize]];
+            unsigned mask = packet.HitMask(node.box_);
+            if (!mask)
+                continue;
+
+            if (!node.count_)
+            {
+                stack[stackSize++] = node.offset_ + 1;
+                stack[stackSize++] = node.offset_;
+                continue;
+            }
+
+            for (unsigned i = 0; i < numRays; ++i)
+            {
+                if (!(mask & (1u << i)))
+                    continue;
+
+                RayOctreeQuery query(drawableResults, rays[base + i], level, maxDistance, drawableFlags, viewMask);
+                drawableResults.Clear();
+                RaycastSingleRange(query, node.offset_, node.offset_ + node.count_, closestHits[i]);
+                for (unsigned j = 0; j < drawableResults.Size(); ++j)
+                {
+                    if (drawableResults[j].distance_ <= closestHits[i])
+                        results[base + i] = drawableResults[j];
+                }
+                packet.maxDistance_[i] = Min(closestHits[i], maxDistance);
+            }
+        }
+    }
+}
+
+void DrawableBVH::Build()
+{
+    // Compact out the removed drawables
+    unsigned count = 0;
+    for (unsigned i = 0; i < drawables_.Size(); ++i)
+    {
+        if (drawables_[i])
+        {
+            drawables_[count] = drawables_[i];
+            boxes_[count] = boxes_[i];
+            ++count;
+        }
+    }
+    drawables_.Resize(count);
+    boxes_.Resize(count);
+
+    centers_.Resize(count);
+    for (unsigned i = 0; i < count; ++i)
+        centers_[i] = boxes_[i].Center();
+
+    nodes_.Clear();
+    if (count)
+    {
+        nodes_.Reserve(2 * (count / MAX_LEAF_DRAWABLES) + 1);
+        nodes_.Resize(1);
+        BuildNode(0, 0, count, 0);
+    }
+
+    for (unsigned i = 0; i < count; ++i)
+        indices_[drawables_[i]] = i;
+
+    centers_.Clear();
+    numIndexed_ = count;
+    numRemoved_ = 0;
+    refitNeeded_ = false;
+}
+
+void DrawableBVH::BuildNode(unsigned nodeIndex, unsigned begin, unsigned end, unsigned depth)
+{
+    BoundingBox box;
+    BoundingBox centerBox;
+    for (unsigned i = begin; i < end; ++i)
+    {
+        box.Merge(boxes_[i]);
+        centerBox.Merge(centers_[i]);
+    }
+
+    nodes_[nodeIndex].box_ = box;
+
+    if (end - begin <= MAX_LEAF_DRAWABLES)
+    {
+        nodes_[nodeIndex].offset_ = begin;
+        nodes_[nodeIndex].count_ = end - begin;
+        return;
+    }
+
+    // Split at the middle of the longest axis of the box centers. If all centers end up on one side, or the hierarchy
+    // has grown too deep from uneven splits, split the range in half instead to keep the depth bounded
+    unsigned middle = begin;
+    if (depth < MAX_SPATIAL_SPLIT_DEPTH)
+    {
+        Vector3 size = centerBox.Size();
+        unsigned axis = size.x_ >= size.y_ && size.x_ >= size.z_ ? 0 : (size.y_ >= size.z_ ? 1 : 2);
+        float split = centerBox.Center().Data()[axis];
+
+        for (unsigned i = begin; i < end; ++i)
+        {
+            if (centers_[i].Data()[axis] < split)
+            {
+                Swap(drawables_[i], drawables_[middle]);
+                Swap(boxes_[i], boxes_[middle]);
+                Swap(centers_[i], centers_[middle]);
+                ++middle;
+            }
+        }
+    }
+    if (middle == begin || middle == end)
+        middle = begin + (end - begin) / 2;
+
+    unsigned children = nodes_.Size();
+    nodes_.Resize(children + 2);
+    nodes_[nodeIndex].offset_ = children;
+    nodes_[nodeIndex].count_ = 0;
+
+    BuildNode(children, begin, middle, depth + 1);
+    BuildNode(children + 1, middle, end, depth + 1);
+}
+
+void DrawableBVH::Refit()
+{
+    // Children are stored after their parents, so a reverse pass visits them first
+    for (unsigned i = nodes_.Size() - 1; i < nodes_.Size(); --i)
+    {
+        BVHNode& node = nodes_[i];
+        BoundingBox box;
+
+        if (node.count_)
+        {
+            for (unsigned j = node.offset_; j < node.offset_ + node.count_; ++j)
+            {
+                if (drawables_[j])
+                    box.Merge(boxes_[j]);
+            }
+        }
+        else
+        {
+            box.Merge(nodes_[node.offset_].box_);
+            box.Merge(nodes_[node.offset_ + 1].box_);
+        }
+
+        node.box_ = box;
+    }
+
+    refitNeeded_ = false;
+}
+
+void DrawableBVH::RaycastSingleRange(RayOctreeQuery& query, unsigned begin, unsigned end, float& closestHit) const
+{
+    for (unsigned i = begin; i < end; ++i)
+    {
+        Drawable* drawable = drawables_[i];
+        if (!drawable || !(drawable->GetDrawableFlags() & query.drawableFlags_) || !(drawable->GetViewMask() & query.viewMask_))
+            continue;
+
+        // Use the same exact box distance as the octree does, so that the same drawables get tested
+        if (query.ray_.HitDistance(boxes_[i]) < Min(closestHit, query.maxDistance_))
+        {
+            unsigned oldSize = query.result_.Size();
+            drawable->ProcessRayQuery(query, query.result_);
+            for (unsigned j = oldSize; j < query.result_.Size(); ++j)
+                closestHit = Min(closestHit, query.result_[j].distance_);
+        }
+    }
+}
+
+}
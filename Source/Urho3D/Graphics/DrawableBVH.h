@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Graphics/OctreeQuery.h"
+
+namespace Urho3D
+{
+
+/// Bounding volume hierarchy node.
+struct BVHNode
+{
+    /// Bounding box of the drawable objects below the node.
+    BoundingBox box_;
+    /// Index of the first child node for an inner node (the second child follows it), or of the first drawable object slot for a leaf.
+    unsigned offset_;
+    /// Number of drawable object slots for a leaf, zero for an inner node.
+    unsigned count_;
+};
+
+/// Bounding volume hierarchy of drawable objects for accelerating raycasts. Refitted from the octree's dirty drawable objects and rebuilt when enough drawable objects have been added or removed.
+class URHO3D_API DrawableBVH
+{
+public:
+    /// Construct.
+    DrawableBVH();
+
+    /// Add a drawable object. It is tested linearly until the next rebuild.
+    void AddDrawable(Drawable* drawable);
+    /// Remove a drawable object.
+    void RemoveDrawable(Drawable* drawable);
+    /// Refresh the bounds of a drawable object that has moved or resized.
+    void UpdateDrawable(Drawable* drawable);
+    /// Rebuild the hierarchy if enough drawable objects have been added or removed, or refit it to the refreshed bounds otherwise.
+    void Update();
+    /// Remove all drawable objects.
+    void Clear();
+
+    /// Return all hits of a ray query in no particular order.
+    void Raycast(RayOctreeQuery& query) const;
+    /// Return hits of a ray query, among which is the closest one. Nodes are visited closest first so that farther drawable objects are skipped.
+    void RaycastSingle(RayOctreeQuery& query) const;
+    /// Return the closest hit for each ray. Rays are traversed in packets of four, so neighbouring rays should be coherent for best performance.
+    void RaycastBatch(const PODVector<Ray>& rays, PODVector<RayQueryResult>& results, RayQueryLevel level, float maxDistance,
+        unsigned char drawableFlags, unsigned viewMask) const;
+
+    /// Return number of drawable objects.
+    unsigned GetNumDrawables() const { return indices_.Size(); }
+    /// Return number of nodes.
+    unsigned GetNumNodes() const { return nodes_.Size(); }
+
+private:
+    /// Rebuild the hierarchy from scratch.
+    void Build();
+    /// Build a node for a range of drawable object slots recursively.
+    void BuildNode(unsigned nodeIndex, unsigned begin, unsigned end, unsigned depth);
+    /// Recalculate node bounding boxes bottom-up.
+    void Refit();
+    /// Test the drawable objects in a range of slots for the closest hit of a ray query.
+    void RaycastSingleRange(RayOctreeQuery& query, unsigned begin, unsigned end, float& closestHit) const;
+
+    /// Nodes, root first. Children are always stored after their parent.
+    PODVector<BVHNode> nodes_;
+    /// Drawable object slots in leaf order. Slots of removed drawable objects are null until the next rebuild.
+    PODVector<Drawable*> drawables_;
+    /// Bounding boxes of the drawable object slots.
+    PODVector<BoundingBox> boxes_;
+    /// Box centers used during build.
+    PODVector<Vector3> centers_;
+    /// Slot indices of the drawable objects.
+    HashMap<Drawable*, unsigned> indices_;
+    /// Number of slots covered by the nodes. The remaining slots hold drawable objects added after the last rebuild.
+    unsigned numIndexed_;
+    /// Number of null slots covered by the nodes.
+    unsigned numRemoved_;
+    /// Refit needed flag.
+    bool refitNeeded_;
+};
+
+}
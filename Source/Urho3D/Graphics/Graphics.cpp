@@ -293,6 +293,11 @@ void Graphics::SetShaderCacheDir(const String& path)
         shaderCacheDir_ = AddTrailingSlash(trimmedPath);
 }
 
+void Graphics::SetShaderProgramCache(bool enable)
+{
+    shaderProgramCache_ = enable;
+}
+
 void Graphics::AddGPUObject(GPUObject* object)
 {
     MutexLock lock(gpuObjectMutex_);
@@ -249,8 +249,10 @@ public:
     void EndDumpShaders();
     /// Precache shader variations from an XML file generated with BeginDumpShaders().
     void PrecacheShaders(Deserializer& source);
-    /// Set shader cache directory, Direct3D only. This can either be an absolute path or a path within the resource system.
+    /// Set shader cache directory for Direct3D shader bytecode and OpenGL program binaries. This can either be an absolute path or a path within the resource system.
     void SetShaderCacheDir(const String& path);
+    /// Set whether to store linked shader programs as program binaries in the shader cache directory and load them instead of compiling when available. Default true. Has no effect on OpenGL ES.
+    void SetShaderProgramCache(bool enable);
 
     /// Return whether rendering initialized.
     bool IsInitialized() const;
@@ -508,9 +510,12 @@ public:
     /// Return whether a custom clipping plane is in use.
     bool GetUseClipPlane() const { return useClipPlane_; }
 
-    /// Return shader cache directory, Direct3D only.
+    /// Return shader cache directory.
     const String& GetShaderCacheDir() const { return shaderCacheDir_; }
 
+    /// Return whether the shader program binary cache is enabled.
+    bool GetShaderProgramCache() const { return shaderProgramCache_; }
+
     /// Return current rendertarget width and height.
     IntVector2 GetRenderTargetDimensions() const;
 
@@ -800,8 +805,10 @@ private:
     const void* shaderParameterSources_[MAX_SHADER_PARAMETER_GROUPS]{};
     /// Base directory for shaders.
     String shaderPath_;
-    /// Cache directory for Direct3D binary shaders.
+    /// Cache directory for Direct3D binary shaders and OpenGL program binaries.
     String shaderCacheDir_;
+    /// Shader program binary cache enable flag.
+    bool shaderProgramCache_{true};
     /// File extension for shaders.
     String shaderExtension_;
     /// Last used shader in shader variation query.
@@ -45,24 +45,11 @@ namespace Urho3D
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
+/// Number of drawables below which a drawable update range is not split further between threads.
+static const unsigned DRAWABLE_UPDATE_GRAIN = 8;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
-void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
-{
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
-
-    while (start != end)
-    {
-        Drawable* drawable = *start;
-        if (drawable)
-            drawable->Update(frame);
-        ++start;
-    }
-}
-
 inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
@@ -85,10 +72,11 @@ Octant::~Octant()
         for (PODVector<Drawable*>::Iterator i = drawables_.Begin(); i != drawables_.End(); ++i)
         {
             (*i)->SetOctant(root_);
-            root_->drawables_.Push(*i);
+            root_->PushDrawable(*i);
             root_->QueueUpdate(*i);
         }
         drawables_.Clear();
+        drawableBounds_.Clear();
         numDrawables_ = 0;
     }
 
@@ -120,7 +108,19 @@ Octant* Octant::GetOrCreateChild(unsigned index)
     else
         newMax.z_ = oldCenter.z_;
 
-    children_[index] = new Octant(BoundingBox(newMin, newMax), level_ + 1, this, root_, index);
+    if (root_ && !root_->freeOctants_.Empty())
+    {
+        Octant* child = root_->freeOctants_.Back();
+        root_->freeOctants_.Pop();
+        child->level_ = level_ + 1;
+        child->parent_ = this;
+        child->index_ = index;
+        child->Initialize(BoundingBox(newMin, newMax));
+        children_[index] = child;
+    }
+    else
+        children_[index] = new Octant(BoundingBox(newMin, newMax), level_ + 1, this, root_, index);
+
     return children_[index];
 }
 
@@ -131,6 +131,19 @@ void Octant::DeleteChild(unsigned index)
     children_[index] = nullptr;
 }
 
+void Octant::ReleaseChild(unsigned index)
+{
+    assert(index < NUM_OCTANTS);
+    Octant* child = children_[index];
+    children_[index] = nullptr;
+
+    // An empty octant has no drawables or child octants left, so it can be reused as is
+    if (child && root_)
+        root_->freeOctants_.Push(child);
+    else
+        delete child;
+}
+
 void Octant::InsertDrawable(Drawable* drawable)
 {
     const BoundingBox& box = drawable->GetWorldBoundingBox();
@@ -149,10 +162,15 @@ void Octant::InsertDrawable(Drawable* drawable)
         if (oldOctant != this)
         {
             // Add first, then remove, because drawable count going to zero deletes the octree branch in question
+            unsigned oldIndex = drawable->octantIndex_;
             AddDrawable(drawable);
             if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
+                oldOctant->RemoveDrawableAt(oldIndex);
+            else
+                root_->AddRaycastDrawable(drawable);
         }
+        else
+            UpdateDrawableBounds(drawable);
     }
     else
     {
@@ -189,6 +207,28 @@ bool Octant::CheckDrawableFit(const BoundingBox& box) const
     return false;
 }
 
+void Octant::RemoveDrawable(Drawable* drawable, bool resetOctant)
+{
+    unsigned index = drawable->octantIndex_;
+    if (index >= drawables_.Size() || drawables_[index] != drawable)
+        return;
+
+    if (resetOctant)
+    {
+        drawable->SetOctant(nullptr);
+        if (root_)
+            root_->RemoveRaycastDrawable(drawable);
+    }
+    RemoveDrawableAt(index);
+}
+
+void Octant::UpdateDrawableBounds(Drawable* drawable)
+{
+    unsigned index = drawable->octantIndex_;
+    if (index < drawables_.Size() && drawables_[index] == drawable)
+        SetDrawableBounds(index, drawable->GetWorldBoundingBox());
+}
+
 void Octant::ResetRoot()
 {
     root_ = nullptr;
@@ -244,7 +284,7 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     {
         auto** start = const_cast<Drawable**>(&drawables_[0]);
         Drawable** end = start + drawables_.Size();
-        query.TestDrawables(start, end, inside);
+        query.TestDrawableBounds(start, end, &drawableBounds_[0], inside);
     }
 
     for (auto child : children_)
@@ -308,10 +348,71 @@ void Octant::GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*
     }
 }
 
+void Octant::GetAllDrawablesInternal(PODVector<Drawable*>& drawables) const
+{
+    drawables.Push(drawables_);
+
+    for (auto child : children_)
+    {
+        if (child)
+            child->GetAllDrawablesInternal(drawables);
+    }
+}
+
+void Octant::PushDrawable(Drawable* drawable)
+{
+    unsigned index = drawables_.Size();
+    drawable->octantIndex_ = index;
+    drawables_.Push(drawable);
+
+    if (index % BOX_SOA_GROUP_SIZE == 0)
+    {
+        unsigned groupStart = drawableBounds_.Size();
+        drawableBounds_.Resize(groupStart + BOX_SOA_GROUP_FLOATS);
+        memset(&drawableBounds_[groupStart], 0, BOX_SOA_GROUP_FLOATS * sizeof(float));
+    }
+    SetDrawableBounds(index, drawable->GetWorldBoundingBox());
+}
+
+void Octant::RemoveDrawableAt(unsigned index)
+{
+    // Move the last drawable object into the freed slot
+    unsigned last = drawables_.Size() - 1;
+    if (index != last)
+    {
+        Drawable* moved = drawables_[last];
+        drawables_[index] = moved;
+        moved->octantIndex_ = index;
+
+        const float* src = &drawableBounds_[(last / BOX_SOA_GROUP_SIZE) * BOX_SOA_GROUP_FLOATS + last % BOX_SOA_GROUP_SIZE];
+        float* dest = &drawableBounds_[(index / BOX_SOA_GROUP_SIZE) * BOX_SOA_GROUP_FLOATS + index % BOX_SOA_GROUP_SIZE];
+        for (unsigned i = 0; i < BOX_SOA_GROUP_FLOATS; i += BOX_SOA_GROUP_SIZE)
+            dest[i] = src[i];
+    }
+
+    drawables_.Pop();
+    if (drawables_.Size() % BOX_SOA_GROUP_SIZE == 0)
+        drawableBounds_.Resize(drawableBounds_.Size() - BOX_SOA_GROUP_FLOATS);
+
+    DecDrawableCount();
+}
+
+void Octant::SetDrawableBounds(unsigned index, const BoundingBox& box)
+{
+    float* dest = &drawableBounds_[(index / BOX_SOA_GROUP_SIZE) * BOX_SOA_GROUP_FLOATS + index % BOX_SOA_GROUP_SIZE];
+    dest[0] = box.min_.x_;
+    dest[BOX_SOA_GROUP_SIZE] = box.min_.y_;
+    dest[2 * BOX_SOA_GROUP_SIZE] = box.min_.z_;
+    dest[3 * BOX_SOA_GROUP_SIZE] = box.max_.x_;
+    dest[4 * BOX_SOA_GROUP_SIZE] = box.max_.y_;
+    dest[5 * BOX_SOA_GROUP_SIZE] = box.max_.z_;
+}
+
 Octree::Octree(Context* context) :
     Component(context),
     Octant(BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), 0, nullptr, this),
-    numLevels_(DEFAULT_OCTREE_LEVELS)
+    numLevels_(DEFAULT_OCTREE_LEVELS),
+    raycastBVHDirty_(false)
 {
     // If the engine is running headless, subscribe to RenderUpdate events for manually updating the octree
     // to allow raycasts and animation update
@@ -323,7 +424,11 @@ Octree::~Octree()
 {
     // Reset root pointer from all child octants now so that they do not move their drawables to root
     drawableUpdates_.Clear();
+    boundsUpdates_.Clear();
     ResetRoot();
+
+    for (PODVector<Octant*>::Iterator i = freeOctants_.Begin(); i != freeOctants_.End(); ++i)
+        delete *i;
 }
 
 void Octree::RegisterObject(Context* context)
@@ -336,6 +441,7 @@ void Octree::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE_EX("Bounding Box Min", Vector3, worldBoundingBox_.min_, UpdateOctreeSize, defaultBoundsMin, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Bounding Box Max", Vector3, worldBoundingBox_.max_, UpdateOctreeSize, defaultBoundsMax, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Number of Levels", int, numLevels_, UpdateOctreeSize, DEFAULT_OCTREE_LEVELS, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Raycast BVH", GetRaycastBVH, SetRaycastBVH, bool, false, AM_DEFAULT);
 }
 
 void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -380,30 +486,18 @@ void Octree::Update(const FrameInfo& frame)
         auto* queue = GetSubsystem<WorkQueue>();
         scene->BeginThreadedUpdate();
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.Size() / numWorkItems), 1);
-
-        PODVector<Drawable*>::Iterator start = drawableUpdates_.Begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
+        // Animated models sample their animations and compute skinning here, so their cost varies a lot. Split the
+        // updates into small ranges that idle threads can steal instead of giving each thread a fixed share
+        Drawable** drawables = drawableUpdates_.Buffer();
+        queue->ParallelFor(drawableUpdates_.Size(), DRAWABLE_UPDATE_GRAIN, [drawables, &frame](unsigned begin, unsigned end, unsigned)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
-
-            PODVector<Drawable*>::Iterator end = drawableUpdates_.End();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
+            for (unsigned i = begin; i < end; ++i)
+            {
+                if (drawables[i])
+                    drawables[i]->Update(frame);
+            }
+        });
 
-        queue->Complete(M_MAX_UNSIGNED);
         scene->EndThreadedUpdate();
     }
 
@@ -437,6 +531,24 @@ void Octree::Update(const FrameInfo& frame)
         scene->SendEvent(E_SCENEDRAWABLEUPDATEFINISHED, eventData);
     }
 
+    // Drawables whose bounding box changed outside the update, for example by facing the camera, go through reinsertion
+    // as well to refresh their culling bounds
+    if (!boundsUpdates_.Empty())
+    {
+        for (PODVector<Drawable*>::ConstIterator i = boundsUpdates_.Begin(); i != boundsUpdates_.End(); ++i)
+        {
+            Drawable* drawable = *i;
+            drawable->boundsUpdateQueued_ = false;
+            if (!drawable->updateQueued_)
+            {
+                drawable->updateQueued_ = true;
+                drawableUpdates_.Push(drawable);
+            }
+        }
+
+        boundsUpdates_.Clear();
+    }
+
     // Reinsert drawables that have been moved or resized, or that have been newly added to the octree and do not sit inside
     // the proper octant yet
     if (!drawableUpdates_.Empty())
@@ -453,9 +565,12 @@ void Octree::Update(const FrameInfo& frame)
             // Skip if no octant or does not belong to this octree anymore
             if (!octant || octant->GetRoot() != this)
                 continue;
-            // Skip if still fits the current octant
+            // Skip if still fits the current octant, only refreshing the culling bounds
             if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
+            {
+                octant->UpdateDrawableBounds(drawable);
                 continue;
+            }
 
             InsertDrawable(drawable);
 
@@ -471,6 +586,8 @@ void Octree::Update(const FrameInfo& frame)
         }
     }
 
+    raycastBVHDirty_ = true;
+    UpdateRaycastBVH();
     drawableUpdates_.Clear();
 }
 
@@ -480,6 +597,7 @@ void Octree::AddManualDrawable(Drawable* drawable)
         return;
 
     AddDrawable(drawable);
+    AddRaycastDrawable(drawable);
 }
 
 void Octree::RemoveManualDrawable(Drawable* drawable)
@@ -503,7 +621,13 @@ void Octree::Raycast(RayOctreeQuery& query) const
     URHO3D_PROFILE(Raycast);
 
     query.result_.Clear();
-    GetDrawablesInternal(query);
+    if (raycastBVH_)
+    {
+        UpdateRaycastBVH();
+        raycastBVH_->Raycast(query);
+    }
+    else
+        GetDrawablesInternal(query);
     Sort(query.result_.Begin(), query.result_.End(), CompareRayQueryResults);
 }
 
@@ -512,32 +636,41 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
     URHO3D_PROFILE(Raycast);
 
     query.result_.Clear();
-    rayQueryDrawables_.Clear();
-    GetDrawablesOnlyInternal(query, rayQueryDrawables_);
 
-    // Sort by increasing hit distance to AABB
-    for (PODVector<Drawable*>::Iterator i = rayQueryDrawables_.Begin(); i != rayQueryDrawables_.End(); ++i)
+    if (raycastBVH_)
     {
-        Drawable* drawable = *i;
-        drawable->SetSortValue(query.ray_.HitDistance(drawable->GetWorldBoundingBox()));
+        UpdateRaycastBVH();
+        raycastBVH_->RaycastSingle(query);
     }
+    else
+    {
+        rayQueryDrawables_.Clear();
+        GetDrawablesOnlyInternal(query, rayQueryDrawables_);
+
+        // Sort by increasing hit distance to AABB
+        for (PODVector<Drawable*>::Iterator i = rayQueryDrawables_.Begin(); i != rayQueryDrawables_.End(); ++i)
+        {
+            Drawable* drawable = *i;
+            drawable->SetSortValue(query.ray_.HitDistance(drawable->GetWorldBoundingBox()));
+        }
 
-    Sort(rayQueryDrawables_.Begin(), rayQueryDrawables_.End(), CompareDrawables);
+        Sort(rayQueryDrawables_.Begin(), rayQueryDrawables_.End(), CompareDrawables);
 
-    // Then do the actual test according to the query, and early-out as possible
-    float closestHit = M_INFINITY;
-    for (PODVector<Drawable*>::Iterator i = rayQueryDrawables_.Begin(); i != rayQueryDrawables_.End(); ++i)
-    {
-        Drawable* drawable = *i;
-        if (drawable->GetSortValue() < Min(closestHit, query.maxDistance_))
+        // Then do the actual test according to the query, and early-out as possible
+        float closestHit = M_INFINITY;
+        for (PODVector<Drawable*>::Iterator i = rayQueryDrawables_.Begin(); i != rayQueryDrawables_.End(); ++i)
         {
-            unsigned oldSize = query.result_.Size();
-            drawable->ProcessRayQuery(query, query.result_);
-            if (query.result_.Size() > oldSize)
-                closestHit = Min(closestHit, query.result_.Back().distance_);
+            Drawable* drawable = *i;
+            if (drawable->GetSortValue() < Min(closestHit, query.maxDistance_))
+            {
+                unsigned oldSize = query.result_.Size();
+                drawable->ProcessRayQuery(query, query.result_);
+                if (query.result_.Size() > oldSize)
+                    closestHit = Min(closestHit, query.result_.Back().distance_);
+            }
+            else
+                break;
         }
-        else
-            break;
     }
 
     if (query.result_.Size() > 1)
@@ -547,6 +680,53 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
     }
 }
 
+void Octree::RaycastBatch(const PODVector<Ray>& rays, PODVector<RayQueryResult>& results, RayQueryLevel level, float maxDistance,
+    unsigned char drawableFlags, unsigned viewMask) const
+{
+    URHO3D_PROFILE(RaycastBatch);
+
+    if (raycastBVH_)
+    {
+        UpdateRaycastBVH();
+        raycastBVH_->RaycastBatch(rays, results, level, maxDistance, drawableFlags, viewMask);
+        return;
+    }
+
+    PODVector<RayQueryResult> rayResults;
+    results.Resize(rays.Size());
+    for (unsigned i = 0; i < rays.Size(); ++i)
+    {
+        RayOctreeQuery query(rayResults, rays[i], level, maxDistance, drawableFlags, viewMask);
+        RaycastSingle(query);
+        if (rayResults.Size())
+            results[i] = rayResults[0];
+        else
+        {
+            results[i] = RayQueryResult();
+            results[i].distance_ = M_INFINITY;
+        }
+    }
+}
+
+void Octree::SetRaycastBVH(bool enable)
+{
+    if (enable == raycastBVH_.NotNull())
+        return;
+
+    if (enable)
+    {
+        raycastBVH_ = new DrawableBVH();
+
+        PODVector<Drawable*> drawables;
+        GetAllDrawablesInternal(drawables);
+        for (PODVector<Drawable*>::ConstIterator i = drawables.Begin(); i != drawables.End(); ++i)
+            raycastBVH_->AddDrawable(*i);
+        raycastBVH_->Update();
+    }
+    else
+        raycastBVH_.Reset();
+}
+
 void Octree::QueueUpdate(Drawable* drawable)
 {
     Scene* scene = GetScene();
@@ -559,14 +739,48 @@ void Octree::QueueUpdate(Drawable* drawable)
         drawableUpdates_.Push(drawable);
 
     drawable->updateQueued_ = true;
+    raycastBVHDirty_ = true;
+}
+
+void Octree::QueueBoundsUpdate(Drawable* drawable)
+{
+    MutexLock lock(octreeMutex_);
+
+    if (!drawable->boundsUpdateQueued_)
+    {
+        boundsUpdates_.Push(drawable);
+        drawable->boundsUpdateQueued_ = true;
+    }
 }
 
 void Octree::CancelUpdate(Drawable* drawable)
 {
     // This doesn't have to take into account scene being in threaded update, because it is called only
     // when removing a drawable from octree, which should only ever happen from the main thread.
-    drawableUpdates_.Remove(drawable);
+    if (drawable->updateQueued_)
+        drawableUpdates_.Remove(drawable);
+    if (drawable->boundsUpdateQueued_)
+        boundsUpdates_.Remove(drawable);
     drawable->updateQueued_ = false;
+    drawable->boundsUpdateQueued_ = false;
+}
+
+void Octree::AddRaycastDrawable(Drawable* drawable)
+{
+    if (raycastBVH_)
+    {
+        raycastBVH_->AddDrawable(drawable);
+        raycastBVHDirty_ = true;
+    }
+}
+
+void Octree::RemoveRaycastDrawable(Drawable* drawable)
+{
+    if (raycastBVH_)
+    {
+        raycastBVH_->RemoveDrawable(drawable);
+        raycastBVHDirty_ = true;
+    }
 }
 
 void Octree::DrawDebugGeometry(bool depthTest)
@@ -575,6 +789,20 @@ void Octree::DrawDebugGeometry(bool depthTest)
     DrawDebugGeometry(debug, depthTest);
 }
 
+void Octree::UpdateRaycastBVH() const
+{
+    // Worker threads may only read the BVH as it is
+    if (!raycastBVH_ || !raycastBVHDirty_ || !Thread::IsMainThread())
+        return;
+
+    // Drawables queued for update may have moved since the last octree update. Refresh their bounds so that raycasts
+    // in between see them where they are now
+    for (PODVector<Drawable*>::ConstIterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+        raycastBVH_->UpdateDrawable(*i);
+    raycastBVH_->Update();
+    raycastBVHDirty_ = false;
+}
+
 void Octree::HandleRenderUpdate(StringHash eventType, VariantMap& eventData)
 {
     // When running in headless mode, update the Octree manually during the RenderUpdate event
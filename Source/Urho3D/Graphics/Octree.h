@@ -25,8 +25,11 @@
 #include "../Container/List.h"
 #include "../Core/Mutex.h"
 #include "../Graphics/Drawable.h"
+#include "../Graphics/DrawableBVH.h"
 #include "../Graphics/OctreeQuery.h"
 
+#include <atomic>
+
 namespace Urho3D
 {
 
@@ -48,6 +51,8 @@ public:
     Octant* GetOrCreateChild(unsigned index);
     /// Delete child octant.
     void DeleteChild(unsigned index);
+    /// Detach an empty child octant and return it to the octree for reuse.
+    void ReleaseChild(unsigned index);
     /// Insert a drawable object by checking for fit recursively.
     void InsertDrawable(Drawable* drawable);
     /// Check if a drawable object fits.
@@ -57,20 +62,14 @@ public:
     void AddDrawable(Drawable* drawable)
     {
         drawable->SetOctant(this);
-        drawables_.Push(drawable);
+        PushDrawable(drawable);
         IncDrawableCount();
     }
 
     /// Remove a drawable object from this octant.
-    void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
-    {
-        if (drawables_.Remove(drawable))
-        {
-            if (resetOctant)
-                drawable->SetOctant(nullptr);
-            DecDrawableCount();
-        }
-    }
+    void RemoveDrawable(Drawable* drawable, bool resetOctant = true);
+    /// Refresh the culling bounds of a drawable object in this octant from its world bounding box.
+    void UpdateDrawableBounds(Drawable* drawable);
 
     /// Return world-space bounding box.
     const BoundingBox& GetWorldBoundingBox() const { return worldBoundingBox_; }
@@ -107,6 +106,14 @@ protected:
     void GetDrawablesInternal(RayOctreeQuery& query) const;
     /// Return drawable objects only for a threaded ray query, called internally.
     void GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*>& drawables) const;
+    /// Return all drawable objects regardless of flags, called internally.
+    void GetAllDrawablesInternal(PODVector<Drawable*>& drawables) const;
+    /// Append a drawable object and its culling bounds without changing the drawable counts.
+    void PushDrawable(Drawable* drawable);
+    /// Remove the drawable object in a slot without resetting its octant.
+    void RemoveDrawableAt(unsigned index);
+    /// Write the culling bounds of a drawable object slot.
+    void SetDrawableBounds(unsigned index, const BoundingBox& box);
 
     /// Increase drawable object count recursively.
     void IncDrawableCount()
@@ -125,7 +132,7 @@ protected:
         if (!numDrawables_)
         {
             if (parent)
-                parent->DeleteChild(index_);
+                parent->ReleaseChild(index_);
         }
 
         if (parent)
@@ -138,6 +145,8 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     PODVector<Drawable*> drawables_;
+    /// World bounding boxes of the drawable objects in structure-of-arrays groups for SIMD culling, in the same order as the drawable objects.
+    PODVector<float> drawableBounds_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS]{};
     /// World bounding box center.
@@ -161,6 +170,8 @@ class URHO3D_API Octree : public Component, public Octant
 {
     URHO3D_OBJECT(Octree, Component);
 
+    friend class Octant;
+
 public:
     /// Construct.
     explicit Octree(Context* context);
@@ -187,14 +198,29 @@ public:
     void Raycast(RayOctreeQuery& query) const;
     /// Return the closest drawable object by a ray query.
     void RaycastSingle(RayOctreeQuery& query) const;
+    /// Return the closest hit for each ray of a batch. Rays that hit nothing get a result with null drawable and infinite distance. With the raycast BVH enabled, coherent rays are traversed in packets.
+    void RaycastBatch(const PODVector<Ray>& rays, PODVector<RayQueryResult>& results, RayQueryLevel level = RAY_TRIANGLE,
+        float maxDistance = M_INFINITY, unsigned char drawableFlags = DRAWABLE_ANY, unsigned viewMask = DEFAULT_VIEWMASK) const;
+    /// Set whether raycasts use a bounding volume hierarchy instead of the octants.
+    void SetRaycastBVH(bool enable);
 
     /// Return subdivision levels.
     unsigned GetNumLevels() const { return numLevels_; }
+    /// Return whether raycasts use a bounding volume hierarchy.
+    bool GetRaycastBVH() const { return raycastBVH_.NotNull(); }
 
     /// Mark drawable object as requiring an update and a reinsertion.
     void QueueUpdate(Drawable* drawable);
+    /// Mark drawable object as requiring its culling bounds to be refreshed on the next update. Can be called from worker threads.
+    void QueueBoundsUpdate(Drawable* drawable);
     /// Cancel drawable object's update.
     void CancelUpdate(Drawable* drawable);
+    /// Add a drawable object that entered the octree to the raycast BVH. Called internally.
+    void AddRaycastDrawable(Drawable* drawable);
+    /// Remove a drawable object that left the octree from the raycast BVH. Called internally.
+    void RemoveRaycastDrawable(Drawable* drawable);
+    /// Mark the raycast BVH as needing a refresh from the drawable objects queued for update. Called internally when an already queued drawable object changes again.
+    void MarkRaycastBVHDirty() { raycastBVHDirty_ = true; }
     /// Visualize the component as debug geometry.
     void DrawDebugGeometry(bool depthTest);
 
@@ -203,17 +229,27 @@ private:
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
     /// Update octree size.
     void UpdateOctreeSize() { SetSize(worldBoundingBox_, numLevels_); }
+    /// Bring the raycast BVH up to date with the drawable objects queued for update.
+    void UpdateRaycastBVH() const;
 
     /// Drawable objects that require update.
     PODVector<Drawable*> drawableUpdates_;
     /// Drawable objects that were inserted during threaded update phase.
     PODVector<Drawable*> threadedDrawableUpdates_;
+    /// Drawable objects whose bounding box changed outside the octree update.
+    PODVector<Drawable*> boundsUpdates_;
     /// Mutex for octree reinsertions.
     Mutex octreeMutex_;
+    /// Released child octants for reuse, so that drawables moving between octants do not allocate.
+    PODVector<Octant*> freeOctants_;
     /// Ray query temporary list of drawables.
     mutable PODVector<Drawable*> rayQueryDrawables_;
+    /// Bounding volume hierarchy for raycasts, or null if disabled.
+    mutable UniquePtr<DrawableBVH> raycastBVH_;
     /// Subdivision level.
     unsigned numLevels_;
+    /// Raycast BVH refresh needed flag. Set also by worker threads during threaded scene update.
+    mutable std::atomic<bool> raycastBVHDirty_;
 };
 
 }
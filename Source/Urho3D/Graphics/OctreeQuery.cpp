@@ -117,6 +117,38 @@ void FrustumOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool in
     }
 }
 
+void FrustumOctreeQuery::TestDrawableBounds(Drawable** start, Drawable** end, const float* bounds, bool inside)
+{
+    if (inside)
+    {
+        TestDrawables(start, end, true);
+        return;
+    }
+
+    // Test a group of boxes at a time and pass on runs of drawables that are not outside
+    auto count = (unsigned)(end - start);
+    unsigned runStart = 0;
+
+    for (unsigned group = 0; group * BOX_SOA_GROUP_SIZE < count; ++group)
+    {
+        unsigned mask = frustum_.IsInsideFastSoA(bounds + group * BOX_SOA_GROUP_FLOATS);
+        unsigned groupEnd = Min((group + 1) * BOX_SOA_GROUP_SIZE, count);
+
+        for (unsigned i = group * BOX_SOA_GROUP_SIZE; i < groupEnd; ++i)
+        {
+            if (!(mask & (1u << (i % BOX_SOA_GROUP_SIZE))))
+            {
+                if (runStart < i)
+                    TestDrawables(start + runStart, start + i, true);
+                runStart = i + 1;
+            }
+        }
+    }
+
+    if (runStart < count)
+        TestDrawables(start + runStart, end, true);
+}
+
 
 Intersection AllContentOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
@@ -58,6 +58,8 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Intersection test for drawables whose world bounding boxes are also given in structure-of-arrays groups. By default ignores the boxes.
+    virtual void TestDrawableBounds(Drawable** start, Drawable** end, const float* /*bounds*/, bool inside) { TestDrawables(start, end, inside); }
 
     /// Result vector reference.
     PODVector<Drawable*>& result_;
@@ -146,6 +148,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables using their structure-of-arrays bounding boxes. Drawables not outside the frustum are passed on to TestDrawables as inside.
+    void TestDrawableBounds(Drawable** start, Drawable** end, const float* bounds, bool inside) override;
 
     /// Frustum.
     Frustum frustum_;
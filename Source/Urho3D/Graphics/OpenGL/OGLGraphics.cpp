@@ -1038,8 +1038,27 @@ void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
     if (vs == vertexShader_ && ps == pixelShader_)
         return;
 
+    ShaderVariation* requestedVs = vs;
+    ShaderVariation* requestedPs = ps;
+
+    // A program from the program binary cache needs no compiled shaders, so look for it first. A combination that failed
+    // to link or compile is also found in the programs, and is not retried
+    bool programExists = vs && ps && impl_->shaderPrograms_.Contains(MakePair(vs, ps));
+    if (vs && ps && !programExists && shaderProgramCache_ && (!vs->GetGPUObjectName() || !ps->GetGPUObjectName()))
+    {
+        URHO3D_PROFILE(LoadShaderProgramBinary);
+
+        SharedPtr<ShaderProgram> newProgram(new ShaderProgram(this, vs, ps));
+        if (newProgram->LoadBinary())
+        {
+            URHO3D_LOGDEBUG("Loaded program binary of vertex shader " + vs->GetFullName() + " and pixel shader " + ps->GetFullName());
+            impl_->shaderPrograms_[MakePair(vs, ps)] = newProgram;
+            programExists = true;
+        }
+    }
+
     // Compile the shaders now if not yet compiled. If already attempted, do not retry
-    if (vs && !vs->GetGPUObjectName())
+    if (vs && !vs->GetGPUObjectName() && !programExists)
     {
         if (vs->GetCompilerOutput().Empty())
         {
@@ -1058,7 +1077,7 @@ void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
             vs = nullptr;
     }
 
-    if (ps && !ps->GetGPUObjectName())
+    if (ps && !ps->GetGPUObjectName() && !programExists)
     {
         if (ps->GetCompilerOutput().Empty())
         {
@@ -1077,6 +1096,11 @@ void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
             ps = nullptr;
     }
 
+    // Remember a combination that failed to compile like one that failed to link, so that the program binary cache is
+    // not searched again on each call. The entry is removed if either shader is released for reloading
+    if ((!vs || !ps) && requestedVs && requestedPs && !programExists)
+        impl_->shaderPrograms_[MakePair(requestedVs, requestedPs)] = new ShaderProgram(this, requestedVs, requestedPs);
+
     if (!vs || !ps)
     {
         glUseProgram(0);
@@ -1118,6 +1142,8 @@ void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
                 // Note: Link() calls glUseProgram() to set the texture sampler uniforms,
                 // so it is not necessary to call it again
                 impl_->shaderProgram_ = newProgram;
+                if (shaderProgramCache_)
+                    newProgram->SaveBinary();
             }
             else
             {
@@ -2765,6 +2791,20 @@ void Graphics::CheckFeatureSupport()
         glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS_EXT, &numSupportedRTs);
     }
 
+    // Program binaries are valid only for the driver that produced them, so identify it for the program binary cache.
+    // Linking sets the retrievable hint with glProgramParameteri, so it is required too
+    impl_->programBinaryDriver_.Clear();
+    if (glGetProgramBinary && glProgramBinary && glProgramParameteri)
+    {
+        int numBinaryFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+        if (numBinaryFormats > 0)
+        {
+            impl_->programBinaryDriver_ = String((const char*)glGetString(GL_VENDOR)) + " " +
+                String((const char*)glGetString(GL_RENDERER)) + " " + String((const char*)glGetString(GL_VERSION));
+        }
+    }
+
     // Must support 2 rendertargets for light pre-pass, and 4 for deferred
     if (numSupportedRTs >= 2)
         lightPrepassSupport_ = true;
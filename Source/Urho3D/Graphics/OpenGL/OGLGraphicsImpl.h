@@ -112,6 +112,8 @@ public:
 
     /// Return the GL Context.
     const SDL_GLContext& GetGLContext() { return context_; }
+    /// Return the driver identification for the program binary cache, or empty if program binaries are not supported.
+    const String& GetProgramBinaryDriver() const { return programBinaryDriver_; }
 
 private:
     /// SDL OpenGL context.
@@ -158,6 +160,8 @@ private:
     ShaderProgram* shaderProgram_{};
     /// Linked shader programs.
     ShaderProgramMap shaderPrograms_;
+    /// Driver identification for the program binary cache. Empty if program binaries are not supported.
+    String programBinaryDriver_;
     /// Need FBO commit flag.
     bool fboDirty_{};
     /// Need vertex attribute pointer update flag.
@@ -27,6 +27,8 @@
 #include "../../Graphics/GraphicsImpl.h"
 #include "../../Graphics/ShaderProgram.h"
 #include "../../Graphics/ShaderVariation.h"
+#include "../../IO/File.h"
+#include "../../IO/FileSystem.h"
 #include "../../IO/Log.h"
 
 #include "../../DebugNew.h"
@@ -124,6 +126,12 @@ bool ShaderProgram::Link()
         return false;
     }
 
+#ifndef GL_ES_VERSION_2_0
+    // Allow retrieving the binary for the program binary cache, if the driver supports the hint
+    if (graphics_->GetShaderProgramCache() && !graphics_->GetImpl()->GetProgramBinaryDriver().Empty() && glProgramParameteri)
+        glProgramParameteri(object_.name_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+
     glAttachShader(object_.name_, vertexShader_->GetGPUObjectName());
     glAttachShader(object_.name_, pixelShader_->GetGPUObjectName());
     glLinkProgram(object_.name_);
@@ -145,6 +153,112 @@ bool ShaderProgram::Link()
     if (!object_.name_)
         return false;
 
+    ExamineProgram();
+    return true;
+}
+
+bool ShaderProgram::LoadBinary()
+{
+#ifndef GL_ES_VERSION_2_0
+    Release();
+
+    String fileName = GetBinaryFileName();
+    if (fileName.Empty() || !graphics_->GetSubsystem<FileSystem>()->FileExists(fileName))
+        return false;
+
+    File file(graphics_->GetContext(), fileName);
+    if (!file.IsOpen() || file.ReadFileID() != "UGLP")
+        return false;
+
+    // Check that the binary was made by the same driver from the same sources, as it is invalid otherwise
+    if (file.ReadString() != graphics_->GetImpl()->GetProgramBinaryDriver() || file.ReadString() != vertexShader_->GetFullName() ||
+        file.ReadString() != pixelShader_->GetFullName() || file.ReadUInt() != vertexSourceHash_ || file.ReadUInt() != pixelSourceHash_)
+        return false;
+
+    auto format = (GLenum)file.ReadUInt();
+    PODVector<unsigned char> binary = file.ReadBuffer();
+    if (binary.Empty())
+        return false;
+
+    object_.name_ = glCreateProgram();
+    if (!object_.name_)
+        return false;
+
+    glProgramBinary(object_.name_, format, &binary[0], (GLsizei)binary.Size());
+
+    // The driver may reject the binary for example after an update, in which case the shaders are compiled as usual
+    int linked;
+    glGetProgramiv(object_.name_, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        glDeleteProgram(object_.name_);
+        object_.name_ = 0;
+        return false;
+    }
+
+    linkerOutput_.Clear();
+    ExamineProgram();
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ShaderProgram::SaveBinary()
+{
+#ifndef GL_ES_VERSION_2_0
+    if (!object_.name_)
+        return false;
+
+    String fileName = GetBinaryFileName();
+    if (fileName.Empty())
+        return false;
+
+    int length = 0;
+    glGetProgramiv(object_.name_, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return false;
+
+    PODVector<unsigned char> binary((unsigned)length);
+    GLenum format = 0;
+    glGetProgramBinary(object_.name_, length, &length, &format, &binary[0]);
+    if (length <= 0)
+        return false;
+    binary.Resize((unsigned)length);
+
+    graphics_->GetSubsystem<FileSystem>()->CreateDir(GetPath(fileName));
+    File file(graphics_->GetContext(), fileName, FILE_WRITE);
+    if (!file.IsOpen())
+        return false;
+
+    file.WriteFileID("UGLP");
+    file.WriteString(graphics_->GetImpl()->GetProgramBinaryDriver());
+    file.WriteString(vertexShader_->GetFullName());
+    file.WriteString(pixelShader_->GetFullName());
+    file.WriteUInt(vertexSourceHash_);
+    file.WriteUInt(pixelSourceHash_);
+    file.WriteUInt(format);
+    return file.WriteBuffer(binary);
+#else
+    return false;
+#endif
+}
+
+String ShaderProgram::GetBinaryFileName()
+{
+    if (!vertexShader_ || !pixelShader_ || !graphics_->GetShaderProgramCache() || graphics_->GetShaderCacheDir().Empty() ||
+        graphics_->GetImpl()->GetProgramBinaryDriver().Empty())
+        return String::EMPTY;
+
+    // The source code includes all defines, so equal hashes mean equal variations
+    vertexSourceHash_ = vertexShader_->GetFullSourceCode().ToHash();
+    pixelSourceHash_ = pixelShader_->GetFullSourceCode().ToHash();
+
+    return graphics_->GetShaderCacheDir() + ToStringHex(vertexSourceHash_) + ToStringHex(pixelSourceHash_) + ".glp";
+}
+
+void ShaderProgram::ExamineProgram()
+{
     const int MAX_NAME_LENGTH = 256;
     char nameBuffer[MAX_NAME_LENGTH];
     int attributeCount, uniformCount, elementCount, nameLength;
@@ -313,8 +427,6 @@ bool ShaderProgram::Link()
     // Rehash the parameter & vertex attributes maps to ensure minimal load factor
     vertexAttributes_.Rehash(NextPowerOfTwo(vertexAttributes_.Size()));
     shaderParameters_.Rehash(NextPowerOfTwo(shaderParameters_.Size()));
-
-    return true;
 }
 
 ShaderVariation* ShaderProgram::GetVertexShader() const
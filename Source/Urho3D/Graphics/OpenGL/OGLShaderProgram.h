@@ -50,6 +50,10 @@ public:
 
     /// Link the shaders and examine the uniforms and samplers used. Return true if successful.
     bool Link();
+    /// Create the program from the program binary cache without compiling the shaders, and examine the uniforms and samplers used. Return true if successful.
+    bool LoadBinary();
+    /// Store the linked program into the program binary cache. Return true if successful.
+    bool SaveBinary();
 
     /// Return the vertex shader.
     ShaderVariation* GetVertexShader() const;
@@ -87,6 +91,11 @@ public:
     static void ClearGlobalParameterSource(ShaderParameterGroup group);
 
 private:
+    /// Examine the vertex attributes, uniforms and samplers of the linked program.
+    void ExamineProgram();
+    /// Calculate the shader source hashes and return the program binary cache file name, or empty if the cache can not be used.
+    String GetBinaryFileName();
+
     /// Vertex shader.
     WeakPtr<ShaderVariation> vertexShader_;
     /// Pixel shader.
@@ -105,6 +114,10 @@ private:
     const void* parameterSources_[MAX_SHADER_PARAMETER_GROUPS]{};
     /// Shader link error string.
     String linkerOutput_;
+    /// Hash of the vertex shader source code, used for program binary cache validation.
+    unsigned vertexSourceHash_{};
+    /// Hash of the pixel shader source code, used for program binary cache validation.
+    unsigned pixelSourceHash_{};
     /// Shader parameter source framenumber.
     unsigned frameNumber_{};
 
@@ -80,6 +80,13 @@ void ShaderVariation::Release()
         object_.name_ = 0;
         graphics_->CleanupShaderPrograms(this);
     }
+    else if (graphics_)
+    {
+        // The variation may be in use by programs loaded from the program binary cache without compiling it
+        if (graphics_->GetVertexShader() == this || graphics_->GetPixelShader() == this)
+            graphics_->SetShaders(nullptr, nullptr);
+        graphics_->CleanupShaderPrograms(this);
+    }
 
     compilerOutput_.Clear();
 }
@@ -101,6 +108,33 @@ bool ShaderVariation::Create()
         return false;
     }
 
+    String shaderCode = GetFullSourceCode();
+    const char* shaderCStr = shaderCode.CString();
+    glShaderSource(object_.name_, 1, &shaderCStr, nullptr);
+    glCompileShader(object_.name_);
+
+    int compiled, length;
+    glGetShaderiv(object_.name_, GL_COMPILE_STATUS, &compiled);
+    if (!compiled)
+    {
+        glGetShaderiv(object_.name_, GL_INFO_LOG_LENGTH, &length);
+        compilerOutput_.Resize((unsigned)length);
+        int outLength;
+        glGetShaderInfoLog(object_.name_, length, &outLength, &compilerOutput_[0]);
+        glDeleteShader(object_.name_);
+        object_.name_ = 0;
+    }
+    else
+        compilerOutput_.Clear();
+
+    return object_.name_ != 0;
+}
+
+String ShaderVariation::GetFullSourceCode() const
+{
+    if (!owner_)
+        return String::EMPTY;
+
     const String& originalShaderCode = owner_->GetSourceCode(type_);
     String shaderCode;
 
@@ -162,25 +196,7 @@ bool ShaderVariation::Create()
     else
         shaderCode += originalShaderCode;
 
-    const char* shaderCStr = shaderCode.CString();
-    glShaderSource(object_.name_, 1, &shaderCStr, nullptr);
-    glCompileShader(object_.name_);
-
-    int compiled, length;
-    glGetShaderiv(object_.name_, GL_COMPILE_STATUS, &compiled);
-    if (!compiled)
-    {
-        glGetShaderiv(object_.name_, GL_INFO_LOG_LENGTH, &length);
-        compilerOutput_.Resize((unsigned)length);
-        int outLength;
-        glGetShaderInfoLog(object_.name_, length, &outLength, &compilerOutput_[0]);
-        glDeleteShader(object_.name_);
-        object_.name_ = 0;
-    }
-    else
-        compilerOutput_.Clear();
-
-    return object_.name_ != 0;
+    return shaderCode;
 }
 
 void ShaderVariation::SetDefines(const String& defines)
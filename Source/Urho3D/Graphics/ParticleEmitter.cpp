@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DrawableEvents.h"
 #include "../Graphics/ParticleEffect.h"
 #include "../Graphics/ParticleEmitter.h"
@@ -32,6 +33,12 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#include <atomic>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -40,14 +47,63 @@ namespace Urho3D
 extern const char* GEOMETRY_CATEGORY;
 extern const char* faceCameraModeNames[];
 static const unsigned MAX_PARTICLES_IN_FRAME = 100;
+/// Number of four-particle groups under which a particle update range is not split between threads.
+static const unsigned PARTICLE_UPDATE_GRAIN = 512;
 
 extern const char* autoRemoveModeNames[];
 
+#ifdef URHO3D_SSE
+/// Select lanes of a where the mask is set and lanes of b elsewhere.
+static inline __m128 SelectPS(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#endif
+
+void ParticleStreams::Resize(unsigned num)
+{
+    unsigned capacity = (num + 3) & ~3U;
+    unsigned oldCapacity = alive_.Size();
+
+    alive_.Resize(capacity);
+    positionX_.Resize(capacity);
+    positionY_.Resize(capacity);
+    positionZ_.Resize(capacity);
+    velocityX_.Resize(capacity);
+    velocityY_.Resize(capacity);
+    velocityZ_.Resize(capacity);
+    sizeX_.Resize(capacity);
+    sizeY_.Resize(capacity);
+    timer_.Resize(capacity);
+    timeToLive_.Resize(capacity);
+    scale_.Resize(capacity);
+    rotation_.Resize(capacity);
+    rotationSpeed_.Resize(capacity);
+    colorIndex_.Resize(capacity);
+    texIndex_.Resize(capacity);
+
+    // Clear new particles, as well as the padding past a shrunk size, so that the padding lanes are never processed
+    for (unsigned i = Min(num, oldCapacity); i < capacity; ++i)
+    {
+        alive_[i] = 0;
+        positionX_[i] = positionY_[i] = positionZ_[i] = 0.0f;
+        velocityX_[i] = velocityY_[i] = velocityZ_[i] = 0.0f;
+        sizeX_[i] = sizeY_[i] = 0.0f;
+        timer_[i] = timeToLive_[i] = 0.0f;
+        scale_[i] = 1.0f;
+        rotation_[i] = rotationSpeed_[i] = 0.0f;
+        colorIndex_[i] = texIndex_[i] = 0;
+    }
+
+    size_ = num;
+}
+
 ParticleEmitter::ParticleEmitter(Context* context) :
     BillboardSet(context),
     periodTimer_(0.0f),
     emissionTimer_(0.0f),
     lastTimeStep_(0.0f),
+    freeParticleHint_(0),
     lastUpdateFrameNumber_(M_MAX_UNSIGNED),
     emitting_(true),
     needUpdate_(false),
@@ -79,7 +135,7 @@ void ParticleEmitter::RegisterObject(Context* context)
     URHO3D_COPY_BASE_ATTRIBUTES(Drawable);
     URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Particles", GetParticlesAttr, SetParticlesAttr, VariantVector, Variant::emptyVariantVector,
         AM_FILE | AM_NOEDIT);
-    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Billboards", GetParticleBillboardsAttr, SetBillboardsAttr, VariantVector, Variant::emptyVariantVector,
+    URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Billboards", GetParticleBillboardsAttr, SetParticleBillboardsAttr, VariantVector, Variant::emptyVariantVector,
         AM_FILE | AM_NOEDIT);
     URHO3D_ATTRIBUTE("Serialize Particles", bool, serializeParticles_, true, AM_FILE);
 }
@@ -165,94 +221,31 @@ void ParticleEmitter::Update(const FrameInfo& frame)
         }
     }
 
-    // Update existing particles
-    Vector3 relativeConstantForce = node_->GetWorldRotation().Inverse() * effect_->GetConstantForce();
+    // Update existing particles. Large effects are split into ranges of four-particle groups that idle worker threads
+    // can steal; the emitter itself is already being updated from the octree's parallel drawable update
+    Vector3 constantForce = effect_->GetConstantForce();
+    if (relative_)
+        constantForce = node_->GetWorldRotation().Inverse() * constantForce;
     // If billboards are not relative, apply scaling to the position update
     Vector3 scaleVector = Vector3::ONE;
     if (scaled_ && !relative_)
         scaleVector = node_->GetWorldScale();
 
-    for (unsigned i = 0; i < particles_.Size(); ++i)
+    unsigned numGroups = particles_.alive_.Size() / 4;
+    if (numGroups > PARTICLE_UPDATE_GRAIN)
     {
-        Particle& particle = particles_[i];
-        Billboard& billboard = billboards_[i];
-
-        if (billboard.enabled_)
-        {
-            needCommit = true;
-
-            // Time to live
-            if (particle.timer_ >= particle.timeToLive_)
-            {
-                billboard.enabled_ = false;
-                continue;
-            }
-            particle.timer_ += lastTimeStep_;
-
-            // Velocity & position
-            const Vector3& constantForce = effect_->GetConstantForce();
-            if (constantForce != Vector3::ZERO)
-            {
-                if (relative_)
-                    particle.velocity_ += lastTimeStep_ * relativeConstantForce;
-                else
-                    particle.velocity_ += lastTimeStep_ * constantForce;
-            }
-
-            float dampingForce = effect_->GetDampingForce();
-            if (dampingForce != 0.0f)
-            {
-                Vector3 force = -dampingForce * particle.velocity_;
-                particle.velocity_ += lastTimeStep_ * force;
-            }
-            billboard.position_ += lastTimeStep_ * particle.velocity_ * scaleVector;
-            billboard.direction_ = particle.velocity_.Normalized();
-
-            // Rotation
-            billboard.rotation_ += lastTimeStep_ * particle.rotationSpeed_;
-
-            // Scaling
-            float sizeAdd = effect_->GetSizeAdd();
-            float sizeMul = effect_->GetSizeMul();
-            if (sizeAdd != 0.0f || sizeMul != 1.0f)
-            {
-                particle.scale_ += lastTimeStep_ * sizeAdd;
-                if (particle.scale_ < 0.0f)
-                    particle.scale_ = 0.0f;
-                if (sizeMul != 1.0f)
-                    particle.scale_ *= (lastTimeStep_ * (sizeMul - 1.0f)) + 1.0f;
-                billboard.size_ = particle.size_ * particle.scale_;
-            }
-
-            // Color interpolation
-            unsigned& index = particle.colorIndex_;
-            const Vector<ColorFrame>& colorFrames_ = effect_->GetColorFrames();
-            if (index < colorFrames_.Size())
-            {
-                if (index < colorFrames_.Size() - 1)
-                {
-                    if (particle.timer_ >= colorFrames_[index + 1].time_)
-                        ++index;
-                }
-                if (index < colorFrames_.Size() - 1)
-                    billboard.color_ = colorFrames_[index].Interpolate(colorFrames_[index + 1], particle.timer_);
-                else
-                    billboard.color_ = colorFrames_[index].color_;
-            }
-
-            // Texture animation
-            unsigned& texIndex = particle.texIndex_;
-            const Vector<TextureFrame>& textureFrames_ = effect_->GetTextureFrames();
-            if (textureFrames_.Size() && texIndex < textureFrames_.Size() - 1)
+        std::atomic<bool> anyAlive(false);
+        GetSubsystem<WorkQueue>()->ParallelFor(numGroups, PARTICLE_UPDATE_GRAIN,
+            [this, &anyAlive, &constantForce, &scaleVector](unsigned begin, unsigned end, unsigned)
             {
-                if (particle.timer_ >= textureFrames_[texIndex + 1].time_)
-                {
-                    billboard.uv_ = textureFrames_[texIndex + 1].uv_;
-                    ++texIndex;
-                }
-            }
-        }
+                if (UpdateParticles(begin, end, constantForce, scaleVector))
+                    anyAlive = true;
+            }, WorkQueue::GetCurrentThreadIndex());
+        if (anyAlive)
+            needCommit = true;
     }
+    else if (UpdateParticles(0, numGroups, constantForce, scaleVector))
+        needCommit = true;
 
     if (needCommit)
         Commit();
@@ -288,6 +281,7 @@ void ParticleEmitter::SetNumParticles(unsigned num)
 
     particles_.Resize(num);
     SetNumBillboards(num);
+    freeParticleHint_ = 0;
 }
 
 void ParticleEmitter::SetEmitting(bool enable)
@@ -324,6 +318,8 @@ void ParticleEmitter::RemoveAllParticles()
 {
     for (PODVector<Billboard>::Iterator i = billboards_.Begin(); i != billboards_.End(); ++i)
         i->enabled_ = false;
+    for (PODVector<unsigned>::Iterator i = particles_.alive_.Begin(); i != particles_.alive_.End(); ++i)
+        *i = 0;
 
     Commit();
 }
@@ -371,16 +367,22 @@ void ParticleEmitter::SetParticlesAttr(const VariantVector& value)
     unsigned index = 0;
     SetNumParticles(index < value.Size() ? value[index++].GetUInt() : 0);
 
-    for (PODVector<Particle>::Iterator i = particles_.Begin(); i != particles_.End() && index < value.Size(); ++i)
+    ParticleStreams& p = particles_;
+    for (unsigned i = 0; i < p.Size() && index < value.Size(); ++i)
     {
-        i->velocity_ = value[index++].GetVector3();
-        i->size_ = value[index++].GetVector2();
-        i->timer_ = value[index++].GetFloat();
-        i->timeToLive_ = value[index++].GetFloat();
-        i->scale_ = value[index++].GetFloat();
-        i->rotationSpeed_ = value[index++].GetFloat();
-        i->colorIndex_ = (unsigned)value[index++].GetInt();
-        i->texIndex_ = (unsigned)value[index++].GetInt();
+        Vector3 velocity = value[index++].GetVector3();
+        p.velocityX_[i] = velocity.x_;
+        p.velocityY_[i] = velocity.y_;
+        p.velocityZ_[i] = velocity.z_;
+        Vector2 size = value[index++].GetVector2();
+        p.sizeX_[i] = size.x_;
+        p.sizeY_[i] = size.y_;
+        p.timer_[i] = value[index++].GetFloat();
+        p.timeToLive_[i] = value[index++].GetFloat();
+        p.scale_[i] = value[index++].GetFloat();
+        p.rotationSpeed_[i] = value[index++].GetFloat();
+        p.colorIndex_[i] = (unsigned)value[index++].GetInt();
+        p.texIndex_[i] = (unsigned)value[index++].GetInt();
     }
 }
 
@@ -393,22 +395,43 @@ VariantVector ParticleEmitter::GetParticlesAttr() const
         return ret;
     }
 
-    ret.Reserve(particles_.Size() * 8 + 1);
-    ret.Push(particles_.Size());
-    for (PODVector<Particle>::ConstIterator i = particles_.Begin(); i != particles_.End(); ++i)
+    const ParticleStreams& p = particles_;
+    ret.Reserve(p.Size() * 8 + 1);
+    ret.Push(p.Size());
+    for (unsigned i = 0; i < p.Size(); ++i)
     {
-        ret.Push(i->velocity_);
-        ret.Push(i->size_);
-        ret.Push(i->timer_);
-        ret.Push(i->timeToLive_);
-        ret.Push(i->scale_);
-        ret.Push(i->rotationSpeed_);
-        ret.Push(i->colorIndex_);
-        ret.Push(i->texIndex_);
+        ret.Push(Vector3(p.velocityX_[i], p.velocityY_[i], p.velocityZ_[i]));
+        ret.Push(Vector2(p.sizeX_[i], p.sizeY_[i]));
+        ret.Push(p.timer_[i]);
+        ret.Push(p.timeToLive_[i]);
+        ret.Push(p.scale_[i]);
+        ret.Push(p.rotationSpeed_[i]);
+        ret.Push(p.colorIndex_[i]);
+        ret.Push(p.texIndex_[i]);
     }
     return ret;
 }
 
+void ParticleEmitter::SetParticleBillboardsAttr(const VariantVector& value)
+{
+    SetBillboardsAttr(value);
+
+    // The billboard amount is normally already set by the particles attribute
+    if (particles_.Size() != billboards_.Size())
+        particles_.Resize(billboards_.Size());
+
+    ParticleStreams& p = particles_;
+    for (unsigned i = 0; i < billboards_.Size(); ++i)
+    {
+        const Billboard& billboard = billboards_[i];
+        p.alive_[i] = billboard.enabled_ ? M_MAX_UNSIGNED : 0;
+        p.positionX_[i] = billboard.position_.x_;
+        p.positionY_[i] = billboard.position_.y_;
+        p.positionZ_[i] = billboard.position_.z_;
+        p.rotation_[i] = billboard.rotation_;
+    }
+}
+
 VariantVector ParticleEmitter::GetParticleBillboardsAttr() const
 {
     VariantVector ret;
@@ -451,7 +474,7 @@ bool ParticleEmitter::EmitNewParticle()
     if (index == M_MAX_UNSIGNED)
         return false;
     assert(index < particles_.Size());
-    Particle& particle = particles_[index];
+    ParticleStreams& p = particles_;
     Billboard& billboard = billboards_[index];
 
     Vector3 startDir;
@@ -486,17 +509,19 @@ bool ParticleEmitter::EmitNewParticle()
         break;
     }
 
-    particle.size_ = effect_->GetRandomSize();
-    particle.timer_ = 0.0f;
-    particle.timeToLive_ = effect_->GetRandomTimeToLive();
-    particle.scale_ = 1.0f;
-    particle.rotationSpeed_ = effect_->GetRandomRotationSpeed();
-    particle.colorIndex_ = 0;
-    particle.texIndex_ = 0;
+    Vector2 size = effect_->GetRandomSize();
+    p.sizeX_[index] = size.x_;
+    p.sizeY_[index] = size.y_;
+    p.timer_[index] = 0.0f;
+    p.timeToLive_[index] = effect_->GetRandomTimeToLive();
+    p.scale_[index] = 1.0f;
+    p.rotationSpeed_[index] = effect_->GetRandomRotationSpeed();
+    p.colorIndex_[index] = 0;
+    p.texIndex_[index] = 0;
 
     if (faceCameraMode_ == FC_DIRECTION)
     {
-        startPos += startDir * particle.size_.y_;
+        startPos += startDir * size.y_;
     }
 
     if (!relative_)
@@ -505,26 +530,44 @@ bool ParticleEmitter::EmitNewParticle()
         startDir = node_->GetWorldRotation() * startDir;
     };
 
-    particle.velocity_ = effect_->GetRandomVelocity() * startDir;
+    Vector3 velocity = effect_->GetRandomVelocity() * startDir;
+    p.velocityX_[index] = velocity.x_;
+    p.velocityY_[index] = velocity.y_;
+    p.velocityZ_[index] = velocity.z_;
+    p.positionX_[index] = startPos.x_;
+    p.positionY_[index] = startPos.y_;
+    p.positionZ_[index] = startPos.z_;
+    p.alive_[index] = M_MAX_UNSIGNED;
 
     billboard.position_ = startPos;
-    billboard.size_ = particles_[index].size_;
+    billboard.size_ = size;
     const Vector<TextureFrame>& textureFrames_ = effect_->GetTextureFrames();
     billboard.uv_ = textureFrames_.Size() ? textureFrames_[0].uv_ : Rect::POSITIVE;
-    billboard.rotation_ = effect_->GetRandomRotation();
+    billboard.rotation_ = p.rotation_[index] = effect_->GetRandomRotation();
     const Vector<ColorFrame>& colorFrames_ = effect_->GetColorFrames();
     billboard.color_ = colorFrames_.Size() ? colorFrames_[0].color_ : Color();
     billboard.enabled_ = true;
     billboard.direction_ = startDir;
+    freeParticleHint_ = index + 1;
 
     return true;
 }
 
 unsigned ParticleEmitter::GetFreeParticle() const
 {
-    for (unsigned i = 0; i < billboards_.Size(); ++i)
+    // Continue from the last emitted particle, as the particles before it are likely to be still alive
+    const PODVector<unsigned>& alive = particles_.alive_;
+    unsigned numParticles = particles_.Size();
+    unsigned start = freeParticleHint_ < numParticles ? freeParticleHint_ : 0;
+
+    for (unsigned i = start; i < numParticles; ++i)
+    {
+        if (!alive[i])
+            return i;
+    }
+    for (unsigned i = 0; i < start; ++i)
     {
-        if (!billboards_[i].enabled_)
+        if (!alive[i])
             return i;
     }
 
@@ -533,18 +576,221 @@ unsigned ParticleEmitter::GetFreeParticle() const
 
 bool ParticleEmitter::CheckActiveParticles() const
 {
-    for (unsigned i = 0; i < billboards_.Size(); ++i)
+    for (unsigned i = 0; i < particles_.Size(); ++i)
     {
-        if (billboards_[i].enabled_)
-        {
+        if (particles_.alive_[i])
             return true;
-            break;
-        }
     }
 
     return false;
 }
 
+bool ParticleEmitter::UpdateParticles(unsigned beginGroup, unsigned endGroup, const Vector3& constantForce,
+    const Vector3& scaleVector)
+{
+    ParticleStreams& p = particles_;
+    unsigned numParticles = p.Size();
+    float timeStep = lastTimeStep_;
+    float dampingForce = effect_->GetDampingForce();
+    float sizeAdd = effect_->GetSizeAdd();
+    float sizeMul = effect_->GetSizeMul();
+    bool applyForce = constantForce != Vector3::ZERO;
+    bool applyDamping = dampingForce != 0.0f;
+    bool applyScale = sizeAdd != 0.0f || sizeMul != 1.0f;
+    Vector3 forceStep = timeStep * constantForce;
+    float sizeAddStep = timeStep * sizeAdd;
+    float sizeMulStep = (timeStep * (sizeMul - 1.0f)) + 1.0f;
+    const Vector<ColorFrame>& colorFrames = effect_->GetColorFrames();
+    const Vector<TextureFrame>& textureFrames = effect_->GetTextureFrames();
+    bool anyAlive = false;
+
+#ifdef URHO3D_SSE
+    __m128 dt = _mm_set1_ps(timeStep);
+    __m128 zero = _mm_setzero_ps();
+    __m128 forceStepX = _mm_set1_ps(forceStep.x_);
+    __m128 forceStepY = _mm_set1_ps(forceStep.y_);
+    __m128 forceStepZ = _mm_set1_ps(forceStep.z_);
+    __m128 negDamping = _mm_set1_ps(-dampingForce);
+    __m128 scaleX = _mm_set1_ps(scaleVector.x_);
+    __m128 scaleY = _mm_set1_ps(scaleVector.y_);
+    __m128 scaleZ = _mm_set1_ps(scaleVector.z_);
+    __m128 sizeAddStep4 = _mm_set1_ps(sizeAddStep);
+    __m128 sizeMulStep4 = _mm_set1_ps(sizeMulStep);
+#endif
+
+    for (unsigned group = beginGroup; group < endGroup; ++group)
+    {
+        unsigned first = group * 4;
+        int aliveBits = 0;
+        int expiredBits = 0;
+
+#ifdef URHO3D_SSE
+        __m128 alive = _mm_loadu_ps(reinterpret_cast<const float*>(&p.alive_[first]));
+        if (!_mm_movemask_ps(alive))
+            continue;
+        anyAlive = true;
+
+        // Particles that have reached their time to live are disabled without further update
+        __m128 timer = _mm_loadu_ps(&p.timer_[first]);
+        __m128 expired = _mm_and_ps(alive, _mm_cmpge_ps(timer, _mm_loadu_ps(&p.timeToLive_[first])));
+        alive = _mm_andnot_ps(expired, alive);
+        aliveBits = _mm_movemask_ps(alive);
+        expiredBits = _mm_movemask_ps(expired);
+        _mm_storeu_ps(reinterpret_cast<float*>(&p.alive_[first]), alive);
+        _mm_storeu_ps(&p.timer_[first], SelectPS(alive, _mm_add_ps(timer, dt), timer));
+
+        // Velocity & position
+        __m128 velX = _mm_loadu_ps(&p.velocityX_[first]);
+        __m128 velY = _mm_loadu_ps(&p.velocityY_[first]);
+        __m128 velZ = _mm_loadu_ps(&p.velocityZ_[first]);
+        __m128 newVelX = velX;
+        __m128 newVelY = velY;
+        __m128 newVelZ = velZ;
+        if (applyForce)
+        {
+            newVelX = _mm_add_ps(newVelX, forceStepX);
+            newVelY = _mm_add_ps(newVelY, forceStepY);
+            newVelZ = _mm_add_ps(newVelZ, forceStepZ);
+        }
+        if (applyDamping)
+        {
+            newVelX = _mm_add_ps(newVelX, _mm_mul_ps(dt, _mm_mul_ps(negDamping, newVelX)));
+            newVelY = _mm_add_ps(newVelY, _mm_mul_ps(dt, _mm_mul_ps(negDamping, newVelY)));
+            newVelZ = _mm_add_ps(newVelZ, _mm_mul_ps(dt, _mm_mul_ps(negDamping, newVelZ)));
+        }
+        _mm_storeu_ps(&p.velocityX_[first], SelectPS(alive, newVelX, velX));
+        _mm_storeu_ps(&p.velocityY_[first], SelectPS(alive, newVelY, velY));
+        _mm_storeu_ps(&p.velocityZ_[first], SelectPS(alive, newVelZ, velZ));
+
+        __m128 posX = _mm_loadu_ps(&p.positionX_[first]);
+        __m128 posY = _mm_loadu_ps(&p.positionY_[first]);
+        __m128 posZ = _mm_loadu_ps(&p.positionZ_[first]);
+        __m128 moveX = _mm_mul_ps(_mm_mul_ps(dt, newVelX), scaleX);
+        __m128 moveY = _mm_mul_ps(_mm_mul_ps(dt, newVelY), scaleY);
+        __m128 moveZ = _mm_mul_ps(_mm_mul_ps(dt, newVelZ), scaleZ);
+        _mm_storeu_ps(&p.positionX_[first], SelectPS(alive, _mm_add_ps(posX, moveX), posX));
+        _mm_storeu_ps(&p.positionY_[first], SelectPS(alive, _mm_add_ps(posY, moveY), posY));
+        _mm_storeu_ps(&p.positionZ_[first], SelectPS(alive, _mm_add_ps(posZ, moveZ), posZ));
+
+        // Rotation
+        __m128 rotation = _mm_loadu_ps(&p.rotation_[first]);
+        __m128 rotationStep = _mm_mul_ps(dt, _mm_loadu_ps(&p.rotationSpeed_[first]));
+        _mm_storeu_ps(&p.rotation_[first], SelectPS(alive, _mm_add_ps(rotation, rotationStep), rotation));
+
+        // Scaling
+        if (applyScale)
+        {
+            __m128 scale = _mm_loadu_ps(&p.scale_[first]);
+            __m128 newScale = _mm_add_ps(scale, sizeAddStep4);
+            newScale = _mm_andnot_ps(_mm_cmplt_ps(newScale, zero), newScale);
+            if (sizeMul != 1.0f)
+                newScale = _mm_mul_ps(newScale, sizeMulStep4);
+            _mm_storeu_ps(&p.scale_[first], SelectPS(alive, newScale, scale));
+        }
+#else
+        for (unsigned i = first; i < first + 4; ++i)
+        {
+            if (!p.alive_[i])
+                continue;
+            anyAlive = true;
+
+            // Particles that have reached their time to live are disabled without further update
+            if (p.timer_[i] >= p.timeToLive_[i])
+            {
+                p.alive_[i] = 0;
+                expiredBits |= 1 << (i - first);
+                continue;
+            }
+            aliveBits |= 1 << (i - first);
+            p.timer_[i] += timeStep;
+
+            // Velocity & position
+            Vector3 velocity(p.velocityX_[i], p.velocityY_[i], p.velocityZ_[i]);
+            if (applyForce)
+                velocity += forceStep;
+            if (applyDamping)
+                velocity += timeStep * (-dampingForce * velocity);
+            p.velocityX_[i] = velocity.x_;
+            p.velocityY_[i] = velocity.y_;
+            p.velocityZ_[i] = velocity.z_;
+            Vector3 move = timeStep * velocity * scaleVector;
+            p.positionX_[i] += move.x_;
+            p.positionY_[i] += move.y_;
+            p.positionZ_[i] += move.z_;
+
+            // Rotation
+            p.rotation_[i] += timeStep * p.rotationSpeed_[i];
+
+            // Scaling
+            if (applyScale)
+            {
+                float scale = p.scale_[i] + sizeAddStep;
+                if (scale < 0.0f)
+                    scale = 0.0f;
+                if (sizeMul != 1.0f)
+                    scale *= sizeMulStep;
+                p.scale_[i] = scale;
+            }
+        }
+        if (!aliveBits && !expiredBits)
+            continue;
+#endif
+
+        // Write the billboards, and advance the color and texture animation. Each lane may be at a different keyframe, and
+        // SSE2 has no gather to load them, so this part stays scalar while the group is still in cache
+        for (unsigned lane = 0; lane < 4; ++lane)
+        {
+            unsigned i = first + lane;
+            if (i >= numParticles)
+                break;
+
+            Billboard& billboard = billboards_[i];
+            if (expiredBits & (1 << lane))
+            {
+                billboard.enabled_ = false;
+                continue;
+            }
+            if (!(aliveBits & (1 << lane)))
+                continue;
+
+            float timer = p.timer_[i];
+            billboard.position_ = Vector3(p.positionX_[i], p.positionY_[i], p.positionZ_[i]);
+            billboard.direction_ = Vector3(p.velocityX_[i], p.velocityY_[i], p.velocityZ_[i]).Normalized();
+            billboard.rotation_ = p.rotation_[i];
+            if (applyScale)
+                billboard.size_ = Vector2(p.sizeX_[i], p.sizeY_[i]) * p.scale_[i];
+
+            // Color interpolation
+            unsigned& index = p.colorIndex_[i];
+            if (index < colorFrames.Size())
+            {
+                if (index < colorFrames.Size() - 1)
+                {
+                    if (timer >= colorFrames[index + 1].time_)
+                        ++index;
+                }
+                if (index < colorFrames.Size() - 1)
+                    billboard.color_ = colorFrames[index].Interpolate(colorFrames[index + 1], timer);
+                else
+                    billboard.color_ = colorFrames[index].color_;
+            }
+
+            // Texture animation
+            unsigned& texIndex = p.texIndex_[i];
+            if (textureFrames.Size() && texIndex < textureFrames.Size() - 1)
+            {
+                if (timer >= textureFrames[texIndex + 1].time_)
+                {
+                    billboard.uv_ = textureFrames[texIndex + 1].uv_;
+                    ++texIndex;
+                }
+            }
+        }
+    }
+
+    return anyAlive;
+}
+
 void ParticleEmitter::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
 {
     // Store scene's timestep and use it instead of global timestep, as time scale may be other than 1
@@ -29,27 +29,58 @@ namespace Urho3D
 
 class ParticleEffect;
 
-/// One particle in the particle system.
-struct Particle
+/// Particle state of an emitter stored as a structure of arrays, so that the update can integrate four particles at a time. Capacity is padded to a multiple of four.
+struct URHO3D_API ParticleStreams
 {
-    /// Velocity.
-    Vector3 velocity_;
-    /// Original billboard size.
-    Vector2 size_;
+    /// Construct empty.
+    ParticleStreams() :
+        size_(0)
+    {
+    }
+
+    /// Resize all streams. New particles are not alive.
+    void Resize(unsigned num);
+
+    /// Return number of particles.
+    unsigned Size() const { return size_; }
+
+    /// Alive mask, all bits set when the particle is alive.
+    PODVector<unsigned> alive_;
+    /// Position X.
+    PODVector<float> positionX_;
+    /// Position Y.
+    PODVector<float> positionY_;
+    /// Position Z.
+    PODVector<float> positionZ_;
+    /// Velocity X.
+    PODVector<float> velocityX_;
+    /// Velocity Y.
+    PODVector<float> velocityY_;
+    /// Velocity Z.
+    PODVector<float> velocityZ_;
+    /// Original billboard width.
+    PODVector<float> sizeX_;
+    /// Original billboard height.
+    PODVector<float> sizeY_;
     /// Time elapsed from creation.
-    float timer_;
+    PODVector<float> timer_;
     /// Lifetime.
-    float timeToLive_;
+    PODVector<float> timeToLive_;
     /// Size scaling value.
-    float scale_;
+    PODVector<float> scale_;
+    /// Rotation.
+    PODVector<float> rotation_;
     /// Rotation speed.
-    float rotationSpeed_;
+    PODVector<float> rotationSpeed_;
     /// Current color animation index.
-    unsigned colorIndex_;
+    PODVector<unsigned> colorIndex_;
     /// Current texture animation index.
-    unsigned texIndex_;
-};
+    PODVector<unsigned> texIndex_;
 
+private:
+    /// Number of particles.
+    unsigned size_;
+};
 /// %Particle emitter component.
 class URHO3D_API ParticleEmitter : public BillboardSet
 {
@@ -93,6 +124,9 @@ public:
     /// Return maximum number of particles.
     unsigned GetNumParticles() const { return particles_.Size(); }
 
+    /// Return particle state. Billboard position and rotation are rewritten from it on each update.
+    const ParticleStreams& GetParticles() const { return particles_; }
+
     /// Return whether is currently emitting.
     bool IsEmitting() const { return emitting_; }
 
@@ -110,6 +144,8 @@ public:
     void SetParticlesAttr(const VariantVector& value);
     /// Return particles attribute. Returns particle amount only if particles are not to be serialized.
     VariantVector GetParticlesAttr() const;
+    /// Set billboards attribute and copy the billboard state to the particles.
+    void SetParticleBillboardsAttr(const VariantVector& value);
     /// Return billboards attribute. Returns billboard amount only if particles are not to be serialized.
     VariantVector GetParticleBillboardsAttr() const;
 
@@ -123,6 +159,8 @@ protected:
     unsigned GetFreeParticle() const;
     /// Return whether has active particles.
     bool CheckActiveParticles() const;
+    /// Integrate particles in the range of four-particle groups and write their billboards. Return whether any particle was alive.
+    bool UpdateParticles(unsigned beginGroup, unsigned endGroup, const Vector3& constantForce, const Vector3& scaleVector);
 
 private:
     /// Handle scene post-update event.
@@ -133,13 +171,15 @@ private:
     /// Particle effect.
     SharedPtr<ParticleEffect> effect_;
     /// Particles.
-    PODVector<Particle> particles_;
+    ParticleStreams particles_;
     /// Active/inactive period timer.
     float periodTimer_;
     /// New particle emission timer.
     float emissionTimer_;
     /// Last scene timestep.
     float lastTimeStep_;
+    /// Index from which to search for a free particle.
+    unsigned freeParticleHint_;
     /// Rendering framenumber on which was last updated.
     unsigned lastUpdateFrameNumber_;
     /// Currently emitting flag.
@@ -131,6 +131,9 @@ public:
     /// Return compile error/warning string.
     const String& GetCompilerOutput() const { return compilerOutput_; }
 
+    /// Return the source code passed to the compiler, including the generated defines. Used internally on OpenGL only.
+    String GetFullSourceCode() const;
+
     /// Return constant buffer data sizes.
     const unsigned* GetConstantBufferSizes() const { return &constantBufferSizes_[0]; }
 
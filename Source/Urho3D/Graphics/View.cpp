@@ -253,28 +253,30 @@ void SortBatchQueueFrontToBackWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* queue = reinterpret_cast<BatchQueue*>(item->start_);
 
-    queue->SortFrontToBack();
+    queue->SortFrontToBack(reinterpret_cast<WorkQueue*>(item->aux_), threadIndex);
 }
 
 void SortBatchQueueBackToFrontWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* queue = reinterpret_cast<BatchQueue*>(item->start_);
 
-    queue->SortBackToFront();
+    queue->SortBackToFront(reinterpret_cast<WorkQueue*>(item->aux_), threadIndex);
 }
 
 void SortLightQueueWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* start = reinterpret_cast<LightBatchQueue*>(item->start_);
-    start->litBaseBatches_.SortFrontToBack();
-    start->litBatches_.SortFrontToBack();
+    auto* workQueue = reinterpret_cast<WorkQueue*>(item->aux_);
+    start->litBaseBatches_.SortFrontToBack(workQueue, threadIndex);
+    start->litBatches_.SortFrontToBack(workQueue, threadIndex);
 }
 
 void SortShadowQueueWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* start = reinterpret_cast<LightBatchQueue*>(item->start_);
+    auto* workQueue = reinterpret_cast<WorkQueue*>(item->aux_);
     for (unsigned i = 0; i < start->shadowSplits_.Size(); ++i)
-        start->shadowSplits_[i].shadowBatches_.SortFrontToBack();
+        start->shadowSplits_[i].shadowBatches_.SortFrontToBack(workQueue, threadIndex);
 }
 
 StringHash ParseTextureTypeXml(ResourceCache* cache, const String& filename);
@@ -535,7 +537,18 @@ void View::Update(const FrameInfo& frame)
     zones_.Clear();
     occluders_.Clear();
     activeOccluders_ = 0;
-    vertexLightQueues_.Clear();
+    // Keep the vertex light queues used last frame so that their storage is reused, and remove the rest. A queue's light
+    // list is emptied here and refilled when the queue is used again
+    for (HashMap<unsigned long long, LightBatchQueue>::Iterator i = vertexLightQueues_.Begin(); i != vertexLightQueues_.End();)
+    {
+        if (i->second_.vertexLights_.Empty())
+            i = vertexLightQueues_.Erase(i);
+        else
+        {
+            i->second_.vertexLights_.Clear();
+            ++i;
+        }
+    }
     for (HashMap<unsigned, BatchQueue>::Iterator i = batchQueues_.Begin(); i != batchQueues_.End(); ++i)
         i->second_.Clear(maxSortedInstances);
 
@@ -1142,7 +1155,7 @@ void View::GetLightBatches()
     {
         URHO3D_PROFILE(GetMaxLightsBatches);
 
-        for (HashSet<Drawable*>::Iterator i = maxLightsDrawables_.Begin(); i != maxLightsDrawables_.End(); ++i)
+        for (FlatHashSet<Drawable*>::Iterator i = maxLightsDrawables_.Begin(); i != maxLightsDrawables_.End(); ++i)
         {
             Drawable* drawable = *i;
             drawable->LimitLights();
@@ -1229,8 +1242,9 @@ void View::GetBaseBatches()
                             i = vertexLightQueues_.Insert(MakePair(hash, LightBatchQueue()));
                             i->second_.light_ = nullptr;
                             i->second_.shadowMap_ = nullptr;
-                            i->second_.vertexLights_ = drawableVertexLights;
                         }
+                        if (i->second_.vertexLights_.Empty())
+                            i->second_.vertexLights_ = drawableVertexLights;
 
                         destBatch.lightQueue_ = &(i->second_);
                     }
@@ -1276,6 +1290,7 @@ void View::UpdateGeometries()
                 item->workFunction_ =
                     command.sortMode_ == SORT_FRONTTOBACK ? SortBatchQueueFrontToBackWork : SortBatchQueueBackToFrontWork;
                 item->start_ = &batchQueues_[command.passIndex_];
+                item->aux_ = queue;
                 queue->AddWorkItem(item);
             }
         }
@@ -1286,6 +1301,7 @@ void View::UpdateGeometries()
             lightItem->priority_ = M_MAX_UNSIGNED;
             lightItem->workFunction_ = SortLightQueueWork;
             lightItem->start_ = &(*i);
+            lightItem->aux_ = queue;
             queue->AddWorkItem(lightItem);
 
             if (i->shadowSplits_.Size())
@@ -1294,6 +1310,7 @@ void View::UpdateGeometries()
                 shadowItem->priority_ = M_MAX_UNSIGNED;
                 shadowItem->workFunction_ = SortShadowQueueWork;
                 shadowItem->start_ = &(*i);
+                shadowItem->aux_ = queue;
                 queue->AddWorkItem(shadowItem);
             }
         }
@@ -2852,7 +2869,7 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     {
         BatchGroupKey key(batch);
 
-        HashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Find(key);
+        FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Find(key);
         if (i == queue.batchGroups_.End())
         {
             // Create a new group based on the batch
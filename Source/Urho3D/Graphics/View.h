@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/FlatHashSet.h"
 #include "../Container/HashSet.h"
 #include "../Container/List.h"
 #include "../Core/Object.h"
@@ -404,7 +405,7 @@ private:
     unsigned activeOccluders_{};
 
     /// Drawables that limit their maximum light count.
-    HashSet<Drawable*> maxLightsDrawables_;
+    FlatHashSet<Drawable*> maxLightsDrawables_;
     /// Rendertargets defined by the renderpath.
     HashMap<StringHash, Texture*> renderTargets_;
     /// Intermediate light processing results.
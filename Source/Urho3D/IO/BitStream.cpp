@@ -0,0 +1,192 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/BitStream.h"
+#include "../Math/Quaternion.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Largest absolute value of the three smallest components of a unit quaternion.
+static const float QUATERNION_COMPONENT_RANGE = 0.70710678f;
+
+static inline unsigned GetMaxQuantizedValue(unsigned numBits)
+{
+    return numBits >= 32 ? M_MAX_UNSIGNED : (1u << numBits) - 1;
+}
+
+BitWriter::BitWriter(Serializer& dest) :
+    dest_(dest),
+    bits_(0),
+    numBits_(0)
+{
+}
+
+BitWriter::~BitWriter()
+{
+    Flush();
+}
+
+unsigned BitWriter::Write(const void* data, unsigned size)
+{
+    Flush();
+    return dest_.Write(data, size);
+}
+
+void BitWriter::WriteBits(unsigned value, unsigned numBits)
+{
+    if (!numBits)
+        return;
+
+    if (numBits < 32)
+        value &= (1u << numBits) - 1;
+    bits_ |= (unsigned long long)value << numBits_;
+    numBits_ += numBits;
+
+    while (numBits_ >= 8)
+    {
+        dest_.WriteUByte((unsigned char)(bits_ & 0xff));
+        bits_ >>= 8;
+        numBits_ -= 8;
+    }
+}
+
+void BitWriter::WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits)
+{
+    // Calculate in double precision, as a float cannot represent all values of 24 or more bits
+    unsigned maxQuantized = GetMaxQuantizedValue(numBits);
+    double range = (double)maxValue - (double)minValue;
+    double normalized = range > 0.0 ? Clamp(((double)value - (double)minValue) / range, 0.0, 1.0) : 0.0;
+    WriteBits((unsigned)(normalized * (double)maxQuantized + 0.5), numBits);
+}
+
+void BitWriter::WriteQuantizedQuaternion(const Quaternion& value, unsigned numBits)
+{
+    const float components[] = { value.w_, value.x_, value.y_, value.z_ };
+
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largest]))
+            largest = i;
+    }
+
+    // The quaternion and its negation are the same rotation, so the largest component is reconstructed as positive
+    float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+    WriteBits(largest, 2);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+            WriteQuantizedFloat(components[i] * sign, -QUATERNION_COMPONENT_RANGE, QUATERNION_COMPONENT_RANGE, numBits);
+    }
+}
+
+void BitWriter::Flush()
+{
+    if (numBits_)
+    {
+        dest_.WriteUByte((unsigned char)(bits_ & 0xff));
+        bits_ = 0;
+        numBits_ = 0;
+    }
+}
+
+BitReader::BitReader(Deserializer& source) :
+    Deserializer(source.GetSize()),
+    source_(source),
+    bits_(0),
+    numBits_(0)
+{
+    position_ = source_.GetPosition();
+}
+
+unsigned BitReader::Read(void* dest, unsigned size)
+{
+    bits_ = 0;
+    numBits_ = 0;
+    unsigned read = source_.Read(dest, size);
+    position_ = source_.GetPosition();
+    return read;
+}
+
+unsigned BitReader::Seek(unsigned position)
+{
+    bits_ = 0;
+    numBits_ = 0;
+    position_ = source_.Seek(position);
+    return position_;
+}
+
+unsigned BitReader::ReadBits(unsigned numBits)
+{
+    if (!numBits)
+        return 0;
+
+    while (numBits_ < numBits)
+    {
+        // Past the end the missing bits read as zero
+        unsigned char byte = 0;
+        source_.Read(&byte, 1);
+        bits_ |= (unsigned long long)byte << numBits_;
+        numBits_ += 8;
+    }
+
+    unsigned value = (unsigned)(bits_ & GetMaxQuantizedValue(numBits));
+    bits_ >>= numBits;
+    numBits_ -= numBits;
+    // Count a partially read byte as not yet read, so that reading the last bits of the source is not past the end
+    position_ = source_.GetPosition() - (numBits_ >> 3) - (numBits_ & 7 ? 1 : 0);
+    return value;
+}
+
+float BitReader::ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits)
+{
+    unsigned maxQuantized = GetMaxQuantizedValue(numBits);
+    return (float)((double)minValue + ((double)maxValue - (double)minValue) * ((double)ReadBits(numBits) / (double)maxQuantized));
+}
+
+Quaternion BitReader::ReadQuantizedQuaternion(unsigned numBits)
+{
+    unsigned largest = ReadBits(2);
+    float components[4];
+    float sumSquares = 0.0f;
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+        {
+            components[i] = ReadQuantizedFloat(-QUATERNION_COMPONENT_RANGE, QUATERNION_COMPONENT_RANGE, numBits);
+            sumSquares += components[i] * components[i];
+        }
+    }
+    components[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+
+    Quaternion ret(components[0], components[1], components[2], components[3]);
+    ret.Normalize();
+    return ret;
+}
+
+}
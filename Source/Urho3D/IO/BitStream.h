@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+
+namespace Urho3D
+{
+
+class Quaternion;
+
+/// Stream for writing values packed to a number of bits into another stream. Byte data written through the Serializer interface starts at the next byte boundary.
+class URHO3D_API BitWriter : public Serializer
+{
+public:
+    /// Construct with the destination stream.
+    explicit BitWriter(Serializer& dest);
+    /// Destruct. Write the remaining bits.
+    ~BitWriter() override;
+
+    /// Write bytes, starting at the next byte boundary.
+    unsigned Write(const void* data, unsigned size) override;
+
+    /// Write the lowest bits of a value, up to 32.
+    void WriteBits(unsigned value, unsigned numBits);
+    /// Write a float quantized within a range.
+    void WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits);
+    /// Write a quaternion as its three smallest components, quantized to a number of bits each.
+    void WriteQuantizedQuaternion(const Quaternion& value, unsigned numBits);
+    /// Write the remaining bits padded to a byte boundary.
+    void Flush();
+
+private:
+    /// Destination stream.
+    Serializer& dest_;
+    /// Bits not yet written to the destination.
+    unsigned long long bits_;
+    /// Number of bits not yet written to the destination.
+    unsigned numBits_;
+};
+
+/// Stream for reading values packed to a number of bits from another stream. Byte data read through the Deserializer interface starts at the next byte boundary.
+class URHO3D_API BitReader : public Deserializer
+{
+public:
+    /// Construct with the source stream, reading from its current position.
+    explicit BitReader(Deserializer& source);
+
+    /// Read bytes, starting at the next byte boundary. Return number of bytes actually read.
+    unsigned Read(void* dest, unsigned size) override;
+    /// Set position in the source stream and discard the remaining bits. Return actual new position.
+    unsigned Seek(unsigned position) override;
+
+    /// Read a value of up to 32 bits.
+    unsigned ReadBits(unsigned numBits);
+    /// Read a float quantized within a range.
+    float ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits);
+    /// Read a quaternion written as its three smallest components.
+    Quaternion ReadQuantizedQuaternion(unsigned numBits);
+
+private:
+    /// Source stream.
+    Deserializer& source_;
+    /// Bits read from the source but not yet returned.
+    unsigned long long bits_;
+    /// Number of bits read from the source but not yet returned.
+    unsigned numBits_;
+};
+
+}
@@ -72,6 +72,10 @@ File::File(Context* context) :
 #ifdef __ANDROID__
     assetHandle_(0),
 #endif
+    mappedData_(nullptr),
+    mappedPosition_(0),
+    blockSize_(0),
+    readBlockIndex_(M_MAX_UNSIGNED),
     readBufferOffset_(0),
     readBufferSize_(0),
     offset_(0),
@@ -89,6 +93,10 @@ File::File(Context* context, const String& fileName, FileMode mode) :
 #ifdef __ANDROID__
     assetHandle_(0),
 #endif
+    mappedData_(nullptr),
+    mappedPosition_(0),
+    blockSize_(0),
+    readBlockIndex_(M_MAX_UNSIGNED),
     readBufferOffset_(0),
     readBufferSize_(0),
     offset_(0),
@@ -107,6 +115,10 @@ File::File(Context* context, PackageFile* package, const String& fileName) :
 #ifdef __ANDROID__
     assetHandle_(0),
 #endif
+    mappedData_(nullptr),
+    mappedPosition_(0),
+    blockSize_(0),
+    readBlockIndex_(M_MAX_UNSIGNED),
     readBufferOffset_(0),
     readBufferSize_(0),
     offset_(0),
@@ -137,21 +149,50 @@ bool File::Open(PackageFile* package, const String& fileName)
     if (!entry)
         return false;
 
-    bool success = OpenInternal(package->GetName(), FILE_READ, true);
-    if (!success)
+    if (package->IsMapped())
+    {
+        // Read directly from the package's memory mapping instead of opening a file handle
+        Close();
+        package_ = package;
+        mappedData_ = package->GetMappedData();
+        mode_ = FILE_READ;
+        readSyncNeeded_ = false;
+        writeSyncNeeded_ = false;
+    }
+    else if (!OpenInternal(package->GetName(), FILE_READ, true))
     {
         URHO3D_LOGERROR("Could not open package file " + fileName);
         return false;
     }
 
     fileName_ = fileName;
+    position_ = 0;
     offset_ = entry->offset_;
     checksum_ = entry->checksum_;
     size_ = entry->size_;
-    compressed_ = package->IsCompressed();
+    blockSize_ = package->GetBlockSize() && entry->compressed_ ? package->GetBlockSize() : 0;
+    compressed_ = package->IsCompressed() && !package->GetBlockSize();
 
     // Seek to beginning of package entry's file data
     SeekInternal(offset_);
+
+    // Block compressed entries begin with the block offset table
+    if (blockSize_)
+    {
+        unsigned numBlocks = (size_ + blockSize_ - 1) / blockSize_;
+        blockOffsets_.Resize(numBlocks + 1);
+        bool valid = ReadInternal(&blockOffsets_[0], blockOffsets_.Size() * sizeof(unsigned));
+        for (unsigned i = 0; valid && i < numBlocks; ++i)
+            valid = blockOffsets_[i] <= blockOffsets_[i + 1];
+        if (!valid || offset_ + blockOffsets_.Back() > package->GetTotalSize())
+        {
+            URHO3D_LOGERROR("Corrupt block index in package file entry " + fileName);
+            Close();
+            return false;
+        }
+        readBlockIndex_ = M_MAX_UNSIGNED;
+    }
+
     return true;
 }
 
@@ -209,6 +250,52 @@ unsigned File::Read(void* dest, unsigned size)
     }
 #endif
 
+    if (blockSize_)
+    {
+        unsigned sizeLeft = size;
+        auto* destPtr = (unsigned char*)dest;
+
+        while (sizeLeft)
+        {
+            unsigned blockIndex = position_ / blockSize_;
+            unsigned blockStart = blockIndex * blockSize_;
+            unsigned blockDataSize = Min(size_ - blockStart, blockSize_);
+            unsigned blockOffset = position_ - blockStart;
+            unsigned copySize;
+
+            if (!blockOffset && sizeLeft >= blockDataSize && blockIndex != readBlockIndex_)
+            {
+                // Whole block requested, decompress directly to the destination
+                if (!ReadBlock(blockIndex, destPtr))
+                    break;
+                copySize = blockDataSize;
+            }
+            else
+            {
+                if (blockIndex != readBlockIndex_)
+                {
+                    if (!readBuffer_)
+                        readBuffer_ = new unsigned char[blockSize_];
+                    if (!ReadBlock(blockIndex, readBuffer_.Get()))
+                        break;
+                    readBlockIndex_ = blockIndex;
+                }
+
+                copySize = Min(blockDataSize - blockOffset, sizeLeft);
+                memcpy(destPtr, readBuffer_.Get() + blockOffset, copySize);
+            }
+
+            destPtr += copySize;
+            sizeLeft -= copySize;
+            position_ += copySize;
+        }
+
+        if (sizeLeft)
+            URHO3D_LOGERROR("Error while decompressing file " + GetName());
+
+        return size - sizeLeft;
+    }
+
     if (compressed_)
     {
         unsigned sizeLeft = size;
@@ -282,6 +369,13 @@ unsigned File::Seek(unsigned position)
     if (mode_ == FILE_READ && position > size_)
         position = size_;
 
+    // Block compressed entries decompress the block containing the new position on the next read
+    if (blockSize_)
+    {
+        position_ = position;
+        return position_;
+    }
+
     if (compressed_)
     {
         // Start over from the beginning
@@ -393,6 +487,9 @@ void File::Close()
 
     readBuffer_.Reset();
     inputBuffer_.Reset();
+    blockOffsets_.Clear();
+    blockSize_ = 0;
+    readBlockIndex_ = M_MAX_UNSIGNED;
 
     if (handle_)
     {
@@ -403,6 +500,17 @@ void File::Close()
         offset_ = 0;
         checksum_ = 0;
     }
+
+    if (mappedData_)
+    {
+        mappedData_ = nullptr;
+        mappedPosition_ = 0;
+        package_.Reset();
+        position_ = 0;
+        size_ = 0;
+        offset_ = 0;
+        checksum_ = 0;
+    }
 }
 
 void File::Flush()
@@ -419,9 +527,9 @@ void File::SetName(const String& name)
 bool File::IsOpen() const
 {
 #ifdef __ANDROID__
-    return handle_ != 0 || assetHandle_ != 0;
+    return handle_ != 0 || assetHandle_ != 0 || mappedData_ != 0;
 #else
-    return handle_ != nullptr;
+    return handle_ != nullptr || mappedData_ != nullptr;
 #endif
 }
 
@@ -525,6 +633,15 @@ bool File::OpenInternal(const String& fileName, FileMode mode, bool fromPackage)
 
 bool File::ReadInternal(void* dest, unsigned size)
 {
+    if (mappedData_)
+    {
+        if (mappedPosition_ + size > package_->GetTotalSize())
+            return false;
+        memcpy(dest, mappedData_ + mappedPosition_, size);
+        mappedPosition_ += size;
+        return true;
+    }
+
 #ifdef __ANDROID__
     if (assetHandle_)
     {
@@ -537,6 +654,12 @@ bool File::ReadInternal(void* dest, unsigned size)
 
 void File::SeekInternal(unsigned newPosition)
 {
+    if (mappedData_)
+    {
+        mappedPosition_ = newPosition;
+        return;
+    }
+
 #ifdef __ANDROID__
     if (assetHandle_)
     {
@@ -550,4 +673,29 @@ void File::SeekInternal(unsigned newPosition)
         fseek((FILE*)handle_, newPosition, SEEK_SET);
 }
 
+bool File::ReadBlock(unsigned index, unsigned char* dest)
+{
+    unsigned packedSize = blockOffsets_[index + 1] - blockOffsets_[index];
+    unsigned unpackedSize = Min(size_ - index * blockSize_, blockSize_);
+    const char* source;
+
+    if (mappedData_)
+        source = (const char*)mappedData_ + offset_ + blockOffsets_[index];
+    else
+    {
+        auto maxPackedSize = (unsigned)LZ4_compressBound(blockSize_);
+        if (packedSize > maxPackedSize)
+            return false;
+        if (!inputBuffer_)
+            inputBuffer_ = new unsigned char[maxPackedSize];
+
+        SeekInternal(offset_ + blockOffsets_[index]);
+        if (!ReadInternal(inputBuffer_.Get(), packedSize))
+            return false;
+        source = (const char*)inputBuffer_.Get();
+    }
+
+    return LZ4_decompress_safe(source, (char*)dest, packedSize, unpackedSize) == (int)unpackedSize;
+}
+
 }
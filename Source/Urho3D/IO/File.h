@@ -107,6 +107,9 @@ public:
     /// Return whether the file originates from a package.
     bool IsPackaged() const { return offset_ != 0; }
 
+    /// Return the contents of an uncompressed entry of a memory mapped package file, or null if not available. Can be read through a MemoryBuffer without copying, and stays valid as long as the file is open.
+    const unsigned char* GetMappedData() const { return mappedData_ && !compressed_ && !blockSize_ ? mappedData_ + offset_ : nullptr; }
+
 private:
     /// Open file internally using either C standard IO functions or SDL RWops for Android asset files. Return true if successful.
     bool OpenInternal(const String& fileName, FileMode mode, bool fromPackage = false);
@@ -114,6 +117,8 @@ private:
     bool ReadInternal(void* dest, unsigned size);
     /// Seek in file internally using either C standard IO functions or SDL RWops for Android asset files.
     void SeekInternal(unsigned newPosition);
+    /// Decompress a block of a block compressed package entry. Return true if successful.
+    bool ReadBlock(unsigned index, unsigned char* dest);
 
     /// File name.
     String fileName_;
@@ -125,6 +130,18 @@ private:
     /// SDL RWops context for Android asset loading.
     SDL_RWops* assetHandle_;
 #endif
+    /// Package file when reading from a memory mapped package. Keeps the mapping alive.
+    SharedPtr<PackageFile> package_;
+    /// Memory mapped package file contents.
+    const unsigned char* mappedData_;
+    /// Read position within the memory mapped package file.
+    unsigned mappedPosition_;
+    /// Offsets of a block compressed entry's blocks from the start of the entry, followed by the end offset.
+    PODVector<unsigned> blockOffsets_;
+    /// Uncompressed block size of a block compressed entry, 0 otherwise.
+    unsigned blockSize_;
+    /// Index of the block in the read buffer.
+    unsigned readBlockIndex_;
     /// Read buffer for Android asset or compressed file loading.
     SharedArrayPtr<unsigned char> readBuffer_;
     /// Decompression input buffer for compressed file loading.
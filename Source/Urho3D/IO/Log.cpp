@@ -31,7 +31,12 @@
 #include "../IO/IOEvents.h"
 #include "../IO/Log.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <ctime>
+#include <mutex>
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -55,11 +60,213 @@ const char* logLevelPrefixes[] =
     nullptr
 };
 
+/// Number of messages the log queue can hold. Must be a power of two.
+static const unsigned LOG_QUEUE_SIZE = 4096;
+/// Maximum number of messages output with one console and file write.
+static const unsigned LOG_WRITE_BATCH = 256;
+
 static Log* logInstance = nullptr;
 static bool threadErrorDisplayed = false;
+/// Next index to give to a thread writing to the log.
+static std::atomic<unsigned> nextLogThreadIndex(1);
+/// Log thread index of the calling thread, assigned on its first message.
+static thread_local unsigned logThreadIndex = 0;
+/// Whether the calling thread is outputting queued messages. It is then the only reader of the queue, so it must not wait for room.
+static thread_local bool writingQueuedMessages = false;
+
+/// Slot of the log message queue.
+struct LogQueueSlot
+{
+    /// Sequence number telling whether the slot is free or holds a message.
+    std::atomic<unsigned> sequence_;
+    /// Message.
+    StoredLogMessage message_;
+};
+
+/// Bounded lock-free log message queue, written by any thread and read by the writer thread only.
+struct LogQueue
+{
+    /// Construct.
+    LogQueue() :
+        slots_(new LogQueueSlot[LOG_QUEUE_SIZE]),
+        enqueuePos_(0),
+        dequeuePos_(0),
+        numWritten_(0),
+        numDropped_(0),
+        numBlocked_(0),
+        startTick_(std::chrono::steady_clock::now()),
+        writerWaiting_(false),
+        writerStopped_(false)
+    {
+        for (unsigned i = 0; i < LOG_QUEUE_SIZE; ++i)
+            slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+
+    /// Destruct.
+    ~LogQueue()
+    {
+        delete[] slots_;
+    }
+
+    /// Copy a message to a free slot. Return false if the queue is full. The slot strings keep their capacity, so this does not allocate once the queue has warmed up.
+    bool Push(const String& message, int level, bool error, unsigned threadIndex, long long time)
+    {
+        unsigned pos = enqueuePos_.load(std::memory_order_relaxed);
+        LogQueueSlot* slot;
+        for (;;)
+        {
+            slot = &slots_[pos & (LOG_QUEUE_SIZE - 1)];
+            int diff = (int)(slot->sequence_.load(std::memory_order_acquire) - pos);
+            if (!diff)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+
+        StoredLogMessage& stored = slot->message_;
+        stored.message_ = message;
+        stored.level_ = level;
+        stored.error_ = error;
+        stored.threadIndex_ = threadIndex;
+        stored.time_ = time;
+        slot->sequence_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Return the oldest message, or null if the queue is empty.
+    StoredLogMessage* Front()
+    {
+        LogQueueSlot& slot = slots_[dequeuePos_ & (LOG_QUEUE_SIZE - 1)];
+        return slot.sequence_.load(std::memory_order_acquire) == dequeuePos_ + 1 ? &slot.message_ : nullptr;
+    }
+
+    /// Free the oldest message's slot.
+    void Pop()
+    {
+        slots_[dequeuePos_ & (LOG_QUEUE_SIZE - 1)].sequence_.store(dequeuePos_ + LOG_QUEUE_SIZE, std::memory_order_release);
+        ++dequeuePos_;
+    }
+
+    /// Wake the writer thread if it is waiting for messages. Called after pushing a message.
+    void WakeWriter()
+    {
+        // Pairs with the fence in WaitForMessages(): either the writer sees the new message, or the waiting flag is seen here
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writerWaiting_.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wakeCondition_.notify_one();
+        }
+    }
+
+    /// Block the writer thread until a message is queued or the writer is stopped.
+    void WaitForMessages()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        writerWaiting_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!writerStopped_ && !Front())
+            wakeCondition_.wait(lock);
+        writerWaiting_.store(false, std::memory_order_relaxed);
+    }
+
+    /// Stop the writer thread from waiting for messages.
+    void StopWriter()
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        writerStopped_ = true;
+        wakeCondition_.notify_one();
+    }
+
+    /// Return microseconds since the queue was created.
+    long long GetTime() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTick_).count();
+    }
+
+    /// Slots.
+    LogQueueSlot* slots_;
+    /// Position of the next message to be written.
+    std::atomic<unsigned> enqueuePos_;
+    /// Position of the next message to be read. Only accessed by the reader.
+    unsigned dequeuePos_;
+    /// Number of messages output so far.
+    std::atomic<unsigned> numWritten_;
+    /// Number of messages dropped because the queue was full.
+    std::atomic<unsigned> numDropped_;
+    /// Number of writes that waited for room in the queue.
+    std::atomic<unsigned> numBlocked_;
+    /// Monotonic time when the queue was created.
+    std::chrono::steady_clock::time_point startTick_;
+    /// Mutex for waking the writer thread.
+    std::mutex wakeMutex_;
+    /// Condition the writer thread waits on when there are no messages.
+    std::condition_variable wakeCondition_;
+    /// Whether the writer thread is waiting for messages.
+    std::atomic<bool> writerWaiting_;
+    /// Whether the writer thread is being stopped. Accessed under the wake mutex.
+    bool writerStopped_;
+};
+
+/// Thread that outputs queued log messages in batches.
+class LogWriterThread : public Thread, public RefCounted
+{
+public:
+    /// Construct.
+    explicit LogWriterThread(Log* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Output messages until stopped, then output the remaining ones. Sleep while there are no messages.
+    void ThreadFunction() override
+    {
+        while (shouldRun_)
+        {
+            if (!owner_->WriteQueuedMessages())
+                owner_->queue_->WaitForMessages();
+        }
+        owner_->WriteQueuedMessages();
+    }
+
+private:
+    /// Log subsystem.
+    Log* owner_;
+};
+
+/// Return the log thread index of the calling thread, 0 for the main thread.
+static unsigned GetLogThreadIndex()
+{
+    if (Thread::IsMainThread())
+        return 0;
+    if (!logThreadIndex)
+        logThreadIndex = nextLogThreadIndex++;
+    return logThreadIndex;
+}
+
+/// Format a wall clock time like Time::GetTimeStamp(). Safe to call from any thread.
+static String FormatTimeStamp(long long seconds)
+{
+    time_t sysTime = (time_t)seconds;
+    tm localTime;
+#ifdef _WIN32
+    localtime_s(&localTime, &sysTime);
+#else
+    localtime_r(&sysTime, &localTime);
+#endif
+    char buffer[64];
+    strftime(buffer, sizeof buffer, "%a %b %e %H:%M:%S %Y", &localTime);
+    return String(buffer);
+}
 
 Log::Log(Context* context) :
     Object(context),
+    queue_(new LogQueue()),
 #ifdef _DEBUG
     level_(LOG_DEBUG),
 #else
@@ -67,16 +274,32 @@ Log::Log(Context* context) :
 #endif
     timeStamp_(true),
     inWrite_(false),
-    quiet_(false)
+    quiet_(false),
+    overflowMode_(LOG_OVERFLOW_DROP),
+    startTime_((long long)time(nullptr))
 {
     logInstance = this;
 
+    // Without threading support the messages are output from the main thread as before
+    writerThread_ = new LogWriterThread(this);
+    if (!writerThread_->Run())
+        writerThread_.Reset();
+
     SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(Log, HandleEndFrame));
 }
 
 Log::~Log()
 {
     logInstance = nullptr;
+
+    if (writerThread_)
+    {
+        queue_->StopWriter();
+        writerThread_->Stop();
+        writerThread_.Reset();
+    }
+    else
+        WriteQueuedMessages();
 }
 
 void Log::Open(const String& fileName)
@@ -92,14 +315,17 @@ void Log::Open(const String& fileName)
             Close();
     }
 
-    logFile_ = new File(context_);
-    if (logFile_->Open(fileName, FILE_WRITE))
+    SharedPtr<File> logFile(new File(context_));
+    if (logFile->Open(fileName, FILE_WRITE))
+    {
+        {
+            MutexLock lock(fileMutex_);
+            logFile_ = logFile;
+        }
         Write(LOG_INFO, "Opened log file " + fileName);
+    }
     else
-    {
-        logFile_.Reset();
         Write(LOG_ERROR, "Failed to create log file " + fileName);
-    }
 #endif
 }
 
@@ -108,6 +334,10 @@ void Log::Close()
 #if !defined(__ANDROID__) && !defined(IOS)
     if (logFile_ && logFile_->IsOpen())
     {
+        // Write out the messages queued so far before closing
+        Flush();
+
+        MutexLock lock(fileMutex_);
         logFile_->Close();
         logFile_.Reset();
     }
@@ -135,6 +365,39 @@ void Log::SetQuiet(bool quiet)
     quiet_ = quiet;
 }
 
+void Log::SetOverflowMode(LogOverflowMode mode)
+{
+    overflowMode_ = mode;
+}
+
+void Log::Flush()
+{
+    // The writer can not wait for itself
+    if (writingQueuedMessages)
+        return;
+
+    if (!writerThread_)
+    {
+        if (Thread::IsMainThread())
+            WriteQueuedMessages();
+        return;
+    }
+
+    unsigned target = queue_->enqueuePos_.load();
+    while ((int)(queue_->numWritten_.load() - target) < 0)
+        Time::Sleep(0);
+}
+
+unsigned Log::GetNumDroppedMessages() const
+{
+    return queue_->numDropped_.load();
+}
+
+unsigned Log::GetNumBlockedWrites() const
+{
+    return queue_->numBlocked_.load();
+}
+
 void Log::Write(int level, const String& message)
 {
     // Special case for LOG_RAW level
@@ -148,120 +411,245 @@ void Log::Write(int level, const String& message)
     if (level < LOG_TRACE || level >= LOG_NONE)
         return;
 
-    // If not in the main thread, store message for later processing
+    // Do not log if message level excluded
+    if (!logInstance || logInstance->level_ > level)
+        return;
+
+    // Messages from other threads only capture their fields here. The writer thread formats and outputs them and their
+    // log event is sent from the main thread at the end of the frame
     if (!Thread::IsMainThread())
     {
-        if (logInstance)
-        {
-            MutexLock lock(logInstance->logMutex_);
-            logInstance->threadMessages_.Push(StoredLogMessage(message, level, false));
-        }
-
+        logInstance->QueueMessage(message, level, false);
         return;
     }
 
-    // Do not log if message level excluded or if currently sending a log event
-    if (!logInstance || logInstance->level_ > level || logInstance->inWrite_)
+    // Do not log if currently sending a log event
+    if (logInstance->inWrite_)
         return;
 
-    String formattedMessage = logLevelPrefixes[level];
-    formattedMessage += ": " + message;
+    long long time = logInstance->QueueMessage(message, level, false);
     logInstance->lastMessage_ = message;
+    logInstance->SendMessageEvent(message, level, false, time);
+}
 
-    if (logInstance->timeStamp_)
-        formattedMessage = "[" + Time::GetTimeStamp() + "] " + formattedMessage;
+void Log::WriteRaw(const String& message, bool error)
+{
+    if (!logInstance)
+        return;
 
-#if defined(__ANDROID__)
-    int androidLevel = ANDROID_LOG_VERBOSE + level;
-    __android_log_print(androidLevel, "Urho3D", "%s", message.CString());
-#elif defined(IOS)
-    SDL_IOS_LogMessage(message.CString());
-#else
-    if (logInstance->quiet_)
+    if (!Thread::IsMainThread())
     {
-        // If in quiet mode, still print the error message to the standard error stream
-        if (level == LOG_ERROR)
-            PrintUnicodeLine(formattedMessage, true);
+        logInstance->QueueMessage(message, LOG_RAW, error);
+        return;
     }
-    else
-        PrintUnicodeLine(formattedMessage, level == LOG_ERROR);
-#endif
 
-    if (logInstance->logFile_)
+    // Prevent recursion during log event
+    if (logInstance->inWrite_)
+        return;
+
+    long long time = logInstance->QueueMessage(message, LOG_RAW, error);
+    logInstance->lastMessage_ = message;
+    logInstance->SendMessageEvent(message, LOG_RAW, error, time);
+}
+
+long long Log::QueueMessage(const String& message, int level, bool error)
+{
+    unsigned threadIndex = GetLogThreadIndex();
+    long long time = queue_->GetTime();
+
+    if (!queue_->Push(message, level, error, threadIndex, time))
     {
-        logInstance->logFile_->WriteLine(formattedMessage);
-        logInstance->logFile_->Flush();
+        // The thread outputting the queued messages can not wait for room, as it is the one making it. This happens for
+        // example when writing to the log file fails
+        if (overflowMode_ == LOG_OVERFLOW_DROP || writingQueuedMessages)
+        {
+            ++queue_->numDropped_;
+            return time;
+        }
+
+        ++queue_->numBlocked_;
+        do
+        {
+            // Without a writer thread only the main thread can make room
+            if (!writerThread_ && !threadIndex)
+                WriteQueuedMessages();
+            else
+            {
+                queue_->WakeWriter();
+                Time::Sleep(0);
+            }
+        }
+        while (!queue_->Push(message, level, error, threadIndex, time));
     }
 
-    logInstance->inWrite_ = true;
+    if (writerThread_)
+        queue_->WakeWriter();
+    else if (!threadIndex && !writingQueuedMessages)
+        WriteQueuedMessages();
+
+    return time;
+}
+
+void Log::SendMessageEvent(const String& message, int level, bool error, long long time)
+{
+    // Formatting is only needed for the event, so skip it when nobody listens
+    if (!context_->GetEventReceivers(E_LOGMESSAGE) && !context_->GetEventReceivers(this, E_LOGMESSAGE))
+        return;
+
+    inWrite_ = true;
 
     using namespace LogMessage;
 
-    VariantMap& eventData = logInstance->GetEventDataMap();
-    eventData[P_MESSAGE] = formattedMessage;
-    eventData[P_LEVEL] = level;
-    logInstance->SendEvent(E_LOGMESSAGE, eventData);
+    VariantMap& eventData = GetEventDataMap();
+    if (level == LOG_RAW)
+    {
+        eventData[P_MESSAGE] = message;
+        eventData[P_LEVEL] = error ? LOG_ERROR : LOG_INFO;
+    }
+    else
+    {
+        long long timeStampSecond = -1;
+        String timeStamp;
+        eventData[P_MESSAGE] = FormatMessage(message, level, time, timeStampSecond, timeStamp);
+        eventData[P_LEVEL] = level;
+    }
+    SendEvent(E_LOGMESSAGE, eventData);
 
-    logInstance->inWrite_ = false;
+    inWrite_ = false;
 }
 
-void Log::WriteRaw(const String& message, bool error)
+String Log::FormatMessage(const String& message, int level, long long time, long long& timeStampSecond, String& timeStamp) const
 {
-    // If not in the main thread, store message for later processing
-    if (!Thread::IsMainThread())
+    String formattedMessage;
+    if (timeStamp_)
     {
-        if (logInstance)
+        // Consecutive messages mostly fall on the same second, so reuse the formatted time
+        long long second = startTime_ + time / 1000000;
+        if (second != timeStampSecond)
         {
-            MutexLock lock(logInstance->logMutex_);
-            logInstance->threadMessages_.Push(StoredLogMessage(message, LOG_RAW, error));
+            timeStampSecond = second;
+            timeStamp = FormatTimeStamp(second);
         }
-
-        return;
+        formattedMessage.Reserve(timeStamp.Length() + message.Length() + 12);
+        formattedMessage += "[";
+        formattedMessage += timeStamp;
+        formattedMessage += "] ";
     }
+    formattedMessage += logLevelPrefixes[level];
+    formattedMessage += ": ";
+    formattedMessage += message;
+    return formattedMessage;
+}
 
-    // Prevent recursion during log event
-    if (!logInstance || logInstance->inWrite_)
-        return;
+bool Log::WriteQueuedMessages()
+{
+    writingQueuedMessages = true;
 
-    logInstance->lastMessage_ = message;
+    long long timeStampSecond = -1;
+    String timeStamp;
+    String consoleOutput;
+    String fileOutput;
+    bool written = false;
 
-#if defined(__ANDROID__)
-    if (logInstance->quiet_)
+    for (;;)
     {
-        if (error)
-            __android_log_print(ANDROID_LOG_ERROR, "Urho3D", "%s", message.CString());
-    }
-    else
-        __android_log_print(error ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO, "Urho3D", "%s", message.CString());
+        bool writeFile;
+        {
+            MutexLock lock(fileMutex_);
+            writeFile = logFile_ != nullptr;
+        }
+
+        unsigned numMessages = 0;
+        while (numMessages < LOG_WRITE_BATCH)
+        {
+            StoredLogMessage* stored = queue_->Front();
+            if (!stored)
+                break;
+
+            bool raw = stored->level_ == LOG_RAW;
+            bool error = raw ? stored->error_ : stored->level_ == LOG_ERROR;
+            String formattedMessage = raw ? stored->message_ :
+                FormatMessage(stored->message_, stored->level_, stored->time_, timeStampSecond, timeStamp);
+
+#if defined(__ANDROID__)
+            if (raw)
+            {
+                if (!quiet_ || error)
+                    __android_log_print(error ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO, "Urho3D", "%s", stored->message_.CString());
+            }
+            else
+                __android_log_print(ANDROID_LOG_VERBOSE + stored->level_, "Urho3D", "%s", stored->message_.CString());
 #elif defined(IOS)
-    SDL_IOS_LogMessage(message.CString());
+            SDL_IOS_LogMessage(stored->message_.CString());
 #else
-    if (logInstance->quiet_)
-    {
-        // If in quiet mode, still print the error message to the standard error stream
-        if (error)
-            PrintUnicode(message, true);
-    }
-    else
-        PrintUnicode(message, error);
+            // In quiet mode, still print the error messages to the standard error stream. Keep the order of
+            // standard output and error output by writing out the batched standard output first
+            if (error)
+            {
+                if (!consoleOutput.Empty())
+                {
+                    PrintUnicode(consoleOutput, false);
+                    consoleOutput.Clear();
+                }
+                PrintUnicode(raw ? formattedMessage : formattedMessage + "\n", true);
+            }
+            else if (!quiet_)
+            {
+                consoleOutput += formattedMessage;
+                if (!raw)
+                    consoleOutput += '\n';
+            }
 #endif
 
-    if (logInstance->logFile_)
-    {
-        logInstance->logFile_->Write(message.CString(), message.Length());
-        logInstance->logFile_->Flush();
-    }
+            if (writeFile)
+            {
+                fileOutput += formattedMessage;
+                if (!raw)
+                    fileOutput += '\n';
+            }
 
-    logInstance->inWrite_ = true;
+            // Messages from other threads get their log event later from the main thread
+            if (stored->threadIndex_)
+                batchEventMessages_.Push(*stored);
 
-    using namespace LogMessage;
+            queue_->Pop();
+            ++numMessages;
+        }
 
-    VariantMap& eventData = logInstance->GetEventDataMap();
-    eventData[P_MESSAGE] = message;
-    eventData[P_LEVEL] = error ? LOG_ERROR : LOG_INFO;
-    logInstance->SendEvent(E_LOGMESSAGE, eventData);
+        if (!numMessages)
+            break;
 
-    logInstance->inWrite_ = false;
+        if (!consoleOutput.Empty())
+        {
+            PrintUnicode(consoleOutput, false);
+            consoleOutput.Clear();
+        }
+        if (!fileOutput.Empty())
+        {
+            // Only Open() and Close() contend for the file, so the main loop does not wait for the write
+            MutexLock lock(fileMutex_);
+            if (logFile_)
+            {
+                logFile_->Write(fileOutput.CString(), fileOutput.Length());
+                logFile_->Flush();
+            }
+            fileOutput.Clear();
+        }
+        if (!batchEventMessages_.Empty())
+        {
+            // Do not let the event messages grow without bounds when the main loop is not running
+            MutexLock lock(eventMutex_);
+            for (unsigned i = 0; i < batchEventMessages_.Size() && eventMessages_.Size() < LOG_QUEUE_SIZE; ++i)
+                eventMessages_.Push(batchEventMessages_[i]);
+            batchEventMessages_.Clear();
+        }
+
+        queue_->numWritten_ += numMessages;
+        written = true;
+    }
+
+    writingQueuedMessages = false;
+    return written;
 }
 
 void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
@@ -277,19 +665,20 @@ void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
         return;
     }
 
-    MutexLock lock(logMutex_);
+    if (!writerThread_)
+        WriteQueuedMessages();
 
-    // Process messages accumulated from other threads (if any)
-    while (!threadMessages_.Empty())
+    Vector<StoredLogMessage> messages;
     {
-        const StoredLogMessage& stored = threadMessages_.Front();
-
-        if (stored.level_ != LOG_RAW)
-            Write(stored.level_, stored.message_);
-        else
-            WriteRaw(stored.message_, stored.error_);
+        MutexLock lock(eventMutex_);
+        messages.Swap(eventMessages_);
+    }
 
-        threadMessages_.PopFront();
+    // Send the log events for messages from other threads that have been output
+    for (Vector<StoredLogMessage>::ConstIterator i = messages.Begin(); i != messages.End(); ++i)
+    {
+        lastMessage_ = i->message_;
+        SendMessageEvent(i->message_, i->level_, i->error_, i->time_);
     }
 }
 
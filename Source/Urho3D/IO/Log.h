@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/List.h"
+#include "../Container/Ptr.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Core/StringUtils.h"
@@ -45,9 +46,20 @@ static const int LOG_ERROR = 4;
 /// Disable all log messages.
 static const int LOG_NONE = 5;
 
+/// Behavior when the log message queue is full.
+enum LogOverflowMode
+{
+    /// Drop the message and count it.
+    LOG_OVERFLOW_DROP = 0,
+    /// Wait until the writer thread has made room, and count the wait. Messages logged by the writer thread itself are dropped instead.
+    LOG_OVERFLOW_BLOCK
+};
+
 class File;
+class LogWriterThread;
+struct LogQueue;
 
-/// Stored log message from another thread.
+/// Stored log message waiting to be written.
 struct StoredLogMessage
 {
     /// Construct undefined.
@@ -57,7 +69,9 @@ struct StoredLogMessage
     StoredLogMessage(const String& message, int level, bool error) :
         message_(message),
         level_(level),
-        error_(error)
+        error_(error),
+        threadIndex_(0),
+        time_(0)
     {
     }
 
@@ -67,6 +81,10 @@ struct StoredLogMessage
     int level_;
     /// Error flag for raw messages.
     bool error_;
+    /// Index of the thread that wrote the message, 0 for the main thread.
+    unsigned threadIndex_;
+    /// Monotonic time of writing in microseconds since the log subsystem was created.
+    long long time_;
 };
 
 /// Logging subsystem.
@@ -90,6 +108,10 @@ public:
     void SetTimeStamp(bool enable);
     /// Set quiet mode ie. only print error entries to standard error stream (which is normally redirected to console also). Output to log file is not affected by this mode.
     void SetQuiet(bool quiet);
+    /// Set what to do when messages are written faster than the writer thread can output them. Default is to drop them.
+    void SetOverflowMode(LogOverflowMode mode);
+    /// Wait until all messages written so far have been output to the console and the log file.
+    void Flush();
 
     /// Return logging level.
     int GetLevel() const { return level_; }
@@ -103,19 +125,45 @@ public:
     /// Return whether log is in quiet mode (only errors printed to standard error stream).
     bool IsQuiet() const { return quiet_; }
 
+    /// Return overflow mode.
+    LogOverflowMode GetOverflowMode() const { return overflowMode_; }
+
+    /// Return number of messages dropped because the queue was full.
+    unsigned GetNumDroppedMessages() const;
+    /// Return number of writes that had to wait for room in the queue.
+    unsigned GetNumBlockedWrites() const;
+
     /// Write to the log. If logging level is higher than the level of the message, the message is ignored.
     static void Write(int level, const String& message);
     /// Write raw output to the log.
     static void WriteRaw(const String& message, bool error = false);
 
 private:
-    /// Handle end of frame. Process the threaded log messages.
-    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+    friend class LogWriterThread;
 
-    /// Mutex for threaded operation.
-    Mutex logMutex_;
-    /// Log messages from other threads.
-    List<StoredLogMessage> threadMessages_;
+    /// Handle end of frame. Send the log events for messages from other threads.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+    /// Add a message to the queue and output it right away if there is no writer thread. Return the message's timestamp.
+    long long QueueMessage(const String& message, int level, bool error);
+    /// Send the log message event. Called from the main thread.
+    void SendMessageEvent(const String& message, int level, bool error, long long time);
+    /// Format a message with its level prefix and, if enabled, a timestamp.
+    String FormatMessage(const String& message, int level, long long time, long long& timeStampSecond, String& timeStamp) const;
+    /// Output queued messages to the console and the log file. Called from the writer thread, or from the main thread if there is none. Return whether any messages were output.
+    bool WriteQueuedMessages();
+
+    /// Lock-free queue of messages waiting to be output.
+    UniquePtr<LogQueue> queue_;
+    /// Writer thread.
+    SharedPtr<LogWriterThread> writerThread_;
+    /// Mutex for the log file, held by the writer thread while writing to it and by Open() and Close().
+    Mutex fileMutex_;
+    /// Mutex for the event messages, held only while adding or taking them.
+    Mutex eventMutex_;
+    /// Messages from other threads already output, waiting for their log event to be sent from the main thread.
+    Vector<StoredLogMessage> eventMessages_;
+    /// Messages from other threads output in the current batch. Accessed only by the thread writing the queued messages.
+    Vector<StoredLogMessage> batchEventMessages_;
     /// Log file.
     SharedPtr<File> logFile_;
     /// Last log message.
@@ -128,6 +176,10 @@ private:
     bool inWrite_;
     /// Quiet mode flag.
     bool quiet_;
+    /// Overflow mode.
+    LogOverflowMode overflowMode_;
+    /// Wall clock time in seconds when the log subsystem was created, for formatting timestamps.
+    long long startTime_;
 };
 
 #ifdef URHO3D_LOGGING
@@ -23,9 +23,18 @@
 #include "../Precompiled.h"
 
 #include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/PackageFile.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace Urho3D
 {
 
@@ -34,6 +43,9 @@ PackageFile::PackageFile(Context* context) :
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
+    blockSize_(0),
+    mappedData_(nullptr),
+    mappedSize_(0),
     compressed_(false)
 {
 }
@@ -43,12 +55,18 @@ PackageFile::PackageFile(Context* context, const String& fileName, unsigned star
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
+    blockSize_(0),
+    mappedData_(nullptr),
+    mappedSize_(0),
     compressed_(false)
 {
     Open(fileName, startOffset);
 }
 
-PackageFile::~PackageFile() = default;
+PackageFile::~PackageFile()
+{
+    Unmap();
+}
 
 bool PackageFile::Open(const String& fileName, unsigned startOffset)
 {
@@ -59,7 +77,7 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
     // Check ID, then read the directory
     file->Seek(startOffset);
     String id = file->ReadFileID();
-    if (id != "UPAK" && id != "ULZ4")
+    if (id != "UPAK" && id != "ULZ4" && id != "ULZB")
     {
         // If start offset has not been explicitly specified, also try to read package size from the end of file
         // to know how much we must rewind to find the package start
@@ -76,7 +94,7 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
             }
         }
 
-        if (id != "UPAK" && id != "ULZ4")
+        if (id != "UPAK" && id != "ULZ4" && id != "ULZB")
         {
             URHO3D_LOGERROR(fileName + " is not a valid package file");
             return false;
@@ -86,10 +104,12 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
     fileName_ = fileName;
     nameHash_ = fileName_;
     totalSize_ = file->GetSize();
-    compressed_ = id == "ULZ4";
+    compressed_ = id == "ULZ4" || id == "ULZB";
 
     unsigned numFiles = file->ReadUInt();
     checksum_ = file->ReadUInt();
+    // Block compressed packages store each entry as independently compressed blocks of fixed uncompressed size
+    blockSize_ = id == "ULZB" ? file->ReadUInt() : 0;
 
     for (unsigned i = 0; i < numFiles; ++i)
     {
@@ -98,7 +118,8 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
         newEntry.offset_ = file->ReadUInt() + startOffset;
         totalDataSize_ += (newEntry.size_ = file->ReadUInt());
         newEntry.checksum_ = file->ReadUInt();
-        if (!compressed_ && newEntry.offset_ + newEntry.size_ > totalSize_)
+        newEntry.compressed_ = blockSize_ ? file->ReadUByte() != 0 : compressed_;
+        if (!newEntry.compressed_ && newEntry.offset_ + newEntry.size_ > totalSize_)
         {
             URHO3D_LOGERROR("File entry " + entryName + " outside package file");
             return false;
@@ -107,6 +128,10 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
             entries_[entryName] = newEntry;
     }
 
+    // Reading entries from a mapping avoids a system call per read. Fall back to file reads if mapping is not possible
+    file->Close();
+    Map();
+
     return true;
 }
 
@@ -153,4 +178,62 @@ const PackageEntry* PackageFile::GetEntry(const String& fileName) const
     return nullptr;
 }
 
+bool PackageFile::Map()
+{
+    Unmap();
+
+#ifdef __ANDROID__
+    if (URHO3D_IS_ASSET(fileName_))
+        return false;
+#endif
+
+    if (!totalSize_)
+        return false;
+
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileW(GetWideNativePath(fileName_).CString(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    // The view keeps the mapping alive, so both handles can be closed right away
+    HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(fileHandle);
+    if (!mappingHandle)
+        return false;
+
+    mappedData_ = (unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, totalSize_);
+    CloseHandle(mappingHandle);
+#elif !defined(__EMSCRIPTEN__)
+    int fd = open(GetNativePath(fileName_).CString(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    void* data = mmap(nullptr, totalSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    mappedData_ = data != MAP_FAILED ? (unsigned char*)data : nullptr;
+#endif
+
+    if (!mappedData_)
+        return false;
+
+    mappedSize_ = totalSize_;
+    return true;
+}
+
+void PackageFile::Unmap()
+{
+    if (!mappedData_)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mappedData_);
+#elif !defined(__EMSCRIPTEN__)
+    munmap(mappedData_, mappedSize_);
+#endif
+
+    mappedData_ = nullptr;
+    mappedSize_ = 0;
+}
+
 }
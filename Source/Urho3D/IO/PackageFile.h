@@ -36,6 +36,8 @@ struct PackageEntry
     unsigned size_;
     /// File checksum.
     unsigned checksum_;
+    /// Whether the entry is stored as LZ4 compressed blocks. Only used by block compressed package files, where incompressible entries are stored as is.
+    bool compressed_;
 };
 
 /// Stores files of a directory tree sequentially for convenient access.
@@ -82,10 +84,24 @@ public:
     /// Return whether the files are compressed.
     bool IsCompressed() const { return compressed_; }
 
+    /// Return uncompressed size of the compressed blocks, or 0 if the package is not block compressed. Block compressed entries support random access.
+    unsigned GetBlockSize() const { return blockSize_; }
+
+    /// Return whether the package file is memory mapped.
+    bool IsMapped() const { return mappedData_ != nullptr; }
+
+    /// Return the memory mapped package file contents, or null if not mapped.
+    const unsigned char* GetMappedData() const { return mappedData_; }
+
     /// Return list of file names in the package.
     const Vector<String> GetEntryNames() const { return entries_.Keys(); }
 
 private:
+    /// Memory map the package file for reading. Return true if successful.
+    bool Map();
+    /// Release the memory mapping.
+    void Unmap();
+
     /// File entries.
     HashMap<String, PackageEntry> entries_;
     /// File name.
@@ -98,6 +114,12 @@ private:
     unsigned totalDataSize_;
     /// Package file checksum.
     unsigned checksum_;
+    /// Block size of a block compressed package file, 0 otherwise.
+    unsigned blockSize_;
+    /// Memory mapped package file contents.
+    unsigned char* mappedData_;
+    /// Size of the memory mapping.
+    unsigned mappedSize_;
     /// Compressed flag.
     bool compressed_;
 };
@@ -137,7 +137,8 @@ end
 
 function is_arithmetic(t)
     for _, type in pairs({ "char", "short", "int", "unsigned", "long", "float", "double", "bool" }) do
-        _, pos = t:find(type)
+        -- Match whole words only, so that e.g. "PhysicsContactPoint" is not mistaken for "int"
+        _, pos = t:find("%f[%w_]" .. type .. "%f[^%w_]")
         if pos ~= nil and t:sub(pos + 1, pos + 1) ~= "*" then return true end
     end
     return false
@@ -186,6 +186,50 @@ void Frustum::Transform(const Matrix3x4& transform)
     UpdatePlanes();
 }
 
+unsigned Frustum::IsInsideFastSoA(const float* boxes) const
+{
+#ifdef URHO3D_SSE
+    const __m128 half = _mm_set1_ps(0.5f);
+    __m128 minX = _mm_loadu_ps(boxes);
+    __m128 minY = _mm_loadu_ps(boxes + 4);
+    __m128 minZ = _mm_loadu_ps(boxes + 8);
+    __m128 maxX = _mm_loadu_ps(boxes + 12);
+    __m128 maxY = _mm_loadu_ps(boxes + 16);
+    __m128 maxZ = _mm_loadu_ps(boxes + 20);
+    __m128 centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+    __m128 centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+    __m128 centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+    __m128 edgeX = _mm_sub_ps(centerX, minX);
+    __m128 edgeY = _mm_sub_ps(centerY, minY);
+    __m128 edgeZ = _mm_sub_ps(centerZ, minZ);
+    __m128 outside = _mm_setzero_ps();
+
+    for (const auto& plane : planes_)
+    {
+        __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal_.x_), centerX),
+            _mm_mul_ps(_mm_set1_ps(plane.normal_.y_), centerY)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal_.z_), centerZ),
+            _mm_set1_ps(plane.d_)));
+        __m128 absDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.absNormal_.x_), edgeX),
+            _mm_mul_ps(_mm_set1_ps(plane.absNormal_.y_), edgeY)), _mm_mul_ps(_mm_set1_ps(plane.absNormal_.z_), edgeZ));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), absDist)));
+    }
+
+    return ~(unsigned)_mm_movemask_ps(outside) & ((1u << BOX_SOA_GROUP_SIZE) - 1);
+#else
+    unsigned mask = 0;
+
+    for (unsigned i = 0; i < BOX_SOA_GROUP_SIZE; ++i)
+    {
+        Vector3 min(boxes[i], boxes[i + 4], boxes[i + 8]);
+        Vector3 max(boxes[i + 12], boxes[i + 16], boxes[i + 20]);
+        if (IsInsideFast(BoundingBox(min, max)) != OUTSIDE)
+            mask |= 1u << i;
+    }
+
+    return mask;
+#endif
+}
+
 Frustum Frustum::Transformed(const Matrix3& transform) const
 {
     Frustum transformed;
@@ -44,6 +44,10 @@ enum FrustumPlane
 
 static const unsigned NUM_FRUSTUM_PLANES = 6;
 static const unsigned NUM_FRUSTUM_VERTICES = 8;
+/// Number of bounding boxes in a structure-of-arrays group.
+static const unsigned BOX_SOA_GROUP_SIZE = 4;
+/// Number of floats in a structure-of-arrays group: the min X, Y and Z followed by the max X, Y and Z of each box.
+static const unsigned BOX_SOA_GROUP_FLOATS = 6 * BOX_SOA_GROUP_SIZE;
 
 /// Convex constructed of 6 planes.
 class URHO3D_API Frustum
@@ -156,6 +160,9 @@ public:
         return INSIDE;
     }
 
+    /// Test a group of bounding boxes in structure-of-arrays form for being outside. Return a mask with a bit set for each box that is inside or intersects.
+    unsigned IsInsideFastSoA(const float* boxes) const;
+
     /// Return distance of a point to the frustum, or 0 if inside.
     float Distance(const Vector3& point) const
     {
@@ -34,11 +34,6 @@ namespace Urho3D
 
 const StringHash StringHash::ZERO;
 
-StringHash::StringHash(const char* str) noexcept :
-    value_(Calculate(str))
-{
-}
-
 StringHash::StringHash(const String& str) noexcept :
     value_(Calculate(str.CString()))
 {
@@ -51,9 +46,10 @@ unsigned StringHash::Calculate(const char* str, unsigned hash)
 
     while (*str)
     {
-        // Perform the actual hashing as case-insensitive
+        // Perform the actual hashing as case-insensitive. Only ASCII letters are lowercased, as in the constant expression
+        // version used by the const char* constructor
         char c = *str;
-        hash = SDBMHash(hash, (unsigned char)tolower(c));
+        hash = SDBMHash(hash, ToLowerASCII(c));
         ++str;
     }
 
@@ -32,7 +32,7 @@ class URHO3D_API StringHash
 {
 public:
     /// Construct with zero value.
-    StringHash() noexcept :
+    constexpr StringHash() noexcept :
         value_(0)
     {
     }
@@ -41,13 +41,17 @@ public:
     StringHash(const StringHash& rhs) noexcept = default;
 
     /// Construct with an initial value.
-    explicit StringHash(unsigned value) noexcept :
+    constexpr explicit StringHash(unsigned value) noexcept :
         value_(value)
     {
     }
 
-    /// Construct from a C string case-insensitively.
-    StringHash(const char* str) noexcept;        // NOLINT(google-explicit-constructor)
+    /// Construct from a C string case-insensitively. Is evaluated at compile time when used in a constant expression.
+    constexpr StringHash(const char* str) noexcept :        // NOLINT(google-explicit-constructor)
+        value_(CalculateConstexpr(str, 0))
+    {
+    }
+
     /// Construct from a string case-insensitively.
     StringHash(const String& str) noexcept;      // NOLINT(google-explicit-constructor)
 
@@ -70,28 +74,28 @@ public:
     }
 
     /// Test for equality with another hash.
-    bool operator ==(const StringHash& rhs) const { return value_ == rhs.value_; }
+    constexpr bool operator ==(const StringHash& rhs) const { return value_ == rhs.value_; }
 
     /// Test for inequality with another hash.
-    bool operator !=(const StringHash& rhs) const { return value_ != rhs.value_; }
+    constexpr bool operator !=(const StringHash& rhs) const { return value_ != rhs.value_; }
 
     /// Test if less than another hash.
-    bool operator <(const StringHash& rhs) const { return value_ < rhs.value_; }
+    constexpr bool operator <(const StringHash& rhs) const { return value_ < rhs.value_; }
 
     /// Test if greater than another hash.
-    bool operator >(const StringHash& rhs) const { return value_ > rhs.value_; }
+    constexpr bool operator >(const StringHash& rhs) const { return value_ > rhs.value_; }
 
     /// Return true if nonzero hash value.
-    explicit operator bool() const { return value_ != 0; }
+    constexpr explicit operator bool() const { return value_ != 0; }
 
-    /// Return hash value.
-    unsigned Value() const { return value_; }
+    /// Return hash value. Can be used as a switch case label for hashes constructed from string literals.
+    constexpr unsigned Value() const { return value_; }
 
     /// Return as string.
     String ToString() const;
 
     /// Return hash value for HashSet & HashMap.
-    unsigned ToHash() const { return value_; }
+    constexpr unsigned ToHash() const { return value_; }
 
     /// Calculate hash value case-insensitively from a C string.
     static unsigned Calculate(const char* str, unsigned hash = 0);
@@ -100,6 +104,15 @@ public:
     static const StringHash ZERO;
 
 private:
+    /// Return character in lowercase if it is an ASCII uppercase letter.
+    static constexpr unsigned char ToLowerASCII(char c) { return (unsigned char)(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c); }
+
+    /// Calculate hash value case-insensitively from a C string in a constant expression. Same as Calculate().
+    static constexpr unsigned CalculateConstexpr(const char* str, unsigned hash)
+    {
+        return str && *str ? CalculateConstexpr(str + 1, ToLowerASCII(*str) + (hash << 6) + (hash << 16) - hash) : hash;
+    }
+
     /// Hash value.
     unsigned value_;
 };
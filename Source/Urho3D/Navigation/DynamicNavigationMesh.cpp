@@ -427,32 +427,11 @@ bool DynamicNavigationMesh::Build()
         }
 
         // Build each tile
-        unsigned numTiles = 0;
-
-        for (int z = 0; z < numTilesZ_; ++z)
-        {
-            for (int x = 0; x < numTilesX_; ++x)
-            {
-                TileCacheData tiles[TILECACHE_MAXLAYERS];
-                int layerCt = BuildTile(geometryList, x, z, tiles);
-                for (int i = 0; i < layerCt; ++i)
-                {
-                    dtCompressedTileRef tileRef;
-                    int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                    if (dtStatusFailed((dtStatus)status))
-                    {
-                        dtFree(tiles[i].data);
-                        tiles[i].data = nullptr;
-                    }
-                }
-                tileCache_->buildNavMeshTilesAt(x, z, navMesh_);
-                ++numTiles;
-            }
-        }
+        unsigned numTiles = BuildTiles(geometryList, IntVector2::ZERO, GetNumTiles() - IntVector2::ONE);
 
         // For a full build it's necessary to update the nav mesh
         // not doing so will cause dependent components to crash, like CrowdManager
-        tileCache_->update(0, navMesh_);
+        UpdateTileCache(0.0f);
 
         URHO3D_LOGDEBUG("Built navigation mesh with " + String(numTiles) + " tiles");
 
@@ -495,19 +474,12 @@ bool DynamicNavigationMesh::Build(const BoundingBox& boundingBox)
     if (!node_->GetWorldScale().Equals(Vector3::ONE))
         URHO3D_LOGWARNING("Navigation mesh root node has scaling. Agent parameters may not work as intended");
 
-    BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
-
-    float tileEdgeLength = (float)tileSize_ * cellSize_;
-
     Vector<NavigationGeometryInfo> geometryList;
     CollectGeometries(geometryList);
 
-    int sx = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int sz = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
-    int ex = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int ez = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
-
-    unsigned numTiles = BuildTiles(geometryList, IntVector2(sx, sz), IntVector2(ex, ez));
+    IntVector2 from, to;
+    GetTileRange(boundingBox, from, to);
+    unsigned numTiles = BuildTiles(geometryList, from, to);
 
     URHO3D_LOGDEBUG("Rebuilt " + String(numTiles) + " tiles of the navigation mesh");
     return true;
@@ -798,8 +770,10 @@ bool DynamicNavigationMesh::ReadTiles(Deserializer& source, bool silent)
 
     for (unsigned i = 0; i < tileQueue_.Size(); ++i)
         tileCache_->buildNavMeshTilesAt(tileQueue_[i].x_, tileQueue_[i].y_, navMesh_);
+    if (!tileQueue_.Empty())
+        RequeuePathRequests(false);
 
-    tileCache_->update(0, navMesh_);
+    UpdateTileCache(0.0f);
 
     // Send event
     if (!silent)
@@ -817,16 +791,13 @@ bool DynamicNavigationMesh::ReadTiles(Deserializer& source, bool silent)
     return true;
 }
 
-int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles)
+bool DynamicNavigationMesh::BuildTileData(DynamicNavBuildData& build, Vector<NavigationGeometryInfo>& geometryList, int x, int z,
+    PODVector<TileCacheData>& tiles)
 {
-    URHO3D_PROFILE(BuildNavigationMeshTile);
-
-    tileCache_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+    tiles.Clear();
 
     const BoundingBox tileBoundingBox = GetTileBoudningBox(IntVector2(x, z));
 
-    DynamicNavBuildData build(allocator_.Get());
-
     rcConfig cfg;   // NOLINT(hicpp-member-init)
     memset(&cfg, 0, sizeof cfg);
     cfg.cs = cellSize_;
@@ -858,20 +829,20 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
     GetTileGeometry(&build, geometryList, expandedBox);
 
     if (build.vertices_.Empty() || build.indices_.Empty())
-        return 0; // Nothing to do
+        return true; // Nothing to do
 
     build.heightField_ = rcAllocHeightfield();
     if (!build.heightField_)
     {
         URHO3D_LOGERROR("Could not allocate heightfield");
-        return 0;
+        return false;
     }
 
     if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
         cfg.ch))
     {
         URHO3D_LOGERROR("Could not create heightfield");
-        return 0;
+        return false;
     }
 
     unsigned numTriangles = build.indices_.Size() / 3;
@@ -891,18 +862,18 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
     if (!build.compactHeightField_)
     {
         URHO3D_LOGERROR("Could not allocate create compact heightfield");
-        return 0;
+        return false;
     }
     if (!rcBuildCompactHeightfield(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_,
         *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not build compact heightfield");
-        return 0;
+        return false;
     }
     if (!rcErodeWalkableArea(build.ctx_, cfg.walkableRadius, *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not erode compact heightfield");
-        return 0;
+        return false;
     }
 
     // area volumes
@@ -915,13 +886,13 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
         if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
         {
             URHO3D_LOGERROR("Could not build distance field");
-            return 0;
+            return false;
         }
         if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea,
             cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build regions");
-            return 0;
+            return false;
         }
     }
     else
@@ -929,7 +900,7 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
         if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build monotone regions");
-            return 0;
+            return false;
         }
     }
 
@@ -937,20 +908,21 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
     if (!build.heightFieldLayers_)
     {
         URHO3D_LOGERROR("Could not allocate height field layer set");
-        return 0;
+        return false;
     }
 
     if (!rcBuildHeightfieldLayers(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.walkableHeight,
         *build.heightFieldLayers_))
     {
         URHO3D_LOGERROR("Could not build height field layers");
-        return 0;
+        return false;
     }
 
-    int retCt = 0;
     for (int i = 0; i < build.heightFieldLayers_->nlayers; ++i)
     {
         dtTileCacheLayerHeader header;      // NOLINT(hicpp-member-init)
+        // Clear also the padding, as it ends up in the compressed tile data
+        memset(&header, 0, sizeof header);
         header.magic = DT_TILECACHE_MAGIC;
         header.version = DT_TILECACHE_VERSION;
         header.tx = x;
@@ -971,19 +943,62 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
         header.hmin = (unsigned short)layer->hmin;
         header.hmax = (unsigned short)layer->hmax;
 
+        TileCacheData tile{};
         if (dtStatusFailed(
             dtBuildTileCacheLayer(compressor_.Get()/*compressor*/, &header, layer->heights, layer->areas/*areas*/, layer->cons,
-                &(tiles[retCt].data), &tiles[retCt].dataSize)))
+                &tile.data, &tile.dataSize)))
         {
             URHO3D_LOGERROR("Failed to build tile cache layers");
-            return 0;
+            for (unsigned j = 0; j < tiles.Size(); ++j)
+                dtFree(tiles[j].data);
+            tiles.Clear();
+            return false;
+        }
+        else
+            tiles.Push(tile);
+    }
+
+    return true;
+}
+
+bool DynamicNavigationMesh::CommitTile(int x, int z, const PODVector<TileCacheData>& tiles)
+{
+    dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
+    const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
+    for (int i = 0; i < existingCt; ++i)
+    {
+        unsigned char* data = nullptr;
+        if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, nullptr)) && data != nullptr)
+            dtFree(data);
+    }
+
+    // Remove the navigation mesh layers too, as the new tile may have fewer layers than the old one
+    const dtMeshTile* meshTiles[TILECACHE_MAXLAYERS];
+    const int meshTileCt = navMesh_->getTilesAt(x, z, meshTiles, maxLayers_);
+    for (int i = 0; i < meshTileCt; ++i)
+        navMesh_->removeTile(navMesh_->getTileRef(meshTiles[i]), nullptr, nullptr);
+    if (meshTileCt)
+        RequeuePathRequests(false);
+
+    bool success = true;
+    for (unsigned i = 0; i < tiles.Size(); ++i)
+    {
+        dtCompressedTileRef tileRef;
+        int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
+        if (dtStatusFailed((dtStatus)status))
+        {
+            dtFree(tiles[i].data);
+            success = false;
         }
         else
-            ++retCt;
+            tileCache_->buildNavMeshTile(tileRef, navMesh_);
     }
 
     // Send a notification of the rebuild of this tile to anyone interested
+    if (!tiles.Empty())
     {
+        const BoundingBox tileBoundingBox = GetTileBoudningBox(IntVector2(x, z));
+
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
@@ -993,45 +1008,34 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
         SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
     }
 
-    return retCt;
+    return success;
 }
 
-unsigned DynamicNavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
+unsigned DynamicNavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const PODVector<IntVector2>& tiles)
 {
-    unsigned numTiles = 0;
+    // Each thread reuses its own build data and Recast context from tile to tile. The allocator is not thread-safe,
+    // but only the tile cache uses it when building the navigation mesh tiles in the main thread
+    PODVector<DynamicNavBuildData*> buildData(GetNumBuildThreads());
+    for (unsigned i = 0; i < buildData.Size(); ++i)
+        buildData[i] = new DynamicNavBuildData(allocator_.Get());
 
-    for (int z = from.y_; z <= to.y_; ++z)
-    {
-        for (int x = from.x_; x <= to.x_; ++x)
+    Vector<PODVector<TileCacheData> > layers(Min(tiles.Size(), NAVMESH_TILE_BATCH_SIZE));
+    PODVector<bool> results(layers.Size());
+
+    unsigned numTiles = ProcessTiles(tiles,
+        [&](unsigned index, unsigned slot, unsigned threadIndex)
         {
-            dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
-            const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
-            for (int i = 0; i < existingCt; ++i)
-            {
-                unsigned char* data = nullptr;
-                if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, nullptr)) && data != nullptr)
-                    dtFree(data);
-            }
+            DynamicNavBuildData& build = *buildData[threadIndex];
+            build.Reset();
+            results[slot] = BuildTileData(build, geometryList, tiles[index].x_, tiles[index].y_, layers[slot]);
+        },
+        [&](unsigned index, unsigned slot)
+        {
+            return CommitTile(tiles[index].x_, tiles[index].y_, layers[slot]) && results[slot];
+        });
 
-            TileCacheData tiles[TILECACHE_MAXLAYERS];
-            int layerCt = BuildTile(geometryList, x, z, tiles);
-            for (int i = 0; i < layerCt; ++i)
-            {
-                dtCompressedTileRef tileRef;
-                int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                if (dtStatusFailed((dtStatus)status))
-                {
-                    dtFree(tiles[i].data);
-                    tiles[i].data = nullptr;
-                }
-                else
-                {
-                    tileCache_->buildNavMeshTile(tileRef, navMesh_);
-                    ++numTiles;
-                }
-            }
-        }
-    }
+    for (unsigned i = 0; i < buildData.Size(); ++i)
+        delete buildData[i];
 
     return numTiles;
 }
@@ -1064,10 +1068,34 @@ void DynamicNavigationMesh::ReleaseTileCache()
 {
     dtFreeTileCache(tileCache_);
     tileCache_ = nullptr;
+    tileCacheUpToDate_ = true;
+}
+
+void DynamicNavigationMesh::UpdateTileCache(float timeStep)
+{
+    tileCache_->update(timeStep, navMesh_);
+    if (tileCacheUpToDate_)
+        return;
+
+    // The tile cache rebuilds the tiles touched by obstacle changes over several updates, and each rebuilt tile gets new polygon references
+    RequeuePathRequests(false);
+
+    tileCacheUpToDate_ = true;
+    for (int i = 0; i < tileCache_->getObstacleCount(); ++i)
+    {
+        const unsigned char state = tileCache_->getObstacle(i)->state;
+        if (state == DT_OBSTACLE_PROCESSING || state == DT_OBSTACLE_REMOVING)
+        {
+            tileCacheUpToDate_ = false;
+            break;
+        }
+    }
 }
 
 void DynamicNavigationMesh::OnSceneSet(Scene* scene)
 {
+    NavigationMesh::OnSceneSet(scene);
+
     // Subscribe to the scene subsystem update, which will trigger the tile cache to update the nav mesh
     if (scene)
         SubscribeToEvent(scene, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(DynamicNavigationMesh, HandleSceneSubsystemUpdate));
@@ -1087,7 +1115,7 @@ void DynamicNavigationMesh::AddObstacle(Obstacle* obstacle, bool silent)
         // Because dtTileCache doesn't process obstacle requests while updating tiles
         // it's necessary update until sufficient request space is available
         while (tileCache_->isObstacleQueueFull())
-            tileCache_->update(1, navMesh_);
+            UpdateTileCache(1.0f);
 
         if (dtStatusFailed(tileCache_->addObstacle(pos, obstacle->GetRadius(), obstacle->GetHeight(), &refHolder)))
         {
@@ -1096,6 +1124,7 @@ void DynamicNavigationMesh::AddObstacle(Obstacle* obstacle, bool silent)
         }
         obstacle->obstacleId_ = refHolder;
         assert(refHolder > 0);
+        tileCacheUpToDate_ = false;
 
         if (!silent)
         {
@@ -1127,7 +1156,7 @@ void DynamicNavigationMesh::RemoveObstacle(Obstacle* obstacle, bool silent)
         // Because dtTileCache doesn't process obstacle requests while updating tiles
         // it's necessary update until sufficient request space is available
         while (tileCache_->isObstacleQueueFull())
-            tileCache_->update(1, navMesh_);
+            UpdateTileCache(1.0f);
 
         if (dtStatusFailed(tileCache_->removeObstacle(obstacle->obstacleId_)))
         {
@@ -1135,6 +1164,7 @@ void DynamicNavigationMesh::RemoveObstacle(Obstacle* obstacle, bool silent)
             return;
         }
         obstacle->obstacleId_ = 0;
+        tileCacheUpToDate_ = false;
         // Require a node in order to send an event
         if (!silent && obstacle->GetNode())
         {
@@ -1155,7 +1185,7 @@ void DynamicNavigationMesh::HandleSceneSubsystemUpdate(StringHash eventType, Var
     using namespace SceneSubsystemUpdate;
 
     if (tileCache_ && navMesh_ && IsEnabledEffective())
-        tileCache_->update(eventData[P_TIMESTEP].GetFloat(), navMesh_);
+        UpdateTileCache(eventData[P_TIMESTEP].GetFloat());
 }
 
 }
@@ -38,6 +38,8 @@ namespace Urho3D
 class OffMeshConnection;
 class Obstacle;
 
+struct DynamicNavBuildData;
+
 class URHO3D_API DynamicNavigationMesh : public NavigationMesh
 {
     URHO3D_OBJECT(DynamicNavigationMesh, NavigationMesh)
@@ -113,10 +115,15 @@ protected:
     /// Used by Obstacle class to remove itself from the tile cache, if 'silent' an event will not be raised.
     void RemoveObstacle(Obstacle*, bool silent = false);
 
-    /// Build one tile of the navigation mesh. Return true if successful.
-    int BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
-    /// Build tiles in the rectangular area. Return number of built tiles.
-    unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    using NavigationMesh::BuildTiles;
+
+    /// Build the compressed layers of one tile into reusable build data without modifying the tile cache, so that it can be called from worker threads. Return true if successful.
+    bool BuildTileData(DynamicNavBuildData& build, Vector<NavigationGeometryInfo>& geometryList, int x, int z,
+        PODVector<TileCacheData>& tiles);
+    /// Replace the layers of a tile in the tile cache and the navigation mesh with built layers. Takes ownership of the layer data. Return true if successful.
+    bool CommitTile(int x, int z, const PODVector<TileCacheData>& tiles);
+    /// Build tiles in the list. Return number of built tiles.
+    unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const PODVector<IntVector2>& tiles) override;
     /// Off-mesh connections to be rebuilt in the mesh processor.
     PODVector<OffMeshConnection*> CollectOffMeshConnections(const BoundingBox& bounds);
     /// Release the navigation mesh, query, and tile cache.
@@ -129,6 +136,8 @@ private:
     bool ReadTiles(Deserializer& source, bool silent);
     /// Free the tile cache.
     void ReleaseTileCache();
+    /// Let the tile cache rebuild the tiles affected by obstacle changes, and requeue the path requests if tiles may have been replaced.
+    void UpdateTileCache(float timeStep);
 
     /// Detour tile cache instance that works with the nav mesh.
     dtTileCache* tileCache_{};
@@ -146,6 +155,8 @@ private:
     bool drawObstacles_{};
     /// Queue of tiles to be built.
     PODVector<IntVector2> tileQueue_;
+    /// Whether the tile cache has no obstacle changes left to apply.
+    bool tileCacheUpToDate_{true};
 };
 
 }
@@ -47,6 +47,23 @@ NavBuildData::~NavBuildData()
     compactHeightField_ = nullptr;
 }
 
+void NavBuildData::Reset()
+{
+    // Keep the vector capacities and the Recast context for the next tile
+    vertices_.Clear();
+    indices_.Clear();
+    offMeshVertices_.Clear();
+    offMeshRadii_.Clear();
+    offMeshFlags_.Clear();
+    offMeshAreas_.Clear();
+    offMeshDir_.Clear();
+    navAreas_.Clear();
+    rcFreeHeightField(heightField_);
+    heightField_ = nullptr;
+    rcFreeCompactHeightfield(compactHeightField_);
+    compactHeightField_ = nullptr;
+}
+
 SimpleNavBuildData::SimpleNavBuildData() :
     NavBuildData(),
     contourSet_(nullptr),
@@ -65,6 +82,17 @@ SimpleNavBuildData::~SimpleNavBuildData()
     polyMeshDetail_ = nullptr;
 }
 
+void SimpleNavBuildData::Reset()
+{
+    NavBuildData::Reset();
+    rcFreeContourSet(contourSet_);
+    contourSet_ = nullptr;
+    rcFreePolyMesh(polyMesh_);
+    polyMesh_ = nullptr;
+    rcFreePolyMeshDetail(polyMeshDetail_);
+    polyMeshDetail_ = nullptr;
+}
+
 DynamicNavBuildData::DynamicNavBuildData(dtTileCacheAlloc* allocator) :
     NavBuildData(),
     contourSet_(nullptr),
@@ -85,4 +113,15 @@ DynamicNavBuildData::~DynamicNavBuildData()
     heightFieldLayers_ = nullptr;
 }
 
+void DynamicNavBuildData::Reset()
+{
+    NavBuildData::Reset();
+    dtFreeTileCacheContourSet(alloc_, contourSet_);
+    contourSet_ = nullptr;
+    dtFreeTileCachePolyMesh(alloc_, polyMesh_);
+    polyMesh_ = nullptr;
+    rcFreeHeightfieldLayerSet(heightFieldLayers_);
+    heightFieldLayers_ = nullptr;
+}
+
 }
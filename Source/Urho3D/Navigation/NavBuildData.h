@@ -58,6 +58,9 @@ struct URHO3D_API NavBuildData
     /// Destructor.
     virtual ~NavBuildData();
 
+    /// Clear the data of the previous tile so that the build data can be reused for the next one.
+    virtual void Reset();
+
     /// World-space bounding box of the navigation mesh tile.
     BoundingBox worldBoundingBox_;
     /// Vertices from geometries.
@@ -91,6 +94,9 @@ struct SimpleNavBuildData : public NavBuildData
     /// Descturctor.
     ~SimpleNavBuildData() override;
 
+    /// Clear the data of the previous tile.
+    void Reset() override;
+
     /// Recast contour set.
     rcContourSet* contourSet_;
     /// Recast poly mesh.
@@ -106,6 +112,9 @@ struct DynamicNavBuildData : public NavBuildData
     /// Destructor.
     ~DynamicNavBuildData() override;
 
+    /// Clear the data of the previous tile.
+    void Reset() override;
+
     /// TileCache specific recast contour set.
     dtTileCacheContourSet* contourSet_;
     /// TileCache specific recast poly mesh.
@@ -34,6 +34,15 @@ URHO3D_EVENT(E_NAVIGATION_MESH_REBUILT, NavigationMeshRebuilt)
     URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
 }
 
+/// Progress of a navigation mesh build. Sent after each batch of tiles has been added to the navigation mesh.
+URHO3D_EVENT(E_NAVIGATION_BUILD_PROGRESS, NavigationBuildProgress)
+{
+    URHO3D_PARAM(P_NODE, Node); // Node pointer
+    URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
+    URHO3D_PARAM(P_BUILTTILES, BuiltTiles); // unsigned
+    URHO3D_PARAM(P_TOTALTILES, TotalTiles); // unsigned
+}
+
 /// Partial bounding box rebuild of navigation mesh.
 URHO3D_EVENT(E_NAVIGATION_AREA_REBUILT, NavigationAreaRebuilt)
 {
@@ -66,6 +75,15 @@ URHO3D_EVENT(E_NAVIGATION_ALL_TILES_REMOVED, NavigationAllTilesRemoved)
     URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
 }
 
+/// Asynchronous path request completed.
+URHO3D_EVENT(E_NAVIGATION_PATH_RESULT, NavigationPathResult)
+{
+    URHO3D_PARAM(P_NODE, Node); // Node pointer
+    URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
+    URHO3D_PARAM(P_REQUEST, Request); // NavigationPathRequest pointer
+    URHO3D_PARAM(P_SUCCESS, Success); // bool
+}
+
 /// Crowd agent formation.
 URHO3D_EVENT(E_CROWD_AGENT_FORMATION, CrowdAgentFormation)
 {
@@ -22,8 +22,11 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Sort.h"
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -46,7 +49,9 @@
 #include "../Physics/CollisionShape.h"
 #endif
 #include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
 
+#include <atomic>
 #include <cfloat>
 #include <Detour/DetourNavMesh.h>
 #include <Detour/DetourNavMeshBuilder.h>
@@ -80,8 +85,27 @@ static const float DEFAULT_EDGE_MAX_LENGTH = 12.0f;
 static const float DEFAULT_EDGE_MAX_ERROR = 1.3f;
 static const float DEFAULT_DETAIL_SAMPLE_DISTANCE = 6.0f;
 static const float DEFAULT_DETAIL_SAMPLE_MAX_ERROR = 1.0f;
+static const float DEFAULT_PATH_TIME_BUDGET = 1.0f;
 
 static const int MAX_POLYS = 2048;
+static const int PATH_SEARCH_ITERATIONS = 32;
+static const unsigned PATH_REQUESTS_PER_WORK_ITEM = 16;
+
+/// Built navigation mesh tile waiting to be added to the navigation mesh.
+struct NavigationTileResult
+{
+    /// Detour tile data, null if the tile has no geometry.
+    unsigned char* data_;
+    /// Detour tile data size.
+    int dataSize_;
+    /// Whether the build was successful.
+    bool success_;
+};
+
+static bool CompareTiles(const IntVector2& lhs, const IntVector2& rhs)
+{
+    return lhs.y_ != rhs.y_ ? lhs.y_ < rhs.y_ : lhs.x_ < rhs.x_;
+}
 
 
 /// Temporary data for finding a path.
@@ -97,6 +121,69 @@ struct FindPathData
     unsigned char pathFlags_[MAX_POLYS]{};
 };
 
+/// Path search shared by the asynchronous path requests that have the same start and end polygons.
+struct PathSearch
+{
+    /// Requests waiting for the result, in request order.
+    Vector<SharedPtr<NavigationPathRequest> > requests_;
+    /// Whether the search succeeded.
+    bool success_{};
+};
+
+/// Navigation mesh query and temporary path data of one path search worker. A sliced search stays in its slot over frames until it completes.
+struct PathSearchSlot
+{
+    /// Construct.
+    PathSearchSlot() :
+        query_(dtAllocNavMeshQuery()),
+        search_(nullptr)
+    {
+    }
+
+    /// Destruct.
+    ~PathSearchSlot()
+    {
+        dtFreeNavMeshQuery(query_);
+    }
+
+    /// Detour navigation mesh query.
+    dtNavMeshQuery* query_;
+    /// Search in progress.
+    PathSearch* search_;
+    /// Searches completed during the current update.
+    PODVector<PathSearch*> completed_;
+    /// Temporary data for finding a path.
+    FindPathData pathData_;
+};
+
+/// Asynchronous path requests of a navigation mesh.
+struct PathQueueData
+{
+    /// Requests whose start and end polygons have not been found yet.
+    Vector<SharedPtr<NavigationPathRequest> > newRequests_;
+    /// Searches waiting for a free slot.
+    PODVector<PathSearch*> searches_;
+    /// Search slots, one for each thread.
+    PODVector<PathSearchSlot*> slots_;
+    /// Index of the next waiting search to start during the current update.
+    std::atomic<unsigned> nextSearch_{};
+    /// World transform of the navigation mesh during the current update.
+    Matrix3x4 transform_;
+    /// Sequence number of the next request.
+    unsigned nextSequence_{};
+};
+
+NavigationPathRequest::NavigationPathRequest(const Vector3& start, const Vector3& end, const Vector3& extents) :
+    start_(start),
+    end_(end),
+    extents_(extents),
+    state_(PATHREQUEST_PENDING),
+    sequence_(0),
+    startRef_(0),
+    endRef_(0)
+{
+}
+
 NavigationMesh::NavigationMesh(Context* context) :
     Component(context),
     navMesh_(nullptr),
@@ -122,13 +209,19 @@ NavigationMesh::NavigationMesh(Context* context) :
     partitionType_(NAVMESH_PARTITION_WATERSHED),
     keepInterResults_(false),
     drawOffMeshConnections_(false),
-    drawNavAreas_(false)
+    drawNavAreas_(false),
+    pathQueue_(new PathQueueData()),
+    pathTimeBudget_(DEFAULT_PATH_TIME_BUDGET)
 {
 }
 
 NavigationMesh::~NavigationMesh()
 {
     ReleaseNavigationMesh();
+
+    // The pending path requests can not complete anymore
+    for (unsigned i = 0; i < pathQueue_->newRequests_.Size(); ++i)
+        pathQueue_->newRequests_[i]->state_ = PATHREQUEST_CANCELED;
 }
 
 void NavigationMesh::RegisterObject(Context* context)
@@ -157,6 +250,7 @@ void NavigationMesh::RegisterObject(Context* context)
         NAVMESH_PARTITION_WATERSHED, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Draw OffMeshConnections", GetDrawOffMeshConnections, SetDrawOffMeshConnections, bool, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Draw NavAreas", GetDrawNavAreas, SetDrawNavAreas, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Path Time Budget", GetPathTimeBudget, SetPathTimeBudget, float, DEFAULT_PATH_TIME_BUDGET, AM_DEFAULT);
 }
 
 void NavigationMesh::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -315,6 +409,13 @@ void NavigationMesh::SetDetailSampleMaxError(float error)
     MarkNetworkUpdate();
 }
 
+void NavigationMesh::SetPathTimeBudget(float budget)
+{
+    pathTimeBudget_ = Max(budget, 0.0f);
+
+    MarkNetworkUpdate();
+}
+
 void NavigationMesh::SetPadding(const Vector3& padding)
 {
     padding_ = padding;
@@ -478,19 +579,12 @@ bool NavigationMesh::Build(const BoundingBox& boundingBox)
     if (!node_->GetWorldScale().Equals(Vector3::ONE))
         URHO3D_LOGWARNING("Navigation mesh root node has scaling. Agent parameters may not work as intended");
 
-    BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
-
-    float tileEdgeLength = (float)tileSize_ * cellSize_;
-
     Vector<NavigationGeometryInfo> geometryList;
     CollectGeometries(geometryList);
 
-    int sx = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int sz = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
-    int ex = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int ez = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
-
-    unsigned numTiles = BuildTiles(geometryList, IntVector2(sx, sz), IntVector2(ex, ez));
+    IntVector2 from, to;
+    GetTileRange(boundingBox, from, to);
+    unsigned numTiles = BuildTiles(geometryList, from, to);
 
     URHO3D_LOGDEBUG("Rebuilt " + String(numTiles) + " tiles of the navigation mesh");
     return true;
@@ -521,6 +615,57 @@ bool NavigationMesh::Build(const IntVector2& from, const IntVector2& to)
     return true;
 }
 
+void NavigationMesh::MarkTileDirty(const IntVector2& tile)
+{
+    if (tile.x_ >= 0 && tile.y_ >= 0 && tile.x_ < numTilesX_ && tile.y_ < numTilesZ_)
+        dirtyTiles_.Insert(tile);
+}
+
+void NavigationMesh::MarkTilesDirty(const BoundingBox& boundingBox)
+{
+    if (!node_ || !numTilesX_ || !numTilesZ_)
+        return;
+
+    IntVector2 from, to;
+    GetTileRange(boundingBox, from, to);
+    for (int z = from.y_; z <= to.y_; ++z)
+    {
+        for (int x = from.x_; x <= to.x_; ++x)
+            dirtyTiles_.Insert(IntVector2(x, z));
+    }
+}
+
+bool NavigationMesh::BuildDirtyTiles()
+{
+    URHO3D_PROFILE(BuildDirtyNavigationMeshTiles);
+
+    if (!node_)
+        return false;
+
+    if (!navMesh_)
+    {
+        URHO3D_LOGERROR("Navigation mesh must first be built fully before it can be partially rebuilt");
+        return false;
+    }
+
+    if (dirtyTiles_.Empty())
+        return true;
+
+    // Build in row order for deterministic results
+    PODVector<IntVector2> tiles;
+    for (HashSet<IntVector2>::ConstIterator i = dirtyTiles_.Begin(); i != dirtyTiles_.End(); ++i)
+        tiles.Push(*i);
+    Sort(tiles.Begin(), tiles.End(), CompareTiles);
+
+    Vector<NavigationGeometryInfo> geometryList;
+    CollectGeometries(geometryList);
+
+    unsigned numTiles = BuildTiles(geometryList, tiles);
+
+    URHO3D_LOGDEBUG("Rebuilt " + String(numTiles) + " dirty tiles of the navigation mesh");
+    return true;
+}
+
 PODVector<unsigned char> NavigationMesh::GetTileData(const IntVector2& tile) const
 {
     VectorBuffer ret;
@@ -565,6 +710,18 @@ IntVector2 NavigationMesh::GetTileIndex(const Vector3& position) const
     return VectorMin(VectorMax(IntVector2::ZERO, VectorFloorToInt(localPosition2D / tileEdgeLength)), GetNumTiles() - IntVector2::ONE);
 }
 
+void NavigationMesh::GetTileRange(const BoundingBox& boundingBox, IntVector2& from, IntVector2& to) const
+{
+    BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
+
+    float tileEdgeLength = (float)tileSize_ * cellSize_;
+
+    from.x_ = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    from.y_ = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+    to.x_ = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    to.y_ = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+}
+
 void NavigationMesh::RemoveTile(const IntVector2& tile)
 {
     if (!navMesh_)
@@ -575,6 +732,7 @@ void NavigationMesh::RemoveTile(const IntVector2& tile)
         return;
 
     navMesh_->removeTile(tileRef, nullptr, nullptr);
+    RequeuePathRequests(false);
 
     // Send event
     using namespace NavigationTileRemoved;
@@ -595,6 +753,7 @@ void NavigationMesh::RemoveAllTiles()
         if (tile->header)
             navMesh_->removeTile(navMesh_->getTileRef(tile), nullptr, nullptr);
     }
+    RequeuePathRequests(false);
 
     // Send event
     using namespace NavigationAllTilesRemoved;
@@ -710,28 +869,7 @@ void NavigationMesh::FindPath(PODVector<NavigationPathPoint>& dest, const Vector
         pt.position_ = transform * pathData_->pathPoints_[i];
         pt.flag_ = (NavigationPathPointFlag)pathData_->pathFlags_[i];
 
-        // Walk through all NavAreas and find nearest
-        unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
-        float nearestDistance = M_LARGE_VALUE;
-        for (unsigned j = 0; j < areas_.Size(); j++)
-        {
-            NavArea* area = areas_[j].Get();
-            if (area && area->IsEnabledEffective())
-            {
-                BoundingBox bb = area->GetWorldBoundingBox();
-                if (bb.IsInside(pt.position_) == INSIDE)
-                {
-                    Vector3 areaWorldCenter = area->GetNode()->GetWorldPosition();
-                    float distance = (areaWorldCenter - pt.position_).LengthSquared();
-                    if (distance < nearestDistance)
-                    {
-                        nearestDistance = distance;
-                        nearestNavAreaID = area->GetAreaID();
-                    }
-                }
-            }
-        }
-        pt.areaID_ = (unsigned char)nearestNavAreaID;
+        pt.areaID_ = GetNearestAreaID(pt.position_);
 
         dest.Push(pt);
     }
@@ -847,6 +985,231 @@ Vector3 NavigationMesh::Raycast(const Vector3& start, const Vector3& end, const
     return start.Lerp(end, t);
 }
 
+SharedPtr<NavigationPathRequest> NavigationMesh::RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents)
+{
+    SharedPtr<NavigationPathRequest> request(new NavigationPathRequest(start, end, extents));
+    request->sequence_ = pathQueue_->nextSequence_++;
+    pathQueue_->newRequests_.Push(request);
+    return request;
+}
+
+void NavigationMesh::CancelPathRequest(NavigationPathRequest* request)
+{
+    if (!request || request->IsCompleted())
+        return;
+
+    request->state_ = PATHREQUEST_CANCELED;
+
+    PathQueueData& queue = *pathQueue_;
+    SharedPtr<NavigationPathRequest> requestPtr(request);
+    if (queue.newRequests_.Remove(requestPtr))
+        return;
+
+    // Drop the search when no request waits for it anymore
+    for (unsigned i = 0; i < queue.searches_.Size(); ++i)
+    {
+        PathSearch* search = queue.searches_[i];
+        if (search->requests_.Remove(requestPtr))
+        {
+            if (search->requests_.Empty())
+            {
+                queue.searches_.Erase(i);
+                delete search;
+            }
+            return;
+        }
+    }
+
+    for (unsigned i = 0; i < queue.slots_.Size(); ++i)
+    {
+        PathSearchSlot* slot = queue.slots_[i];
+        if (slot->search_ && slot->search_->requests_.Remove(requestPtr))
+        {
+            if (slot->search_->requests_.Empty())
+            {
+                delete slot->search_;
+                slot->search_ = nullptr;
+            }
+            return;
+        }
+    }
+}
+
+void NavigationMesh::UpdatePathRequests()
+{
+    PathQueueData& queue = *pathQueue_;
+    if (!GetNumPathRequests())
+        return;
+
+    // Keep the requests queued until there is navigation data to search
+    if (!InitializeQuery())
+        return;
+
+    URHO3D_PROFILE(UpdatePathRequests);
+
+    auto* workQueue = GetSubsystem<WorkQueue>();
+
+    if (queue.slots_.Empty())
+    {
+        unsigned numSlots = GetNumBuildThreads();
+        for (unsigned i = 0; i < numSlots; ++i)
+        {
+            auto* slot = new PathSearchSlot();
+            queue.slots_.Push(slot);
+            if (!slot->query_ || dtStatusFailed(slot->query_->init(navMesh_, MAX_POLYS)))
+            {
+                URHO3D_LOGERROR("Could not create navigation mesh queries for path requests");
+                RequeuePathRequests(true);
+                return;
+            }
+        }
+    }
+
+    queue.transform_ = node_->GetWorldTransform();
+    const dtQueryFilter* filter = queryFilter_.Get();
+    Vector<SharedPtr<NavigationPathRequest> > completed;
+
+    if (!queue.newRequests_.Empty())
+    {
+        // Find the start and end polygons of the new requests. This does not disturb the sliced searches in progress
+        const Vector<SharedPtr<NavigationPathRequest> >& requests = queue.newRequests_;
+        Matrix3x4 inverse = queue.transform_.Inverse();
+
+        ParallelForFunction findPolys = [&](unsigned begin, unsigned end, unsigned threadIndex)
+        {
+            dtNavMeshQuery* query = queue.slots_[threadIndex]->query_;
+            for (unsigned i = begin; i < end; ++i)
+            {
+                NavigationPathRequest* request = requests[i];
+                request->startPos_ = inverse * request->start_;
+                request->endPos_ = inverse * request->end_;
+                query->findNearestPoly(&request->startPos_.x_, &request->extents_.x_, filter, &request->startRef_, nullptr);
+                query->findNearestPoly(&request->endPos_.x_, &request->extents_.x_, filter, &request->endRef_, nullptr);
+            }
+        };
+        if (workQueue)
+            workQueue->ParallelFor(requests.Size(), PATH_REQUESTS_PER_WORK_ITEM, findPolys);
+        else
+            findPolys(0, requests.Size(), 0);
+
+        // Requests with the same start and end polygons share one search, also when it is already in progress
+        HashMap<Pair<dtPolyRef, dtPolyRef>, PathSearch*> searchMap;
+        for (unsigned i = 0; i < queue.slots_.Size(); ++i)
+        {
+            PathSearch* search = queue.slots_[i]->search_;
+            if (search)
+                searchMap[MakePair(search->requests_[0]->startRef_, search->requests_[0]->endRef_)] = search;
+        }
+        for (unsigned i = 0; i < queue.searches_.Size(); ++i)
+        {
+            PathSearch* search = queue.searches_[i];
+            searchMap[MakePair(search->requests_[0]->startRef_, search->requests_[0]->endRef_)] = search;
+        }
+
+        for (unsigned i = 0; i < requests.Size(); ++i)
+        {
+            NavigationPathRequest* request = requests[i];
+            if (!request->startRef_ || !request->endRef_)
+            {
+                request->state_ = PATHREQUEST_FAILED;
+                completed.Push(requests[i]);
+                continue;
+            }
+
+            PathSearch*& search = searchMap[MakePair(request->startRef_, request->endRef_)];
+            if (!search)
+            {
+                search = new PathSearch();
+                queue.searches_.Push(search);
+            }
+            search->requests_.Push(requests[i]);
+        }
+
+        queue.newRequests_.Clear();
+    }
+
+    // Advance the searches in all slots until the time budget of the frame has been used
+    HiresTimer timer;
+    auto budgetUSec = (long long)(pathTimeBudget_ * 1000.0f);
+    queue.nextSearch_ = 0;
+
+    ParallelForFunction updateSearches = [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
+    {
+        for (unsigned i = begin; i < end; ++i)
+            UpdatePathSearches(*queue.slots_[i], timer, budgetUSec);
+    };
+    if (workQueue)
+        workQueue->ParallelFor(queue.slots_.Size(), 1, updateSearches);
+    else
+        updateSearches(0, queue.slots_.Size(), 0);
+
+    queue.searches_.Erase(0, Min((unsigned)queue.nextSearch_, queue.searches_.Size()));
+
+    for (unsigned i = 0; i < queue.slots_.Size(); ++i)
+    {
+        PathSearchSlot* slot = queue.slots_[i];
+        for (unsigned j = 0; j < slot->completed_.Size(); ++j)
+        {
+            PathSearch* search = slot->completed_[j];
+            for (unsigned k = 0; k < search->requests_.Size(); ++k)
+            {
+                NavigationPathRequest* request = search->requests_[k];
+                if (search->success_)
+                {
+                    request->state_ = PATHREQUEST_SUCCEEDED;
+                    for (unsigned l = 0; l < request->path_.Size(); ++l)
+                        request->path_[l].areaID_ = GetNearestAreaID(request->path_[l].position_);
+                }
+                else
+                {
+                    request->state_ = PATHREQUEST_FAILED;
+                    request->path_.Clear();
+                }
+                completed.Push(search->requests_[k]);
+            }
+            delete search;
+        }
+        slot->completed_.Clear();
+    }
+
+    // Deliver the results in request order
+    Sort(completed.Begin(), completed.End(),
+        [](const SharedPtr<NavigationPathRequest>& lhs, const SharedPtr<NavigationPathRequest>& rhs)
+        {
+            return lhs->sequence_ < rhs->sequence_;
+        });
+
+    WeakPtr<NavigationMesh> self(this);
+    for (unsigned i = 0; i < completed.Size(); ++i)
+    {
+        using namespace NavigationPathResult;
+        VariantMap& eventData = GetContext()->GetEventDataMap();
+        eventData[P_NODE] = GetNode();
+        eventData[P_MESH] = this;
+        eventData[P_REQUEST] = completed[i].Get();
+        eventData[P_SUCCESS] = completed[i]->state_ == PATHREQUEST_SUCCEEDED;
+        SendEvent(E_NAVIGATION_PATH_RESULT, eventData);
+
+        if (self.Expired())
+            return;
+    }
+}
+
+unsigned NavigationMesh::GetNumPathRequests() const
+{
+    const PathQueueData& queue = *pathQueue_;
+    unsigned numRequests = queue.newRequests_.Size();
+    for (unsigned i = 0; i < queue.searches_.Size(); ++i)
+        numRequests += queue.searches_[i]->requests_.Size();
+    for (unsigned i = 0; i < queue.slots_.Size(); ++i)
+    {
+        if (queue.slots_[i]->search_)
+            numRequests += queue.slots_[i]->search_->requests_.Size();
+    }
+
+    return numRequests;
+}
+
 void NavigationMesh::DrawDebugGeometry(bool depthTest)
 {
     Scene* scene = GetScene();
@@ -950,6 +1313,21 @@ PODVector<unsigned char> NavigationMesh::GetNavigationDataAttr() const
     return ret.GetBuffer();
 }
 
+void NavigationMesh::OnSceneSet(Scene* scene)
+{
+    // Subscribe to the scene post-update, which processes the path requests
+    if (scene)
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(NavigationMesh, HandleScenePostUpdate));
+    else
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+}
+
+void NavigationMesh::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    if (IsEnabledEffective())
+        UpdatePathRequests();
+}
+
 void NavigationMesh::CollectGeometries(Vector<NavigationGeometryInfo>& geometryList)
 {
     URHO3D_PROFILE(CollectNavigationGeometry);
@@ -977,6 +1355,8 @@ void NavigationMesh::CollectGeometries(Vector<NavigationGeometryInfo>& geometryL
         if (connection->IsEnabledEffective() && connection->GetEndPoint())
         {
             const Matrix3x4& transform = connection->GetNode()->GetWorldTransform();
+            // Update the end point transform now, as tile builds read it from worker threads
+            connection->GetEndPoint()->GetWorldTransform();
 
             NavigationGeometryInfo info;
             info.component_ = connection;
@@ -1250,6 +1630,143 @@ void NavigationMesh::AddTriMeshGeometry(NavBuildData* build, Geometry* geometry,
     }
 }
 
+unsigned char NavigationMesh::GetNearestAreaID(const Vector3& point) const
+{
+    // Walk through all NavAreas and find nearest
+    unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
+    float nearestDistance = M_LARGE_VALUE;
+    for (unsigned j = 0; j < areas_.Size(); j++)
+    {
+        NavArea* area = areas_[j].Get();
+        if (area && area->IsEnabledEffective())
+        {
+            BoundingBox bb = area->GetWorldBoundingBox();
+            if (bb.IsInside(point) == INSIDE)
+            {
+                Vector3 areaWorldCenter = area->GetNode()->GetWorldPosition();
+                float distance = (areaWorldCenter - point).LengthSquared();
+                if (distance < nearestDistance)
+                {
+                    nearestDistance = distance;
+                    nearestNavAreaID = area->GetAreaID();
+                }
+            }
+        }
+    }
+
+    return (unsigned char)nearestNavAreaID;
+}
+
+void NavigationMesh::UpdatePathSearches(PathSearchSlot& slot, HiresTimer& timer, long long budgetUSec)
+{
+    PathQueueData& queue = *pathQueue_;
+    const dtQueryFilter* filter = queryFilter_.Get();
+
+    do
+    {
+        if (!slot.search_)
+        {
+            unsigned index = queue.nextSearch_++;
+            if (index >= queue.searches_.Size())
+                return;
+
+            slot.search_ = queue.searches_[index];
+            NavigationPathRequest* request = slot.search_->requests_[0];
+            if (dtStatusFailed(slot.query_->initSlicedFindPath(request->startRef_, request->endRef_, &request->startPos_.x_,
+                &request->endPos_.x_, filter)))
+            {
+                slot.search_->success_ = false;
+                slot.completed_.Push(slot.search_);
+                slot.search_ = nullptr;
+                continue;
+            }
+        }
+
+        dtStatus status = slot.query_->updateSlicedFindPath(PATH_SEARCH_ITERATIONS, nullptr);
+        if (dtStatusInProgress(status))
+            continue;
+
+        slot.search_->success_ = dtStatusSucceed(status) && FinishPathSearch(slot);
+        slot.completed_.Push(slot.search_);
+        slot.search_ = nullptr;
+    }
+    while (timer.GetUSec(false) < budgetUSec);
+}
+
+bool NavigationMesh::FinishPathSearch(PathSearchSlot& slot)
+{
+    FindPathData& data = slot.pathData_;
+    int numPolys = 0;
+
+    if (dtStatusFailed(slot.query_->finalizeSlicedFindPath(data.polys_, &numPolys, MAX_POLYS)) || !numPolys)
+        return false;
+
+    const Matrix3x4& transform = pathQueue_->transform_;
+    const Vector<SharedPtr<NavigationPathRequest> >& requests = slot.search_->requests_;
+
+    // The polygon corridor is shared, but each request gets a straight path between its own points
+    for (unsigned i = 0; i < requests.Size(); ++i)
+    {
+        NavigationPathRequest* request = requests[i];
+        Vector3 actualLocalEnd = request->endPos_;
+
+        // If full path was not found, clamp end point to the end polygon
+        if (data.polys_[numPolys - 1] != request->endRef_)
+            slot.query_->closestPointOnPoly(data.polys_[numPolys - 1], &request->endPos_.x_, &actualLocalEnd.x_, nullptr);
+
+        int numPathPoints = 0;
+        slot.query_->findStraightPath(&request->startPos_.x_, &actualLocalEnd.x_, data.polys_, numPolys,
+            &data.pathPoints_[0].x_, data.pathFlags_, data.pathPolys_, &numPathPoints, MAX_POLYS);
+
+        // Transform path result back to world space. Area IDs are filled in the main thread
+        request->path_.Clear();
+        for (int j = 0; j < numPathPoints; ++j)
+        {
+            NavigationPathPoint pt;
+            pt.position_ = transform * data.pathPoints_[j];
+            pt.flag_ = (NavigationPathPointFlag)data.pathFlags_[j];
+            pt.areaID_ = 0;
+            request->path_.Push(pt);
+        }
+    }
+
+    return true;
+}
+
+void NavigationMesh::RequeuePathRequests(bool releaseSlots)
+{
+    PathQueueData& queue = *pathQueue_;
+
+    // Polygon references are not valid in removed or replaced tiles, so find the polygons again
+    for (unsigned i = 0; i < queue.slots_.Size(); ++i)
+    {
+        PathSearchSlot* slot = queue.slots_[i];
+        if (slot->search_)
+        {
+            queue.newRequests_.Push(slot->search_->requests_);
+            delete slot->search_;
+            slot->search_ = nullptr;
+        }
+        if (releaseSlots)
+            delete slot;
+    }
+    if (releaseSlots)
+        queue.slots_.Clear();
+
+    for (unsigned i = 0; i < queue.searches_.Size(); ++i)
+    {
+        queue.newRequests_.Push(queue.searches_[i]->requests_);
+        delete queue.searches_[i];
+    }
+    queue.searches_.Clear();
+
+    Sort(queue.newRequests_.Begin(), queue.newRequests_.End(),
+        [](const SharedPtr<NavigationPathRequest>& lhs, const SharedPtr<NavigationPathRequest>& rhs)
+        {
+            return lhs->sequence_ < rhs->sequence_;
+        });
+}
+
 void NavigationMesh::WriteTile(Serializer& dest, int x, int z) const
 {
     const dtNavMesh* navMesh = navMesh_;
@@ -1299,17 +1816,14 @@ bool NavigationMesh::ReadTile(Deserializer& source, bool silent)
     return true;
 }
 
-bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z)
+bool NavigationMesh::BuildTileData(SimpleNavBuildData& build, Vector<NavigationGeometryInfo>& geometryList, int x, int z,
+    unsigned char*& navData, int& navDataSize)
 {
-    URHO3D_PROFILE(BuildNavigationMeshTile);
-
-    // Remove previous tile (if any)
-    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+    navData = nullptr;
+    navDataSize = 0;
 
     const BoundingBox tileBoundingBox = GetTileBoudningBox(IntVector2(x, z));
 
-    SimpleNavBuildData build;
-
     rcConfig cfg;       // NOLINT(hicpp-member-init)
     memset(&cfg, 0, sizeof cfg);
     cfg.cs = cellSize_;
@@ -1462,9 +1976,6 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
             build.polyMesh_->flags[i] = 0x1;
     }
 
-    unsigned char* navData = nullptr;
-    int navDataSize = 0;
-
     dtNavMeshCreateParams params;       // NOLINT(hicpp-member-init)
     memset(&params, 0, sizeof params);
     params.verts = build.polyMesh_->verts;
@@ -1507,6 +2018,22 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
         return false;
     }
 
+    return true;
+}
+
+bool NavigationMesh::CommitTile(int x, int z, unsigned char* navData, int navDataSize)
+{
+    // Remove previous tile (if any). The path requests that may refer to its polygons need to find them again
+    const dtTileRef tileRef = navMesh_->getTileRefAt(x, z, 0);
+    if (tileRef)
+    {
+        navMesh_->removeTile(tileRef, nullptr, nullptr);
+        RequeuePathRequests(false);
+    }
+
+    if (!navData)
+        return true;
+
     if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
     {
         URHO3D_LOGERROR("Failed to add navigation mesh tile");
@@ -1516,6 +2043,8 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
 
     // Send a notification of the rebuild of this tile to anyone interested
     {
+        const BoundingBox tileBoundingBox = GetTileBoudningBox(IntVector2(x, z));
+
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
@@ -1529,19 +2058,95 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
 
 unsigned NavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
-    unsigned numTiles = 0;
-
+    PODVector<IntVector2> tiles;
     for (int z = from.y_; z <= to.y_; ++z)
     {
         for (int x = from.x_; x <= to.x_; ++x)
+            tiles.Push(IntVector2(x, z));
+    }
+
+    return BuildTiles(geometryList, tiles);
+}
+
+unsigned NavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const PODVector<IntVector2>& tiles)
+{
+    // Each thread reuses its own build data and Recast context from tile to tile
+    PODVector<SimpleNavBuildData*> buildData(GetNumBuildThreads());
+    for (unsigned i = 0; i < buildData.Size(); ++i)
+        buildData[i] = new SimpleNavBuildData();
+
+    NavigationTileResult results[NAVMESH_TILE_BATCH_SIZE];
+
+    unsigned numTiles = ProcessTiles(tiles,
+        [&](unsigned index, unsigned slot, unsigned threadIndex)
+        {
+            SimpleNavBuildData& build = *buildData[threadIndex];
+            build.Reset();
+            NavigationTileResult& result = results[slot];
+            result.success_ = BuildTileData(build, geometryList, tiles[index].x_, tiles[index].y_, result.data_, result.dataSize_);
+        },
+        [&](unsigned index, unsigned slot)
+        {
+            const NavigationTileResult& result = results[slot];
+            // Remove the previous tile also when the build failed
+            return CommitTile(tiles[index].x_, tiles[index].y_, result.data_, result.dataSize_) && result.success_;
+        });
+
+    for (unsigned i = 0; i < buildData.Size(); ++i)
+        delete buildData[i];
+
+    return numTiles;
+}
+
+unsigned NavigationMesh::ProcessTiles(const PODVector<IntVector2>& tiles, const NavigationTileBuildFunction& buildFunction,
+    const NavigationTileCommitFunction& commitFunction)
+{
+    URHO3D_PROFILE(BuildNavigationMeshTiles);
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned numTiles = 0;
+
+    for (unsigned batchStart = 0; batchStart < tiles.Size(); batchStart += NAVMESH_TILE_BATCH_SIZE)
+    {
+        unsigned batchSize = Min(tiles.Size() - batchStart, NAVMESH_TILE_BATCH_SIZE);
+
+        // Tiles are independent of each other, so build them as separate work items. The navigation mesh is only
+        // modified afterward in the main thread
+        ParallelForFunction buildRange = [&](unsigned begin, unsigned end, unsigned threadIndex)
+        {
+            for (unsigned i = begin; i < end; ++i)
+                buildFunction(batchStart + i, i, threadIndex);
+        };
+        if (queue)
+            queue->ParallelFor(batchSize, 1, buildRange);
+        else
+            buildRange(0, batchSize, 0);
+
+        for (unsigned i = 0; i < batchSize; ++i)
         {
-            if (BuildTile(geometryList, x, z))
+            dirtyTiles_.Erase(tiles[batchStart + i]);
+            if (commitFunction(batchStart + i, i))
                 ++numTiles;
         }
+
+        using namespace NavigationBuildProgress;
+        VariantMap& eventData = GetContext()->GetEventDataMap();
+        eventData[P_NODE] = GetNode();
+        eventData[P_MESH] = this;
+        eventData[P_BUILTTILES] = batchStart + batchSize;
+        eventData[P_TOTALTILES] = tiles.Size();
+        SendEvent(E_NAVIGATION_BUILD_PROGRESS, eventData);
     }
+
     return numTiles;
 }
 
+unsigned NavigationMesh::GetNumBuildThreads() const
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    return queue ? queue->GetNumThreads() + 1 : 1;
+}
+
 bool NavigationMesh::InitializeQuery()
 {
     if (!navMesh_ || !node_)
@@ -1577,6 +2182,9 @@ void NavigationMesh::ReleaseNavigationMesh()
     numTilesX_ = 0;
     numTilesZ_ = 0;
     boundingBox_.Clear();
+    dirtyTiles_.Clear();
+
+    RequeuePathRequests(true);
 }
 
 void NavigationMesh::SetPartitionType(NavmeshPartitionType partitionType)
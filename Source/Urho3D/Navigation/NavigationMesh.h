@@ -28,6 +28,8 @@
 #include "../Math/Matrix3x4.h"
 #include "../Scene/Component.h"
 
+#include <functional>
+
 #ifdef DT_POLYREF64
 using dtPolyRef = uint64_t;
 #else
@@ -48,10 +50,22 @@ enum NavmeshPartitionType
 };
 
 class Geometry;
+class HiresTimer;
 class NavArea;
 
 struct FindPathData;
 struct NavBuildData;
+struct PathQueueData;
+struct PathSearchSlot;
+struct SimpleNavBuildData;
+
+/// Maximum number of tiles built in parallel before they are added to the navigation mesh.
+static const unsigned NAVMESH_TILE_BATCH_SIZE = 256;
+
+/// Function that builds a tile from the tile list into a result slot of the current batch. Arguments are the tile index, the slot and the worker thread index. Called from worker threads.
+using NavigationTileBuildFunction = std::function<void(unsigned, unsigned, unsigned)>;
+/// Function that adds a built tile from its result slot to the navigation mesh. Arguments are the tile index and the slot. Called from the main thread. Return true if successful.
+using NavigationTileCommitFunction = std::function<bool(unsigned, unsigned)>;
 
 /// Description of a navigation mesh geometry component, with transform and bounds information.
 struct NavigationGeometryInfo
@@ -86,6 +100,65 @@ struct URHO3D_API NavigationPathPoint
     unsigned char areaID_;
 };
 
+/// State of an asynchronous path request.
+enum NavigationPathRequestState
+{
+    PATHREQUEST_PENDING = 0,
+    PATHREQUEST_SUCCEEDED,
+    PATHREQUEST_FAILED,
+    PATHREQUEST_CANCELED
+};
+
+/// Asynchronous path request queued to a navigation mesh. Poll IsCompleted() or handle E_NAVIGATION_PATH_RESULT to get the result.
+class URHO3D_API NavigationPathRequest : public RefCounted
+{
+    friend class NavigationMesh;
+
+public:
+    /// Construct.
+    NavigationPathRequest(const Vector3& start, const Vector3& end, const Vector3& extents);
+
+    /// Return world space start point.
+    const Vector3& GetStart() const { return start_; }
+
+    /// Return world space end point.
+    const Vector3& GetEnd() const { return end_; }
+
+    /// Return how far off the navigation mesh the points can be.
+    const Vector3& GetExtents() const { return extents_; }
+
+    /// Return state.
+    NavigationPathRequestState GetState() const { return state_; }
+
+    /// Return whether the request has succeeded, failed or been canceled.
+    bool IsCompleted() const { return state_ != PATHREQUEST_PENDING; }
+
+    /// Return path points. Non-empty if the request succeeded. Ends at the nearest reachable point if the end point can not be reached.
+    const PODVector<NavigationPathPoint>& GetPath() const { return path_; }
+
+private:
+    /// World space start point.
+    Vector3 start_;
+    /// World space end point.
+    Vector3 end_;
+    /// Extents for finding the start and end polygons.
+    Vector3 extents_;
+    /// State.
+    NavigationPathRequestState state_;
+    /// Path points.
+    PODVector<NavigationPathPoint> path_;
+    /// Sequence number for delivering the results in request order.
+    unsigned sequence_;
+    /// Start polygon.
+    dtPolyRef startRef_;
+    /// End polygon.
+    dtPolyRef endRef_;
+    /// Start point in navigation mesh space.
+    Vector3 startPos_;
+    /// End point in navigation mesh space.
+    Vector3 endPos_;
+};
+
 /// Navigation mesh component. Collects the navigation geometry from child nodes with the Navigable component and responds to path queries.
 class URHO3D_API NavigationMesh : public Component
 {
@@ -142,6 +215,12 @@ public:
     virtual bool Build(const BoundingBox& boundingBox);
     /// Rebuild part of the navigation mesh in the rectangular area. Return true if successful.
     virtual bool Build(const IntVector2& from, const IntVector2& to);
+    /// Mark a tile to be rebuilt by BuildDirtyTiles().
+    void MarkTileDirty(const IntVector2& tile);
+    /// Mark the tiles intersecting the world-space bounding box to be rebuilt by BuildDirtyTiles().
+    void MarkTilesDirty(const BoundingBox& boundingBox);
+    /// Rebuild only the tiles marked dirty. Return true if successful.
+    bool BuildDirtyTiles();
     /// Return tile data.
     virtual PODVector<unsigned char> GetTileData(const IntVector2& tile) const;
     /// Add tile to navigation mesh.
@@ -179,6 +258,14 @@ public:
     float GetDistanceToWall
         (const Vector3& point, float radius, const Vector3& extents = Vector3::ONE, const dtQueryFilter* filter = nullptr,
             Vector3* hitPos = nullptr, Vector3* hitNormal = nullptr);
+    /// Queue an asynchronous path request between world space points. Paths are searched in slices within the path time budget of each frame, using worker threads if available. Requests with the same start and end polygons share one search.
+    SharedPtr<NavigationPathRequest> RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE);
+    /// Cancel an asynchronous path request.
+    void CancelPathRequest(NavigationPathRequest* request);
+    /// Process the queued path requests within the path time budget. Called automatically after each scene update.
+    void UpdatePathRequests();
+    /// Set the time budget in milliseconds for processing path requests per frame.
+    void SetPathTimeBudget(float budget);
     /// Perform a walkability raycast on the navigation mesh between start and end and return the point where a wall was hit, or the end point if no walls.
     Vector3 Raycast
         (const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE, const dtQueryFilter* filter = nullptr,
@@ -249,6 +336,15 @@ public:
     /// Return number of tiles.
     IntVector2 GetNumTiles() const { return IntVector2(numTilesX_, numTilesZ_); }
 
+    /// Return the time budget in milliseconds for processing path requests per frame.
+    float GetPathTimeBudget() const { return pathTimeBudget_; }
+
+    /// Return number of pending path requests.
+    unsigned GetNumPathRequests() const;
+
+    /// Return number of tiles marked dirty.
+    unsigned GetNumDirtyTiles() const { return dirtyTiles_.Size(); }
+
     /// Set the partition type used for polygon generation.
     void SetPartitionType(NavmeshPartitionType partitionType);
 
@@ -277,8 +373,18 @@ private:
     void WriteTile(Serializer& dest, int x, int z) const;
     /// Read tile data to the navigation mesh.
     bool ReadTile(Deserializer& source, bool silent);
+    /// Advance path searches in a search slot until the time budget runs out.
+    void UpdatePathSearches(PathSearchSlot& slot, HiresTimer& timer, long long budgetUSec);
+    /// Build the paths of all requests sharing the completed search in a search slot. Return true if successful.
+    bool FinishPathSearch(PathSearchSlot& slot);
+    /// Return the ID of the nearest navigation area containing a world space point.
+    unsigned char GetNearestAreaID(const Vector3& point) const;
 
 protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+    /// Handle scene post-update to process the path requests.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
     /// Collect geometry from under Navigable components.
     void CollectGeometries(Vector<NavigationGeometryInfo>& geometryList);
     /// Visit nodes and collect navigable geometry.
@@ -287,14 +393,28 @@ protected:
     void GetTileGeometry(NavBuildData* build, Vector<NavigationGeometryInfo>& geometryList, BoundingBox& box);
     /// Add a triangle mesh to the geometry data.
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
-    /// Build one tile of the navigation mesh. Return true if successful.
-    virtual bool BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z);
+    /// Build the data of one tile into reusable build data without modifying the navigation mesh, so that it can be called from worker threads. Tile data is null if the tile has no geometry. Return true if successful.
+    bool BuildTileData(SimpleNavBuildData& build, Vector<NavigationGeometryInfo>& geometryList, int x, int z, unsigned char*& navData,
+        int& navDataSize);
+    /// Replace a tile of the navigation mesh with built tile data, or just remove it if the data is null. Takes ownership of the data. Return true if successful.
+    bool CommitTile(int x, int z, unsigned char* navData, int navDataSize);
     /// Build tiles in the rectangular area. Return number of built tiles.
     unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Build tiles in the list. Return number of built tiles.
+    virtual unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const PODVector<IntVector2>& tiles);
+    /// Build the tiles in batches over the work queue and add each batch to the navigation mesh in tile order. Send progress events. Return number of tiles committed successfully.
+    unsigned ProcessTiles(const PODVector<IntVector2>& tiles, const NavigationTileBuildFunction& buildFunction,
+        const NavigationTileCommitFunction& commitFunction);
+    /// Return number of threads that may build tiles at the same time, including the main thread.
+    unsigned GetNumBuildThreads() const;
+    /// Return the inclusive range of tiles intersecting a world-space bounding box.
+    void GetTileRange(const BoundingBox& boundingBox, IntVector2& from, IntVector2& to) const;
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
     /// Release the navigation mesh and the query.
     virtual void ReleaseNavigationMesh();
+    /// Move the pending path requests back to find their polygons again after tiles were removed or replaced. Optionally release the search slots when the navigation mesh itself is released.
+    void RequeuePathRequests(bool releaseSlots);
 
     /// Identifying name for this navigation mesh.
     String meshName_;
@@ -350,6 +470,12 @@ protected:
     bool drawNavAreas_;
     /// NavAreas for this NavMesh
     Vector<WeakPtr<NavArea> > areas_;
+    /// Tiles waiting to be rebuilt by BuildDirtyTiles().
+    HashSet<IntVector2> dirtyTiles_;
+    /// Asynchronous path requests and searches.
+    UniquePtr<PathQueueData> pathQueue_;
+    /// Time budget in milliseconds for processing path requests per frame.
+    float pathTimeBudget_;
 };
 
 /// Register Navigation library objects.
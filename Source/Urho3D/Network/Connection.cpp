@@ -31,6 +31,7 @@
 #include "../Network/Connection.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
+#include "../Network/NetworkInterestGrid.h"
 #include "../Network/NetworkPriority.h"
 #include "../Network/Protocol.h"
 #include "../Resource/ResourceCache.h"
@@ -64,6 +65,7 @@ Connection::Connection(Context* context, bool isClient, const kNet::SharedPtr<kN
     Object(context),
     timeStamp_(0),
     connection_(connection),
+    interestRadius_(0.0f),
     sendMode_(OPSM_NONE),
     isClient_(isClient),
     connectPending_(false),
@@ -219,6 +221,11 @@ void Connection::SetPosition(const Vector3& position)
         sendMode_ = OPSM_POSITION;
 }
 
+void Connection::SetInterestRadius(float radius)
+{
+    interestRadius_ = Max(radius, 0.0f);
+}
+
 void Connection::SetRotation(const Quaternion& rotation)
 {
     rotation_ = rotation;
@@ -252,8 +259,12 @@ void Connection::SendServerUpdate()
     nodesToProcess_.Insert(sceneID);
     ProcessNode(sceneID);
 
-    // Then go through all dirtied nodes
-    nodesToProcess_.Insert(sceneState_.dirtyNodes_);
+    // Then go through all dirtied nodes, or only those in the area of interest
+    auto* grid = scene_->GetComponent<NetworkInterestGrid>();
+    if (grid && grid->IsEnabledEffective())
+        ProcessInterestArea(grid);
+    else
+        nodesToProcess_.Insert(sceneState_.dirtyNodes_);
     nodesToProcess_.Erase(sceneID); // Do not process the root node twice
 
     while (nodesToProcess_.Size())
@@ -1122,6 +1133,9 @@ void Connection::ProcessNode(unsigned nodeID)
             // would be enough. However, this may be better due to the client not possibly having updated parenting
             // information at the time of receiving this message
             SendMessage(MSG_REMOVENODE, true, true, msg_);
+
+            // The weak pointer reference count is shared with the other connections
+            MutexLock lock(GetSubsystem<Network>()->GetReplicationMutex());
             sceneState_.nodeStates_.Erase(nodeID);
         }
         else
@@ -1155,11 +1169,15 @@ void Connection::ProcessNewNode(Node* node)
     msg_.Clear();
     msg_.WriteNetID(node->GetID());
 
+    Mutex& replicationMutex = GetSubsystem<Network>()->GetReplicationMutex();
     NodeReplicationState& nodeState = sceneState_.nodeStates_[node->GetID()];
     nodeState.connection_ = this;
     nodeState.sceneState_ = &sceneState_;
-    nodeState.node_ = node;
-    node->AddReplicationState(&nodeState);
+    {
+        MutexLock lock(replicationMutex);
+        nodeState.node_ = node;
+        node->AddReplicationState(&nodeState);
+    }
 
     // Write node's attributes
     node->WriteInitialDeltaUpdate(msg_, timeStamp_);
@@ -1186,8 +1204,11 @@ void Connection::ProcessNewNode(Node* node)
         ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
         componentState.connection_ = this;
         componentState.nodeState_ = &nodeState;
-        componentState.component_ = component;
-        component->AddReplicationState(&componentState);
+        {
+            MutexLock lock(replicationMutex);
+            componentState.component_ = component;
+            component->AddReplicationState(&componentState);
+        }
 
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
@@ -1216,6 +1237,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     auto* priority = node->GetComponent<NetworkPriority>();
     if (priority && (!priority->GetAlwaysUpdateOwner() || node->GetOwner() != this))
     {
+        // The world transform was refreshed in Scene::PrepareNetworkUpdate(), so this only reads it
         float distance = (node->GetWorldPosition() - position_).Length();
         if (!priority->CheckUpdate(distance, nodeState.priorityAcc_))
             return;
@@ -1295,6 +1317,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             msg_.WriteNetID(current->first_);
 
             SendMessage(MSG_REMOVECOMPONENT, true, true, msg_);
+
+            MutexLock lock(GetSubsystem<Network>()->GetReplicationMutex());
             nodeState.componentStates_.Erase(current);
         }
         else
@@ -1358,8 +1382,11 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
                 componentState.connection_ = this;
                 componentState.nodeState_ = &nodeState;
-                componentState.component_ = component;
-                component->AddReplicationState(&componentState);
+                {
+                    MutexLock lock(GetSubsystem<Network>()->GetReplicationMutex());
+                    componentState.component_ = component;
+                    component->AddReplicationState(&componentState);
+                }
 
                 msg_.Clear();
                 msg_.WriteNetID(node->GetID());
@@ -1376,6 +1403,78 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     sceneState_.dirtyNodes_.Erase(node->GetID());
 }
 
+void Connection::ProcessInterestArea(NetworkInterestGrid* grid)
+{
+    URHO3D_PROFILE(ProcessInterestArea);
+
+    // Nodes enter the area of interest within the radius, but leave it only after moving one more cell away,
+    // so that nodes moving along a cell border are not removed and sent again repeatedly
+    float radius = interestRadius_ > 0.0f ? interestRadius_ : grid->GetInterestRadius();
+    IntRect enterCells = grid->GetCellRect(position_, radius);
+    IntRect leaveCells = grid->GetCellRect(position_, radius + grid->GetCellSize());
+    unsigned sceneID = scene_->GetID();
+
+    // Remove the nodes that have left from the client. Removed nodes are still processed normally
+    interestNodes_.Clear();
+    for (HashMap<unsigned, NodeReplicationState>::ConstIterator i = sceneState_.nodeStates_.Begin();
+         i != sceneState_.nodeStates_.End(); ++i)
+    {
+        if (i->first_ != sceneID && i->second_.node_ && !grid->IsRelevant(i->first_, leaveCells, this))
+            interestNodes_.Push(i->first_);
+    }
+
+    if (interestNodes_.Size())
+    {
+        MutexLock lock(GetSubsystem<Network>()->GetReplicationMutex());
+
+        for (PODVector<unsigned>::ConstIterator i = interestNodes_.Begin(); i != interestNodes_.End(); ++i)
+        {
+            NodeReplicationState& nodeState = sceneState_.nodeStates_[*i];
+            Node* node = nodeState.node_;
+            node->GetNetworkState()->replicationStates_.Remove(&nodeState);
+            for (HashMap<unsigned, ComponentReplicationState>::Iterator j = nodeState.componentStates_.Begin();
+                 j != nodeState.componentStates_.End(); ++j)
+            {
+                Component* component = j->second_.component_;
+                if (component)
+                    component->GetNetworkState()->replicationStates_.Remove(&j->second_);
+            }
+
+            msg_.Clear();
+            msg_.WriteNetID(*i);
+            SendMessage(MSG_REMOVENODE, true, true, msg_);
+
+            sceneState_.nodeStates_.Erase(*i);
+            sceneState_.dirtyNodes_.Erase(*i);
+        }
+    }
+
+    // Process the dirty nodes the client has, and the new nodes in the area of interest. Forget the dirty new nodes
+    // outside it, as they will be found from the grid when they enter
+    for (HashSet<unsigned>::Iterator i = sceneState_.dirtyNodes_.Begin(); i != sceneState_.dirtyNodes_.End();)
+    {
+        if (*i == sceneID || sceneState_.nodeStates_.Contains(*i) || grid->IsRelevant(*i, enterCells, this))
+        {
+            nodesToProcess_.Insert(*i);
+            ++i;
+        }
+        else
+            i = sceneState_.dirtyNodes_.Erase(i);
+    }
+
+    interestNodes_.Clear();
+    grid->GetNodes(interestNodes_, enterCells);
+    for (PODVector<unsigned>::ConstIterator i = interestNodes_.Begin(); i != interestNodes_.End(); ++i)
+    {
+        if (!sceneState_.nodeStates_.Contains(*i))
+        {
+            // Mark dirty too, so that new nodes depending on each other are processed in order
+            sceneState_.dirtyNodes_.Insert(*i);
+            nodesToProcess_.Insert(*i);
+        }
+    }
+}
+
 bool Connection::RequestNeededPackages(unsigned numPackages, MemoryBuffer& msg)
 {
     auto* cache = GetSubsystem<ResourceCache>();
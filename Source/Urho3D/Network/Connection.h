@@ -41,6 +41,7 @@ namespace Urho3D
 
 class File;
 class MemoryBuffer;
+class NetworkInterestGrid;
 class Node;
 class Scene;
 class Serializable;
@@ -130,6 +131,8 @@ public:
     void SetPosition(const Vector3& position);
     /// Set the observer rotation for interest management, to be sent to the server. Note: not used by the NetworkPriority component.
     void SetRotation(const Quaternion& rotation);
+    /// Set the area of interest radius used by a NetworkInterestGrid component on the server. Zero (default) uses the grid's radius.
+    void SetInterestRadius(float radius);
     /// Set the connection pending status. Called by Network.
     void SetConnectPending(bool connectPending);
     /// Set whether to log data in/out statistics.
@@ -170,6 +173,9 @@ public:
     /// Return the observer rotation sent by the client for interest management.
     const Quaternion& GetRotation() const { return rotation_; }
 
+    /// Return the area of interest radius.
+    float GetInterestRadius() const { return interestRadius_; }
+
     /// Return whether is a client connection.
     bool IsClient() const { return isClient_; }
 
@@ -255,6 +261,8 @@ private:
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
     void ProcessExistingNode(Node* node, NodeReplicationState& nodeState);
+    /// Collect the nodes to process from the area of interest, and remove the nodes that have left it from the client.
+    void ProcessInterestArea(NetworkInterestGrid* grid);
     /// Process a SyncPackagesInfo message from server.
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Check a package list received from server and initiate package downloads as necessary. Return true on success, or false if failed to initialze downloads (cache dir not set)
@@ -286,6 +294,8 @@ private:
     HashMap<unsigned, PODVector<unsigned char> > componentLatestData_;
     /// Node ID's to process during a replication update.
     HashSet<unsigned> nodesToProcess_;
+    /// Node ID's in the area of interest or leaving it during a replication update.
+    PODVector<unsigned> interestNodes_;
     /// Reusable message buffer.
     VectorBuffer msg_;
     /// Queued remote events.
@@ -302,6 +312,8 @@ private:
     Vector3 position_;
     /// Observer rotation for interest management.
     Quaternion rotation_;
+    /// Area of interest radius.
+    float interestRadius_;
     /// Send mode for the observer position & rotation.
     ObserverPositionSendMode sendMode_;
     /// Client connection flag.
@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
 #include "../Input/InputEvents.h"
@@ -34,6 +35,7 @@
 #include "../Network/HttpRequest.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
+#include "../Network/NetworkInterestGrid.h"
 #include "../Network/NetworkPriority.h"
 #include "../Network/Protocol.h"
 #include "../Scene/Scene.h"
@@ -508,20 +510,37 @@ void Network::PostUpdate(float timeStep)
                 }
 
                 for (HashSet<Scene*>::ConstIterator i = networkScenes_.Begin(); i != networkScenes_.End(); ++i)
+                {
+                    // The grid reads the nodes marked for network update, so update it before they are cleared
+                    auto* grid = (*i)->GetComponent<NetworkInterestGrid>();
+                    if (grid && grid->IsEnabledEffective())
+                        grid->Update();
+
                     (*i)->PrepareNetworkUpdate();
+                }
             }
 
             {
                 URHO3D_PROFILE(SendServerUpdate);
 
-                // Then send server updates for each client connection
+                // Then send server updates for each client connection. The changed attributes were serialized once
+                // above, so the connections only filter and assemble their messages and can be processed in parallel
+                updateConnections_.Clear();
                 for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
                      i != clientConnections_.End(); ++i)
-                {
-                    i->second_->SendServerUpdate();
-                    i->second_->SendRemoteEvents();
-                    i->second_->SendPackages();
-                }
+                    updateConnections_.Push(i->second_);
+
+                GetSubsystem<WorkQueue>()->ParallelFor(updateConnections_.Size(), 1,
+                    [this](unsigned begin, unsigned end, unsigned /*threadIndex*/)
+                    {
+                        for (unsigned i = begin; i < end; ++i)
+                        {
+                            Connection* connection = updateConnections_[i];
+                            connection->SendServerUpdate();
+                            connection->SendRemoteEvents();
+                            connection->SendPackages();
+                        }
+                    });
             }
         }
 
@@ -596,6 +615,7 @@ void Network::ConfigureNetworkSimulator()
 void RegisterNetworkLibrary(Context* context)
 {
     NetworkPriority::RegisterObject(context);
+    NetworkInterestGrid::RegisterObject(context);
 }
 
 }
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/HashSet.h"
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../IO/VectorBuffer.h"
 #include "../Network/Connection.h"
@@ -128,6 +129,8 @@ public:
 
     /// Return the package download cache directory.
     const String& GetPackageCacheDir() const { return packageCacheDir_; }
+    /// Return the mutex for modifying replication states shared between client connections. Connections are updated in worker threads.
+    Mutex& GetReplicationMutex() { return replicationMutex_; }
 
     /// Process incoming messages from connections. Called by HandleBeginFrame.
     void Update(float timeStep);
@@ -170,6 +173,10 @@ private:
     float updateAcc_;
     /// Package cache directory.
     String packageCacheDir_;
+    /// Client connections being updated.
+    PODVector<Connection*> updateConnections_;
+    /// Replication state modification mutex.
+    Mutex replicationMutex_;
 };
 
 /// Register Network library objects.
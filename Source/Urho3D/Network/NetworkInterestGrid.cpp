@@ -0,0 +1,255 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Network/NetworkInterestGrid.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* NETWORK_CATEGORY;
+
+static const float DEFAULT_CELL_SIZE = 50.0f;
+static const float DEFAULT_INTEREST_RADIUS = 200.0f;
+static const float MIN_CELL_SIZE = 1.0f;
+
+/// Return whether a node or any of its children is owned by a connection.
+static bool IsOwnedBy(const Node* node, Connection* connection)
+{
+    if (node->GetOwner() == connection)
+        return true;
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (Vector<SharedPtr<Node> >::ConstIterator i = children.Begin(); i != children.End(); ++i)
+    {
+        if (IsOwnedBy(*i, connection))
+            return true;
+    }
+    return false;
+}
+
+NetworkInterestGrid::NetworkInterestGrid(Context* context) :
+    Component(context),
+    cellSize_(DEFAULT_CELL_SIZE),
+    interestRadius_(DEFAULT_INTEREST_RADIUS),
+    rebuild_(true)
+{
+}
+
+NetworkInterestGrid::~NetworkInterestGrid() = default;
+
+void NetworkInterestGrid::RegisterObject(Context* context)
+{
+    context->RegisterFactory<NetworkInterestGrid>(NETWORK_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Cell Size", GetCellSize, SetCellSize, float, DEFAULT_CELL_SIZE, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Interest Radius", GetInterestRadius, SetInterestRadius, float, DEFAULT_INTEREST_RADIUS, AM_DEFAULT);
+}
+
+void NetworkInterestGrid::OnSetEnabled()
+{
+    // Changes are not tracked while disabled
+    rebuild_ = true;
+}
+
+void NetworkInterestGrid::SetCellSize(float size)
+{
+    cellSize_ = Max(size, MIN_CELL_SIZE);
+    rebuild_ = true;
+    MarkNetworkUpdate();
+}
+
+void NetworkInterestGrid::SetInterestRadius(float radius)
+{
+    interestRadius_ = Max(radius, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void NetworkInterestGrid::Update()
+{
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+    if (rebuild_)
+    {
+        cells_.Clear();
+        roots_.Clear();
+        nodeRoots_.Clear();
+        localRoots_.Clear();
+
+        const Vector<SharedPtr<Node> >& rootNodes = scene->GetChildren();
+        for (Vector<SharedPtr<Node> >::ConstIterator i = rootNodes.Begin(); i != rootNodes.End(); ++i)
+            dirtyRoots_.Insert((*i)->GetID());
+        rebuild_ = false;
+    }
+    else
+    {
+        // Added, removed, moved and reparented replicated nodes are marked for network update. Place both the hierarchy
+        // a node was in and the one it is in now again. Local roots are not marked, so they are checked on each update
+        const HashSet<unsigned>& updateNodes = scene->GetNetworkUpdateNodes();
+        for (HashSet<unsigned>::ConstIterator i = updateNodes.Begin(); i != updateNodes.End(); ++i)
+        {
+            HashMap<unsigned, unsigned>::ConstIterator j = nodeRoots_.Find(*i);
+            if (j != nodeRoots_.End())
+                dirtyRoots_.Insert(j->second_);
+
+            Node* node = scene->GetNode(*i);
+            if (node && node != scene)
+            {
+                while (node->GetParent() && node->GetParent() != scene)
+                    node = node->GetParent();
+                if (node->GetParent())
+                    dirtyRoots_.Insert(node->GetID());
+            }
+        }
+        dirtyRoots_.Insert(localRoots_);
+    }
+
+    for (HashSet<unsigned>::ConstIterator i = dirtyRoots_.Begin(); i != dirtyRoots_.End(); ++i)
+        UpdateRoot(*i);
+    dirtyRoots_.Clear();
+}
+
+IntRect NetworkInterestGrid::GetCellRect(const Vector3& position, float radius) const
+{
+    return IntRect(FloorToInt((position.x_ - radius) / cellSize_), FloorToInt((position.z_ - radius) / cellSize_),
+        FloorToInt((position.x_ + radius) / cellSize_), FloorToInt((position.z_ + radius) / cellSize_));
+}
+
+bool NetworkInterestGrid::IsRelevant(unsigned nodeID, const IntRect& cells, Connection* connection) const
+{
+    HashMap<unsigned, unsigned>::ConstIterator i = nodeRoots_.Find(nodeID);
+    if (i == nodeRoots_.End())
+        return false;
+    HashMap<unsigned, RootCell>::ConstIterator j = roots_.Find(i->second_);
+    if (j == roots_.End())
+        return false;
+
+    const IntVector2& cell = j->second_.cell_;
+    if (cell.x_ >= cells.left_ && cell.x_ <= cells.right_ && cell.y_ >= cells.top_ && cell.y_ <= cells.bottom_)
+        return true;
+
+    // A hierarchy stays relevant when the connection owns any of its nodes, for example a weapon held by another character
+    Node* root = j->second_.root_;
+    return connection && root && IsOwnedBy(root, connection);
+}
+
+void NetworkInterestGrid::GetNodes(PODVector<unsigned>& dest, const IntRect& cells) const
+{
+    for (int z = cells.top_; z <= cells.bottom_; ++z)
+    {
+        for (int x = cells.left_; x <= cells.right_; ++x)
+        {
+            HashMap<IntVector2, PODVector<unsigned> >::ConstIterator i = cells_.Find(IntVector2(x, z));
+            if (i == cells_.End())
+                continue;
+
+            for (PODVector<unsigned>::ConstIterator j = i->second_.Begin(); j != i->second_.End(); ++j)
+            {
+                HashMap<unsigned, RootCell>::ConstIterator k = roots_.Find(*j);
+                if (k != roots_.End())
+                    dest.Push(k->second_.nodes_);
+            }
+        }
+    }
+}
+
+void NetworkInterestGrid::OnSceneSet(Scene* scene)
+{
+    cells_.Clear();
+    roots_.Clear();
+    nodeRoots_.Clear();
+    localRoots_.Clear();
+    dirtyRoots_.Clear();
+    rebuild_ = true;
+}
+
+void NetworkInterestGrid::UpdateRoot(unsigned rootID)
+{
+    HashMap<unsigned, RootCell>::Iterator i = roots_.Find(rootID);
+    if (i != roots_.End())
+        RemoveRoot(i);
+
+    Scene* scene = GetScene();
+    Node* root = scene->GetNode(rootID);
+    if (!root || root->GetParent() != scene)
+        return;
+
+    RootCell& rootCell = roots_[rootID];
+    root->GetChildren(nodes_, true);
+    nodes_.Push(root);
+    for (PODVector<Node*>::ConstIterator j = nodes_.Begin(); j != nodes_.End(); ++j)
+    {
+        Node* node = *j;
+        if (node->IsReplicated())
+        {
+            rootCell.nodes_.Push(node->GetID());
+            nodeRoots_[node->GetID()] = rootID;
+        }
+    }
+
+    if (rootCell.nodes_.Empty())
+    {
+        roots_.Erase(rootID);
+        return;
+    }
+
+    const Vector3 position = root->GetWorldPosition();
+    rootCell.root_ = root;
+    rootCell.cell_ = IntVector2(FloorToInt(position.x_ / cellSize_), FloorToInt(position.z_ / cellSize_));
+    cells_[rootCell.cell_].Push(rootID);
+    if (!root->IsReplicated())
+        localRoots_.Insert(rootID);
+}
+
+void NetworkInterestGrid::RemoveRoot(HashMap<unsigned, RootCell>::Iterator i)
+{
+    unsigned rootID = i->first_;
+    const RootCell& rootCell = i->second_;
+
+    // A node may already have been placed in another hierarchy it moved to
+    for (PODVector<unsigned>::ConstIterator j = rootCell.nodes_.Begin(); j != rootCell.nodes_.End(); ++j)
+    {
+        HashMap<unsigned, unsigned>::Iterator k = nodeRoots_.Find(*j);
+        if (k != nodeRoots_.End() && k->second_ == rootID)
+            nodeRoots_.Erase(k);
+    }
+
+    HashMap<IntVector2, PODVector<unsigned> >::Iterator cell = cells_.Find(rootCell.cell_);
+    if (cell != cells_.End())
+    {
+        cell->second_.RemoveSwap(rootID);
+        if (cell->second_.Empty())
+            cells_.Erase(cell);
+    }
+
+    localRoots_.Erase(rootID);
+    roots_.Erase(i);
+}
+
+}
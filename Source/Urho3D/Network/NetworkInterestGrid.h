@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Container/HashSet.h"
+#include "../Math/Rect.h"
+#include "../Scene/Component.h"
+
+namespace Urho3D
+{
+
+class Connection;
+
+/// %Network interest management grid. When added to a replicated scene, clients only receive the nodes within their area of interest, centered on the connection's observer position. Nodes are placed on the grid by the world position of their topmost ancestor below the scene on the XZ plane, so that hierarchies enter and leave together. Nodes are removed on the client when they leave the area and sent again when they return.
+class URHO3D_API NetworkInterestGrid : public Component
+{
+    URHO3D_OBJECT(NetworkInterestGrid, Component);
+
+public:
+    /// Construct.
+    explicit NetworkInterestGrid(Context* context);
+    /// Destruct.
+    ~NetworkInterestGrid() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+    /// Handle enabled/disabled state change.
+    void OnSetEnabled() override;
+
+    /// Set grid cell size. Default 50.
+    void SetCellSize(float size);
+    /// Set default area of interest radius, used for connections without their own radius. Default 200.
+    void SetInterestRadius(float radius);
+
+    /// Return grid cell size.
+    float GetCellSize() const { return cellSize_; }
+
+    /// Return default area of interest radius.
+    float GetInterestRadius() const { return interestRadius_; }
+    /// Return number of occupied grid cells.
+    unsigned GetNumOccupiedCells() const { return cells_.Size(); }
+
+    /// Place the replicated nodes that were added, removed or moved since the last update on the grid. Called by Network before the scene prepares its network update.
+    void Update();
+    /// Return the rectangle of cells touched by a circle on the XZ plane.
+    IntRect GetCellRect(const Vector3& position, float radius) const;
+    /// Return whether a node is inside a rectangle of cells, or in a hierarchy where any node is owned by the connection. Unknown nodes are never inside. Called by Connection.
+    bool IsRelevant(unsigned nodeID, const IntRect& cells, Connection* connection) const;
+    /// Return node ID's in a rectangle of cells. Called by Connection.
+    void GetNodes(PODVector<unsigned>& dest, const IntRect& cells) const;
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
+private:
+    /// Grid placement of a hierarchy.
+    struct RootCell
+    {
+        /// Topmost ancestor below the scene.
+        WeakPtr<Node> root_;
+        /// Grid cell.
+        IntVector2 cell_;
+        /// Replicated node ID's of the hierarchy, including the root.
+        PODVector<unsigned> nodes_;
+    };
+
+    /// Place a hierarchy on the grid, or remove it if the root no longer exists or has left the scene.
+    void UpdateRoot(unsigned rootID);
+    /// Remove a hierarchy from its grid cell.
+    void RemoveRoot(HashMap<unsigned, RootCell>::Iterator i);
+
+    /// Root node ID's by grid cell. Empty cells are removed.
+    HashMap<IntVector2, PODVector<unsigned> > cells_;
+    /// Grid placement by root node ID.
+    HashMap<unsigned, RootCell> roots_;
+    /// Root node ID by node ID.
+    HashMap<unsigned, unsigned> nodeRoots_;
+    /// Root node ID's to place again on the next update.
+    HashSet<unsigned> dirtyRoots_;
+    /// Local root node ID's, which are not marked for network update and are placed again on each update.
+    HashSet<unsigned> localRoots_;
+    /// Reusable node list for traversing the scene.
+    PODVector<Node*> nodes_;
+    /// Grid cell size.
+    float cellSize_;
+    /// Default area of interest radius.
+    float interestRadius_;
+    /// Place all hierarchies again on the next update.
+    bool rebuild_;
+};
+
+}
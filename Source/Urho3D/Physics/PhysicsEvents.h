@@ -76,6 +76,12 @@ URHO3D_EVENT(E_PHYSICSCOLLISIONEND, PhysicsCollisionEnd)
     URHO3D_PARAM(P_TRIGGER, Trigger);              // bool
 }
 
+/// Physics contact stream of a simulation step. Global event sent by the PhysicsWorld when the contact stream is enabled. The contact pairs and points are read from the PhysicsWorld.
+URHO3D_EVENT(E_PHYSICSCONTACTS, PhysicsContacts)
+{
+    URHO3D_PARAM(P_WORLD, World);                  // PhysicsWorld pointer
+}
+
 /// Node's physics collision started. Sent by scene nodes participating in a collision.
 URHO3D_EVENT(E_NODECOLLISIONSTART, NodeCollisionStart)
 {
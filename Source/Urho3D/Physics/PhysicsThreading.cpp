@@ -0,0 +1,230 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/WorkQueue.h"
+#include "../Physics/PhysicsThreading.h"
+
+#include <Bullet/BulletCollision/BroadphaseCollision/btOverlappingPairCache.h>
+#include <Bullet/BulletCollision/CollisionShapes/btCollisionShape.h>
+#include <Bullet/LinearMath/btPoolAllocator.h>
+
+#include "../DebugNew.h"
+
+extern int gNumManifold;
+
+namespace Urho3D
+{
+
+/// Pairs processed per narrow phase work item.
+static const unsigned PAIRS_PER_WORK_ITEM = 64;
+
+/// Per-thread dispatch state, needed as Bullet does not pass the thread through to the manifold functions.
+struct DispatchThreadState
+{
+    /// Manifold changes of the current thread, or null when not dispatching.
+    void* changes_;
+    /// Index of the pair being processed.
+    unsigned pairIndex_;
+    /// Number of manifold changes made by the pair so far.
+    unsigned sequence_;
+};
+
+/// Dispatch state of the current thread.
+static thread_local DispatchThreadState dispatchState = { nullptr, 0, 0 };
+/// Work queue thread index of the current thread while solving islands.
+static thread_local unsigned solverThreadIndex = 0;
+/// Work queue for solving islands.
+static WorkQueue* islandWorkQueue = nullptr;
+
+ThreadedCollisionDispatcher::ThreadedCollisionDispatcher(btCollisionConfiguration* collisionConfiguration, WorkQueue* workQueue) :
+    btCollisionDispatcher(collisionConfiguration),
+    workQueue_(workQueue)
+{
+    threadChanges_.Resize(workQueue_->GetNumThreads() + 1);
+}
+
+btPersistentManifold* ThreadedCollisionDispatcher::getNewManifold(const btCollisionObject* body0, const btCollisionObject* body1)
+{
+    auto* changes = static_cast<PODVector<ManifoldChange>*>(dispatchState.changes_);
+    if (!changes)
+        return btCollisionDispatcher::getNewManifold(body0, body1);
+
+    // Same as the base class, except that the manifold is not yet added to the manifold array
+    btScalar contactBreakingThreshold = (m_dispatcherFlags & CD_USE_RELATIVE_CONTACT_BREAKING_THRESHOLD) ?
+        btMin(body0->getCollisionShape()->getContactBreakingThreshold(gContactBreakingThreshold),
+            body1->getCollisionShape()->getContactBreakingThreshold(gContactBreakingThreshold)) : gContactBreakingThreshold;
+    btScalar contactProcessingThreshold = btMin(body0->getContactProcessingThreshold(), body1->getContactProcessingThreshold());
+
+    void* mem = m_persistentManifoldPoolAllocator->allocate(sizeof(btPersistentManifold));
+    if (!mem)
+    {
+        if (m_dispatcherFlags & CD_DISABLE_CONTACTPOOL_DYNAMIC_ALLOCATION)
+            return nullptr;
+        mem = btAlignedAlloc(sizeof(btPersistentManifold), 16);
+    }
+
+    auto* manifold = new(mem) btPersistentManifold(body0, body1, 0, contactBreakingThreshold, contactProcessingThreshold);
+    ManifoldChange change = { dispatchState.pairIndex_, dispatchState.sequence_++, manifold, false };
+    changes->Push(change);
+    return manifold;
+}
+
+void ThreadedCollisionDispatcher::releaseManifold(btPersistentManifold* manifold)
+{
+    auto* changes = static_cast<PODVector<ManifoldChange>*>(dispatchState.changes_);
+    if (!changes)
+    {
+        btCollisionDispatcher::releaseManifold(manifold);
+        return;
+    }
+
+    ManifoldChange change = { dispatchState.pairIndex_, dispatchState.sequence_++, manifold, true };
+    changes->Push(change);
+}
+
+void ThreadedCollisionDispatcher::dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& dispatchInfo,
+    btDispatcher* dispatcher)
+{
+    unsigned numPairs = (unsigned)pairCache->getNumOverlappingPairs();
+    if (!workQueue_->GetNumThreads() || numPairs <= PAIRS_PER_WORK_ITEM)
+    {
+        btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, dispatchInfo, dispatcher);
+        return;
+    }
+
+    btBroadphasePair* pairs = pairCache->getOverlappingPairArrayPtr();
+    btNearCallback nearCallback = getNearCallback();
+
+    workQueue_->ParallelFor(numPairs, PAIRS_PER_WORK_ITEM, [&](unsigned begin, unsigned end, unsigned threadIndex)
+    {
+        // Restore the previous state afterward, in case this range was taken while the thread waited inside another one
+        DispatchThreadState previousState = dispatchState;
+        dispatchState.changes_ = &threadChanges_[threadIndex];
+        for (unsigned i = begin; i < end; ++i)
+        {
+            dispatchState.pairIndex_ = i;
+            dispatchState.sequence_ = 0;
+            nearCallback(pairs[i], *this, dispatchInfo);
+        }
+        dispatchState = previousState;
+    });
+
+    // Apply the manifold changes in the order sequential dispatch would have made them, so that the manifold array
+    // and therefore the collision events stay deterministic
+    changes_.Clear();
+    for (unsigned i = 0; i < threadChanges_.Size(); ++i)
+    {
+        changes_.Push(threadChanges_[i]);
+        threadChanges_[i].Clear();
+    }
+    Sort(changes_.Begin(), changes_.End(), CompareChanges);
+
+    for (PODVector<ManifoldChange>::ConstIterator i = changes_.Begin(); i != changes_.End(); ++i)
+    {
+        if (i->release_)
+            btCollisionDispatcher::releaseManifold(i->manifold_);
+        else
+        {
+            ++gNumManifold;
+            i->manifold_->m_index1a = m_manifoldsPtr.size();
+            m_manifoldsPtr.push_back(i->manifold_);
+        }
+    }
+}
+
+bool ThreadedCollisionDispatcher::CompareChanges(const ManifoldChange& lhs, const ManifoldChange& rhs)
+{
+    return lhs.pairIndex_ != rhs.pairIndex_ ? lhs.pairIndex_ < rhs.pairIndex_ : lhs.sequence_ < rhs.sequence_;
+}
+
+ConstraintSolverPool::ConstraintSolverPool(unsigned numSolvers)
+{
+    for (unsigned i = 0; i < Max(numSolvers, 1U); ++i)
+        solvers_.Push(new btSequentialImpulseConstraintSolver());
+}
+
+ConstraintSolverPool::~ConstraintSolverPool()
+{
+    for (unsigned i = 0; i < solvers_.Size(); ++i)
+        delete solvers_[i];
+}
+
+void ConstraintSolverPool::prepareSolve(int numBodies, int numManifolds)
+{
+    for (unsigned i = 0; i < solvers_.Size(); ++i)
+        solvers_[i]->prepareSolve(numBodies, numManifolds);
+}
+
+btScalar ConstraintSolverPool::solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds,
+    int numManifolds, btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info, btIDebugDraw* debugDrawer,
+    btDispatcher* dispatcher)
+{
+    // Each thread solves its islands one at a time, so the thread's own solver is always free
+    btSequentialImpulseConstraintSolver* solver = solvers_[solverThreadIndex < solvers_.Size() ? solverThreadIndex : 0];
+    return solver->solveGroup(bodies, numBodies, manifolds, numManifolds, constraints, numConstraints, info, debugDrawer, dispatcher);
+}
+
+void ConstraintSolverPool::allSolved(const btContactSolverInfo& info, btIDebugDraw* debugDrawer)
+{
+    for (unsigned i = 0; i < solvers_.Size(); ++i)
+        solvers_[i]->allSolved(info, debugDrawer);
+}
+
+void ConstraintSolverPool::reset()
+{
+    for (unsigned i = 0; i < solvers_.Size(); ++i)
+        solvers_[i]->reset();
+}
+
+void SetIslandWorkQueue(WorkQueue* workQueue)
+{
+    islandWorkQueue = workQueue;
+}
+
+void DispatchIslands(btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* islands,
+    btSimulationIslandManagerMt::IslandCallback* callback)
+{
+    if (!islandWorkQueue || islands->size() < 2)
+    {
+        btSimulationIslandManagerMt::defaultIslandDispatch(islands, callback);
+        return;
+    }
+
+    islandWorkQueue->ParallelFor((unsigned)islands->size(), 1, [&](unsigned begin, unsigned end, unsigned threadIndex)
+    {
+        unsigned previousIndex = solverThreadIndex;
+        solverThreadIndex = threadIndex;
+        for (unsigned i = begin; i < end; ++i)
+        {
+            btSimulationIslandManagerMt::Island* island = (*islands)[i];
+            callback->processIsland(&island->bodyArray[0], island->bodyArray.size(),
+                island->manifoldArray.size() ? &island->manifoldArray[0] : nullptr, island->manifoldArray.size(),
+                island->constraintArray.size() ? &island->constraintArray[0] : nullptr, island->constraintArray.size(), island->id);
+        }
+        solverThreadIndex = previousIndex;
+    });
+}
+
+}
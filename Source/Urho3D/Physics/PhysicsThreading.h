@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2008 - 2018 the Urho3D project, 2017 - 2018 Flock SDK developers & contributors. 
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Vector.h"
+
+#include <Bullet/BulletCollision/CollisionDispatch/btCollisionDispatcher.h>
+#include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
+#include <Bullet/BulletDynamics/Dynamics/btSimulationIslandManagerMt.h>
+
+namespace Urho3D
+{
+
+class WorkQueue;
+
+/// Collision dispatcher that runs the narrow phase of the overlapping pairs in the work queue threads. Contact manifolds are added to and removed from the manifold array in the same order as in sequential dispatch.
+class URHO3D_API ThreadedCollisionDispatcher : public btCollisionDispatcher
+{
+public:
+    /// Construct.
+    ThreadedCollisionDispatcher(btCollisionConfiguration* collisionConfiguration, WorkQueue* workQueue);
+
+    /// Return a new contact manifold. While dispatching, it is added to the manifold array only after all pairs are processed.
+    btPersistentManifold* getNewManifold(const btCollisionObject* body0, const btCollisionObject* body1) override;
+    /// Release a contact manifold. While dispatching, the release is deferred until all pairs are processed.
+    void releaseManifold(btPersistentManifold* manifold) override;
+    /// Process all overlapping pairs.
+    void dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& dispatchInfo, btDispatcher* dispatcher) override;
+
+private:
+    /// Manifold addition or removal made while dispatching.
+    struct ManifoldChange
+    {
+        /// Index of the pair that made the change.
+        unsigned pairIndex_;
+        /// Order of the change within the pair.
+        unsigned sequence_;
+        /// Manifold.
+        btPersistentManifold* manifold_;
+        /// Release flag.
+        bool release_;
+    };
+
+    /// Sort comparison for manifold changes.
+    static bool CompareChanges(const ManifoldChange& lhs, const ManifoldChange& rhs);
+
+    /// Work queue.
+    WorkQueue* workQueue_;
+    /// Manifold changes made by each thread while dispatching.
+    Vector<PODVector<ManifoldChange> > threadChanges_;
+    /// Manifold changes of all threads in sequential order.
+    PODVector<ManifoldChange> changes_;
+};
+
+/// Constraint solver that solves simulation islands in parallel, using one sequential impulse solver per work queue thread.
+class URHO3D_API ConstraintSolverPool : public btConstraintSolver
+{
+public:
+    /// Construct.
+    explicit ConstraintSolverPool(unsigned numSolvers);
+    /// Destruct.
+    ~ConstraintSolverPool() override;
+
+    /// Prepare all solvers for a simulation step.
+    void prepareSolve(int numBodies, int numManifolds) override;
+    /// Solve an island with the calling thread's solver.
+    btScalar solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds, int numManifolds,
+        btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info, btIDebugDraw* debugDrawer,
+        btDispatcher* dispatcher) override;
+    /// Finish a simulation step in all solvers.
+    void allSolved(const btContactSolverInfo& info, btIDebugDraw* debugDrawer) override;
+    /// Reset all solvers.
+    void reset() override;
+    /// Return solver type.
+    btConstraintSolverType getSolverType() const override { return BT_SEQUENTIAL_IMPULSE_SOLVER; }
+
+private:
+    /// Solvers indexed by work queue thread.
+    PODVector<btSequentialImpulseConstraintSolver*> solvers_;
+};
+
+/// Set the work queue used for solving simulation islands in parallel.
+URHO3D_API void SetIslandWorkQueue(WorkQueue* workQueue);
+/// Island dispatch function for btSimulationIslandManagerMt that solves the islands in the work queue threads.
+URHO3D_API void DispatchIslands(btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* islands,
+    btSimulationIslandManagerMt::IslandCallback* callback);
+
+}
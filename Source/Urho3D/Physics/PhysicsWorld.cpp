@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
@@ -32,6 +33,7 @@
 #include "../Physics/CollisionShape.h"
 #include "../Physics/Constraint.h"
 #include "../Physics/PhysicsEvents.h"
+#include "../Physics/PhysicsThreading.h"
 #include "../Physics/PhysicsUtils.h"
 #include "../Physics/PhysicsWorld.h"
 #include "../Physics/RaycastVehicle.h"
@@ -47,6 +49,7 @@
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 
 extern ContactAddedCallback gContactAddedCallback;
 
@@ -61,11 +64,111 @@ static const Vector3 DEFAULT_GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
 
 PhysicsWorldConfig PhysicsWorld::config;
 
+static const unsigned QUERIES_PER_WORK_ITEM = 16;
+
 static bool CompareRaycastResults(const PhysicsRaycastResult& lhs, const PhysicsRaycastResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
 }
 
+static bool CompareContactStreamManifolds(const ContactStreamManifold& lhs, const ContactStreamManifold& rhs)
+{
+    return lhs.key_ != rhs.key_ ? lhs.key_ < rhs.key_ : lhs.index_ < rhs.index_;
+}
+
+static bool IsCollisionReported(RigidBody* bodyA, RigidBody* bodyB)
+{
+    // Skip collision event signaling if both objects are static, or if collision event mode does not match
+    if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
+        return false;
+    if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
+        return false;
+    if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
+        !bodyA->IsActive() && !bodyB->IsActive())
+        return false;
+    return true;
+}
+
+/// Erase the event parameters that are not in the list, such as ones added by event handlers.
+template <unsigned N> static void EraseOtherParameters(VariantMap& eventData, const StringHash (&keys)[N])
+{
+    for (VariantMap::Iterator i = eventData.Begin(); i != eventData.End();)
+    {
+        bool listed = false;
+        for (unsigned j = 0; j < N && !listed; ++j)
+            listed = i->first_ == keys[j];
+        if (listed)
+            ++i;
+        else
+            i = eventData.Erase(i);
+    }
+}
+
+static void ClearRaycastResult(PhysicsRaycastResult& result)
+{
+    result.body_ = nullptr;
+    result.position_ = Vector3::ZERO;
+    result.normal_ = Vector3::ZERO;
+    result.distance_ = M_INFINITY;
+    result.hitFraction_ = 0.0f;
+}
+
+static void RaycastSingleImpl(btCollisionWorld* world, PhysicsRaycastResult& result, const Ray& ray, float maxDistance,
+    unsigned collisionMask)
+{
+    btCollisionWorld::ClosestRayResultCallback
+        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
+    rayCallback.m_collisionFilterGroup = (short)0xffff;
+    rayCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+
+    if (rayCallback.hasHit())
+    {
+        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+        result.distance_ = (result.position_ - ray.origin_).Length();
+        result.hitFraction_ = rayCallback.m_closestHitFraction;
+        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+    }
+    else
+        ClearRaycastResult(result);
+}
+
+static void ConvexCastImpl(btCollisionWorld* world, PhysicsRaycastResult& result, const btConvexShape* shape, const Vector3& startPos,
+    const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
+{
+    btCollisionWorld::ClosestConvexResultCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
+    convexCallback.m_collisionFilterGroup = (short)0xffff;
+    convexCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->convexSweepTest(shape, btTransform(ToBtQuaternion(startRot), convexCallback.m_convexFromWorld),
+        btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld), convexCallback);
+
+    if (convexCallback.hasHit())
+    {
+        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
+        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
+        result.hitFraction_ = convexCallback.m_closestHitFraction;
+    }
+    else
+        ClearRaycastResult(result);
+}
+
+static void RunQueries(WorkQueue* workQueue, unsigned count, const ParallelForFunction& function)
+{
+    // The world is not modified while the caller waits for the queries, so they can read it concurrently. The caller may be
+    // a worker thread, for example a thread-safe logic component update, so pass its own thread index. Other threads can not
+    // split the queries over the work queue
+    unsigned threadIndex = WorkQueue::GetCurrentThreadIndex();
+    if (workQueue && threadIndex != NON_WORKER_THREAD_INDEX)
+        workQueue->ParallelFor(count, QUERIES_PER_WORK_ITEM, function, threadIndex);
+    else
+        function(0, count, threadIndex);
+}
+
 void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep)
 {
     static_cast<PhysicsWorld*>(world->getWorldUserInfo())->PreStep(timeStep);
@@ -156,12 +259,31 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     else
         collisionConfiguration_ = new btDefaultCollisionConfiguration();
 
-    collisionDispatcher_ = new btCollisionDispatcher(collisionConfiguration_);
+    auto* workQueue = GetSubsystem<WorkQueue>();
+    threaded_ = PhysicsWorld::config.threaded_ && workQueue && workQueue->GetNumThreads();
+
+    if (threaded_)
+        collisionDispatcher_ = new ThreadedCollisionDispatcher(collisionConfiguration_, workQueue);
+    else
+        collisionDispatcher_ = new btCollisionDispatcher(collisionConfiguration_);
     btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.Get()));
 
     broadphase_ = new btDbvtBroadphase();
-    solver_ = new btSequentialImpulseConstraintSolver();
-    world_ = new btDiscreteDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+
+    if (threaded_)
+    {
+        // Solve the simulation islands in parallel, each thread with its own solver
+        solver_ = new ConstraintSolverPool(workQueue->GetNumThreads() + 1);
+        auto* world = new btDiscreteDynamicsWorldMt(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+        SetIslandWorkQueue(workQueue);
+        static_cast<btSimulationIslandManagerMt*>(world->getSimulationIslandManager())->setIslandDispatchFunction(DispatchIslands);
+        world_ = world;
+    }
+    else
+    {
+        solver_ = new btSequentialImpulseConstraintSolver();
+        world_ = new btDiscreteDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+    }
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -210,6 +332,8 @@ void PhysicsWorld::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Interpolation", bool, interpolation_, true, AM_FILE);
     URHO3D_ATTRIBUTE("Internal Edge Utility", bool, internalEdge_, true, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Split Impulse", GetSplitImpulse, SetSplitImpulse, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Collision Events", GetCollisionEvents, SetCollisionEvents, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Contact Stream", GetContactStream, SetContactStream, bool, false, AM_DEFAULT);
 }
 
 bool PhysicsWorld::isVisible(const btVector3& aabbMin, const btVector3& aabbMax)
@@ -355,6 +479,29 @@ void PhysicsWorld::SetInternalEdge(bool enable)
     MarkNetworkUpdate();
 }
 
+void PhysicsWorld::SetCollisionEvents(bool enable)
+{
+    collisionEvents_ = enable;
+    // Forget the previous collisions so that no stale collision end events are sent if re-enabled
+    if (!enable)
+        previousCollisions_.Clear();
+
+    MarkNetworkUpdate();
+}
+
+void PhysicsWorld::SetContactStream(bool enable)
+{
+    contactStream_ = enable;
+    if (!enable)
+    {
+        contactPairs_.Clear();
+        contactPoints_.Clear();
+        previousContactKeys_.Clear();
+    }
+
+    MarkNetworkUpdate();
+}
+
 void PhysicsWorld::SetSplitImpulse(bool enable)
 {
     world_->getSolverInfo().m_splitImpulse = enable;
@@ -404,29 +551,23 @@ void PhysicsWorld::RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, f
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
-    btCollisionWorld::ClosestRayResultCallback
-        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
-    rayCallback.m_collisionFilterGroup = (short)0xffff;
-    rayCallback.m_collisionFilterMask = (short)collisionMask;
+    RaycastSingleImpl(world_.Get(), result, ray, maxDistance, collisionMask);
+}
 
-    world_->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+void PhysicsWorld::RaycastSingleBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<Ray>& rays, float maxDistance,
+    unsigned collisionMask)
+{
+    URHO3D_PROFILE(PhysicsRaycastSingleBatch);
 
-    if (rayCallback.hasHit())
-    {
-        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
-        result.distance_ = (result.position_ - ray.origin_).Length();
-        result.hitFraction_ = rayCallback.m_closestHitFraction;
-        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
-    }
-    else
+    if (maxDistance >= M_INFINITY)
+        URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
+
+    results.Resize(rays.Size());
+    RunQueries(GetSubsystem<WorkQueue>(), rays.Size(), [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
     {
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-        result.body_ = nullptr;
-    }
+        for (unsigned i = begin; i < end; ++i)
+            RaycastSingleImpl(world_.Get(), results[i], rays[i], maxDistance, collisionMask);
+    });
 }
 
 void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, float segmentDistance, unsigned collisionMask)
@@ -485,32 +626,29 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
         URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
 
     btSphereShape shape(radius);
-    Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
+    ConvexCastImpl(world_.Get(), result, &shape, ray.origin_, Quaternion::IDENTITY, ray.origin_ + maxDistance * ray.direction_,
+        Quaternion::IDENTITY, collisionMask);
+}
 
-    btCollisionWorld::ClosestConvexResultCallback
-        convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
+void PhysicsWorld::SphereCastBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<Ray>& rays, float radius,
+    float maxDistance, unsigned collisionMask)
+{
+    URHO3D_PROFILE(PhysicsSphereCastBatch);
 
-    world_->convexSweepTest(&shape, btTransform(btQuaternion::getIdentity(), convexCallback.m_convexFromWorld),
-        btTransform(btQuaternion::getIdentity(), convexCallback.m_convexToWorld), convexCallback);
+    if (maxDistance >= M_INFINITY)
+        URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
 
-    if (convexCallback.hasHit())
-    {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
-    }
-    else
+    btSphereShape shape(radius);
+    results.Resize(rays.Size());
+    RunQueries(GetSubsystem<WorkQueue>(), rays.Size(), [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
     {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-    }
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const Ray& ray = rays[i];
+            ConvexCastImpl(world_.Get(), results[i], &shape, ray.origin_, Quaternion::IDENTITY,
+                ray.origin_ + maxDistance * ray.direction_, Quaternion::IDENTITY, collisionMask);
+        }
+    });
 }
 
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos,
@@ -581,30 +719,84 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, btCollisionShape* sh
 
     URHO3D_PROFILE(PhysicsConvexCast);
 
-    btCollisionWorld::ClosestConvexResultCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
+    ConvexCastImpl(world_.Get(), result, static_cast<btConvexShape*>(shape), startPos, startRot, endPos, endRot, collisionMask);
+}
 
-    world_->convexSweepTest(static_cast<btConvexShape*>(shape), btTransform(ToBtQuaternion(startRot),
-            convexCallback.m_convexFromWorld), btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld),
-        convexCallback);
+void PhysicsWorld::ConvexCastBatch(PODVector<PhysicsRaycastResult>& results, CollisionShape* shape,
+    const PODVector<PhysicsConvexSweep>& sweeps, unsigned collisionMask)
+{
+    if (!shape || !shape->GetCollisionShape() || !shape->GetCollisionShape()->isConvex())
+    {
+        URHO3D_LOGERROR("Null or non-convex collision shape for convex cast");
+        results.Resize(sweeps.Size());
+        for (unsigned i = 0; i < results.Size(); ++i)
+            ClearRaycastResult(results[i]);
+        return;
+    }
 
-    if (convexCallback.hasHit())
+    URHO3D_PROFILE(PhysicsConvexCastBatch);
+
+    // If shape is attached in a rigidbody, set its collision group temporarily to 0 to make sure it is not returned in the sweep results
+    auto* bodyComp = shape->GetComponent<RigidBody>();
+    btRigidBody* body = bodyComp ? bodyComp->GetBody() : nullptr;
+    btBroadphaseProxy* proxy = body ? body->getBroadphaseProxy() : nullptr;
+    short group = 0;
+    if (proxy)
     {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
+        group = proxy->m_collisionFilterGroup;
+        proxy->m_collisionFilterGroup = 0;
     }
-    else
+
+    Node* shapeNode = shape->GetNode();
+    Vector3 scale = shapeNode ? shapeNode->GetWorldScale() : Vector3::ONE;
+    Vector3 offsetPos = shape->GetPosition();
+    Quaternion offsetRot = shape->GetRotation();
+    auto* convexShape = static_cast<btConvexShape*>(shape->GetCollisionShape());
+
+    results.Resize(sweeps.Size());
+    RunQueries(GetSubsystem<WorkQueue>(), sweeps.Size(), [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
     {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
+        for (unsigned i = begin; i < end; ++i)
+        {
+            // Take the shape's offset position & rotation into account
+            const PhysicsConvexSweep& sweep = sweeps[i];
+            Matrix3x4 startTransform(sweep.startPos_, sweep.startRot_, scale);
+            Matrix3x4 endTransform(sweep.endPos_, sweep.endRot_, scale);
+            ConvexCastImpl(world_.Get(), results[i], convexShape, startTransform * offsetPos, sweep.startRot_ * offsetRot,
+                endTransform * offsetPos, sweep.endRot_ * offsetRot, collisionMask);
+        }
+    });
+
+    // Restore the collision group
+    if (proxy)
+        proxy->m_collisionFilterGroup = group;
+}
+
+void PhysicsWorld::ConvexCastBatch(PODVector<PhysicsRaycastResult>& results, btCollisionShape* shape,
+    const PODVector<PhysicsConvexSweep>& sweeps, unsigned collisionMask)
+{
+    if (!shape || !shape->isConvex())
+    {
+        URHO3D_LOGERROR("Null or non-convex collision shape for convex cast");
+        results.Resize(sweeps.Size());
+        for (unsigned i = 0; i < results.Size(); ++i)
+            ClearRaycastResult(results[i]);
+        return;
     }
+
+    URHO3D_PROFILE(PhysicsConvexCastBatch);
+
+    auto* convexShape = static_cast<btConvexShape*>(shape);
+    results.Resize(sweeps.Size());
+    RunQueries(GetSubsystem<WorkQueue>(), sweeps.Size(), [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const PhysicsConvexSweep& sweep = sweeps[i];
+            ConvexCastImpl(world_.Get(), results[i], convexShape, sweep.startPos_, sweep.startRot_, sweep.endPos_, sweep.endRot_,
+                collisionMask);
+        }
+    });
 }
 
 void PhysicsWorld::RemoveCachedGeometry(Model* model)
@@ -832,11 +1024,23 @@ void PhysicsWorld::PostStep(float timeStep)
 
 void PhysicsWorld::SendCollisionEvents()
 {
+    if (contactStream_)
+        SendContactStream();
+    if (!collisionEvents_)
+        return;
+
     URHO3D_PROFILE(SendCollisionEvents);
 
+    // The event data maps are not cleared, so that the parameters rewritten before each send keep their storage from step
+    // to step. Other parameters are erased, so that they do not persist to later steps or to the end events
+    static const StringHash physicsEndParams[] = {PhysicsCollisionEnd::P_WORLD, PhysicsCollisionEnd::P_NODEA,
+        PhysicsCollisionEnd::P_NODEB, PhysicsCollisionEnd::P_BODYA, PhysicsCollisionEnd::P_BODYB, PhysicsCollisionEnd::P_TRIGGER};
+    static const StringHash nodeEndParams[] = {NodeCollisionEnd::P_BODY, NodeCollisionEnd::P_OTHERNODE,
+        NodeCollisionEnd::P_OTHERBODY, NodeCollisionEnd::P_TRIGGER};
+    EraseOtherParameters(physicsCollisionData_, physicsEndParams);
+    EraseOtherParameters(nodeCollisionData_, nodeEndParams);
+
     currentCollisions_.Clear();
-    physicsCollisionData_.Clear();
-    nodeCollisionData_.Clear();
 
     int numManifolds = collisionDispatcher_->getNumManifolds();
 
@@ -1014,8 +1218,10 @@ void PhysicsWorld::SendCollisionEvents()
         }
     }
 
-    // Send collision end events as applicable
+    // Send collision end events as applicable. The contacts are not part of them
     {
+        EraseOtherParameters(physicsCollisionData_, physicsEndParams);
+        EraseOtherParameters(nodeCollisionData_, nodeEndParams);
         physicsCollisionData_[PhysicsCollisionEnd::P_WORLD] = this;
 
         for (HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair>::Iterator
@@ -1076,6 +1282,125 @@ void PhysicsWorld::SendCollisionEvents()
     previousCollisions_ = currentCollisions_;
 }
 
+void PhysicsWorld::SendContactStream()
+{
+    URHO3D_PROFILE(SendContactStream);
+
+    // Collect the manifolds with contacts and sort them by the component IDs of the body pair
+    streamManifolds_.Clear();
+    int numManifolds = collisionDispatcher_->getNumManifolds();
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        btPersistentManifold* contactManifold = collisionDispatcher_->getManifoldByIndexInternal(i);
+        if (!contactManifold->getNumContacts())
+            continue;
+
+        auto* body0 = static_cast<RigidBody*>(contactManifold->getBody0()->getUserPointer());
+        auto* body1 = static_cast<RigidBody*>(contactManifold->getBody1()->getUserPointer());
+        if (!body0 || !body1 || !IsCollisionReported(body0, body1))
+            continue;
+
+        ContactStreamManifold entry;
+        entry.flipped_ = body0->GetID() > body1->GetID();
+        entry.bodyA_ = entry.flipped_ ? body1 : body0;
+        entry.bodyB_ = entry.flipped_ ? body0 : body1;
+        entry.key_ = (unsigned long long)entry.bodyA_->GetID() << 32u | entry.bodyB_->GetID();
+        entry.manifold_ = contactManifold;
+        entry.index_ = (unsigned)i;
+        streamManifolds_.Push(entry);
+    }
+    Sort(streamManifolds_.Begin(), streamManifolds_.End(), CompareContactStreamManifolds);
+
+    // Merge the sorted pairs with the previous step's to find the begun, continued and ended pairs
+    contactPairs_.Clear();
+    contactPoints_.Clear();
+    currentContactKeys_.Clear();
+    unsigned previous = 0;
+
+    for (unsigned i = 0; i < streamManifolds_.Size();)
+    {
+        const ContactStreamManifold& first = streamManifolds_[i];
+        unsigned long long key = first.key_;
+
+        while (previous < previousContactKeys_.Size() && previousContactKeys_[previous].key_ < key)
+            AddEndedContactPair(previousContactKeys_[previous++]);
+        // A matching key continues the pair only if it still refers to the same bodies, as component IDs may be reused
+        bool existed = false;
+        if (previous < previousContactKeys_.Size() && previousContactKeys_[previous].key_ == key)
+        {
+            const ContactStreamKey& previousKey = previousContactKeys_[previous++];
+            existed = previousKey.bodyA_.Get() == first.bodyA_ && previousKey.bodyB_.Get() == first.bodyB_;
+            if (!existed)
+                AddEndedContactPair(previousKey);
+        }
+
+        PhysicsContactPair pair;
+        pair.bodyA_ = first.bodyA_;
+        pair.bodyB_ = first.bodyB_;
+        pair.state_ = existed ? CONTACT_STAY : CONTACT_BEGIN;
+        pair.trigger_ = first.bodyA_->IsTrigger() || first.bodyB_->IsTrigger();
+        pair.firstContact_ = contactPoints_.Size();
+
+        for (; i < streamManifolds_.Size() && streamManifolds_[i].key_ == key; ++i)
+        {
+            // Normals point the same way as in the physics collision events, where body A is the first body
+            btPersistentManifold* contactManifold = streamManifolds_[i].manifold_;
+            float normalSign = streamManifolds_[i].flipped_ ? -1.0f : 1.0f;
+            for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+            {
+                btManifoldPoint& point = contactManifold->getContactPoint(j);
+                PhysicsContactPoint contact;
+                contact.position_ = ToVector3(point.m_positionWorldOnB);
+                contact.normal_ = normalSign * ToVector3(point.m_normalWorldOnB);
+                contact.distance_ = point.m_distance1;
+                contact.impulse_ = point.m_appliedImpulse;
+                contactPoints_.Push(contact);
+            }
+        }
+
+        pair.numContacts_ = contactPoints_.Size() - pair.firstContact_;
+        contactPairs_.Push(pair);
+
+        ContactStreamKey currentKey;
+        currentKey.key_ = key;
+        currentKey.bodyA_ = first.bodyA_;
+        currentKey.bodyB_ = first.bodyB_;
+        currentContactKeys_.Push(currentKey);
+    }
+
+    while (previous < previousContactKeys_.Size())
+        AddEndedContactPair(previousContactKeys_[previous++]);
+
+    previousContactKeys_.Swap(currentContactKeys_);
+
+    if (!contactPairs_.Empty())
+    {
+        using namespace PhysicsContacts;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_WORLD] = this;
+        SendEvent(E_PHYSICSCONTACTS, eventData);
+    }
+}
+
+void PhysicsWorld::AddEndedContactPair(const ContactStreamKey& key)
+{
+    // Every reported pair ends, also when it is no longer reported because the bodies fell asleep, unless a body was destroyed
+    RigidBody* bodyA = key.bodyA_;
+    RigidBody* bodyB = key.bodyB_;
+    if (!bodyA || !bodyB)
+        return;
+
+    PhysicsContactPair pair;
+    pair.bodyA_ = bodyA;
+    pair.bodyB_ = bodyB;
+    pair.state_ = CONTACT_END;
+    pair.trigger_ = bodyA->IsTrigger() || bodyB->IsTrigger();
+    pair.firstContact_ = contactPoints_.Size();
+    pair.numContacts_ = 0;
+    contactPairs_.Push(pair);
+}
+
 void RegisterPhysicsLibrary(Context* context)
 {
     CollisionShape::RegisterObject(context);
@@ -83,6 +83,31 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_;
 };
 
+/// Start and end transform of a swept convex test.
+struct URHO3D_API PhysicsConvexSweep
+{
+    /// Construct with defaults.
+    PhysicsConvexSweep() = default;
+
+    /// Construct with start and end transforms.
+    PhysicsConvexSweep(const Vector3& startPos, const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot) :
+        startPos_(startPos),
+        startRot_(startRot),
+        endPos_(endPos),
+        endRot_(endRot)
+    {
+    }
+
+    /// Start worldspace position.
+    Vector3 startPos_;
+    /// Start worldspace rotation.
+    Quaternion startRot_;
+    /// End worldspace position.
+    Vector3 endPos_;
+    /// End worldspace rotation.
+    Quaternion endRot_;
+};
+
 /// Delayed world transform assignment for parented rigidbodies.
 struct DelayedWorldTransform
 {
@@ -96,6 +121,72 @@ struct DelayedWorldTransform
     Quaternion worldRotation_;
 };
 
+/// State of a rigid body pair in the contact stream.
+enum ContactPairState
+{
+    CONTACT_BEGIN = 0,
+    CONTACT_STAY,
+    CONTACT_END
+};
+
+/// Contact point in the contact stream.
+struct PhysicsContactPoint
+{
+    /// Contact worldspace position.
+    Vector3 position_;
+    /// Contact worldspace normal, oriented as in the physics collision events.
+    Vector3 normal_;
+    /// Contact distance.
+    float distance_;
+    /// Contact impulse.
+    float impulse_;
+};
+
+/// Rigid body pair in the contact stream. Body A has the smaller component ID.
+struct PhysicsContactPair
+{
+    /// Rigid body A.
+    RigidBody* bodyA_;
+    /// Rigid body B.
+    RigidBody* bodyB_;
+    /// Begin, stay or end state.
+    ContactPairState state_;
+    /// Trigger flag.
+    bool trigger_;
+    /// Index of the first contact point.
+    unsigned firstContact_;
+    /// Number of contact points. Zero for ended pairs.
+    unsigned numContacts_;
+};
+
+/// Contact manifold collected for the contact stream.
+struct ContactStreamManifold
+{
+    /// Pair key made of the component IDs.
+    unsigned long long key_;
+    /// Rigid body A.
+    RigidBody* bodyA_;
+    /// Rigid body B.
+    RigidBody* bodyB_;
+    /// Manifold.
+    btPersistentManifold* manifold_;
+    /// Manifold index, used to keep the order of manifolds within a pair.
+    unsigned index_;
+    /// Whether the manifold bodies are in reverse order to A and B.
+    bool flipped_;
+};
+
+/// Rigid body pair reported in the contact stream, kept for finding the ended pairs on the next step.
+struct ContactStreamKey
+{
+    /// Pair key made of the component IDs.
+    unsigned long long key_;
+    /// Rigid body A.
+    WeakPtr<RigidBody> bodyA_;
+    /// Rigid body B.
+    WeakPtr<RigidBody> bodyB_;
+};
+
 /// Manifold pointers stored during collision processing.
 struct ManifoldPair
 {
@@ -116,12 +207,15 @@ struct ManifoldPair
 struct PhysicsWorldConfig
 {
     PhysicsWorldConfig() :
-        collisionConfig_(nullptr)
+        collisionConfig_(nullptr),
+        threaded_(false)
     {
     }
 
     /// Override for the collision configuration (default btDefaultCollisionConfiguration).
     btCollisionConfiguration* collisionConfig_;
+    /// Run collision dispatch and constraint solving in the work queue threads (default false). Has no effect without worker threads.
+    bool threaded_;
 };
 
 static const int DEFAULT_FPS = 60;
@@ -189,6 +283,10 @@ public:
     void SetSplitImpulse(bool enable);
     /// Set maximum angular velocity for network replication.
     void SetMaxNetworkAngularVelocity(float velocity);
+    /// Set whether to send the per-pair physics and node collision events. Enabled by default.
+    void SetCollisionEvents(bool enable);
+    /// Set whether to gather the contact stream and send it with a single event after each simulation step. Disabled by default.
+    void SetContactStream(bool enable);
     /// Perform a physics world raycast and return all hits.
     void Raycast
         (PODVector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -205,6 +303,18 @@ public:
     /// Perform a physics world swept convex test using a user-supplied Bullet collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, btCollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform physics world raycasts in the work queue threads and return the closest hit of each ray. The results are resized to the number of rays.
+    void RaycastSingleBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<Ray>& rays, float maxDistance,
+        unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform physics world swept sphere tests in the work queue threads and return the closest hit of each ray. The results are resized to the number of rays.
+    void SphereCastBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<Ray>& rays, float radius, float maxDistance,
+        unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform physics world swept convex tests using a user-supplied collision shape in the work queue threads and return the first hit of each sweep. The results are resized to the number of sweeps.
+    void ConvexCastBatch(PODVector<PhysicsRaycastResult>& results, CollisionShape* shape, const PODVector<PhysicsConvexSweep>& sweeps,
+        unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform physics world swept convex tests using a user-supplied Bullet collision shape in the work queue threads and return the first hit of each sweep. The results are resized to the number of sweeps.
+    void ConvexCastBatch(PODVector<PhysicsRaycastResult>& results, btCollisionShape* shape, const PODVector<PhysicsConvexSweep>& sweeps,
+        unsigned collisionMask = M_MAX_UNSIGNED);
     /// Invalidate cached collision geometry for a model.
     void RemoveCachedGeometry(Model* model);
     /// Return rigid bodies by a sphere query.
@@ -288,6 +398,21 @@ public:
     /// Return whether is currently inside the Bullet substep loop.
     bool IsSimulating() const { return simulating_; }
 
+    /// Return whether the simulation runs in the work queue threads.
+    bool IsThreaded() const { return threaded_; }
+
+    /// Return whether the per-pair collision events are sent.
+    bool GetCollisionEvents() const { return collisionEvents_; }
+
+    /// Return whether the contact stream is gathered.
+    bool GetContactStream() const { return contactStream_; }
+
+    /// Return rigid body pairs of the contact stream from the last simulation step, sorted by component IDs.
+    const PODVector<PhysicsContactPair>& GetContactPairs() const { return contactPairs_; }
+
+    /// Return contact points of the contact stream from the last simulation step.
+    const PODVector<PhysicsContactPoint>& GetContactPoints() const { return contactPoints_; }
+
     /// Overrides of the internal configuration.
     static struct PhysicsWorldConfig config;
 
@@ -304,6 +429,10 @@ private:
     void PostStep(float timeStep);
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Gather the contact stream and send it.
+    void SendContactStream();
+    /// Add an ended pair to the contact stream if both bodies still exist.
+    void AddEndedContactPair(const ContactStreamKey& key);
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -341,6 +470,16 @@ private:
     VariantMap nodeCollisionData_;
     /// Preallocated buffer for physics collision contact data.
     VectorBuffer contacts_;
+    /// Manifolds collected for the contact stream.
+    PODVector<ContactStreamManifold> streamManifolds_;
+    /// Contact stream pairs.
+    PODVector<PhysicsContactPair> contactPairs_;
+    /// Contact stream points.
+    PODVector<PhysicsContactPoint> contactPoints_;
+    /// Sorted keys of the contact stream pairs on this step.
+    Vector<ContactStreamKey> currentContactKeys_;
+    /// Sorted keys of the contact stream pairs on the previous step.
+    Vector<ContactStreamKey> previousContactKeys_;
     /// Simulation substeps per second.
     unsigned fps_{DEFAULT_FPS};
     /// Maximum number of simulation substeps per frame. 0 (default) unlimited, or negative values for adaptive timestep.
@@ -359,6 +498,12 @@ private:
     bool applyingTransforms_{};
     /// Simulating flag.
     bool simulating_{};
+    /// Threaded simulation flag.
+    bool threaded_{};
+    /// Per-pair collision events flag.
+    bool collisionEvents_{true};
+    /// Contact stream flag.
+    bool contactStream_{};
     /// Debug draw depth test mode.
     bool debugDepthTest_{};
     /// Debug renderer.
@@ -26,6 +26,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../IO/Log.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/ResourceCache.h"
@@ -36,80 +37,133 @@
 namespace Urho3D
 {
 
+/// Background loader thread.
+class BackgroundLoaderThread : public Thread, public RefCounted
+{
+public:
+    /// Construct.
+    explicit BackgroundLoaderThread(BackgroundLoader* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Load queued resources until stopped.
+    void ThreadFunction() override
+    {
+        while (shouldRun_)
+        {
+            if (!owner_->LoadNextResource())
+                Time::Sleep(5);
+        }
+    }
+
+private:
+    /// Background loader.
+    BackgroundLoader* owner_;
+};
+
 BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
-    owner_(owner)
+    owner_(owner),
+    numThreads_(1),
+    numStartedThreads_(0)
 {
 }
 
 BackgroundLoader::~BackgroundLoader()
 {
+    // Stop the threads first, as they need the queue mutex to finish the resource they are loading. Take them over
+    // with the mutex held and prevent starting more, as a thread queuing dependencies may be starting threads
+    Vector<SharedPtr<BackgroundLoaderThread> > stoppedThreads;
+    {
+        MutexLock lock(backgroundLoadMutex_);
+
+        numThreads_ = 0;
+        stoppedThreads.Swap(threads_);
+        numStartedThreads_ = 0;
+    }
+
+    for (unsigned i = 0; i < stoppedThreads.Size(); ++i)
+        stoppedThreads[i]->Stop();
+
     MutexLock lock(backgroundLoadMutex_);
 
+    pendingItems_.Clear();
     backgroundLoadQueue_.Clear();
 }
 
-void BackgroundLoader::ThreadFunction()
+void BackgroundLoader::SetNumThreads(unsigned num)
 {
-    while (shouldRun_)
+    num = Max(num, 1U);
+
+    Vector<SharedPtr<BackgroundLoaderThread> > stoppedThreads;
     {
-        backgroundLoadMutex_.Acquire();
+        MutexLock lock(backgroundLoadMutex_);
 
-        // Search for a queued resource that has not been loaded yet
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-        while (i != backgroundLoadQueue_.End())
+        numThreads_ = num;
+        while (threads_.Size() > numThreads_)
         {
-            if (i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
+            stoppedThreads.Push(threads_.Back());
+            threads_.Pop();
         }
+        numStartedThreads_ = threads_.Size();
+        // If loading has already started, start the additional threads immediately
+        if (!threads_.Empty())
+            StartThreads();
+    }
 
-        if (i == backgroundLoadQueue_.End())
-        {
-            // No resources to load found
-            backgroundLoadMutex_.Release();
-            Time::Sleep(5);
-        }
-        else
-        {
-            BackgroundLoadItem& item = i->second_;
-            Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
-            backgroundLoadMutex_.Release();
-
-            bool success = false;
-            SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
-            {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
-            }
+    // Stop extra threads outside the lock, as they may be finishing a resource
+    for (unsigned i = 0; i < stoppedThreads.Size(); ++i)
+        stoppedThreads[i]->Stop();
+}
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.Size())
-            {
-                for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependents_.Begin();
-                     i != item.dependents_.End(); ++i)
-                {
-                    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
-                    if (j != backgroundLoadQueue_.End())
-                        j->second_.dependencies_.Erase(key);
-                }
+bool BackgroundLoader::LoadNextResource()
+{
+    backgroundLoadMutex_.Acquire();
 
-                item.dependents_.Clear();
-            }
+    if (pendingItems_.Empty())
+    {
+        backgroundLoadMutex_.Release();
+        return false;
+    }
 
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
+    BackgroundLoadItem& item = *pendingItems_.Front();
+    pendingItems_.PopFront();
+    Resource* resource = item.resource_;
+    // We can be sure that the item is not removed from the queue as long as it is in the
+    // "queued" or "loading" state
+    resource->SetAsyncLoadState(ASYNC_LOADING);
+    backgroundLoadMutex_.Release();
+
+    bool success = false;
+    SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
+    if (file)
+        success = resource->BeginLoad(*file);
+
+    // Process dependencies now
+    // Need to lock the queue again when manipulating other entries
+    Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
+    backgroundLoadMutex_.Acquire();
+    if (item.dependents_.Size())
+    {
+        for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependents_.Begin();
+             i != item.dependents_.End(); ++i)
+        {
+            HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
+            if (j != backgroundLoadQueue_.End())
+                j->second_.dependencies_.Erase(key);
         }
+
+        item.dependents_.Clear();
     }
+
+    resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+    backgroundLoadMutex_.Release();
+
+    return true;
 }
 
-bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller)
+bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller,
+    unsigned priority)
 {
     StringHash nameHash(name);
     Pair<StringHash, StringHash> key = MakePair(type, nameHash);
@@ -122,6 +176,7 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
 
     BackgroundLoadItem& item = backgroundLoadQueue_[key];
     item.sendEventOnFailure_ = sendEventOnFailure;
+    item.priority_ = priority;
 
     // Make sure the pointer is non-null and is a Resource subclass
     item.resource_ = DynamicCast<Resource>(owner_->GetContext()->CreateObject(type));
@@ -147,7 +202,8 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
     item.resource_->SetName(name);
     item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
 
-    // If this is a resource calling for the background load of more resources, mark the dependency as necessary
+    // If this is a resource calling for the background load of more resources, mark the dependency as necessary.
+    // The caller can not finish before its dependencies, so they are loaded with at least the caller's priority
     if (caller)
     {
         Pair<StringHash, StringHash> callerKey = MakePair(caller->GetType(), caller->GetNameHash());
@@ -156,6 +212,7 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
         {
             BackgroundLoadItem& callerItem = j->second_;
             item.dependents_.Insert(callerKey);
+            item.priority_ = Max(item.priority_, callerItem.priority_);
             callerItem.dependencies_.Insert(key);
         }
         else
@@ -163,13 +220,27 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
                        " requested for a background loaded resource but was not in the background load queue");
     }
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
+    InsertPending(&item);
+
+    // Start the loader threads now. Dependencies queued by a resource being loaded are picked up by the other
+    // threads, so that for example the textures of a material load in parallel
+    StartThreads();
 
     return true;
 }
 
+bool BackgroundLoader::RaisePriority(StringHash type, StringHash nameHash, unsigned priority)
+{
+    MutexLock lock(backgroundLoadMutex_);
+
+    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(MakePair(type, nameHash));
+    if (i == backgroundLoadQueue_.End())
+        return false;
+
+    RaiseItemPriority(i->second_, priority);
+    return true;
+}
+
 void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 {
     backgroundLoadMutex_.Acquire();
@@ -179,6 +250,8 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(key);
     if (i != backgroundLoadQueue_.End())
     {
+        // The resource is needed now, so move it and its dependencies to the front of the queue
+        RaiseItemPriority(i->second_, M_MAX_UNSIGNED);
         backgroundLoadMutex_.Release();
 
         {
@@ -217,7 +290,8 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
+    // The loader threads may be starting more threads, so do not access the thread vector without the mutex
+    if (numStartedThreads_)
     {
         HiresTimer timer;
 
@@ -256,6 +330,52 @@ unsigned BackgroundLoader::GetNumQueuedResources() const
     return backgroundLoadQueue_.Size();
 }
 
+void BackgroundLoader::StartThreads()
+{
+    while (threads_.Size() < numThreads_)
+    {
+        SharedPtr<BackgroundLoaderThread> thread(new BackgroundLoaderThread(this));
+        thread->Run();
+        threads_.Push(thread);
+    }
+    numStartedThreads_ = threads_.Size();
+}
+
+void BackgroundLoader::InsertPending(BackgroundLoadItem* item)
+{
+    // Items of equal priority load in request order
+    List<BackgroundLoadItem*>::Iterator i = pendingItems_.Begin();
+    while (i != pendingItems_.End() && (*i)->priority_ >= item->priority_)
+        ++i;
+    pendingItems_.Insert(i, item);
+}
+
+void BackgroundLoader::RaiseItemPriority(BackgroundLoadItem& item, unsigned priority)
+{
+    if (item.priority_ >= priority)
+        return;
+
+    item.priority_ = priority;
+
+    // Reposition in the pending list if no thread has taken the item yet
+    if (item.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
+    {
+        List<BackgroundLoadItem*>::Iterator i = pendingItems_.Find(&item);
+        if (i != pendingItems_.End())
+        {
+            pendingItems_.Erase(i);
+            InsertPending(&item);
+        }
+    }
+
+    for (HashSet<Pair<StringHash, StringHash> >::ConstIterator i = item.dependencies_.Begin(); i != item.dependencies_.End(); ++i)
+    {
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
+        if (j != backgroundLoadQueue_.End())
+            RaiseItemPriority(j->second_, priority);
+    }
+}
+
 void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
 {
     Resource* resource = item.resource_;
@@ -24,15 +24,18 @@
 
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
+#include "../Container/List.h"
 #include "../Core/Mutex.h"
 #include "../Container/Ptr.h"
 #include "../Container/RefCounted.h"
-#include "../Core/Thread.h"
 #include "../Math/StringHash.h"
 
+#include <atomic>
+
 namespace Urho3D
 {
 
+class BackgroundLoaderThread;
 class Resource;
 class ResourceCache;
 
@@ -45,43 +48,64 @@ struct BackgroundLoadItem
     HashSet<Pair<StringHash, StringHash> > dependencies_;
     /// Resources that depend on this resource's loading.
     HashSet<Pair<StringHash, StringHash> > dependents_;
+    /// Load priority. Higher priority resources are loaded first.
+    unsigned priority_;
     /// Whether to send failure event.
     bool sendEventOnFailure_;
 };
 
-/// Background loader of resources. Owned by the ResourceCache.
-class BackgroundLoader : public RefCounted, public Thread
+/// Background loader of resources using a pool of loader threads. Owned by the ResourceCache.
+class BackgroundLoader : public RefCounted
 {
 public:
     /// Construct.
     explicit BackgroundLoader(ResourceCache* owner);
 
-    /// Destruct. Forcibly clear the load queue.
+    /// Destruct. Stop the loader threads and forcibly clear the load queue.
     ~BackgroundLoader() override;
 
-    /// Resource background loading loop.
-    void ThreadFunction() override;
-
-    /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
-    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller);
+    /// Set number of loader threads. Threads are started on the first background request.
+    void SetNumThreads(unsigned num);
+    /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Resources requested by a caller inherit at least its priority. Return true if queued (not a duplicate and resource was a known type).
+    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, unsigned priority = 0);
+    /// Raise the priority of a queued resource and the resources it depends on. Return true if the resource was in the queue.
+    bool RaisePriority(StringHash type, StringHash nameHash, unsigned priority);
     /// Wait and finish possible loading of a resource when being requested from the cache.
     void WaitForResource(StringHash type, StringHash nameHash);
     /// Process resources that are ready to finish.
     void FinishResources(int maxMs);
+    /// Take the highest priority resource from the queue and call its BeginLoad(). Called from the loader threads. Return false if nothing was queued.
+    bool LoadNextResource();
 
+    /// Return number of loader threads.
+    unsigned GetNumThreads() const { return numThreads_; }
     /// Return amount of resources in the load queue.
     unsigned GetNumQueuedResources() const;
 
 private:
+    /// Start loader threads up to the configured number. Called with the queue mutex held, also from the loader threads when they queue dependencies.
+    void StartThreads();
+    /// Insert an item into the pending list according to its priority. Called with the queue mutex held.
+    void InsertPending(BackgroundLoadItem* item);
+    /// Raise priority of an item and its dependencies. Called with the queue mutex held.
+    void RaiseItemPriority(BackgroundLoadItem& item, unsigned priority);
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
 
     /// Resource cache.
     ResourceCache* owner_;
+    /// Loader threads.
+    Vector<SharedPtr<BackgroundLoaderThread> > threads_;
+    /// Number of loader threads to start.
+    unsigned numThreads_;
+    /// Number of started loader threads. Changed with the queue mutex held, but readable without locking.
+    std::atomic<unsigned> numStartedThreads_;
     /// Mutex for thread-safe access to the background load queue.
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Queued items that no thread has started loading yet, in descending priority order.
+    List<BackgroundLoadItem*> pendingItems_;
 };
 
 }
@@ -26,6 +26,7 @@
 #include "../Core/Profiler.h"
 #include "../Core/Context.h"
 #include "../IO/Deserializer.h"
+#include "../IO/File.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
 #include "../Resource/JSONFile.h"
@@ -120,13 +121,26 @@ bool JSONFile::BeginLoad(Deserializer& source)
         return false;
     }
 
-    SharedArrayPtr<char> buffer(new char[dataSize + 1]);
-    if (source.Read(buffer.Get(), dataSize) != dataSize)
-        return false;
-    buffer[dataSize] = '\0';
+    // Parse an uncompressed entry of a memory mapped package directly from the mapping, otherwise read the data first
+    auto* file = dynamic_cast<File*>(&source);
+    const unsigned char* mappedData = file && !file->GetPosition() ? file->GetMappedData() : nullptr;
+    SharedArrayPtr<char> buffer;
+    const char* data;
+    if (mappedData)
+    {
+        data = reinterpret_cast<const char*>(mappedData);
+        source.Seek(dataSize);
+    }
+    else
+    {
+        buffer = new char[dataSize];
+        if (source.Read(buffer.Get(), dataSize) != dataSize)
+            return false;
+        data = buffer.Get();
+    }
 
     rapidjson::Document document;
-    if (document.Parse<kParseCommentsFlag | kParseTrailingCommasFlag>(buffer).HasParseError())
+    if (document.Parse<kParseCommentsFlag | kParseTrailingCommasFlag>(data, dataSize).HasParseError())
     {
         URHO3D_LOGERROR("Could not parse JSON data from " + source.GetName());
         return false;
@@ -79,7 +79,7 @@ ResourceCache::ResourceCache(Context* context) :
     RegisterResourceLibrary(context_);
 
 #ifdef URHO3D_THREADING
-    // Create resource background loader. Its thread will start on the first background request
+    // Create resource background loader. Its threads will start on the first background request
     backgroundLoader_ = new BackgroundLoader(this);
 #endif
 
@@ -174,6 +174,8 @@ bool ResourceCache::AddManualResource(Resource* resource)
         return false;
     }
 
+    MutexLock lock(resourceMutex_);
+
     resource->ResetUseTimer();
     resourceGroups_[resource->GetType()].resources_[resource->GetNameHash()] = resource;
     UpdateResourceGroup(resource->GetType());
@@ -246,13 +248,15 @@ void ResourceCache::RemovePackageFile(const String& fileName, bool releaseResour
 void ResourceCache::ReleaseResource(StringHash type, const String& name, bool force)
 {
     StringHash nameHash(name);
-    const SharedPtr<Resource>& existingRes = FindResource(type, nameHash);
+    SharedPtr<Resource> existingRes = FindResource(type, nameHash);
     if (!existingRes)
         return;
 
     // If other references exist, do not release, unless forced
-    if ((existingRes.Refs() == 1 && existingRes.WeakRefs() == 0) || force)
+    if ((existingRes.Refs() == 2 && existingRes.WeakRefs() == 0) || force)
     {
+        MutexLock lock(resourceMutex_);
+
         resourceGroups_[type].resources_.Erase(nameHash);
         UpdateResourceGroup(type);
     }
@@ -260,21 +264,24 @@ void ResourceCache::ReleaseResource(StringHash type, const String& name, bool fo
 
 void ResourceCache::ReleaseResources(StringHash type, bool force)
 {
+    MutexLock lock(resourceMutex_);
+
     bool released = false;
 
-    HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i != resourceGroups_.End())
     {
-        for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
              j != i->second_.resources_.End();)
         {
-            HashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
             // If other references exist, do not release, unless forced
-            if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
+            if ((j->second_.Refs() == 1 && j->second_.WeakRefs() == 0) || force)
             {
-                i->second_.resources_.Erase(current);
+                j = i->second_.resources_.Erase(j);
                 released = true;
             }
+            else
+                ++j;
         }
     }
 
@@ -284,24 +291,27 @@ void ResourceCache::ReleaseResources(StringHash type, bool force)
 
 void ResourceCache::ReleaseResources(StringHash type, const String& partialName, bool force)
 {
+    MutexLock lock(resourceMutex_);
+
     bool released = false;
 
-    HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i != resourceGroups_.End())
     {
-        for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
              j != i->second_.resources_.End();)
         {
-            HashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
-            if (current->second_->GetName().Contains(partialName))
+            if (j->second_->GetName().Contains(partialName))
             {
                 // If other references exist, do not release, unless forced
-                if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
+                if ((j->second_.Refs() == 1 && j->second_.WeakRefs() == 0) || force)
                 {
-                    i->second_.resources_.Erase(current);
+                    j = i->second_.resources_.Erase(j);
                     released = true;
+                    continue;
                 }
             }
+            ++j;
         }
     }
 
@@ -315,25 +325,28 @@ void ResourceCache::ReleaseResources(const String& partialName, bool force)
     // This is not necessary if forcing release
     unsigned repeat = force ? 1 : 2;
 
+    MutexLock lock(resourceMutex_);
+
     while (repeat--)
     {
-        for (HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
+        for (FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
         {
             bool released = false;
 
-            for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+            for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
                  j != i->second_.resources_.End();)
             {
-                HashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
-                if (current->second_->GetName().Contains(partialName))
+                if (j->second_->GetName().Contains(partialName))
                 {
                     // If other references exist, do not release, unless forced
-                    if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
+                    if ((j->second_.Refs() == 1 && j->second_.WeakRefs() == 0) || force)
                     {
-                        i->second_.resources_.Erase(current);
+                        j = i->second_.resources_.Erase(j);
                         released = true;
+                        continue;
                     }
                 }
+                ++j;
             }
             if (released)
                 UpdateResourceGroup(i->first_);
@@ -345,23 +358,26 @@ void ResourceCache::ReleaseAllResources(bool force)
 {
     unsigned repeat = force ? 1 : 2;
 
+    MutexLock lock(resourceMutex_);
+
     while (repeat--)
     {
-        for (HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin();
+        for (FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin();
              i != resourceGroups_.End(); ++i)
         {
             bool released = false;
 
-            for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+            for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
                  j != i->second_.resources_.End();)
             {
-                HashMap<StringHash, SharedPtr<Resource> >::Iterator current = j++;
                 // If other references exist, do not release, unless forced
-                if ((current->second_.Refs() == 1 && current->second_.WeakRefs() == 0) || force)
+                if ((j->second_.Refs() == 1 && j->second_.WeakRefs() == 0) || force)
                 {
-                    i->second_.resources_.Erase(current);
+                    j = i->second_.resources_.Erase(j);
                     released = true;
                 }
+                else
+                    ++j;
             }
             if (released)
                 UpdateResourceGroup(i->first_);
@@ -399,7 +415,7 @@ void ResourceCache::ReloadResourceWithDependencies(const String& fileName)
 {
     StringHash fileNameHash(fileName);
     // If the filename is a resource we keep track of, reload it
-    const SharedPtr<Resource>& resource = FindResource(fileNameHash);
+    SharedPtr<Resource> resource = FindResource(fileNameHash);
     if (resource)
     {
         URHO3D_LOGDEBUG("Reloading changed resource " + fileName);
@@ -419,7 +435,7 @@ void ResourceCache::ReloadResourceWithDependencies(const String& fileName)
 
             for (HashSet<StringHash>::ConstIterator k = j->second_.Begin(); k != j->second_.End(); ++k)
             {
-                const SharedPtr<Resource>& dependent = FindResource(*k);
+                SharedPtr<Resource> dependent = FindResource(*k);
                 if (dependent)
                     dependents.Push(dependent);
             }
@@ -458,6 +474,13 @@ void ResourceCache::SetAutoReloadResources(bool enable)
     }
 }
 
+void ResourceCache::SetNumBackgroundLoadThreads(unsigned num)
+{
+#ifdef URHO3D_THREADING
+    backgroundLoader_->SetNumThreads(num);
+#endif
+}
+
 void ResourceCache::AddResourceRouter(ResourceRouter* router, bool addAsFirst)
 {
     // Check for duplicate
@@ -555,7 +578,7 @@ Resource* ResourceCache::GetExistingResource(StringHash type, const String& name
 
     StringHash nameHash(sanitatedName);
 
-    const SharedPtr<Resource>& existing = FindResource(type, nameHash);
+    SharedPtr<Resource> existing = FindResource(type, nameHash);
     return existing;
 }
 
@@ -580,7 +603,7 @@ Resource* ResourceCache::GetResource(StringHash type, const String& name, bool s
     backgroundLoader_->WaitForResource(type, nameHash);
 #endif
 
-    const SharedPtr<Resource>& existing = FindResource(type, nameHash);
+    SharedPtr<Resource> existing = FindResource(type, nameHash);
     if (existing)
         return existing;
 
@@ -627,7 +650,9 @@ Resource* ResourceCache::GetResource(StringHash type, const String& name, bool s
             return nullptr;
     }
 
-    // Store to cache
+    // Store to cache. The background loader may look up resources at the same time
+    MutexLock lock(resourceMutex_);
+
     resource->ResetUseTimer();
     resourceGroups_[type].resources_[nameHash] = resource;
     UpdateResourceGroup(type);
@@ -635,7 +660,8 @@ Resource* ResourceCache::GetResource(StringHash type, const String& name, bool s
     return resource;
 }
 
-bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller)
+bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller,
+    unsigned priority)
 {
 #ifdef URHO3D_THREADING
     // If empty name, fail immediately
@@ -648,13 +674,22 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name,
     if (FindResource(type, nameHash) != noResource)
         return false;
 
-    return backgroundLoader_->QueueResource(type, sanitatedName, sendEventOnFailure, caller);
+    return backgroundLoader_->QueueResource(type, sanitatedName, sendEventOnFailure, caller, priority);
 #else
     // When threading not supported, fall back to synchronous loading
     return GetResource(type, name, sendEventOnFailure);
 #endif
 }
 
+bool ResourceCache::RaiseBackgroundLoadPriority(StringHash type, const String& name, unsigned priority)
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->RaisePriority(type, StringHash(SanitateResourceName(name)), priority);
+#else
+    return false;
+#endif
+}
+
 SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String& name, bool sendEventOnFailure)
 {
     String sanitatedName = SanitateResourceName(name);
@@ -717,13 +752,22 @@ unsigned ResourceCache::GetNumBackgroundLoadResources() const
 #endif
 }
 
+unsigned ResourceCache::GetNumBackgroundLoadThreads() const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->GetNumThreads();
+#else
+    return 0;
+#endif
+}
+
 void ResourceCache::GetResources(PODVector<Resource*>& result, StringHash type) const
 {
     result.Clear();
-    HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
     if (i != resourceGroups_.End())
     {
-        for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = i->second_.resources_.Begin();
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = i->second_.resources_.Begin();
              j != i->second_.resources_.End(); ++j)
             result.Push(j->second_);
     }
@@ -764,20 +808,20 @@ bool ResourceCache::Exists(const String& name) const
 
 unsigned long long ResourceCache::GetMemoryBudget(StringHash type) const
 {
-    HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
     return i != resourceGroups_.End() ? i->second_.memoryBudget_ : 0;
 }
 
 unsigned long long ResourceCache::GetMemoryUse(StringHash type) const
 {
-    HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Find(type);
     return i != resourceGroups_.End() ? i->second_.memoryUse_ : 0;
 }
 
 unsigned long long ResourceCache::GetTotalMemoryUse() const
 {
     unsigned long long total = 0;
-    for (HashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
+    for (FlatHashMap<StringHash, ResourceGroup>::ConstIterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
         total += i->second_.memoryUse_;
     return total;
 }
@@ -923,7 +967,7 @@ String ResourceCache::PrintMemoryUsage() const
     unsigned long long totalAverage = 0;
     unsigned long long totalUse = GetTotalMemoryUse();
 
-    for (HashMap<StringHash, ResourceGroup>::ConstIterator cit = resourceGroups_.Begin(); cit != resourceGroups_.End(); ++cit)
+    for (FlatHashMap<StringHash, ResourceGroup>::ConstIterator cit = resourceGroups_.Begin(); cit != resourceGroups_.End(); ++cit)
     {
         const unsigned resourceCt = cit->second_.resources_.Size();
         unsigned long long average = 0;
@@ -932,7 +976,7 @@ String ResourceCache::PrintMemoryUsage() const
         else
             average = 0;
         unsigned long long largest = 0;
-        for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator resIt = cit->second_.resources_.Begin(); resIt != cit->second_.resources_.End(); ++resIt)
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::ConstIterator resIt = cit->second_.resources_.Begin(); resIt != cit->second_.resources_.End(); ++resIt)
         {
             if (resIt->second_->GetMemoryUse() > largest)
                 largest = resIt->second_->GetMemoryUse();
@@ -972,27 +1016,27 @@ String ResourceCache::PrintMemoryUsage() const
     return output;
 }
 
-const SharedPtr<Resource>& ResourceCache::FindResource(StringHash type, StringHash nameHash)
+SharedPtr<Resource> ResourceCache::FindResource(StringHash type, StringHash nameHash)
 {
     MutexLock lock(resourceMutex_);
 
-    HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
+    FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i == resourceGroups_.End())
         return noResource;
-    HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
+    FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
     if (j == i->second_.resources_.End())
         return noResource;
 
     return j->second_;
 }
 
-const SharedPtr<Resource>& ResourceCache::FindResource(StringHash nameHash)
+SharedPtr<Resource> ResourceCache::FindResource(StringHash nameHash)
 {
     MutexLock lock(resourceMutex_);
 
-    for (HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
+    for (FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Begin(); i != resourceGroups_.End(); ++i)
     {
-        HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
+        FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Find(nameHash);
         if (j != i->second_.resources_.End())
             return j->second_;
     }
@@ -1010,9 +1054,9 @@ void ResourceCache::ReleasePackageResources(PackageFile* package, bool force)
         StringHash nameHash(i->first_);
 
         // We do not know the actual resource type, so search all type containers
-        for (HashMap<StringHash, ResourceGroup>::Iterator j = resourceGroups_.Begin(); j != resourceGroups_.End(); ++j)
+        for (FlatHashMap<StringHash, ResourceGroup>::Iterator j = resourceGroups_.Begin(); j != resourceGroups_.End(); ++j)
         {
-            HashMap<StringHash, SharedPtr<Resource> >::Iterator k = j->second_.resources_.Find(nameHash);
+            FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator k = j->second_.resources_.Find(nameHash);
             if (k != j->second_.resources_.End())
             {
                 // If other references exist, do not release, unless forced
@@ -1032,7 +1076,9 @@ void ResourceCache::ReleasePackageResources(PackageFile* package, bool force)
 
 void ResourceCache::UpdateResourceGroup(StringHash type)
 {
-    HashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
+    MutexLock lock(resourceMutex_);
+
+    FlatHashMap<StringHash, ResourceGroup>::Iterator i = resourceGroups_.Find(type);
     if (i == resourceGroups_.End())
         return;
 
@@ -1040,9 +1086,9 @@ void ResourceCache::UpdateResourceGroup(StringHash type)
     {
         unsigned totalSize = 0;
         unsigned oldestTimer = 0;
-        HashMap<StringHash, SharedPtr<Resource> >::Iterator oldestResource = i->second_.resources_.End();
+        FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator oldestResource = i->second_.resources_.End();
 
-        for (HashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
+        for (FlatHashMap<StringHash, SharedPtr<Resource> >::Iterator j = i->second_.resources_.Begin();
              j != i->second_.resources_.End(); ++j)
         {
             totalSize += j->second_->GetMemoryUse();
@@ -26,6 +26,7 @@
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
 #include "../IO/Deserializer.h"
+#include "../IO/File.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
 #include "../IO/VectorBuffer.h"
@@ -85,11 +86,25 @@ bool XMLFile::BeginLoad(Deserializer& source)
         return false;
     }
 
-    SharedArrayPtr<char> buffer(new char[dataSize]);
-    if (source.Read(buffer.Get(), dataSize) != dataSize)
-        return false;
+    // Parse an uncompressed entry of a memory mapped package directly from the mapping, otherwise read the data first
+    auto* file = dynamic_cast<File*>(&source);
+    const unsigned char* mappedData = file && !file->GetPosition() ? file->GetMappedData() : nullptr;
+    SharedArrayPtr<char> buffer;
+    const char* data;
+    if (mappedData)
+    {
+        data = reinterpret_cast<const char*>(mappedData);
+        source.Seek(dataSize);
+    }
+    else
+    {
+        buffer = new char[dataSize];
+        if (source.Read(buffer.Get(), dataSize) != dataSize)
+            return false;
+        data = buffer.Get();
+    }
 
-    if (!document_->load_buffer(buffer.Get(), dataSize))
+    if (!document_->load_buffer(data, dataSize))
     {
         URHO3D_LOGERROR("Could not parse XML data from " + source.GetName());
         document_->reset();
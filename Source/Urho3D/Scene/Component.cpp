@@ -173,6 +173,8 @@ void Component::PrepareNetworkUpdate()
 
     unsigned numAttributes = attributes->Size();
 
+    DirtyBits changedAttributes;
+
     // Check for attribute changes
     for (unsigned i = 0; i < numAttributes; ++i)
     {
@@ -186,6 +188,7 @@ void Component::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            changedAttributes.Set(i);
 
             // Mark the attribute dirty in all replication states that are tracking this component
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
@@ -205,6 +208,7 @@ void Component::PrepareNetworkUpdate()
         }
     }
 
+    UpdateNetworkPayloads(changedAttributes);
     networkUpdate_ = false;
 }
 
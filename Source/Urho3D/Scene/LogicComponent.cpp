@@ -23,12 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../IO/Log.h"
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-#include "../Physics/PhysicsEvents.h"
-#endif
 #include "../Scene/LogicComponent.h"
 #include "../Scene/Scene.h"
-#include "../Scene/SceneEvents.h"
 
 namespace Urho3D
 {
@@ -37,11 +33,15 @@ LogicComponent::LogicComponent(Context* context) :
     Component(context),
     updateEventMask_(USE_UPDATE | USE_POSTUPDATE | USE_FIXEDUPDATE | USE_FIXEDPOSTUPDATE),
     currentEventMask_(0),
-    delayedStartCalled_(false)
+    delayedStartCalled_(false),
+    threadSafeUpdate_(false)
 {
 }
 
-LogicComponent::~LogicComponent() = default;
+LogicComponent::~LogicComponent()
+{
+    RemoveUpdatePhases();
+}
 
 void LogicComponent::OnSetEnabled()
 {
@@ -73,6 +73,17 @@ void LogicComponent::SetUpdateEventMask(unsigned char mask)
     }
 }
 
+void LogicComponent::SetThreadSafeUpdate(bool enable)
+{
+    if (enable != threadSafeUpdate_)
+    {
+        // The scene keeps thread-safe components in separate buckets, so re-register
+        RemoveUpdatePhases();
+        threadSafeUpdate_ = enable;
+        UpdateEventSubscription();
+    }
+}
+
 void LogicComponent::OnNodeSet(Node* node)
 {
     if (node)
@@ -89,17 +100,12 @@ void LogicComponent::OnNodeSet(Node* node)
 
 void LogicComponent::OnSceneSet(Scene* scene)
 {
+    RemoveUpdatePhases();
+
     if (scene)
-        UpdateEventSubscription();
-    else
     {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-        UnsubscribeFromEvent(E_PHYSICSPRESTEP);
-        UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
-#endif
-        currentEventMask_ = 0;
+        updateScene_ = scene;
+        UpdateEventSubscription();
     }
 }
 
@@ -109,31 +115,17 @@ void LogicComponent::UpdateEventSubscription()
     if (!scene)
         return;
 
+    // Re-registering, for example after toggling thread-safe update, starts from no registered phases
+    if (!updateScene_)
+        updateScene_ = scene;
+
     bool enabled = IsEnabledEffective();
 
     bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
-    if (needUpdate && !(currentEventMask_ & USE_UPDATE))
-    {
-        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
-        currentEventMask_ |= USE_UPDATE;
-    }
-    else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
-    {
-        UnsubscribeFromEvent(scene, E_SCENEUPDATE);
-        currentEventMask_ &= ~USE_UPDATE;
-    }
+    SetUpdatePhase(LOGIC_UPDATE, needUpdate);
 
     bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
-    if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
-    {
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(LogicComponent, HandleScenePostUpdate));
-        currentEventMask_ |= USE_POSTUPDATE;
-    }
-    else if (!needPostUpdate && (currentEventMask_ & USE_POSTUPDATE))
-    {
-        UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
-        currentEventMask_ &= ~USE_POSTUPDATE;
-    }
+    SetUpdatePhase(LOGIC_POSTUPDATE, needPostUpdate);
 
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
     Component* world = GetFixedUpdateSource();
@@ -141,87 +133,90 @@ void LogicComponent::UpdateEventSubscription()
         return;
 
     bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE);
-    if (needFixedUpdate && !(currentEventMask_ & USE_FIXEDUPDATE))
-    {
-        SubscribeToEvent(world, E_PHYSICSPRESTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPreStep));
-        currentEventMask_ |= USE_FIXEDUPDATE;
-    }
-    else if (!needFixedUpdate && (currentEventMask_ & USE_FIXEDUPDATE))
-    {
-        UnsubscribeFromEvent(world, E_PHYSICSPRESTEP);
-        currentEventMask_ &= ~USE_FIXEDUPDATE;
-    }
+    SetUpdatePhase(LOGIC_FIXEDUPDATE, needFixedUpdate);
 
     bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE);
-    if (needFixedPostUpdate && !(currentEventMask_ & USE_FIXEDPOSTUPDATE))
+    SetUpdatePhase(LOGIC_FIXEDPOSTUPDATE, needFixedPostUpdate);
+#endif
+}
+
+void LogicComponent::SetUpdatePhase(LogicUpdatePhase phase, bool enable)
+{
+    Scene* scene = updateScene_;
+    if (!scene)
+        return;
+
+    auto phaseBit = (unsigned char)(1u << phase);
+    if (enable && !(currentEventMask_ & phaseBit))
     {
-        SubscribeToEvent(world, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPostStep));
-        currentEventMask_ |= USE_FIXEDPOSTUPDATE;
+        scene->AddLogicComponentUpdate(this, phase);
+        currentEventMask_ |= phaseBit;
     }
-    else if (!needFixedPostUpdate && (currentEventMask_ & USE_FIXEDPOSTUPDATE))
+    else if (!enable && (currentEventMask_ & phaseBit))
     {
-        UnsubscribeFromEvent(world, E_PHYSICSPOSTSTEP);
-        currentEventMask_ &= ~USE_FIXEDPOSTUPDATE;
+        scene->RemoveLogicComponentUpdate(this, phase);
+        currentEventMask_ &= ~phaseBit;
     }
-#endif
 }
 
-void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::RemoveUpdatePhases()
 {
-    using namespace SceneUpdate;
+    for (unsigned i = 0; i < MAX_LOGIC_UPDATE_PHASES; ++i)
+        SetUpdatePhase((LogicUpdatePhase)i, false);
 
+    currentEventMask_ = 0;
+    updateScene_.Reset();
+}
+
+bool LogicComponent::CheckDelayedStart()
+{
     // Execute user-defined delayed start function before first update
     if (!delayedStartCalled_)
     {
         DelayedStart();
         delayedStartCalled_ = true;
 
-        // If did not need actual update events, unsubscribe now
+        // If did not need actual update events, unregister now
         if (!(updateEventMask_ & USE_UPDATE))
         {
-            UnsubscribeFromEvent(GetScene(), E_SCENEUPDATE);
-            currentEventMask_ &= ~USE_UPDATE;
-            return;
+            SetUpdatePhase(LOGIC_UPDATE, false);
+            return false;
         }
     }
 
-    // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
+    return true;
 }
 
-void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::CallUpdate(LogicUpdatePhase phase, float timeStep)
 {
-    using namespace ScenePostUpdate;
-
-    // Execute user-defined post-update function
-    PostUpdate(eventData[P_TIMESTEP].GetFloat());
-}
-
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-
-void LogicComponent::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
-{
-    using namespace PhysicsPreStep;
-
-    // Execute user-defined delayed start function before first fixed update if not called yet
-    if (!delayedStartCalled_)
+    switch (phase)
     {
-        DelayedStart();
-        delayedStartCalled_ = true;
-    }
-
-    // Execute user-defined fixed update function
-    FixedUpdate(eventData[P_TIMESTEP].GetFloat());
-}
+    case LOGIC_UPDATE:
+        if (CheckDelayedStart())
+            Update(timeStep);
+        break;
+
+    case LOGIC_POSTUPDATE:
+        PostUpdate(timeStep);
+        break;
+
+    case LOGIC_FIXEDUPDATE:
+        // Execute user-defined delayed start function before first fixed update if not called yet
+        if (!delayedStartCalled_)
+        {
+            DelayedStart();
+            delayedStartCalled_ = true;
+        }
+        FixedUpdate(timeStep);
+        break;
 
-void LogicComponent::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
-{
-    using namespace PhysicsPostStep;
+    case LOGIC_FIXEDPOSTUPDATE:
+        FixedPostUpdate(timeStep);
+        break;
 
-    // Execute user-defined fixed post-update function
-    FixedPostUpdate(eventData[P_TIMESTEP].GetFloat());
+    default:
+        break;
+    }
 }
 
-#endif
-
 }
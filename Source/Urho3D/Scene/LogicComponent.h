@@ -36,11 +36,23 @@ static const unsigned char USE_FIXEDUPDATE = 0x4;
 /// Bitmask for using the physics post-update event.
 static const unsigned char USE_FIXEDPOSTUPDATE = 0x8;
 
+/// Logic component update phase. The phase's bit in the update event mask is 1 << phase.
+enum LogicUpdatePhase
+{
+    LOGIC_UPDATE = 0,
+    LOGIC_POSTUPDATE,
+    LOGIC_FIXEDUPDATE,
+    LOGIC_FIXEDPOSTUPDATE,
+    MAX_LOGIC_UPDATE_PHASES
+};
+
 /// Helper base class for user-defined game logic components that hooks up to update events and forwards them to virtual functions similar to ScriptInstance class.
 class URHO3D_API LogicComponent : public Component
 {
     URHO3D_OBJECT(LogicComponent, Component);
 
+    friend class Scene;
+
     /// Construct.
     explicit LogicComponent(Context* context);
     /// Destruct.
@@ -70,9 +82,15 @@ class URHO3D_API LogicComponent : public Component
     /// Set what update events should be subscribed to. Use this for optimization: by default all are in use. Note that this is not an attribute and is not saved or network-serialized, therefore it should always be called eg. in the subclass constructor.
     void SetUpdateEventMask(unsigned char mask);
 
+    /// Set whether the update functions are thread-safe, in which case the scene may call them for components of the same type in parallel from worker threads. A thread-safe update may only modify the component and its own node, and must not create or remove nodes or components or send events. Like the update event mask, should be called eg. in the subclass constructor.
+    void SetThreadSafeUpdate(bool enable);
+
     /// Return what update events are subscribed to.
     unsigned char GetUpdateEventMask() const { return updateEventMask_; }
 
+    /// Return whether the update functions are thread-safe.
+    bool IsThreadSafeUpdate() const { return threadSafeUpdate_; }
+
     /// Return whether the DelayedStart() function has been called.
     bool IsDelayedStartCalled() const { return delayedStartCalled_; }
 
@@ -83,24 +101,31 @@ protected:
     void OnSceneSet(Scene* scene) override;
 
 private:
-    /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
+    /// Register/unregister to the scene's update phases based on current enabled state and update event mask.
     void UpdateEventSubscription();
-    /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
-    /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-    /// Handle physics pre-step event.
-    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
-    /// Handle physics post-step event.
-    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
-#endif
+    /// Register or unregister to an update phase of the scene.
+    void SetUpdatePhase(LogicUpdatePhase phase, bool enable);
+    /// Unregister from all update phases of the scene.
+    void RemoveUpdatePhases();
+    /// Call the delayed start function if not called yet. Return false if updates are not wanted after it.
+    bool CheckDelayedStart();
+    /// Call the update function of a phase. Called by the scene.
+    void CallUpdate(LogicUpdatePhase phase, float timeStep);
+
+    /// Scene the component is registered to for update phases.
+    WeakPtr<Scene> updateScene_;
+    /// Update phase bucket indices in the scene.
+    unsigned updateBuckets_[MAX_LOGIC_UPDATE_PHASES];
+    /// Indices within the update phase buckets in the scene.
+    unsigned updateSlots_[MAX_LOGIC_UPDATE_PHASES];
     /// Requested event subscription mask.
     unsigned char updateEventMask_;
     /// Current event subscription mask.
     unsigned char currentEventMask_;
     /// Flag for delayed start.
     bool delayedStartCalled_;
+    /// Thread-safe update flag.
+    bool threadSafeUpdate_;
 };
 
 }
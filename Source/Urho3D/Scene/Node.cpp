@@ -1705,6 +1705,8 @@ void Node::PrepareNetworkUpdate()
     const Vector<AttributeInfo>* attributes = networkState_->attributes_;
     unsigned numAttributes = attributes->Size();
 
+    DirtyBits changedAttributes;
+
     // Check for attribute changes
     for (unsigned i = 0; i < numAttributes; ++i)
     {
@@ -1718,6 +1720,7 @@ void Node::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            changedAttributes.Set(i);
 
             // Mark the attribute dirty in all replication states that are tracking this node
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
@@ -1760,6 +1763,7 @@ void Node::PrepareNetworkUpdate()
         }
     }
 
+    UpdateNetworkPayloads(changedAttributes);
     networkUpdate_ = false;
 }
 
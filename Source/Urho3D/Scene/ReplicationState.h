@@ -26,6 +26,7 @@
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
 #include "../Container/Ptr.h"
+#include "../IO/VectorBuffer.h"
 #include "../Math/StringHash.h"
 
 #include <cstring>
@@ -62,6 +63,14 @@ struct URHO3D_API DirtyBits
         memcpy(data_, bits.data_, MAX_NETWORK_ATTRIBUTES / 8);
     }
 
+    /// Assign from another set of bits.
+    DirtyBits& operator =(const DirtyBits& rhs)
+    {
+        count_ = rhs.count_;
+        memcpy(data_, rhs.data_, MAX_NETWORK_ATTRIBUTES / 8);
+        return *this;
+    }
+
     /// Set a bit.
     void Set(unsigned index)
     {
@@ -112,6 +121,12 @@ struct URHO3D_API DirtyBits
             return false;
     }
 
+    /// Test for equality with another set of bits.
+    bool operator ==(const DirtyBits& rhs) const { return count_ == rhs.count_ && !memcmp(data_, rhs.data_, MAX_NETWORK_ATTRIBUTES / 8); }
+
+    /// Test for inequality with another set of bits.
+    bool operator !=(const DirtyBits& rhs) const { return !(*this == rhs); }
+
     /// Return number of set bits.
     unsigned Count() const { return count_; }
 
@@ -126,7 +141,8 @@ struct URHO3D_API NetworkState
 {
     /// Construct with defaults.
     NetworkState() :
-        interceptMask_(0)
+        interceptMask_(0),
+        hasLatestDataPayload_(false)
     {
     }
 
@@ -142,6 +158,14 @@ struct URHO3D_API NetworkState
     VariantMap previousVars_;
     /// Bitmask for intercepting network messages. Used on the client only.
     unsigned long long interceptMask_;
+    /// Attributes of the shared delta update payload. Empty if there is none.
+    DirtyBits deltaPayloadBits_;
+    /// Delta update data after the timestamp, written once for all connections on the last network frame that changed attributes.
+    VectorBuffer deltaPayload_;
+    /// Latest data update data after the timestamp, written once for all connections.
+    VectorBuffer latestDataPayload_;
+    /// Whether the latest data update payload is valid.
+    bool hasLatestDataPayload_;
 };
 
 /// Base class for per-user network replication states.
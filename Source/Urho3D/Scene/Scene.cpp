@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/FrameAllocator.h"
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
@@ -29,6 +30,9 @@
 #include "../IO/File.h"
 #include "../IO/Log.h"
 #include "../IO/PackageFile.h"
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+#include "../Physics/PhysicsEvents.h"
+#endif
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Resource/XMLFile.h"
@@ -54,6 +58,10 @@ const char* SUBSYSTEM_CATEGORY = "Subsystem";
 
 static const float DEFAULT_SMOOTHING_CONSTANT = 50.0f;
 static const float DEFAULT_SNAP_THRESHOLD = 5.0f;
+/// Minimum number of thread-safe logic components of a type for a parallel update.
+static const unsigned MIN_PARALLEL_LOGIC_COMPONENTS = 64;
+/// Logic components per parallel update work range.
+static const unsigned LOGIC_COMPONENT_UPDATE_GRAIN = 32;
 
 Scene::Scene(Context* context) :
     Node(context),
@@ -71,6 +79,9 @@ Scene::Scene(Context* context) :
     asyncLoading_(false),
     threadedUpdate_(false)
 {
+    for (unsigned i = 0; i < MAX_LOGIC_UPDATE_PHASES; ++i)
+        logicComponentUpdateDepth_[i] = 0;
+
     // Assign an ID to self so that nodes can refer to this node as a parent
     SetID(GetFreeNodeID(REPLICATED));
     NodeAdded(this);
@@ -757,6 +768,42 @@ const String& Scene::GetVarName(StringHash hash) const
     return i != varNames_.End() ? i->second_ : String::EMPTY;
 }
 
+void SceneUpdateEvent::ToVariantMap(VariantMap& eventData) const
+{
+    using namespace SceneUpdate;
+
+    eventData[P_SCENE] = scene_;
+    eventData[P_TIMESTEP] = timeStep_;
+}
+
+void SceneUpdateEvent::FromVariantMap(const VariantMap& eventData)
+{
+    using namespace SceneUpdate;
+
+    const Variant* scene = eventData[P_SCENE];
+    const Variant* timeStep = eventData[P_TIMESTEP];
+    scene_ = scene ? static_cast<Scene*>(scene->GetPtr()) : nullptr;
+    timeStep_ = timeStep ? timeStep->GetFloat() : 0.0f;
+}
+
+void UpdateSmoothingEvent::ToVariantMap(VariantMap& eventData) const
+{
+    using namespace UpdateSmoothing;
+
+    eventData[P_CONSTANT] = constant_;
+    eventData[P_SQUAREDSNAPTHRESHOLD] = squaredSnapThreshold_;
+}
+
+void UpdateSmoothingEvent::FromVariantMap(const VariantMap& eventData)
+{
+    using namespace UpdateSmoothing;
+
+    const Variant* constant = eventData[P_CONSTANT];
+    const Variant* squaredSnapThreshold = eventData[P_SQUAREDSNAPTHRESHOLD];
+    constant_ = constant ? constant->GetFloat() : 0.0f;
+    squaredSnapThreshold_ = squaredSnapThreshold ? squaredSnapThreshold->GetFloat() : 0.0f;
+}
+
 void Scene::Update(float timeStep)
 {
     if (asyncLoading_)
@@ -773,13 +820,18 @@ void Scene::Update(float timeStep)
 
     using namespace SceneUpdate;
 
+    // Update variable timestep logic. Logic components are called directly, outside of event handling, so any events they
+    // send reuse the preallocated event data map; fill it only afterward
+    UpdateLogicComponents(LOGIC_UPDATE, timeStep);
+    SceneUpdateEvent sceneUpdate;
+    sceneUpdate.scene_ = this;
+    sceneUpdate.timeStep_ = timeStep;
+    SendTypedEvent(E_SCENEUPDATE, sceneUpdate);
+
     VariantMap& eventData = GetEventDataMap();
     eventData[P_SCENE] = this;
     eventData[P_TIMESTEP] = timeStep;
 
-    // Update variable timestep logic
-    SendEvent(E_SCENEUPDATE, eventData);
-
     // Update scene attribute animation.
     SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
 
@@ -790,18 +842,18 @@ void Scene::Update(float timeStep)
     {
         URHO3D_PROFILE(UpdateSmoothing);
 
-        float constant = 1.0f - Clamp(powf(2.0f, -timeStep * smoothingConstant_), 0.0f, 1.0f);
-        float squaredSnapThreshold = snapThreshold_ * snapThreshold_;
-
-        using namespace UpdateSmoothing;
-
-        smoothingData_[P_CONSTANT] = constant;
-        smoothingData_[P_SQUAREDSNAPTHRESHOLD] = squaredSnapThreshold;
-        SendEvent(E_UPDATESMOOTHING, smoothingData_);
+        UpdateSmoothingEvent smoothing;
+        smoothing.constant_ = 1.0f - Clamp(powf(2.0f, -timeStep * smoothingConstant_), 0.0f, 1.0f);
+        smoothing.squaredSnapThreshold_ = snapThreshold_ * snapThreshold_;
+        SendTypedEvent(E_UPDATESMOOTHING, smoothing);
     }
 
     // Post-update variable timestep logic
-    SendEvent(E_SCENEPOSTUPDATE, eventData);
+    UpdateLogicComponents(LOGIC_POSTUPDATE, timeStep);
+    VariantMap& postUpdateData = GetEventDataMap();
+    postUpdateData[P_SCENE] = this;
+    postUpdateData[P_TIMESTEP] = timeStep;
+    SendEvent(E_SCENEPOSTUPDATE, postUpdateData);
 
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
@@ -839,6 +891,166 @@ void Scene::DelayedMarkedDirty(Component* component)
     delayedDirtyComponents_.Push(component);
 }
 
+void Scene::AddLogicComponentUpdate(LogicComponent* component, LogicUpdatePhase phase)
+{
+    Vector<LogicComponentBucket>& buckets = logicComponentUpdates_[phase];
+    StringHash type = component->GetType();
+    bool threadSafe = component->IsThreadSafeUpdate();
+
+    unsigned bucketIndex = 0;
+    while (bucketIndex < buckets.Size() && (buckets[bucketIndex].type_ != type || buckets[bucketIndex].threadSafe_ != threadSafe))
+        ++bucketIndex;
+    if (bucketIndex == buckets.Size())
+    {
+        buckets.Resize(bucketIndex + 1);
+        buckets[bucketIndex].type_ = type;
+        buckets[bucketIndex].threadSafe_ = threadSafe;
+    }
+
+    PODVector<LogicComponent*>& components = buckets[bucketIndex].components_;
+    component->updateBuckets_[phase] = bucketIndex;
+    component->updateSlots_[phase] = components.Size();
+    components.Push(component);
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    if (phase == LOGIC_FIXEDUPDATE || phase == LOGIC_FIXEDPOSTUPDATE)
+    {
+        Component* world = component->GetFixedUpdateSource();
+        if (world && world != fixedUpdateSource_.Get())
+        {
+            if (fixedUpdateSource_)
+                UnsubscribeFromEvents(fixedUpdateSource_.Get());
+            fixedUpdateSource_ = world;
+            SubscribeToEvent(world, E_PHYSICSPRESTEP, URHO3D_HANDLER(Scene, HandlePhysicsPreStep));
+            SubscribeToEvent(world, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(Scene, HandlePhysicsPostStep));
+        }
+    }
+#endif
+}
+
+void Scene::RemoveLogicComponentUpdate(LogicComponent* component, LogicUpdatePhase phase)
+{
+    LogicComponentBucket& bucket = logicComponentUpdates_[phase][component->updateBuckets_[phase]];
+    PODVector<LogicComponent*>& components = bucket.components_;
+    unsigned slot = component->updateSlots_[phase];
+    assert(components[slot] == component);
+
+    if (logicComponentUpdateDepth_[phase])
+    {
+        // Leave a hole during the update, to be removed afterward
+        components[slot] = nullptr;
+        bucket.dirty_ = true;
+    }
+    else
+    {
+        LogicComponent* last = components.Back();
+        components[slot] = last;
+        last->updateSlots_[phase] = slot;
+        components.Pop();
+    }
+}
+
+void Scene::UpdateLogicComponents(LogicUpdatePhase phase, float timeStep)
+{
+    Vector<LogicComponentBucket>& buckets = logicComponentUpdates_[phase];
+    if (buckets.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateLogicComponents);
+
+    // Components registered during the update will be updated on the next time, so take the bucket sizes up front, as a
+    // component may move to a later bucket. Note that the bucket vector may also grow during the update, so it has to be
+    // indexed each time
+    ++logicComponentUpdateDepth_[phase];
+
+    const unsigned numBuckets = buckets.Size();
+    FramePODVector<unsigned> bucketSizes(numBuckets);
+    for (unsigned i = 0; i < numBuckets; ++i)
+        bucketSizes.Push(buckets[i].components_.Size());
+
+    for (unsigned i = 0; i < numBuckets; ++i)
+    {
+        const unsigned numComponents = bucketSizes[i];
+
+        if (buckets[i].threadSafe_ && numComponents >= MIN_PARALLEL_LOGIC_COMPONENTS && !threadedUpdate_)
+        {
+            // Call the delayed start functions from the main thread first, as they are not required to be thread-safe
+            if (phase == LOGIC_UPDATE || phase == LOGIC_FIXEDUPDATE)
+            {
+                for (unsigned j = 0; j < numComponents; ++j)
+                {
+                    LogicComponent* component = buckets[i].components_[j];
+                    if (component && !component->delayedStartCalled_)
+                    {
+                        if (phase == LOGIC_FIXEDUPDATE)
+                        {
+                            component->DelayedStart();
+                            component->delayedStartCalled_ = true;
+                        }
+                        else
+                            component->CheckDelayedStart();
+                    }
+                }
+            }
+
+            BeginThreadedUpdate();
+
+            LogicComponent** components = buckets[i].components_.Buffer();
+            GetSubsystem<WorkQueue>()->ParallelFor(numComponents, LOGIC_COMPONENT_UPDATE_GRAIN,
+                [components, phase, timeStep](unsigned begin, unsigned end, unsigned)
+            {
+                for (unsigned j = begin; j < end; ++j)
+                {
+                    LogicComponent* component = components[j];
+                    if (component && !component->GetBlockEvents())
+                        component->CallUpdate(phase, timeStep);
+                }
+            });
+
+            EndThreadedUpdate();
+        }
+        else
+        {
+            for (unsigned j = 0; j < numComponents; ++j)
+            {
+                LogicComponent* component = buckets[i].components_[j];
+                if (component && !component->GetBlockEvents())
+                    component->CallUpdate(phase, timeStep);
+            }
+        }
+    }
+
+    if (!--logicComponentUpdateDepth_[phase])
+        CleanupLogicComponentUpdates(phase);
+}
+
+void Scene::CleanupLogicComponentUpdates(LogicUpdatePhase phase)
+{
+    Vector<LogicComponentBucket>& buckets = logicComponentUpdates_[phase];
+    for (unsigned i = 0; i < buckets.Size(); ++i)
+    {
+        LogicComponentBucket& bucket = buckets[i];
+        if (!bucket.dirty_)
+            continue;
+
+        // Compact while keeping the update order
+        PODVector<LogicComponent*>& components = bucket.components_;
+        unsigned dest = 0;
+        for (unsigned j = 0; j < components.Size(); ++j)
+        {
+            LogicComponent* component = components[j];
+            if (component)
+            {
+                components[dest] = component;
+                component->updateSlots_[phase] = dest;
+                ++dest;
+            }
+        }
+        components.Resize(dest);
+        bucket.dirty_ = false;
+    }
+}
+
 unsigned Scene::GetFreeNodeID(CreateMode mode)
 {
     if (mode == REPLICATED)
@@ -1106,6 +1318,13 @@ void Scene::PrepareNetworkUpdate()
 
     networkUpdateNodes_.Clear();
     networkUpdateComponents_.Clear();
+
+    // Refresh the world transforms of moved nodes now, as the connections only read them while sending their updates in parallel
+    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    {
+        if (i->second_->IsDirty())
+            i->second_->GetWorldTransform();
+    }
 }
 
 void Scene::CleanupConnection(Connection* connection)
@@ -1170,6 +1389,20 @@ void Scene::HandleUpdate(StringHash eventType, VariantMap& eventData)
     Update(eventData[P_TIMESTEP].GetFloat());
 }
 
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+void Scene::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPreStep;
+    UpdateLogicComponents(LOGIC_FIXEDUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void Scene::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPostStep;
+    UpdateLogicComponents(LOGIC_FIXEDPOSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+#endif
+
 void Scene::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
 {
     using namespace ResourceBackgroundLoaded;
@@ -26,6 +26,7 @@
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
+#include "../Scene/LogicComponent.h"
 #include "../Scene/Node.h"
 #include "../Scene/SceneResolver.h"
 
@@ -51,6 +52,26 @@ enum LoadMode
     LOAD_SCENE_AND_RESOURCES
 };
 
+/// Logic components of the same type and thread safety that are registered for an update phase.
+struct LogicComponentBucket
+{
+    /// Construct.
+    LogicComponentBucket() :
+        threadSafe_(false),
+        dirty_(false)
+    {
+    }
+
+    /// Component type.
+    StringHash type_;
+    /// Components. May contain holes when removed during the update.
+    PODVector<LogicComponent*> components_;
+    /// Thread-safe update flag.
+    bool threadSafe_;
+    /// Cleanup required flag.
+    bool dirty_;
+};
+
 /// Asynchronous loading progress of a scene.
 struct AsyncProgress
 {
@@ -219,6 +240,12 @@ public:
     void EndThreadedUpdate();
     /// Add a component to the delayed dirty notify queue. Is thread-safe.
     void DelayedMarkedDirty(Component* component);
+    /// Register a logic component for an update phase. Called by LogicComponent.
+    void AddLogicComponentUpdate(LogicComponent* component, LogicUpdatePhase phase);
+    /// Unregister a logic component from an update phase. Called by LogicComponent.
+    void RemoveLogicComponentUpdate(LogicComponent* component, LogicUpdatePhase phase);
+    /// Call the update functions of the logic components registered for an update phase. Components of the same type are called in one batch, in parallel if they are thread-safe.
+    void UpdateLogicComponents(LogicUpdatePhase phase, float timeStep);
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
@@ -247,7 +274,7 @@ public:
     void SetVarNamesAttr(const String& value);
     /// Return node user variable reverse mappings.
     String GetVarNamesAttr() const;
-    /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
+    /// Prepare network update by comparing attributes and marking replication states dirty as necessary. Also refresh the world transforms of the replicated nodes.
     void PrepareNetworkUpdate();
     /// Clean up all references to a network connection that is about to be removed.
     void CleanupConnection(Connection* connection);
@@ -257,12 +284,22 @@ public:
     void MarkNetworkUpdate(Component* component);
     /// Mark a node dirty in scene replication states. The node does not need to have own replication state yet.
     void MarkReplicationDirty(Node* node);
+    /// Return ID's of the nodes marked for attribute check on the next network update.
+    const HashSet<unsigned>& GetNetworkUpdateNodes() const { return networkUpdateNodes_; }
 
 private:
     /// Handle the logic update event to update the scene, if active.
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
     /// Handle a background loaded resource completing.
     void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    /// Handle the physics pre-step event to call logic component fixed updates.
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    /// Handle the physics post-step event to call logic component fixed post-updates.
+    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+#endif
+    /// Remove holes left by logic components unregistered during the update of a phase.
+    void CleanupLogicComponentUpdates(LogicUpdatePhase phase);
     /// Update asynchronous loading.
     void UpdateAsyncLoading();
     /// Finish asynchronous loading.
@@ -306,8 +343,12 @@ private:
     PODVector<Component*> delayedDirtyComponents_;
     /// Mutex for the delayed dirty notification queue.
     Mutex sceneMutex_;
-    /// Preallocated event data map for smoothing update events.
-    VariantMap smoothingData_;
+    /// Logic components registered for each update phase, bucketed by type.
+    Vector<LogicComponentBucket> logicComponentUpdates_[MAX_LOGIC_UPDATE_PHASES];
+    /// Update in progress counter for each logic component update phase.
+    unsigned logicComponentUpdateDepth_[MAX_LOGIC_UPDATE_PHASES];
+    /// Physics world whose steps call the logic component fixed updates.
+    WeakPtr<Component> fixedUpdateSource_;
     /// Next free non-local node ID.
     unsigned replicatedNodeID_;
     /// Next free non-local component ID.
@@ -27,6 +27,8 @@
 namespace Urho3D
 {
 
+class Scene;
+
 /// Variable timestep scene update.
 URHO3D_EVENT(E_SCENEUPDATE, SceneUpdate)
 {
@@ -212,4 +214,32 @@ URHO3D_EVENT(E_INTERCEPTNETWORKUPDATE, InterceptNetworkUpdate)
     URHO3D_PARAM(P_VALUE, Value);                  // Variant
 }
 
+/// Strongly typed data of the E_SCENEUPDATE event.
+struct URHO3D_API SceneUpdateEvent
+{
+    /// Convert to event data map.
+    void ToVariantMap(VariantMap& eventData) const;
+    /// Convert from event data map.
+    void FromVariantMap(const VariantMap& eventData);
+
+    /// Scene.
+    Scene* scene_;
+    /// Timestep.
+    float timeStep_;
+};
+
+/// Strongly typed data of the E_UPDATESMOOTHING event.
+struct URHO3D_API UpdateSmoothingEvent
+{
+    /// Convert to event data map.
+    void ToVariantMap(VariantMap& eventData) const;
+    /// Convert from event data map.
+    void FromVariantMap(const VariantMap& eventData);
+
+    /// Smoothing constant.
+    float constant_;
+    /// Squared snap threshold.
+    float squaredSnapThreshold_;
+};
+
 }
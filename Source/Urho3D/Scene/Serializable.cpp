@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../IO/BitStream.h"
 #include "../IO/Deserializer.h"
 #include "../IO/Log.h"
 #include "../IO/Serializer.h"
@@ -37,6 +38,106 @@
 namespace Urho3D
 {
 
+static void WriteNetworkValue(BitWriter& dest, const AttributeInfo& attr, const Variant& value)
+{
+    if (!attr.IsQuantized())
+    {
+        dest.WriteVariantData(value);
+        return;
+    }
+
+    float minValue = attr.quantizeMin_;
+    float maxValue = attr.quantizeMax_;
+    unsigned bits = attr.quantizeBits_;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        dest.WriteQuantizedFloat(value.GetFloat(), minValue, maxValue, bits);
+        break;
+
+    case VAR_VECTOR2:
+        {
+            const Vector2& vector = value.GetVector2();
+            dest.WriteQuantizedFloat(vector.x_, minValue, maxValue, bits);
+            dest.WriteQuantizedFloat(vector.y_, minValue, maxValue, bits);
+        }
+        break;
+
+    case VAR_VECTOR3:
+        {
+            const Vector3& vector = value.GetVector3();
+            dest.WriteQuantizedFloat(vector.x_, minValue, maxValue, bits);
+            dest.WriteQuantizedFloat(vector.y_, minValue, maxValue, bits);
+            dest.WriteQuantizedFloat(vector.z_, minValue, maxValue, bits);
+        }
+        break;
+
+    case VAR_VECTOR4:
+        {
+            const Vector4& vector = value.GetVector4();
+            dest.WriteQuantizedFloat(vector.x_, minValue, maxValue, bits);
+            dest.WriteQuantizedFloat(vector.y_, minValue, maxValue, bits);
+            dest.WriteQuantizedFloat(vector.z_, minValue, maxValue, bits);
+            dest.WriteQuantizedFloat(vector.w_, minValue, maxValue, bits);
+        }
+        break;
+
+    case VAR_QUATERNION:
+        dest.WriteQuantizedQuaternion(value.GetQuaternion(), bits);
+        break;
+
+    default:
+        break;
+    }
+}
+
+static Variant ReadNetworkValue(BitReader& source, const AttributeInfo& attr)
+{
+    if (!attr.IsQuantized())
+        return source.ReadVariant(attr.type_);
+
+    float minValue = attr.quantizeMin_;
+    float maxValue = attr.quantizeMax_;
+    unsigned bits = attr.quantizeBits_;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        return source.ReadQuantizedFloat(minValue, maxValue, bits);
+
+    case VAR_VECTOR2:
+        {
+            float x = source.ReadQuantizedFloat(minValue, maxValue, bits);
+            float y = source.ReadQuantizedFloat(minValue, maxValue, bits);
+            return Vector2(x, y);
+        }
+
+    case VAR_VECTOR3:
+        {
+            float x = source.ReadQuantizedFloat(minValue, maxValue, bits);
+            float y = source.ReadQuantizedFloat(minValue, maxValue, bits);
+            float z = source.ReadQuantizedFloat(minValue, maxValue, bits);
+            return Vector3(x, y, z);
+        }
+
+    case VAR_VECTOR4:
+        {
+            float x = source.ReadQuantizedFloat(minValue, maxValue, bits);
+            float y = source.ReadQuantizedFloat(minValue, maxValue, bits);
+            float z = source.ReadQuantizedFloat(minValue, maxValue, bits);
+            float w = source.ReadQuantizedFloat(minValue, maxValue, bits);
+            return Vector4(x, y, z, w);
+        }
+
+    case VAR_QUATERNION:
+        return source.ReadQuantizedQuaternion(bits);
+
+    default:
+        return Variant::EMPTY;
+    }
+}
+
 static unsigned RemapAttributeIndex(const Vector<AttributeInfo>* attributes, const AttributeInfo& netAttr, unsigned netAttrIndex)
 {
     if (!attributes)
@@ -761,10 +862,11 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
     dest.WriteUByte(timeStamp);
     dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
 
+    BitWriter writer(dest);
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(writer, attributes->At(i), networkState_->currentValues_[i]);
     }
 }
 
@@ -785,12 +887,21 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
     // First write the change bitfield, then attribute data for changed attributes
     // Note: the attribute bits should not contain LATESTDATA attributes
     dest.WriteUByte(timeStamp);
+
+    // Usually the connection is up to date and the changes are the same as written for all connections
+    if (attributeBits.Count() && attributeBits == networkState_->deltaPayloadBits_)
+    {
+        dest.Write(networkState_->deltaPayload_.GetData(), networkState_->deltaPayload_.GetSize());
+        return;
+    }
+
     dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
 
+    BitWriter writer(dest);
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(writer, attributes->At(i), networkState_->currentValues_[i]);
     }
 }
 
@@ -810,10 +921,77 @@ void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeSta
 
     dest.WriteUByte(timeStamp);
 
+    if (networkState_->hasLatestDataPayload_)
+    {
+        dest.Write(networkState_->latestDataPayload_.GetData(), networkState_->latestDataPayload_.GetSize());
+        return;
+    }
+
+    BitWriter writer(dest);
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributes->At(i).mode_ & AM_LATESTDATA)
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(writer, attributes->At(i), networkState_->currentValues_[i]);
+    }
+}
+
+void Serializable::UpdateNetworkPayloads(const DirtyBits& changedAttributes)
+{
+    if (!networkState_ || !changedAttributes.Count())
+        return;
+
+    // Unchanged attributes keep the payloads valid. Otherwise rewrite them now, as connections may process them in parallel
+    // and must not write shared state
+    if (networkState_->replicationStates_.Empty())
+    {
+        networkState_->deltaPayloadBits_.ClearAll();
+        networkState_->hasLatestDataPayload_ = false;
+        return;
+    }
+
+    const Vector<AttributeInfo>* attributes = networkState_->attributes_;
+    unsigned numAttributes = attributes->Size();
+    DirtyBits deltaBits;
+    bool latestDataChanged = false;
+
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        if (changedAttributes.IsSet(i))
+        {
+            if (attributes->At(i).mode_ & AM_LATESTDATA)
+                latestDataChanged = true;
+            else
+                deltaBits.Set(i);
+        }
+    }
+
+    if (deltaBits.Count())
+    {
+        VectorBuffer& payload = networkState_->deltaPayload_;
+        payload.Clear();
+        payload.Write(deltaBits.data_, (numAttributes + 7) >> 3);
+
+        BitWriter writer(payload);
+        for (unsigned i = 0; i < numAttributes; ++i)
+        {
+            if (deltaBits.IsSet(i))
+                WriteNetworkValue(writer, attributes->At(i), networkState_->currentValues_[i]);
+        }
+        networkState_->deltaPayloadBits_ = deltaBits;
+    }
+
+    if (latestDataChanged)
+    {
+        VectorBuffer& payload = networkState_->latestDataPayload_;
+        payload.Clear();
+
+        BitWriter writer(payload);
+        for (unsigned i = 0; i < numAttributes; ++i)
+        {
+            if (attributes->At(i).mode_ & AM_LATESTDATA)
+                WriteNetworkValue(writer, attributes->At(i), networkState_->currentValues_[i]);
+        }
+        networkState_->hasLatestDataPayload_ = true;
     }
 }
 
@@ -831,14 +1009,15 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
     unsigned char timeStamp = source.ReadUByte();
     source.Read(attributeBits.data_, (numAttributes + 7) >> 3);
 
-    for (unsigned i = 0; i < numAttributes && !source.IsEof(); ++i)
+    BitReader reader(source);
+    for (unsigned i = 0; i < numAttributes && !reader.IsEof(); ++i)
     {
         if (attributeBits.IsSet(i))
         {
             const AttributeInfo& attr = attributes->At(i);
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                OnSetAttribute(attr, ReadNetworkValue(reader, attr));
                 changed = true;
             }
             else
@@ -850,7 +1029,7 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
                 eventData[P_TIMESTAMP] = (unsigned)timeStamp;
                 eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
                 eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
+                eventData[P_VALUE] = ReadNetworkValue(reader, attr);
                 SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
             }
         }
@@ -871,14 +1050,15 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
     unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
     unsigned char timeStamp = source.ReadUByte();
 
-    for (unsigned i = 0; i < numAttributes && !source.IsEof(); ++i)
+    BitReader reader(source);
+    for (unsigned i = 0; i < numAttributes && !reader.IsEof(); ++i)
     {
         const AttributeInfo& attr = attributes->At(i);
         if (attr.mode_ & AM_LATESTDATA)
         {
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                OnSetAttribute(attr, ReadNetworkValue(reader, attr));
                 changed = true;
             }
             else
@@ -890,7 +1070,7 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
                 eventData[P_TIMESTAMP] = (unsigned)timeStamp;
                 eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
                 eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
+                eventData[P_VALUE] = ReadNetworkValue(reader, attr);
                 SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
             }
         }
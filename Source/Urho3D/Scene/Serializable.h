@@ -103,6 +103,8 @@ public:
     void WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp);
     /// Write a latest data network update.
     void WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp);
+    /// Write the delta and latest data updates of changed network attributes once for all connections, or invalidate them if no connection is replicating the object. Called by PrepareNetworkUpdate().
+    void UpdateNetworkPayloads(const DirtyBits& changedAttributes);
     /// Read and apply a network delta update. Return true if attributes were changed.
     bool ReadDeltaUpdate(Deserializer& source);
     /// Read and apply a network latest data update. Return true if attributes were changed.
@@ -103,6 +103,8 @@ public:
 
     /// Return UI rendering batches.
     void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor) override;
+    /// Return whether the batches can be cached. Never, as the hotspot offset depends on the current shape.
+    bool IsBatchCacheable() override { return false; }
 
     /// Define a shape.
     void DefineShape(const String& shape, Image* image, const IntRect& imageRect, const IntVector2& hotSpot);
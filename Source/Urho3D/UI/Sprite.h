@@ -47,6 +47,8 @@ public:
     const IntVector2& GetScreenPosition() const override;
     /// Return UI rendering batches.
     void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor) override;
+    /// Return whether the batches can be cached. Never, as the batches depend on the transforms of parent sprites.
+    bool IsBatchCacheable() override { return false; }
     /// React to position change.
     void OnPositionSet(const IntVector2& newPosition) override;
     /// Convert screen coordinates to element coordinates.
@@ -112,12 +112,14 @@ UI::UI(Context* context) :
     useScreenKeyboard_(false),
 #endif
     useMutableGlyphs_(false),
+    useBatchCache_(true),
     forceAutoHint_(false),
     fontHintLevel_(FONT_HINT_LEVEL_NORMAL),
     fontSubpixelThreshold_(12),
     fontOversampling_(2),
     uiRendered_(false),
     nonModalBatchSize_(0),
+    numRebuiltElements_(0),
     dragElementsCount_(0),
     dragConfirmedCount_(0),
     uiScale_(1.0f),
@@ -415,6 +417,8 @@ void UI::RenderUpdate()
     // If the OS cursor is visible, do not render the UI's own cursor
     bool osCursorVisible = GetSubsystem<Input>()->IsMouseVisible();
 
+    numRebuiltElements_ = 0;
+
     // Get rendering batches from the non-modal UI elements
     batches_.Clear();
     vertexData_.Clear();
@@ -689,6 +693,11 @@ void UI::SetUseMutableGlyphs(bool enable)
     }
 }
 
+void UI::SetUseBatchCache(bool enable)
+{
+    useBatchCache_ = enable;
+}
+
 void UI::SetForceAutoHint(bool enable)
 {
     if (enable != forceAutoHint_)
@@ -1109,7 +1118,7 @@ void UI::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, U
             while (j != children.End() && (*j)->GetPriority() == currentPriority)
             {
                 if ((*j)->IsWithinScissor(currentScissor) && (*j) != cursor_)
-                    (*j)->GetBatches(batches, vertexData, currentScissor);
+                    GetElementBatches(batches, vertexData, *j, currentScissor);
                 ++j;
             }
             // Now recurse into the children
@@ -1129,7 +1138,7 @@ void UI::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, U
             if ((*i) != cursor_)
             {
                 if ((*i)->IsWithinScissor(currentScissor))
-                    (*i)->GetBatches(batches, vertexData, currentScissor);
+                    GetElementBatches(batches, vertexData, *i, currentScissor);
                 if ((*i)->IsVisible())
                     GetBatches(batches, vertexData, *i, currentScissor);
             }
@@ -1138,6 +1147,18 @@ void UI::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, U
     }
 }
 
+void UI::GetElementBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, UIElement* element,
+    const IntRect& currentScissor)
+{
+    if (!useBatchCache_)
+    {
+        element->GetBatches(batches, vertexData, currentScissor);
+        ++numRebuiltElements_;
+    }
+    else if (element->GetCachedBatches(batches, vertexData, currentScissor))
+        ++numRebuiltElements_;
+}
+
 void UI::GetElementAt(UIElement*& result, UIElement* current, const IntVector2& position, bool enabledOnly)
 {
     if (!current)
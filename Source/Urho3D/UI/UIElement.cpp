@@ -156,6 +156,14 @@ void UIElement::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Tags", StringVector, tags_, Variant::emptyStringVector, AM_FILE);
 }
 
+void UIElement::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
+{
+    Animatable::OnSetAttribute(attr, src);
+
+    // Attributes may be written directly to member variables without going through the setters
+    MarkBatchesDirty();
+}
+
 void UIElement::ApplyAttributes()
 {
     colorGradient_ = false;
@@ -821,6 +829,7 @@ void UIElement::SetClipBorder(const IntRect& rect)
 
 void UIElement::SetColor(const Color& color)
 {
+    MarkBatchesDirty();
     for (auto& cornerColor : colors_)
         cornerColor = color;
     colorGradient_ = false;
@@ -829,6 +838,7 @@ void UIElement::SetColor(const Color& color)
 
 void UIElement::SetColor(Corner corner, const Color& color)
 {
+    MarkBatchesDirty();
     colors_[corner] = color;
     colorGradient_ = false;
     derivedColorDirty_ = true;
@@ -1077,6 +1087,7 @@ void UIElement::SetLayoutFlexScale(const Vector2& scale)
 void UIElement::SetIndent(int indent)
 {
     indent_ = indent;
+    MarkBatchesDirty();
     if (parent_)
         parent_->UpdateLayout();
     UpdateLayout();
@@ -1086,6 +1097,7 @@ void UIElement::SetIndent(int indent)
 void UIElement::SetIndentSpacing(int indentSpacing)
 {
     indentSpacing_ = Max(indentSpacing, 0);
+    MarkBatchesDirty();
     if (parent_)
         parent_->UpdateLayout();
     UpdateLayout();
@@ -1100,11 +1112,15 @@ void UIElement::UpdateLayout()
     // Prevent further updates while this update happens
     DisableLayoutUpdate();
 
-    PODVector<int> positions;
-    PODVector<int> sizes;
-    PODVector<int> minSizes;
-    PODVector<int> maxSizes;
-    PODVector<float> flexScales;
+    // Use frame-allocated temporaries, as layouts may be updated every frame. Rewind them on return, as filling a layout
+    // updates it once per added child
+    FrameAllocatorScope frameScope;
+    unsigned numChildren = layoutMode_ != LM_FREE ? children_.Size() : 0;
+    FramePODVector<int> positions(numChildren);
+    FramePODVector<int> sizes(numChildren);
+    FramePODVector<int> minSizes(numChildren);
+    FramePODVector<int> maxSizes(numChildren);
+    FramePODVector<float> flexScales(numChildren);
 
     int baseIndentWidth = GetIndentWidth();
 
@@ -1822,6 +1838,73 @@ void UIElement::AdjustScissor(IntRect& currentScissor)
     }
 }
 
+bool UIElement::GetCachedBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor)
+{
+    if (!IsBatchCacheable())
+    {
+        // Rebuild the cache when the element becomes cacheable again
+        batchesDirty_ = true;
+        GetBatches(batches, vertexData, currentScissor);
+        return true;
+    }
+
+    const IntVector2& screenPosition = GetScreenPosition();
+    float opacity = GetDerivedOpacity();
+    unsigned state = (hovering_ ? 1 : 0) | (selected_ ? 2 : 0) | (HasFocus() ? 4 : 0) | (enabled_ ? 8 : 0);
+    bool rebuild = batchesDirty_ || currentScissor != cachedScissor_ || size_ != cachedSize_ || opacity != cachedOpacity_ ||
+        state != cachedState_;
+
+    if (rebuild)
+    {
+        cachedBatches_.Clear();
+        cachedVertexData_.Clear();
+        GetBatches(cachedBatches_, cachedVertexData_, currentScissor);
+
+        cachedScissor_ = currentScissor;
+        cachedScreenPosition_ = screenPosition;
+        cachedSize_ = size_;
+        cachedOpacity_ = opacity;
+        cachedState_ = state;
+        batchesDirty_ = false;
+    }
+    else
+    {
+        // Moving does not change the batches other than by translation, so adjust the cached vertices in place
+        if (screenPosition != cachedScreenPosition_)
+        {
+            Vector2 floatOffset((float)(screenPosition.x_ - cachedScreenPosition_.x_),
+                (float)(screenPosition.y_ - cachedScreenPosition_.y_));
+            for (unsigned i = 0; i < cachedVertexData_.Size(); i += UI_VERTEX_SIZE)
+            {
+                cachedVertexData_[i] += floatOffset.x_;
+                cachedVertexData_[i + 1] += floatOffset.y_;
+            }
+            cachedScreenPosition_ = screenPosition;
+        }
+
+        // Reset hovering for next frame, as GetBatches() would do
+        hovering_ = false;
+    }
+
+    if (cachedVertexData_.Empty())
+        return rebuild;
+
+    unsigned vertexStart = vertexData.Size();
+    vertexData.Resize(vertexStart + cachedVertexData_.Size());
+    memcpy(&vertexData[vertexStart], &cachedVertexData_[0], cachedVertexData_.Size() * sizeof(float));
+
+    for (PODVector<UIBatch>::ConstIterator i = cachedBatches_.Begin(); i != cachedBatches_.End(); ++i)
+    {
+        UIBatch batch = *i;
+        batch.vertexData_ = &vertexData;
+        batch.vertexStart_ += vertexStart;
+        batch.vertexEnd_ += vertexStart;
+        UIBatch::AddOrMerge(batch, batches);
+    }
+
+    return rebuild;
+}
+
 void UIElement::GetBatchesWithOffset(IntVector2& offset, PODVector<UIBatch>& batches, PODVector<float>& vertexData,
     IntRect currentScissor)
 {
@@ -2067,7 +2150,7 @@ void UIElement::ApplyStyleRecursive(UIElement* element)
     }
 }
 
-int UIElement::CalculateLayoutParentSize(const PODVector<int>& sizes, int begin, int end, int spacing)
+int UIElement::CalculateLayoutParentSize(const FramePODVector<int>& sizes, int begin, int end, int spacing)
 {
     int width = begin + end;
     if (sizes.Empty())
@@ -2084,8 +2167,8 @@ int UIElement::CalculateLayoutParentSize(const PODVector<int>& sizes, int begin,
     return width - spacing;
 }
 
-void UIElement::CalculateLayout(PODVector<int>& positions, PODVector<int>& sizes, const PODVector<int>& minSizes,
-    const PODVector<int>& maxSizes, const PODVector<float>& flexScales, int targetSize, int begin, int end, int spacing)
+void UIElement::CalculateLayout(FramePODVector<int>& positions, FramePODVector<int>& sizes, const FramePODVector<int>& minSizes,
+    const FramePODVector<int>& maxSizes, const FramePODVector<float>& flexScales, int targetSize, int begin, int end, int spacing)
 {
     unsigned numChildren = sizes.Size();
     if (!numChildren)
@@ -2116,6 +2199,7 @@ void UIElement::CalculateLayout(PODVector<int>& positions, PODVector<int>& sizes
     }
 
     // Error correction passes
+    FramePODVector<unsigned> resizable(numChildren);
     for (;;)
     {
         int actualTotalSize = 0;
@@ -2127,7 +2211,7 @@ void UIElement::CalculateLayout(PODVector<int>& positions, PODVector<int>& sizes
             break;
 
         // Check which of the children can be resized to correct the error. If none, must break
-        PODVector<unsigned> resizable;
+        resizable.Clear();
         for (unsigned i = 0; i < numChildren; ++i)
         {
             if (error < 0 && sizes[i] > minSizes[i])
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/FrameAllocator.h"
 #include "../Math/Vector2.h"
 #include "../Resource/XMLFile.h"
 #include "../Scene/Animatable.h"
@@ -124,6 +125,8 @@ public:
     /// Register object factory.
     static void RegisterObject(Context* context);
 
+    /// Handle attribute write access.
+    void OnSetAttribute(const AttributeInfo& attr, const Variant& src) override;
     /// Apply attribute changes that can not be applied immediately.
     void ApplyAttributes() override;
     /// Load from XML data. Return true if successful.
@@ -143,6 +146,8 @@ public:
     virtual const IntVector2& GetScreenPosition() const;
     /// Return UI rendering batches.
     virtual void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor);
+    /// Return whether the batches can currently be cached. Changes of screen position, size, scissor, opacity and hover, selection, focus or enabled state are detected automatically; elements whose batches depend on other state must call MarkBatchesDirty() when it changes, or return false here.
+    virtual bool IsBatchCacheable() { return true; }
     /// Return UI rendering batches for debug draw.
     virtual void GetDebugDrawBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor);
     /// React to mouse hover.
@@ -621,6 +626,10 @@ public:
     void SetChildOffset(const IntVector2& offset);
     /// Set hovering state.
     void SetHovering(bool enable);
+    /// Mark the cached UI rendering batches dirty so that they are rebuilt on next render.
+    void MarkBatchesDirty() { batchesDirty_ = true; }
+    /// Return UI rendering batches from the cache, rebuilding them first if they are out of date. Return true if rebuilt. Called by UI.
+    bool GetCachedBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor);
     /// Adjust scissor for rendering.
     void AdjustScissor(IntRect& currentScissor);
     /// Get UI rendering batches with a specified offset. Also recurse to child elements.
@@ -745,11 +754,11 @@ private:
     /// Recursively apply style to a child element hierarchy when adding to an element.
     void ApplyStyleRecursive(UIElement* element);
     /// Calculate layout width for resizing the parent element.
-    int CalculateLayoutParentSize(const PODVector<int>& sizes, int begin, int end, int spacing);
+    int CalculateLayoutParentSize(const FramePODVector<int>& sizes, int begin, int end, int spacing);
     /// Calculate child widths/positions in the layout.
     void CalculateLayout
-        (PODVector<int>& positions, PODVector<int>& sizes, const PODVector<int>& minSizes, const PODVector<int>& maxSizes,
-            const PODVector<float>& flexScales, int targetSize, int begin, int end, int spacing);
+        (FramePODVector<int>& positions, FramePODVector<int>& sizes, const FramePODVector<int>& minSizes,
+            const FramePODVector<int>& maxSizes, const FramePODVector<float>& flexScales, int targetSize, int begin, int end, int spacing);
     /// Get child element constant position in a layout.
     IntVector2 GetLayoutChildPosition(UIElement* child);
     /// Detach from parent.
@@ -809,6 +818,22 @@ private:
     static XPathQuery styleXPathQuery_;
     /// Tag list.
     StringVector tags_;
+    /// Batches cached from the last rebuild.
+    PODVector<UIBatch> cachedBatches_;
+    /// Vertex data of the cached batches.
+    PODVector<float> cachedVertexData_;
+    /// Scissor of the cached batches.
+    IntRect cachedScissor_;
+    /// Screen position of the cached vertex data.
+    IntVector2 cachedScreenPosition_;
+    /// Size of the cached batches.
+    IntVector2 cachedSize_;
+    /// Derived opacity of the cached batches.
+    float cachedOpacity_{};
+    /// Hover, selection, focus and enabled state bits of the cached batches.
+    unsigned cachedState_{};
+    /// Cached batches dirty flag.
+    bool batchesDirty_{true};
 };
 
 template <class T> T* UIElement::CreateChild(const String& name, unsigned index)
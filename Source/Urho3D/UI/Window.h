@@ -57,6 +57,8 @@ public:
 
     /// Return UI rendering batches.
     void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor) override;
+    /// Return whether the batches can currently be cached. Not while modal, as the modal shade depends on the root element.
+    bool IsBatchCacheable() override { return !modal_; }
 
     /// React to mouse hover.
     void OnHover(const IntVector2& position, const IntVector2& screenPosition, int buttons, int qualifiers, Cursor* cursor) override;
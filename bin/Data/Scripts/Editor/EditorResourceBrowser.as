@@ -96,11 +96,13 @@ const StringHash JSON_TYPE_GENERIC("json");
 const StringHash BINARY_TYPE_SCENE("USCN");
 const StringHash BINARY_TYPE_PACKAGE("UPAK");
 const StringHash BINARY_TYPE_COMPRESSED_PACKAGE("ULZ4");
+const StringHash BINARY_TYPE_BLOCK_COMPRESSED_PACKAGE("ULZB");
 const StringHash BINARY_TYPE_ANGELSCRIPT("ASBC");
 const StringHash BINARY_TYPE_MODEL("UMDL");
 const StringHash BINARY_TYPE_MODEL2("UMD2");
 const StringHash BINARY_TYPE_SHADER("USHD");
 const StringHash BINARY_TYPE_ANIMATION("UANI");
+const StringHash BINARY_TYPE_COMPRESSED_ANIMATION("UANC");
 
 const StringHash EXTENSION_TYPE_TTF(".ttf");
 const StringHash EXTENSION_TYPE_OTF(".otf");
@@ -1086,7 +1088,7 @@ int GetResourceType(StringHash fileType)
         return RESOURCE_TYPE_SCENE;
     else if (fileType == BINARY_TYPE_PACKAGE)
         return RESOURCE_TYPE_UNUSABLE;
-    else if (fileType == BINARY_TYPE_COMPRESSED_PACKAGE)
+    else if (fileType == BINARY_TYPE_COMPRESSED_PACKAGE || fileType == BINARY_TYPE_BLOCK_COMPRESSED_PACKAGE)
         return RESOURCE_TYPE_UNUSABLE;
     else if (fileType == BINARY_TYPE_ANGELSCRIPT)
         return RESOURCE_TYPE_SCRIPTFILE;
@@ -1094,7 +1096,7 @@ int GetResourceType(StringHash fileType)
         return RESOURCE_TYPE_MODEL;
     else if (fileType == BINARY_TYPE_SHADER)
         return RESOURCE_TYPE_UNUSABLE;
-    else if (fileType == BINARY_TYPE_ANIMATION)
+    else if (fileType == BINARY_TYPE_ANIMATION || fileType == BINARY_TYPE_COMPRESSED_ANIMATION)
         return RESOURCE_TYPE_ANIMATION;
 
     // XML filetypes
@@ -1309,7 +1311,7 @@ bool GetBinaryType(String path, StringHash &out fileType, bool useCache = false)
         fileType = BINARY_TYPE_SCENE;
     else if (type == BINARY_TYPE_PACKAGE)
         fileType = BINARY_TYPE_PACKAGE;
-    else if (type == BINARY_TYPE_COMPRESSED_PACKAGE)
+    else if (type == BINARY_TYPE_COMPRESSED_PACKAGE || type == BINARY_TYPE_BLOCK_COMPRESSED_PACKAGE)
         fileType = BINARY_TYPE_COMPRESSED_PACKAGE;
     else if (type == BINARY_TYPE_ANGELSCRIPT)
         fileType = BINARY_TYPE_ANGELSCRIPT;
@@ -1317,7 +1319,7 @@ bool GetBinaryType(String path, StringHash &out fileType, bool useCache = false)
         fileType = BINARY_TYPE_MODEL;
     else if (type == BINARY_TYPE_SHADER)
         fileType = BINARY_TYPE_SHADER;
-    else if (type == BINARY_TYPE_ANIMATION)
+    else if (type == BINARY_TYPE_ANIMATION || type == BINARY_TYPE_COMPRESSED_ANIMATION)
         fileType = BINARY_TYPE_ANIMATION;
     else
         return false;